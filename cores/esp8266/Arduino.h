@@ -173,6 +173,7 @@ int analogRead(uint8_t pin);
 void analogReference(uint8_t mode);
 void analogWrite(uint8_t pin, int val);
 void analogWriteMode(uint8_t pin, int val, bool openDrain);
+void analogWriteBatch(const uint8_t *pins, const int *values, size_t count);
 void analogWriteFreq(uint32_t freq);
 void analogWriteResolution(int res);
 void analogWriteRange(uint32_t range);
@@ -0,0 +1,177 @@
+/*
+    DeltaPatch.cpp - streaming binary patch decoder
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <MD5Builder.h>
+#include "DeltaPatch.h"
+
+static uint32_t get32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void DeltaPatch::begin(Print& out, Reader source, uint32_t sourceSize)
+{
+    _out        = &out;
+    _source     = std::move(source);
+    _sourceSize = sourceSize;
+    _error      = DELTA_OK;
+    _state      = HEADER;
+    _targetSize = 0;
+    _targetPos  = 0;
+    _sourcePos  = 0;
+    _diffLeft   = 0;
+    _extraLeft  = 0;
+    _nextPos    = 0;
+    _headLen    = 0;
+}
+
+size_t DeltaPatch::write(const uint8_t* data, size_t size)
+{
+    if (!_out || _error != DELTA_OK)
+        return 0;
+
+    size_t consumed = 0;
+    while (consumed < size && _state != DONE)
+    {
+        size_t left = size - consumed;
+        switch (_state)
+        {
+        case HEADER:
+        case RECORD:
+        {
+            size_t want = (_state == HEADER ? headerSize : recordSize) - _headLen;
+            size_t n    = std::min(left, want);
+            memcpy(_head + _headLen, data + consumed, n);
+            _headLen += n;
+            consumed += n;
+            if (n == want && !(_state == HEADER ? _header() : _record()))
+                return 0;
+            break;
+        }
+
+        case DIFF:
+        {
+            size_t n = std::min(std::min(left, sizeof(_buf)), (size_t)_diffLeft);
+            if (!_source(_sourcePos, _buf, n))
+            {
+                _fail(DELTA_ERR_READ);
+                return 0;
+            }
+            for (size_t i = 0; i < n; i++)
+                _buf[i] += data[consumed + i];
+            if (_out->write(_buf, n) != n)
+            {
+                _fail(DELTA_ERR_OUTPUT);
+                return 0;
+            }
+            consumed += n;
+            _sourcePos += n;
+            _targetPos += n;
+            _diffLeft -= n;
+            if (!_diffLeft)
+            {
+                _state = _extraLeft ? EXTRA : RECORD;
+                if (_state == RECORD)
+                    _sourcePos = _nextPos;
+            }
+            break;
+        }
+
+        case EXTRA:
+        {
+            size_t n = std::min(left, (size_t)_extraLeft);
+            if (_out->write(data + consumed, n) != n)
+            {
+                _fail(DELTA_ERR_OUTPUT);
+                return 0;
+            }
+            consumed += n;
+            _targetPos += n;
+            _extraLeft -= n;
+            if (!_extraLeft)
+            {
+                _sourcePos = _nextPos;
+                _state     = RECORD;
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        if (_state == RECORD && !_headLen && _targetPos == _targetSize)
+            _state = DONE;
+    }
+    return size;
+}
+
+bool DeltaPatch::_header()
+{
+    _headLen = 0;
+    if (memcmp_P(_head, PSTR("ESPD"), 4))
+        return _fail(DELTA_ERR_HEADER);
+    if (get32(_head + 4) != _sourceSize || _sourceSize < sourceSkip)
+        return _fail(DELTA_ERR_SOURCE);
+    _targetSize = get32(_head + 8);
+
+    MD5Builder md5;
+    md5.begin();
+    for (uint32_t pos = sourceSkip; pos < _sourceSize;)
+    {
+        size_t n = std::min((size_t)(_sourceSize - pos), sizeof(_buf));
+        if (!_source(pos, _buf, n))
+            return _fail(DELTA_ERR_READ);
+        md5.add(_buf, n);
+        pos += n;
+    }
+    md5.calculate();
+    uint8_t sum[16];
+    md5.getBytes(sum);
+    if (memcmp(sum, _head + 12, sizeof(sum)))
+        return _fail(DELTA_ERR_SOURCE);
+
+    _state = RECORD;
+    return true;
+}
+
+bool DeltaPatch::_record()
+{
+    _headLen   = 0;
+    _diffLeft  = get32(_head);
+    _extraLeft = get32(_head + 4);
+    int32_t seek = (int32_t)get32(_head + 8);
+
+    if (_diffLeft > _targetSize - _targetPos || _extraLeft > _targetSize - _targetPos - _diffLeft)
+        return _fail(DELTA_ERR_DATA);
+    if (_diffLeft && (_sourcePos < sourceSkip || _diffLeft > _sourceSize - _sourcePos))
+        return _fail(DELTA_ERR_DATA);
+
+    // the seek applies after the diff moved the source offset
+    int64_t next = (int64_t)_sourcePos + _diffLeft + seek;
+    if (next < 0 || next > _sourceSize)
+        return _fail(DELTA_ERR_DATA);
+
+    _nextPos = (uint32_t)next;
+    _state   = _diffLeft ? DIFF : _extraLeft ? EXTRA : RECORD;
+    if (_state == RECORD)
+        _sourcePos = _nextPos;
+    return true;
+}
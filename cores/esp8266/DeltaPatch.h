@@ -0,0 +1,175 @@
+/*
+    DeltaPatch.h - streaming binary patch decoder
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef __DELTAPATCH_H
+#define __DELTAPATCH_H
+
+#include <Stream.h>
+#include <functional>
+
+// Rebuilds a target image from a source image, read back at any offset
+// through a callback, and a patch as made by tools/delta.py.  The patch is
+// written to it in pieces of any size (it is a write-only Stream, like
+// Inflate, which can be chained in front of it for compressed patches) and
+// the target goes to the Print given to begin().  Memory use is a few
+// hundred bytes whatever the image size.
+//
+// Patch format (bsdiff style, integers little endian):
+//   "ESPD", uint32 source size, uint32 target size,
+//   MD5 of the source but its first 4 bytes (flash mode and size in the
+//   image header, which upload tools may rewrite)
+//   then records until the whole target is produced:
+//     uint32 diff length, uint32 extra length, int32 source seek,
+//     diff bytes, added modulo 256 to as many source bytes, from the
+//     current source offset on,
+//     extra bytes, output as they are,
+//     and the source offset moves by the seek.
+// Diff bytes are mostly zero when code only moved, so patches compress
+// well and are best sent gzip compressed.
+
+enum DeltaPatchError : int8_t
+{
+    DELTA_OK         = 0,
+    DELTA_ERR_HEADER = -1,  // not a patch
+    DELTA_ERR_SOURCE = -2,  // made against another source image
+    DELTA_ERR_DATA   = -3,  // record out of the source or target bounds
+    DELTA_ERR_READ   = -4,  // reading the source failed
+    DELTA_ERR_OUTPUT = -5,  // output Print refused data
+};
+
+class DeltaPatch: public Stream
+{
+public:
+    using Reader = std::function<bool(uint32_t offset, uint8_t* data, size_t size)>;
+
+    DeltaPatch() = default;
+    DeltaPatch(const DeltaPatch&) = delete;
+    DeltaPatch& operator=(const DeltaPatch&) = delete;
+
+    void begin(Print& out, Reader source, uint32_t sourceSize);
+    void end()
+    {
+        _out = nullptr;
+    }
+
+    // First byte of every patch
+    static bool isPatchStart(uint8_t c)
+    {
+        return c == 'E';
+    }
+
+    // Applies and forwards to the output, returns 0 on error
+    // (and size once the whole target was output, ignoring the rest)
+    virtual size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    virtual size_t write(const uint8_t* data, size_t size) override;
+    virtual int    availableForWrite() override
+    {
+        return sizeof(_buf);
+    }
+    virtual bool outputCanTimeout() override
+    {
+        return _out && _out->outputCanTimeout();
+    }
+
+    // Stream, nothing to read
+    virtual int available() override
+    {
+        return 0;
+    }
+    virtual int read() override
+    {
+        return -1;
+    }
+    virtual int peek() override
+    {
+        return -1;
+    }
+
+    // Some of the patch was written
+    bool started() const
+    {
+        return _state != HEADER || _headLen;
+    }
+    // The whole target was output
+    bool finished() const
+    {
+        return _state == DONE;
+    }
+    DeltaPatchError getError() const
+    {
+        return _error;
+    }
+    // Target size from the header, 0 before
+    uint32_t targetSize() const
+    {
+        return _targetSize;
+    }
+    // Target bytes output so far
+    uint32_t patched() const
+    {
+        return _targetPos;
+    }
+
+protected:
+    enum State : uint8_t
+    {
+        HEADER,
+        RECORD,
+        DIFF,
+        EXTRA,
+        DONE,
+    };
+
+    static constexpr size_t headerSize = 28;
+    static constexpr size_t recordSize = 12;
+    // source bytes not covered by the header MD5, never diffed against
+    static constexpr uint32_t sourceSkip = 4;
+
+    bool _header();
+    bool _record();
+    bool _fail(DeltaPatchError error)
+    {
+        _error = error;
+        return false;
+    }
+
+    Print*          _out = nullptr;
+    Reader          _source;
+    uint32_t        _sourceSize = 0;
+    DeltaPatchError _error      = DELTA_OK;
+    State           _state      = HEADER;
+
+    uint32_t _targetSize = 0;
+    uint32_t _targetPos  = 0;
+    uint32_t _sourcePos  = 0;
+    uint32_t _diffLeft   = 0;
+    uint32_t _extraLeft  = 0;
+    uint32_t _nextPos    = 0;  // source offset after the current record
+
+    // header or record being received
+    uint8_t _head[headerSize];
+    uint8_t _headLen = 0;
+    // source bytes, patched in place
+    uint8_t _buf[256];
+};
+
+#endif  // __DELTAPATCH_H
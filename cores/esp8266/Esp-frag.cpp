@@ -61,3 +61,28 @@ uint8_t EspClass::getHeapFragmentation()
   return (uint8_t)umm_fragmentation_metric();
 }
 #endif
+
+bool EspClass::getHeapStats(size_t sizeClass, uint16_t* size, uint16_t* used, uint16_t* count, uint32_t* fallbacks)
+{
+#if defined(UMM_SLAB)
+  UMM_SLAB_STATS stats;
+  if (!umm_slab_get_stats(sizeClass, &stats))
+    return false;
+  if (size)
+    *size = stats.size;
+  if (used)
+    *used = stats.used;
+  if (count)
+    *count = stats.count;
+  if (fallbacks)
+    *fallbacks = stats.fallbacks;
+  return true;
+#else
+  (void)sizeClass;
+  (void)size;
+  (void)used;
+  (void)count;
+  (void)fallbacks;
+  return false;
+#endif
+}
@@ -721,6 +721,9 @@ static SpiFlashOpResult spi_flash_write_page_break(uint32_t offset, uint32_t *da
     }
 
     // finally, the remaining data
+    if (size == size_page_aligned) {
+        return result;
+    }
     return spi_flash_write(offset + size_page_aligned, data + (size_page_aligned >> 2), size - size_page_aligned);
 }
 
@@ -773,100 +776,10 @@ static SpiFlashOpResult spi_flash_write_puya(uint32_t offset, uint32_t *data, si
 }
 #endif
 
-static constexpr size_t Alignment { 4 };
-
-template <typename T>
-static T aligned(T value) {
-    static constexpr auto Mask = Alignment - 1;
-    return (value + Mask) & ~Mask;
-}
-
-template <typename T>
-static T alignBefore(T value) {
-    return aligned(value) - Alignment;
-}
-
-static bool isAlignedAddress(uint32_t address) {
-    return (address & (Alignment - 1)) == 0;
-}
-
-static bool isAlignedSize(size_t size) {
-    return (size & (Alignment - 1)) == 0;
-}
-
-static bool isAlignedPointer(const uint8_t *ptr) {
-    return isAlignedAddress(reinterpret_cast<uint32_t>(ptr));
-}
-
-
+// Unaligned addresses, buffers and sizes are handled by flash_hal_write(),
+// one program operation per flash page touched
 size_t EspClass::flashWriteUnalignedMemory(uint32_t address, const uint8_t *data, size_t size) {
-    auto flash_write = [](uint32_t address, uint8_t *data, size_t size) {
-        return spi_flash_write(address, reinterpret_cast<uint32_t *>(data), size) == SPI_FLASH_RESULT_OK;
-    };
-
-    auto flash_read = [](uint32_t address, uint8_t *data, size_t size) {
-        return spi_flash_read(address, reinterpret_cast<uint32_t *>(data), size) == SPI_FLASH_RESULT_OK;
-    };
-
-    constexpr size_t BufferSize { FLASH_PAGE_SIZE };
-    alignas(alignof(uint32_t)) uint8_t buf[BufferSize];
-
-    size_t written = 0;
-
-    if (!isAlignedAddress(address)) {
-        auto before_address = alignBefore(address);
-        auto offset = address - before_address;
-        auto wlen = std::min(Alignment - offset, size);
-
-        if (!flash_read(before_address, &buf[0], Alignment)) {
-            return 0;
-        }
-
-#if PUYA_SUPPORT
-        if (getFlashChipVendorId() == SPI_FLASH_VENDOR_PUYA) {
-            for (size_t i = 0; i < wlen ; ++i) {
-                buf[offset + i] &= data[i];
-            }
-        } else {
-#endif
-            memcpy(&buf[offset], data, wlen);
-#if PUYA_SUPPORT
-        }
-#endif
-
-        if (!flash_write(before_address, &buf[0], Alignment)) {
-            return 0;
-        }
-
-        address += wlen;
-        data += wlen;
-        written += wlen;
-        size -= wlen;
-    }
-
-    while (size > 0) {
-        auto len = std::min(size, BufferSize);
-        auto wlen = aligned(len);
-
-        if (wlen != len) {
-            auto partial = wlen - Alignment;
-            if (!flash_read(address + partial, &buf[partial], Alignment)) {
-                return written;
-            }
-        }
-
-        memcpy(&buf[0], data, len);
-        if (!flashWrite(address, reinterpret_cast<const uint32_t *>(&buf[0]), wlen)) {
-            return written;
-        }
-
-        address += len;
-        data += len;
-        written += len;
-        size -= len;
-    }
-
-    return written;
+    return flash_hal_write(address, size, data) == FLASH_HAL_OK ? size : 0;
 }
 
 bool EspClass::flashWrite(uint32_t address, const uint32_t *data, size_t size) {
@@ -885,56 +798,15 @@ bool EspClass::flashWrite(uint32_t address, const uint32_t *data, size_t size) {
 
 bool EspClass::flashWrite(uint32_t address, const uint8_t *data, size_t size) {
     if (data && size) {
-        if (!isAlignedAddress(address)
-         || !isAlignedPointer(data)
-         || !isAlignedSize(size))
-        {
-            return flashWriteUnalignedMemory(address, data, size) == size;
-        }
-
-        return flashWrite(address, reinterpret_cast<const uint32_t *>(data), size);
+        return flash_hal_write(address, size, data) == FLASH_HAL_OK;
     }
 
     return false;
 }
 
 bool EspClass::flashRead(uint32_t address, uint8_t *data, size_t size) {
-    size_t sizeAligned = size & ~3;
-    size_t currentOffset = 0;
-
-    if ((uintptr_t)data % 4 != 0) {
-        constexpr size_t BufferSize { FLASH_PAGE_SIZE / sizeof(uint32_t) };
-        alignas(alignof(uint32_t)) uint32_t buf[BufferSize];
-        size_t sizeLeft = sizeAligned;
-
-        while (sizeLeft) {
-            size_t willCopy = std::min(sizeLeft, BufferSize);
-            // We read to our aligned buffer and then copy to data
-            if (!flashRead(address + currentOffset, &buf[0], willCopy))
-            {
-                return false;
-            }
-            memcpy(data + currentOffset, &buf[0], willCopy);
-            sizeLeft -= willCopy;
-            currentOffset += willCopy;
-        }
-    } else {
-        // Pointer is properly aligned, so use aligned read
-        if (!flashRead(address, reinterpret_cast<uint32_t *>(data), sizeAligned)) {
-            return false;
-        }
-        currentOffset = sizeAligned;
-    }
-
-    if (currentOffset < size) {
-        uint32_t tempData;
-        if (spi_flash_read(address + currentOffset, &tempData, sizeof(tempData)) != SPI_FLASH_RESULT_OK) {
-            return false;
-        }
-        memcpy(data + currentOffset, &tempData, size - currentOffset);
-    }
-
-    return true;
+    // Unaligned buffers and sizes take one more read
+    return flash_hal_read(address, size, data) == FLASH_HAL_OK;
 }
 
 bool EspClass::flashRead(uint32_t address, uint32_t *data, size_t size) {
@@ -120,6 +120,9 @@ class EspClass {
         static void getHeapStats(uint32_t* free = nullptr, uint16_t* max = nullptr, uint8_t* frag = nullptr) __attribute__((deprecated("Use 'uint32_t*' on max, 2nd argument")));
         static void getHeapStats(uint32_t* free = nullptr, uint32_t* max = nullptr, uint8_t* frag = nullptr);
 #endif
+        // size class of the UMM_SLAB pools of the current heap, false past the
+        // last class or when built without UMM_SLAB (nullptr for unused values)
+        static bool getHeapStats(size_t sizeClass, uint16_t* size, uint16_t* used, uint16_t* count, uint32_t* fallbacks);
         static uint32_t getFreeContStack();
         static void resetFreeContStack();
 
@@ -195,7 +198,7 @@ class EspClass {
          * @brief Read @a size bytes to @a data to flash at @a address
          * This overload handles all misalignment cases
          * @param address address on flash where read should start
-         * @param data input buffer, passing unaligned memory will cause significant stack usage
+         * @param data output buffer, unaligned memory will cause an additional read
          * @param size amount of data, passing not multiple of 4 will cause additional read
          * @return bool result of operation
          */
@@ -380,6 +380,17 @@ bool FS::exists(const String& path) {
     return exists(path.c_str());
 }
 
+bool FS::stat(const char* path, FSStat& st) {
+    if (!_impl) {
+        return false;
+    }
+    return _impl->stat(path, st);
+}
+
+bool FS::stat(const String& path, FSStat& st) {
+    return stat(path.c_str(), st);
+}
+
 Dir FS::openDir(const char* path) {
     if (!_impl) {
         return Dir();
@@ -182,6 +182,13 @@ struct FSInfo64 {
     size_t maxPathLength;
 };
 
+// File metadata, without opening it
+struct FSStat {
+    size_t size;
+    time_t lastWrite; // 0 when the filesystem has no timestamps
+    bool isDir;
+};
+
 
 class FSConfig
 {
@@ -229,6 +236,9 @@ public:
     bool exists(const char* path);
     bool exists(const String& path);
 
+    bool stat(const char* path, FSStat& st);
+    bool stat(const String& path, FSStat& st);
+
     Dir openDir(const char* path);
     Dir openDir(const String& path);
 
@@ -278,6 +288,7 @@ using fs::SeekSet;
 using fs::SeekCur;
 using fs::SeekEnd;
 using fs::FSInfo;
+using fs::FSStat;
 using fs::FSConfig;
 using fs::SPIFFSConfig;
 #endif //FS_NO_GLOBALS
@@ -116,6 +116,7 @@ public:
     virtual bool gc() { return true; } // May not be implemented in all file systems.
     virtual bool check() { return true; } // May not be implemented in all file systems.
     virtual time_t getCreationTime() { return 0; } // May not be implemented in all file systems.
+    virtual bool stat(const char* path, FSStat& st) { (void)path; (void)st; return false; } // May not be implemented in all file systems.
 
     // Filesystems *may* support a timestamp per-file, so allow the user to override with
     // their own callback for all files on this FS.  The default implementation simply
@@ -38,13 +38,17 @@
 void serialEvent() __attribute__((weak));
 
 HardwareSerial::HardwareSerial(int uart_nr)
-    : _uart_nr(uart_nr), _rx_size(256)
+    : _uart_nr(uart_nr), _rx_size(256), _tx_size(0), _tx_blocking(true)
 {}
 
 void HardwareSerial::begin(unsigned long baud, SerialConfig config, SerialMode mode, uint8_t tx_pin, bool invert)
 {
     end();
     _uart = uart_init(_uart_nr, baud, (int) config, (int) mode, tx_pin, _rx_size, invert);
+    if(_tx_size) {
+        uart_resize_tx_buffer(_uart, _tx_size);
+    }
+    uart_set_tx_blocking(_uart, _tx_blocking);
 #if defined(DEBUG_ESP_PORT) && !defined(NDEBUG)
     if (static_cast<void*>(this) == static_cast<void*>(&DEBUG_ESP_PORT))
     {
@@ -83,6 +87,21 @@ size_t HardwareSerial::setRxBufferSize(size_t size){
     return _rx_size;
 }
 
+size_t HardwareSerial::setTxBufferSize(size_t size){
+    if(_uart) {
+        _tx_size = uart_resize_tx_buffer(_uart, size);
+    } else {
+        _tx_size = size;
+    }
+    return _tx_size;
+}
+
+void HardwareSerial::setTxBlocking(bool blocking)
+{
+    _tx_blocking = blocking;
+    uart_set_tx_blocking(_uart, blocking);
+}
+
 void HardwareSerial::setDebugOutput(bool en)
 {
     if(!_uart) {
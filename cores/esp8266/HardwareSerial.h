@@ -101,6 +101,22 @@ public:
         return uart_get_rx_buffer_size(_uart);
     }
 
+    /*
+     * Optional TX buffer (none by default), sent from the UART interrupt:
+     * write() returns once data is queued rather than when it reaches the
+     * TX FIFO, and availableForWrite() includes its free space.
+     */
+    size_t setTxBufferSize(size_t size);
+    size_t getTxBufferSize()
+    {
+        return uart_get_tx_buffer_size(_uart);
+    }
+    /*
+     * When the TX buffer is full, write() waits for room (default) or
+     * returns how much it queued
+     */
+    void setTxBlocking(bool blocking);
+
     bool swap()
     {
         return swap(1);
@@ -231,6 +247,8 @@ protected:
     int _uart_nr;
     uart_t* _uart = nullptr;
     size_t _rx_size;
+    size_t _tx_size;
+    bool _tx_blocking;
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SERIAL)
@@ -0,0 +1,639 @@
+/*
+    Inflate.cpp - streaming DEFLATE decoder
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+// Canonical Huffman decoding is done one bit at a time as in zlib's puff.c,
+// which needs no lookup tables beyond the per length symbol counts.
+
+#include <Arduino.h>
+#include <new>
+#include "Inflate.h"
+
+static const uint16_t lengthBase[29] PROGMEM
+    = { 3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+        31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uint8_t lengthExtra[29] PROGMEM
+    = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const uint16_t distBase[30] PROGMEM
+    = { 1,   2,   3,   4,   5,   7,    9,    13,   17,   25,   33,   49,   65,    97,    129,
+        193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uint8_t distExtra[30] PROGMEM
+    = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uint8_t codeLengthOrder[19] PROGMEM
+    = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+// CRC32 as used by gzip (reflected 0xedb88320, unlike the core's crc32())
+static const uint32_t crcTable[16] PROGMEM
+    = { 0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4,
+        0x4db26158, 0x5005713c, 0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c,
+        0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c };
+
+static uint32_t gzipCrc(uint32_t crc, const uint8_t* data, size_t len)
+{
+    while (len--)
+    {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ pgm_read_dword(&crcTable[crc & 15]);
+        crc = (crc >> 4) ^ pgm_read_dword(&crcTable[crc & 15]);
+    }
+    return crc;
+}
+
+static uint32_t adler32(uint32_t adler, const uint8_t* data, size_t len)
+{
+    uint32_t a = adler & 0xffff;
+    uint32_t b = adler >> 16;
+    while (len)
+    {
+        // largest n such that b cannot overflow before the modulo
+        size_t n = len < 5552 ? len : 5552;
+        len -= n;
+        while (n--)
+        {
+            a += *data++;
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+// Builds the counts and sorted symbols of the canonical code with these
+// lengths, returns 0 for a complete code, > 0 for an incomplete one and < 0
+// for an over-subscribed one.
+static int buildCode(uint16_t* count, uint16_t* symbol, const uint8_t* length, int n)
+{
+    uint16_t offs[16];
+
+    memset(count, 0, 16 * sizeof(count[0]));
+    for (int s = 0; s < n; s++)
+        count[length[s]]++;
+    if (count[0] == n)
+        return 0;
+
+    int left = 1;
+    for (int len = 1; len < 16; len++)
+    {
+        left <<= 1;
+        left -= count[len];
+        if (left < 0)
+            return left;
+    }
+
+    offs[1] = 0;
+    for (int len = 1; len < 15; len++)
+        offs[len + 1] = offs[len] + count[len];
+    for (int s = 0; s < n; s++)
+        if (length[s])
+            symbol[offs[length[s]]++] = s;
+    return left;
+}
+
+bool Inflate::begin(Print& out, InflateFormat format, uint8_t windowBits)
+{
+    end();
+    _error = INFLATE_OK;
+    if (windowBits < 8 || windowBits > 15)
+    {
+        _error = INFLATE_ERR_MEMORY;
+        return false;
+    }
+    _wsize  = 1 << windowBits;
+    _window = new (std::nothrow) uint8_t[_wsize];
+    if (!_window)
+    {
+        _error = INFLATE_ERR_MEMORY;
+        return false;
+    }
+
+    _out    = &out;
+    _format = format;
+    _wpos   = 0;
+    _wdone  = 0;
+    _inLen  = 0;
+    _inPos  = 0;
+    _bitBuf = 0;
+    _bitCnt = 0;
+    _last   = false;
+    _total  = 0;
+    switch (format)
+    {
+    case INFLATE_RAW:
+        _state = BLOCK;
+        break;
+    case INFLATE_ZLIB:
+        _state = ZLIB_HEADER;
+        break;
+    case INFLATE_GZIP:
+        _state = GZIP_HEADER;
+        break;
+    default:
+        _state = DETECT;
+        break;
+    }
+    return true;
+}
+
+void Inflate::end()
+{
+    delete[] _window;
+    _window = nullptr;
+    _out    = nullptr;
+}
+
+size_t Inflate::write(const uint8_t* data, size_t size)
+{
+    if (!_out || _error != INFLATE_OK)
+        return 0;
+
+    size_t consumed = 0;
+    while (_state != DONE)
+    {
+        if (_inPos)
+        {
+            memmove(_in, _in + _inPos, _inLen - _inPos);
+            _inLen -= _inPos;
+            _savePos -= _inPos;
+            _inPos = 0;
+        }
+        size_t n = std::min(size - consumed, sizeof(_in) - _inLen);
+        memcpy(_in + _inLen, data + consumed, n);
+        _inLen += n;
+        consumed += n;
+
+        Step step;
+        do
+        {
+            _checkpoint();
+            step = _step();
+        } while (step == PROGRESS && _state != DONE && _error == INFLATE_OK);
+        if (step == FAILED || _error != INFLATE_OK)
+            return 0;
+        if (step == NEED_INPUT)
+        {
+            _rollback();
+            // nothing decodable from a full buffer
+            if (!_inPos && _inLen == sizeof(_in))
+            {
+                _error = INFLATE_ERR_DATA;
+                return 0;
+            }
+            if (consumed == size)
+                break;
+        }
+    }
+
+    _flush();
+    return _error == INFLATE_OK ? size : 0;
+}
+
+bool Inflate::_need(uint8_t bits)
+{
+    while (_bitCnt < bits)
+    {
+        if (_inPos == _inLen)
+            return false;
+        _bitBuf |= (uint32_t)_in[_inPos++] << _bitCnt;
+        _bitCnt += 8;
+    }
+    return true;
+}
+
+// up to 16 bits, after _need() succeeded for them
+uint16_t Inflate::_bits(uint8_t bits)
+{
+    uint16_t value = _bitBuf & ((1UL << bits) - 1);
+    _bitBuf >>= bits;
+    _bitCnt -= bits;
+    return value;
+}
+
+// skips a zero terminated gzip header field, false until its end was read
+bool Inflate::_zero()
+{
+    while (_inPos < _inLen)
+        if (!_in[_inPos++])
+            return true;
+    return false;
+}
+
+// returns the symbol, -1 when more input is needed, -2 for an invalid code
+int Inflate::_decode(const uint16_t* count, const uint16_t* symbol)
+{
+    int code  = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len < 16; len++)
+    {
+        if (!_need(1))
+            return -1;
+        code |= _bits(1);
+        int n = count[len];
+        if (code - n < first)
+            return symbol[index + (code - first)];
+        index += n;
+        first += n;
+        first <<= 1;
+        code <<= 1;
+    }
+    return -2;
+}
+
+void Inflate::_put(uint8_t c)
+{
+    _window[_wpos++] = c;
+    _total++;
+    if (_wpos == _wsize)
+    {
+        _flush();
+        _wpos = _wdone = 0;
+    }
+}
+
+void Inflate::_flush()
+{
+    size_t len = _wpos - _wdone;
+    if (!len)
+        return;
+    const uint8_t* data = _window + _wdone;
+    if (_format == INFLATE_GZIP)
+        _check = gzipCrc(_check, data, len);
+    else if (_format == INFLATE_ZLIB)
+        _check = adler32(_check, data, len);
+    _wdone = _wpos;
+    if (_error == INFLATE_OK && _out->write(data, len) != len)
+        _error = INFLATE_ERR_OUTPUT;
+}
+
+Inflate::Step Inflate::_step()
+{
+    switch (_state)
+    {
+    case DETECT:
+    {
+        if (_inLen - _inPos < 2)
+            return NEED_INPUT;
+        uint8_t b0 = _in[_inPos];
+        uint8_t b1 = _in[_inPos + 1];
+        if (b0 == 0x1f && b1 == 0x8b)
+        {
+            _format = INFLATE_GZIP;
+            _state  = GZIP_HEADER;
+        }
+        else if ((b0 & 0x0f) == 8 && (b0 >> 4) <= 7 && ((b0 << 8) | b1) % 31 == 0)
+        {
+            _format = INFLATE_ZLIB;
+            _state  = ZLIB_HEADER;
+        }
+        else
+        {
+            _format = INFLATE_RAW;
+            _state  = BLOCK;
+        }
+        return PROGRESS;
+    }
+
+    case ZLIB_HEADER:
+    {
+        if (!_need(16))
+            return NEED_INPUT;
+        uint8_t cmf = _bits(8);
+        uint8_t flg = _bits(8);
+        // deflate, window up to 32KB, no preset dictionary
+        if ((cmf & 0x0f) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 || (flg & 0x20))
+            return _fail(INFLATE_ERR_HEADER);
+        _check = 1;
+        _state = BLOCK;
+        return PROGRESS;
+    }
+
+    case GZIP_HEADER:
+    {
+        if (!_need(16))
+            return NEED_INPUT;
+        if (_bits(16) != 0x8b1f)
+            return _fail(INFLATE_ERR_HEADER);
+        // method, flags, mtime, extra flags and OS
+        uint8_t header[8];
+        for (auto& b : header)
+        {
+            if (!_need(8))
+                return NEED_INPUT;
+            b = _bits(8);
+        }
+        if (header[0] != 8 || (header[1] & 0xe0))
+            return _fail(INFLATE_ERR_HEADER);
+        _flags = header[1];
+        _check = 0xffffffff;
+        _state = GZIP_EXTRA_LEN;
+        return PROGRESS;
+    }
+
+    case GZIP_EXTRA_LEN:
+        if (_flags & 0x04)
+        {
+            if (!_need(16))
+                return NEED_INPUT;
+            _skip  = _bits(16);
+            _state = GZIP_EXTRA;
+        }
+        else
+            _state = GZIP_NAME;
+        return PROGRESS;
+
+    case GZIP_EXTRA:
+    {
+        uint16_t n = std::min<uint16_t>(_skip, _inLen - _inPos);
+        _inPos += n;
+        _skip -= n;
+        if (_skip)
+            return n ? PROGRESS : NEED_INPUT;
+        _state = GZIP_NAME;
+        return PROGRESS;
+    }
+
+    case GZIP_NAME:
+    {
+        if (_flags & 0x08)
+        {
+            uint16_t pos = _inPos;
+            if (!_zero())
+                return _inPos != pos ? PROGRESS : NEED_INPUT;
+        }
+        _state = GZIP_COMMENT;
+        return PROGRESS;
+    }
+
+    case GZIP_COMMENT:
+    {
+        if (_flags & 0x10)
+        {
+            uint16_t pos = _inPos;
+            if (!_zero())
+                return _inPos != pos ? PROGRESS : NEED_INPUT;
+        }
+        _state = GZIP_HCRC;
+        return PROGRESS;
+    }
+
+    case GZIP_HCRC:
+        // the header CRC is not verified
+        if (_flags & 0x02)
+        {
+            if (!_need(16))
+                return NEED_INPUT;
+            _bits(16);
+        }
+        _state = BLOCK;
+        return PROGRESS;
+
+    case BLOCK:
+        return _block();
+
+    case STORED_LEN:
+    {
+        _bits(_bitCnt);
+        if (!_need(16))
+            return NEED_INPUT;
+        uint16_t len = _bits(16);
+        if (!_need(16))
+            return NEED_INPUT;
+        if (_bits(16) != (uint16_t)~len)
+            return _fail(INFLATE_ERR_DATA);
+        _skip  = len;
+        _state = len ? STORED : (_last ? TRAILER : BLOCK);
+        return PROGRESS;
+    }
+
+    case STORED:
+    {
+        uint16_t n = std::min<uint16_t>(_skip, _inLen - _inPos);
+        if (!n)
+            return NEED_INPUT;
+        _skip -= n;
+        while (n--)
+            _put(_in[_inPos++]);
+        if (!_skip)
+            _state = _last ? TRAILER : BLOCK;
+        return PROGRESS;
+    }
+
+    case CODES:
+        return _codes();
+
+    case TRAILER:
+        return _trailer();
+
+    case DONE:
+        break;
+    }
+    return PROGRESS;
+}
+
+Inflate::Step Inflate::_block()
+{
+    if (!_need(3))
+        return NEED_INPUT;
+    _last        = _bits(1);
+    uint8_t type = _bits(2);
+
+    if (type == 0)
+    {
+        _state = STORED_LEN;
+        return PROGRESS;
+    }
+
+    uint8_t lengths[286 + 30];
+    int     nlen, ndist;
+
+    if (type == 1)
+    {
+        nlen  = 288;
+        ndist = 30;
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        // 286 and 287 take part in the code but are never valid
+        memset(lengths + 280, 8, 8);
+        buildCode(_litCount, _litSymbol, lengths, nlen);
+        memset(lengths, 5, ndist);
+        buildCode(_distCount, _distSymbol, lengths, ndist);
+        _state = CODES;
+        return PROGRESS;
+    }
+    if (type != 2)
+        return _fail(INFLATE_ERR_DATA);
+
+    // dynamic block, its code tables are decoded in one go
+    if (!_need(14))
+        return NEED_INPUT;
+    nlen      = _bits(5) + 257;
+    ndist     = _bits(5) + 1;
+    int ncode = _bits(4) + 4;
+    if (nlen > 286 || ndist > 30)
+        return _fail(INFLATE_ERR_DATA);
+
+    uint16_t count[16], symbol[19];
+    memset(lengths, 0, 19);
+    for (int i = 0; i < ncode; i++)
+    {
+        if (!_need(3))
+            return NEED_INPUT;
+        lengths[pgm_read_byte(&codeLengthOrder[i])] = _bits(3);
+    }
+    if (buildCode(count, symbol, lengths, 19))
+        return _fail(INFLATE_ERR_DATA);
+
+    for (int index = 0; index < nlen + ndist;)
+    {
+        int sym = _decode(count, symbol);
+        if (sym == -1)
+            return NEED_INPUT;
+        if (sym < 0)
+            return _fail(INFLATE_ERR_DATA);
+        if (sym < 16)
+        {
+            lengths[index++] = sym;
+            continue;
+        }
+        uint8_t len = 0, repeat;
+        if (sym == 16)
+        {
+            if (!index)
+                return _fail(INFLATE_ERR_DATA);
+            len = lengths[index - 1];
+            if (!_need(2))
+                return NEED_INPUT;
+            repeat = 3 + _bits(2);
+        }
+        else if (sym == 17)
+        {
+            if (!_need(3))
+                return NEED_INPUT;
+            repeat = 3 + _bits(3);
+        }
+        else
+        {
+            if (!_need(7))
+                return NEED_INPUT;
+            repeat = 11 + _bits(7);
+        }
+        if (index + repeat > nlen + ndist)
+            return _fail(INFLATE_ERR_DATA);
+        while (repeat--)
+            lengths[index++] = len;
+    }
+    if (!lengths[256])
+        return _fail(INFLATE_ERR_DATA);
+
+    // incomplete codes are only allowed for a single length one code
+    int err = buildCode(_litCount, _litSymbol, lengths, nlen);
+    if (err < 0 || (err > 0 && nlen - _litCount[0] != 1))
+        return _fail(INFLATE_ERR_DATA);
+    err = buildCode(_distCount, _distSymbol, lengths + nlen, ndist);
+    if (err < 0 || (err > 0 && ndist - _distCount[0] != 1))
+        return _fail(INFLATE_ERR_DATA);
+
+    _state = CODES;
+    return PROGRESS;
+}
+
+Inflate::Step Inflate::_codes()
+{
+    for (;;)
+    {
+        int sym = _decode(_litCount, _litSymbol);
+        if (sym == -1)
+            return NEED_INPUT;
+        if (sym < 0)
+            return _fail(INFLATE_ERR_DATA);
+
+        if (sym < 256)
+            _put(sym);
+        else if (sym == 256)
+        {
+            _state = _last ? TRAILER : BLOCK;
+            return PROGRESS;
+        }
+        else
+        {
+            sym -= 257;
+            if (sym >= 29)
+                return _fail(INFLATE_ERR_DATA);
+            uint8_t extra = pgm_read_byte(&lengthExtra[sym]);
+            if (!_need(extra))
+                return NEED_INPUT;
+            uint16_t len = pgm_read_word(&lengthBase[sym]) + _bits(extra);
+
+            sym = _decode(_distCount, _distSymbol);
+            if (sym == -1)
+                return NEED_INPUT;
+            if (sym < 0 || sym >= 30)
+                return _fail(INFLATE_ERR_DATA);
+            extra = pgm_read_byte(&distExtra[sym]);
+            if (!_need(extra))
+                return NEED_INPUT;
+            uint32_t dist = pgm_read_word(&distBase[sym]) + _bits(extra);
+            if (dist > _wsize || dist > _total)
+                return _fail(INFLATE_ERR_DISTANCE);
+
+            uint16_t mask = _wsize - 1;
+            while (len--)
+                _put(_window[(_wpos - dist) & mask]);
+        }
+        if (_error != INFLATE_OK)
+            return FAILED;
+        _checkpoint();
+    }
+}
+
+Inflate::Step Inflate::_trailer()
+{
+    _bits(_bitCnt & 7);
+    _flush();
+    if (_format == INFLATE_ZLIB)
+    {
+        uint32_t adler = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            if (!_need(8))
+                return NEED_INPUT;
+            adler = (adler << 8) | _bits(8);
+        }
+        if (adler != _check)
+            return _fail(INFLATE_ERR_CHECKSUM);
+    }
+    else if (_format == INFLATE_GZIP)
+    {
+        uint32_t trailer[2];
+        for (auto& v : trailer)
+        {
+            if (!_need(16))
+                return NEED_INPUT;
+            v = _bits(16);
+            if (!_need(16))
+                return NEED_INPUT;
+            v |= (uint32_t)_bits(16) << 16;
+        }
+        if (trailer[0] != ~_check || trailer[1] != _total)
+            return _fail(INFLATE_ERR_CHECKSUM);
+    }
+    _state = DONE;
+    return PROGRESS;
+}
@@ -0,0 +1,203 @@
+/*
+    Inflate.h - streaming DEFLATE decoder
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef __INFLATE_H
+#define __INFLATE_H
+
+#include <Stream.h>
+
+// Streaming decoder for DEFLATE (RFC 1951) data, raw or in zlib (RFC 1950)
+// or gzip (RFC 1952) framing.  Compressed data is written to it in pieces
+// of any size (it is a write-only Stream, so Stream::send*() can feed it
+// directly) and the decoded data goes to the Print given to begin().
+//
+// Memory use is the history window, (1 << windowBits) bytes, plus about
+// 1.5KB.  The window must be at least as large as the one the data was
+// compressed with (32KB for gzip and zlib defaults) unless the decoded
+// data is smaller than the window, back references beyond it fail with
+// INFLATE_ERR_DISTANCE.
+
+enum InflateFormat : uint8_t
+{
+    INFLATE_RAW,
+    INFLATE_ZLIB,
+    INFLATE_GZIP,
+    INFLATE_AUTO,  // zlib or gzip by their header, raw otherwise
+};
+
+enum InflateError : int8_t
+{
+    INFLATE_OK           = 0,
+    INFLATE_ERR_MEMORY   = -1,  // window allocation failed
+    INFLATE_ERR_HEADER   = -2,  // bad or unsupported zlib/gzip header
+    INFLATE_ERR_DATA     = -3,  // invalid compressed data
+    INFLATE_ERR_DISTANCE = -4,  // back reference beyond the window
+    INFLATE_ERR_CHECKSUM = -5,  // trailer checksum or size mismatch
+    INFLATE_ERR_OUTPUT   = -6,  // output Print refused data
+};
+
+class Inflate: public Stream
+{
+public:
+    Inflate() = default;
+    Inflate(const Inflate&) = delete;
+    Inflate& operator=(const Inflate&) = delete;
+    ~Inflate()
+    {
+        end();
+    }
+
+    // windowBits 8..15
+    bool begin(Print& out, InflateFormat format = INFLATE_AUTO, uint8_t windowBits = 15);
+    void end();
+
+    // Decodes and forwards to the output, returns 0 on error
+    // (and size once the end of the stream was decoded, ignoring the rest)
+    virtual size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    virtual size_t write(const uint8_t* data, size_t size) override;
+    virtual int    availableForWrite() override
+    {
+        return sizeof(_in);
+    }
+    virtual bool outputCanTimeout() override
+    {
+        return _out && _out->outputCanTimeout();
+    }
+
+    // Stream, nothing to read
+    virtual int available() override
+    {
+        return 0;
+    }
+    virtual int read() override
+    {
+        return -1;
+    }
+    virtual int peek() override
+    {
+        return -1;
+    }
+
+    // The whole stream, trailer included, was decoded
+    bool finished() const
+    {
+        return _state == DONE;
+    }
+    InflateError getError() const
+    {
+        return _error;
+    }
+    // Decoded bytes so far
+    uint32_t inflated() const
+    {
+        return _total;
+    }
+
+protected:
+    enum State : uint8_t
+    {
+        DETECT,
+        ZLIB_HEADER,
+        GZIP_HEADER,
+        GZIP_EXTRA_LEN,
+        GZIP_EXTRA,
+        GZIP_NAME,
+        GZIP_COMMENT,
+        GZIP_HCRC,
+        BLOCK,
+        STORED_LEN,
+        STORED,
+        CODES,
+        TRAILER,
+        DONE,
+    };
+    enum Step : uint8_t
+    {
+        PROGRESS,
+        NEED_INPUT,
+        FAILED,
+    };
+
+    Step     _step();
+    Step     _block();
+    Step     _codes();
+    Step     _trailer();
+    int      _decode(const uint16_t* count, const uint16_t* symbol);
+    bool     _need(uint8_t bits);
+    uint16_t _bits(uint8_t bits);
+    bool     _zero();
+    void     _put(uint8_t c);
+    void     _flush();
+    void     _checkpoint()
+    {
+        _savePos    = _inPos;
+        _saveBitBuf = _bitBuf;
+        _saveBitCnt = _bitCnt;
+    }
+    void _rollback()
+    {
+        _inPos  = _savePos;
+        _bitBuf = _saveBitBuf;
+        _bitCnt = _saveBitCnt;
+    }
+    Step _fail(InflateError error)
+    {
+        _error = error;
+        return FAILED;
+    }
+
+    Print*   _out    = nullptr;
+    uint8_t* _window = nullptr;
+    uint16_t _wsize  = 0;
+    uint16_t _wpos   = 0;  // next write position in the window
+    uint16_t _wdone  = 0;  // window bytes already given to _out
+
+    InflateFormat _format = INFLATE_AUTO;
+    InflateError  _error  = INFLATE_OK;
+    State         _state  = DETECT;
+    bool          _last   = false;  // current block is the final one
+    uint16_t      _skip   = 0;      // gzip extra field bytes, or stored block bytes, left
+    uint8_t       _flags  = 0;      // gzip header flags
+    uint32_t      _check  = 0;      // running CRC32 or Adler32 of the output
+    uint32_t      _total  = 0;
+
+    // Input is buffered until a whole step (a symbol with its extra bits,
+    // a block header with its code tables) can be decoded, the largest
+    // being a dynamic block header of up to ~560 bytes.
+    uint8_t  _in[640];
+    uint16_t _inLen  = 0;
+    uint16_t _inPos  = 0;
+    uint32_t _bitBuf = 0;
+    uint8_t  _bitCnt = 0;
+    // Input position at the start of the step being decoded
+    uint16_t _savePos    = 0;
+    uint32_t _saveBitBuf = 0;
+    uint8_t  _saveBitCnt = 0;
+
+    // Canonical Huffman codes, per code length counts and sorted symbols
+    uint16_t _litCount[16];
+    uint16_t _litSymbol[288];
+    uint16_t _distCount[16];
+    uint16_t _distSymbol[30];
+};
+
+#endif  // __INFLATE_H
@@ -47,6 +47,18 @@ size_t Print::write(const uint8_t *buffer, size_t size) {
     return n;
 }
 
+size_t Print::writev(const Buffer *buffers, size_t count) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t ret = write(buffers[i].data, buffers[i].size);
+        n += ret;
+        if (ret != buffers[i].size) {
+            break;
+        }
+    }
+    return n;
+}
+
 size_t Print::printf(const char *format, ...) {
     va_list arg;
     va_start(arg, format);
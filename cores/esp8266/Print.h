@@ -75,6 +75,16 @@ class Print {
         inline size_t write(char c) { return write((uint8_t) c); }
         inline size_t write(int8_t c) { return write((uint8_t) c); }
 
+        // one of the buffers given to writev()
+        struct Buffer {
+            const uint8_t *data;
+            size_t size;
+        };
+        // write several buffers in a row (scatter-gather), returns the number
+        // of bytes written. The default calls write() for each of them,
+        // subclasses may gather them into fewer lower-level writes.
+        virtual size_t writev(const Buffer *buffers, size_t count);
+
         // default to zero, meaning "a single write may block"
         // should be overridden by subclasses with buffering
         virtual int availableForWrite() { return 0; }
@@ -17,8 +17,10 @@
 */
 
 #include <assert.h>
+#include <string.h>
 #include <numeric>
 
+#include <Arduino.h>
 #include "Schedule.h"
 #include "PolledTimeout.h"
 #include "interrupts.h"
@@ -38,17 +40,53 @@ static int sCount = 0;
 static uint32_t recurrent_max_grain_mS = 0;
 
 typedef std::function<bool(void)> mRecFuncT;
-struct recurrent_fn_t
+struct recurrent_fn_t: TimerWheelTimer
 {
-    recurrent_fn_t* mNext = nullptr;
+    recurrent_fn_t* mNext = nullptr; // scheduling order
+    recurrent_fn_t* mPrev = nullptr;
+    recurrent_fn_t* mAlarmNext = nullptr; // functions with an alarm
+    recurrent_fn_t* mAlarmPrev = nullptr;
     mRecFuncT mFunc;
-    esp8266::polledTimeout::periodicFastUs callNow;
     std::function<bool(void)> alarm = nullptr;
-    recurrent_fn_t(esp8266::polledTimeout::periodicFastUs interval) : callNow(interval) { }
+    uint32_t mRepeatUs;
+    uint32_t mScheduledUs;
+    recurrent_fn_t(uint32_t repeat_us) : mRepeatUs(repeat_us), mScheduledUs(micros()) { }
 };
 
+// Recurrent functions wait in their timer wheel, in microseconds, which is
+// only used from run_scheduled_recurrent_functions().  Those scheduled
+// meanwhile, possibly from an interrupt, are queued until the next run.
 static recurrent_fn_t* rFirst = nullptr;
 static recurrent_fn_t* rLast = nullptr;
+static recurrent_fn_t* rAlarms = nullptr;
+static recurrent_fn_t* rQueuedFirst = nullptr;
+static recurrent_fn_t* rQueuedLast = nullptr;
+static TimerWheel* rWheel = nullptr;
+
+static_assert((SCHEDULED_INLINE_FN_COUNT & (SCHEDULED_INLINE_FN_COUNT - 1)) == 0,
+    "SCHEDULED_INLINE_FN_COUNT must be a power of 2");
+
+// Ring of inline scheduled functions: producers (any context) claim a slot
+// by moving mHead, fill it, then publish it by setting its invoke pointer.
+// The only consumer, run_scheduled_functions(), stops at the first slot not
+// yet published and releases slots by moving mTail.
+struct inline_fn_t
+{
+    alignas(8) uint8_t mStorage[SCHEDULED_INLINE_FN_SIZE];
+    void (* volatile mInvoke)(void*);
+};
+
+struct inline_ring_t
+{
+    inline_fn_t mSlots[SCHEDULED_INLINE_FN_COUNT];
+    volatile uint16_t mHead;
+    volatile uint16_t mTail;
+};
+
+static inline_ring_t sInline[SCHEDULE_PRIORITY_COUNT];
+static schedule_inline_stats_t sInlineStats;
+
+#define compiler_barrier() __asm__ __volatile__("" ::: "memory")
 
 // Returns a pointer to an unused sched_fn_t,
 // or if none are available allocates a new one,
@@ -104,11 +142,102 @@ bool schedule_function(const std::function<void(void)>& fn)
     return true;
 }
 
+IRAM_ATTR // (not only) called from ISR
+bool schedule_inline_function_raw(void (*invoke)(void*), const void* fn, size_t size,
+    schedule_priority_t priority)
+{
+    if (!invoke || priority >= SCHEDULE_PRIORITY_COUNT || size > SCHEDULED_INLINE_FN_SIZE)
+        return false;
+
+    inline_ring_t& ring = sInline[priority];
+    inline_fn_t* slot;
+    {
+        // lx106 has no compare-and-swap: claiming a slot is the only
+        // section where interrupts are held off, for a few instructions
+        esp8266::InterruptLock lockAllInterruptsInThisScope;
+
+        uint16_t pending = ring.mHead - ring.mTail;
+        if (pending >= SCHEDULED_INLINE_FN_COUNT)
+        {
+            ++sInlineStats.dropped[priority];
+            return false;
+        }
+        slot = &ring.mSlots[ring.mHead & (SCHEDULED_INLINE_FN_COUNT - 1)];
+        ring.mHead = ring.mHead + 1;
+        ++sInlineStats.scheduled[priority];
+        if (pending + 1 > sInlineStats.maxPending[priority])
+            sInlineStats.maxPending[priority] = pending + 1;
+    }
+
+    // copied byte-wise: memcpy may not be in IRAM
+    const uint8_t* src = static_cast<const uint8_t*>(fn);
+    for (size_t i = 0; i < size; i++)
+        slot->mStorage[i] = src[i];
+    compiler_barrier();
+    slot->mInvoke = invoke;
+
+    return true;
+}
+
+void schedule_inline_get_stats(schedule_inline_stats_t* stats)
+{
+    esp8266::InterruptLock lockAllInterruptsInThisScope;
+    *stats = sInlineStats;
+}
+
+void schedule_inline_reset_stats()
+{
+    esp8266::InterruptLock lockAllInterruptsInThisScope;
+    sInlineStats = schedule_inline_stats_t();
+}
+
+// Runs the oldest published function of a ring, returns false if none
+static bool run_inline_function(inline_ring_t& ring)
+{
+    if (ring.mTail == ring.mHead)
+        return false;
+    inline_fn_t* slot = &ring.mSlots[ring.mTail & (SCHEDULED_INLINE_FN_COUNT - 1)];
+    auto invoke = slot->mInvoke;
+    if (!invoke)
+        // claimed but still being filled by an interrupted producer
+        return false;
+    compiler_barrier();
+
+    // release the slot before the call, which may schedule again
+    alignas(8) uint8_t fn[SCHEDULED_INLINE_FN_SIZE];
+    memcpy(fn, slot->mStorage, sizeof(fn));
+    slot->mInvoke = nullptr;
+    compiler_barrier();
+    ring.mTail = ring.mTail + 1;
+
+    invoke(fn);
+    return true;
+}
+
+static void run_inline_functions()
+{
+    // functions scheduled during this run wait for the next one
+    inline_ring_t& high = sInline[SCHEDULE_PRIORITY_HIGH];
+    inline_ring_t& normal = sInline[SCHEDULE_PRIORITY_NORMAL];
+    uint16_t normalCount = normal.mHead - normal.mTail;
+    while (true)
+    {
+        // all pending high priority functions go before each normal one
+        uint16_t highCount = high.mHead - high.mTail;
+        while (highCount-- && run_inline_function(high))
+            optimistic_yield(100000);
+
+        if (!normalCount-- || !run_inline_function(normal))
+            break;
+        optimistic_yield(100000);
+    }
+}
+
 IRAM_ATTR // (not only) called from ISR
 bool schedule_recurrent_function_us(const std::function<bool(void)>& fn,
     uint32_t repeat_us, const std::function<bool(void)>& alarm)
 {
-    assert(repeat_us < decltype(recurrent_fn_t::callNow)::neverExpires); //~26800000us (26.8s)
+    assert(repeat_us <= TimerWheel::maxDelay); //~2147s
 
     if (!fn)
         return false;
@@ -122,15 +251,15 @@ bool schedule_recurrent_function_us(const std::function<bool(void)>& fn,
 
     esp8266::InterruptLock lockAllInterruptsInThisScope;
 
-    if (rLast)
+    if (rQueuedLast)
     {
-        rLast->mNext = item;
+        rQueuedLast->mNext = item;
     }
     else
     {
-        rFirst = item;
+        rQueuedFirst = item;
     }
-    rLast = item;
+    rQueuedLast = item;
 
     // grain needs to be recomputed
     recurrent_max_grain_mS = 0;
@@ -138,15 +267,118 @@ bool schedule_recurrent_function_us(const std::function<bool(void)>& fn,
     return true;
 }
 
+// Moves the functions scheduled since the last run to the wheel,
+// returns false when there is no wheel
+static bool take_queued_recurrent_functions()
+{
+    if (!rWheel)
+    {
+        rWheel = new (std::nothrow) TimerWheel;
+        if (!rWheel)
+            return false;
+    }
+
+    recurrent_fn_t* item;
+    {
+        esp8266::InterruptLock lockAllInterruptsInThisScope;
+        item = rQueuedFirst;
+        rQueuedFirst = rQueuedLast = nullptr;
+    }
+
+    while (item)
+    {
+        auto next = item->mNext;
+
+        item->mNext = nullptr;
+        item->mPrev = rLast;
+        if (rLast)
+        {
+            rLast->mNext = item;
+        }
+        else
+        {
+            rFirst = item;
+        }
+        rLast = item;
+
+        if (item->alarm)
+        {
+            item->mAlarmNext = rAlarms;
+            if (rAlarms)
+                rAlarms->mAlarmPrev = item;
+            rAlarms = item;
+        }
+
+        // first call repeat_us after scheduling, every run when 0
+        rWheel->add(*item, item->mScheduledUs, item->mRepeatUs, item->mRepeatUs);
+
+        item = next;
+    }
+    return true;
+}
+
+static void remove_recurrent_function(recurrent_fn_t* item)
+{
+    rWheel->cancel(*item);
+
+    if (item->mPrev)
+        item->mPrev->mNext = item->mNext;
+    else
+        rFirst = item->mNext;
+    if (item->mNext)
+        item->mNext->mPrev = item->mPrev;
+    else
+        rLast = item->mPrev;
+
+    if (item->alarm)
+    {
+        if (item->mAlarmPrev)
+            item->mAlarmPrev->mAlarmNext = item->mAlarmNext;
+        else
+            rAlarms = item->mAlarmNext;
+        if (item->mAlarmNext)
+            item->mAlarmNext->mAlarmPrev = item->mAlarmPrev;
+    }
+
+    delete item;
+
+    // grain needs to be recomputed
+    recurrent_max_grain_mS = 0;
+}
+
+size_t schedule_recurrent_get_stats(schedule_recurrent_stats_t* stats, size_t count)
+{
+    size_t n = 0;
+    for (auto it = rFirst; it; it = it->mNext, n++)
+    {
+        if (n < count)
+        {
+            stats[n].repeat_us = it->mRepeatUs;
+            stats[n].timer = it->stats();
+        }
+    }
+    return n;
+}
+
+void schedule_recurrent_reset_stats()
+{
+    for (auto it = rFirst; it; it = it->mNext)
+        it->resetStats();
+}
+
 uint32_t compute_scheduled_recurrent_grain ()
 {
     if (recurrent_max_grain_mS == 0)
     {
-        if (rFirst)
+        uint32_t recurrent_max_grain_uS = 0;
+        for (auto it = rFirst; it; it = it->mNext)
+            recurrent_max_grain_uS = std::gcd(recurrent_max_grain_uS, it->mRepeatUs);
+
         {
-            uint32_t recurrent_max_grain_uS = rFirst->callNow.getTimeout();
-            for (auto it = rFirst->mNext; it; it = it->mNext)
-                recurrent_max_grain_uS = std::gcd(recurrent_max_grain_uS, it->callNow.getTimeout());
+            // and the ones scheduled since the last run, possibly from an ISR
+            esp8266::InterruptLock lockAllInterruptsInThisScope;
+            for (auto it = rQueuedFirst; it; it = it->mNext)
+                recurrent_max_grain_uS = std::gcd(recurrent_max_grain_uS, it->mRepeatUs);
             if (recurrent_max_grain_uS)
                 // round to the upper millis
                 recurrent_max_grain_mS = recurrent_max_grain_uS <= 1000? 1: (recurrent_max_grain_uS + 999) / 1000;
@@ -167,6 +399,8 @@ uint32_t compute_scheduled_recurrent_grain ()
 
 void run_scheduled_functions()
 {
+    run_inline_functions();
+
     // prevent scheduling of new functions during this run
     auto stop = sLast;
     bool done = false;
@@ -208,8 +442,7 @@ void run_scheduled_recurrent_functions()
     // its purpose is that it is never called from an interrupt
     // (always on cont stack).
 
-    auto current = rFirst;
-    if (!current)
+    if (!rFirst && !rQueuedFirst)
         return;
 
     static bool fence = false;
@@ -225,49 +458,14 @@ void run_scheduled_recurrent_functions()
         fence = true;
     }
 
-    recurrent_fn_t* prev = nullptr;
-    // prevent scheduling of new functions during this run
-    auto stop = rLast;
-
-    bool done;
-    do
+    if (!take_queued_recurrent_functions())
     {
-        done = current == stop;
-        const bool wakeup = current->alarm && current->alarm();
-        bool callNow = current->callNow;
-
-        if ((wakeup || callNow) && !current->mFunc())
-        {
-            // remove function from stack
-            esp8266::InterruptLock lockAllInterruptsInThisScope;
-
-            auto to_ditch = current;
-
-            // removing rLast
-            if (rLast == current)
-                rLast = prev;
-
-            current = current->mNext;
-            if (prev)
-            {
-                prev->mNext = current;
-            }
-            else
-            {
-                rFirst = current;
-            }
-
-            delete(to_ditch);
-
-            // grain needs to be recomputed
-            recurrent_max_grain_mS = 0;
-        }
-        else
-        {
-            prev = current;
-            current = current->mNext;
-        }
+        fence = false;
+        return;
+    }
 
+    auto maybeYield = [&yieldNow]()
+    {
         if (yieldNow)
         {
             // because scheduled functions might last too long for watchdog etc,
@@ -276,7 +474,30 @@ void run_scheduled_recurrent_functions()
             esp_schedule();
             cont_suspend(g_pcont);
         }
-    } while (current && !done);
+    };
+
+    // functions scheduled during this run wait for the next one
+    const uint32_t now = micros();
+
+    // alarms are polled, those already due are called once, from the wheel
+    for (auto current = rAlarms; current; )
+    {
+        auto next = current->mAlarmNext;
+        if ((int32_t)(current->expiry() - now) > 0 && current->alarm() && !current->mFunc())
+            remove_recurrent_function(current);
+        current = next;
+        maybeYield();
+    }
+
+    while (auto timer = rWheel->expire(now))
+    {
+        auto current = static_cast<recurrent_fn_t*>(timer);
+        if (!current->mFunc())
+            remove_recurrent_function(current);
+        else if (!current->mRepeatUs)
+            rWheel->add(*current, now, 1);
+        maybeYield();
+    }
 
     fence = false;
 }
@@ -20,10 +20,23 @@
 #define ESP_SCHEDULE_H
 
 #include <functional>
+#include <type_traits>
+#include <stddef.h>
 #include <stdint.h>
 
+#include "TimerWheel.h"
+
 #define SCHEDULED_FN_MAX_COUNT 32
 
+// Slots of each priority ring of schedule_inline_function() (power of 2),
+// and bytes of captured state a slot can hold.
+#ifndef SCHEDULED_INLINE_FN_COUNT
+#define SCHEDULED_INLINE_FN_COUNT 8
+#endif
+#ifndef SCHEDULED_INLINE_FN_SIZE
+#define SCHEDULED_INLINE_FN_SIZE 12
+#endif
+
 // The purpose of scheduled functions is to trigger, from SYS stack (like in
 // an interrupt or a system event), registration of user code to be executed
 // in user stack (called CONT stack) without the common restrictions from
@@ -62,6 +75,61 @@ uint32_t compute_scheduled_recurrent_grain ();
 
 bool schedule_function (const std::function<void(void)>& fn);
 
+// scheduled functions without heap:
+//
+// * Same as above, but the lambda (or function pointer) is copied into a
+//   fixed-capacity ring instead of a heap allocated std::function, so it
+//   can be used from any interrupt level or Wi-Fi callback under burst load.
+// * The lambda must be trivially copyable (captures of pointers, integers,
+//   `this`...) and not larger than SCHEDULED_INLINE_FN_SIZE bytes, this is
+//   checked at compile time.
+// * There is one ring of SCHEDULED_INLINE_FN_COUNT slots per priority.
+//   All pending high priority functions run before the next normal one,
+//   and all inline functions run before functions from schedule_function().
+// * Returns false, and counts a drop, when the ring is full.
+// * Scheduling from an ISR only runs IRAM code.  The lambda itself runs
+//   later from CONT and needs no IRAM_ATTR.
+
+enum schedule_priority_t : uint8_t
+{
+    SCHEDULE_PRIORITY_HIGH = 0,
+    SCHEDULE_PRIORITY_NORMAL,
+    SCHEDULE_PRIORITY_COUNT
+};
+
+struct schedule_inline_stats_t
+{
+    uint32_t scheduled[SCHEDULE_PRIORITY_COUNT]; // accepted functions
+    uint32_t dropped[SCHEDULE_PRIORITY_COUNT];   // rejected, ring was full
+    uint16_t maxPending[SCHEDULE_PRIORITY_COUNT]; // high watermark
+};
+
+bool schedule_inline_function_raw(void (*invoke)(void*), const void* fn, size_t size,
+    schedule_priority_t priority);
+
+// runs the copied function, from CONT: not needed in IRAM
+template <typename T>
+void schedule_inline_function_invoke(void* obj)
+{
+    (*static_cast<T*>(obj))();
+}
+
+// always inlined into its caller (in IRAM when that is an ISR), so that only
+// schedule_inline_function_raw() is called, which is in IRAM
+template <typename T>
+inline __attribute__((always_inline))
+bool schedule_inline_function(T fn, schedule_priority_t priority = SCHEDULE_PRIORITY_NORMAL)
+{
+    static_assert(sizeof(T) <= SCHEDULED_INLINE_FN_SIZE, "captured state exceeds SCHEDULED_INLINE_FN_SIZE");
+    static_assert(alignof(T) <= 8, "captured state is overaligned");
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable functions can be scheduled inline");
+    return schedule_inline_function_raw(&schedule_inline_function_invoke<T>, &fn, sizeof(T), priority);
+}
+
+// Counters since boot or the last reset
+void schedule_inline_get_stats(schedule_inline_stats_t* stats);
+void schedule_inline_reset_stats();
+
 // Run all scheduled functions.
 // Use this function if your are not using `loop`,
 // or `loop` does not return on a regular basis.
@@ -84,10 +152,25 @@ void run_scheduled_functions();
 //   recurrent function.
 // * If alarm is used, anytime during scheduling when it returns true,
 //   any remaining delay from repeat_us is disregarded, and fn is executed.
+// * Functions wait in a timer wheel: a run only calls the functions that
+//   are due (and the alarms), however many are scheduled.  When a run comes
+//   more than repeat_us late, missed calls are skipped and counted.
 
 bool schedule_recurrent_function_us(const std::function<bool(void)>& fn,
     uint32_t repeat_us, const std::function<bool(void)>& alarm = nullptr);
 
+struct schedule_recurrent_stats_t
+{
+    uint32_t repeat_us;
+    TimerWheelStats timer; // calls when due (not from alarm), lateness in us
+};
+
+// Per recurrent function counters, in scheduling order.  Fills up to count
+// entries, returns the number of functions.  Functions scheduled since the
+// last run of recurrent functions are not listed yet.
+size_t schedule_recurrent_get_stats(schedule_recurrent_stats_t* stats, size_t count);
+void schedule_recurrent_reset_stats();
+
 // Test recurrence and run recurrent scheduled functions.
 // (internally called at every `yield()` and `loop()`)
 
@@ -0,0 +1,220 @@
+/*
+    TimerWheel.cpp - hierarchical timing wheel
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "TimerWheel.h"
+
+// A timer on level L expires 32^L to 32^(L+1) ticks after _tick, it is in
+// the slot of bits L*5.. of its expiry.  That slot is moved down when _tick
+// reaches its start, the lower bits of _tick are then all zero.  Level 0
+// slots only hold timers expiring at their tick.
+
+static constexpr uint32_t slotMask = TimerWheel::slots - 1;
+
+TimerWheel::~TimerWheel()
+{
+    for (uint32_t level = 0; level < levels; level++)
+        for (uint32_t index = 0; index < slots; index++)
+            while (_slots[level][index])
+                cancel(*_slots[level][index]);
+    while (_due)
+        cancel(*_due);
+}
+
+void TimerWheel::_link(TimerWheelTimer** head, TimerWheelTimer* timer)
+{
+    timer->_next = *head;
+    if (*head)
+        (*head)->_pprev = &timer->_next;
+    *head         = timer;
+    timer->_pprev = head;
+}
+
+void TimerWheel::_place(TimerWheelTimer* timer)
+{
+    uint32_t at = timer->_expiry;
+    if ((int32_t)(at - _tick) < 0)
+        at = _tick;
+    uint32_t delta = at - _tick;
+    if (delta >= (1u << (levels * slotBits)))
+        // placed again from the last level
+        at = _tick + (1u << (levels * slotBits)) - 1;
+
+    uint32_t level = 0;
+    while (level < levels - 1 && delta >= (1u << ((level + 1) * slotBits)))
+        level++;
+    uint32_t index = (at >> (level * slotBits)) & slotMask;
+    timer->_level  = level;
+    timer->_index  = index;
+    _link(&_slots[level][index], timer);
+    _occupied[level] |= 1u << index;
+}
+
+void TimerWheel::add(TimerWheelTimer& timer, uint32_t now, uint32_t delay, uint32_t period)
+{
+    cancel(timer);
+    if (!_count && _tick - now > 1)
+        // the wheel was idle, unless now is still that of the last expire()
+        _tick = now;
+    timer._expiry = now + (delay > maxDelay ? maxDelay : delay);
+    timer._period = period > maxDelay ? maxDelay : period;
+    _count++;
+    _place(&timer);
+}
+
+void TimerWheel::cancel(TimerWheelTimer& timer)
+{
+    if (!timer._pprev)
+        return;
+
+    *timer._pprev = timer._next;
+    if (timer._next)
+        timer._next->_pprev = timer._pprev;
+    else if (timer._level == due)
+        _dueTail = timer._pprev;
+    if (timer._level != due && !_slots[timer._level][timer._index])
+        _occupied[timer._level] &= ~(1u << timer._index);
+
+    timer._next  = nullptr;
+    timer._pprev = nullptr;
+    _count--;
+}
+
+void TimerWheel::_cascade(uint32_t level, uint32_t index)
+{
+    TimerWheelTimer* timer = _slots[level][index];
+    _slots[level][index]   = nullptr;
+    _occupied[level] &= ~(1u << index);
+    while (timer)
+    {
+        TimerWheelTimer* next = timer->_next;
+        _place(timer);
+        timer = next;
+    }
+}
+
+void TimerWheel::_collect(uint32_t index)
+{
+    TimerWheelTimer* timer = _slots[0][index];
+    _slots[0][index]       = nullptr;
+    _occupied[0] &= ~(1u << index);
+    while (timer)
+    {
+        TimerWheelTimer* next = timer->_next;
+        if ((int32_t)(timer->_expiry - _tick) > 0)
+        {
+            // came from the last level, still far
+            _place(timer);
+        }
+        else
+        {
+            timer->_level = due;
+            timer->_next  = nullptr;
+            timer->_pprev = _dueTail;
+            *_dueTail     = timer;
+            _dueTail      = &timer->_next;
+        }
+        timer = next;
+    }
+}
+
+uint32_t TimerWheel::_skip(uint32_t from) const
+{
+    // earliest slot start, on any level, not processed yet
+    uint32_t best = from + maxDelay;
+    for (uint32_t level = 0; level < levels; level++)
+    {
+        if (!_occupied[level])
+            continue;
+        uint32_t shift = level * slotBits;
+        uint32_t pos   = from >> shift;
+        uint32_t index = pos & slotMask;
+        uint32_t first = index;
+        if (level && (from & ((1u << shift) - 1)))
+            // its current slot was moved down already
+            first++;
+        uint32_t ahead = first < slots ? _occupied[level] & (~0u << first) : 0;
+        uint32_t tick;
+        if (ahead)
+            tick = (pos - index + __builtin_ctz(ahead)) << shift;
+        else
+            // the remaining ones are in the next round
+            tick = ((pos >> slotBits) + 1) << (shift + slotBits);
+        if ((int32_t)(tick - from) < (int32_t)(best - from))
+            best = tick;
+    }
+    return best;
+}
+
+void TimerWheel::_advance(uint32_t now)
+{
+    while ((int32_t)(now - _tick) >= 0)
+    {
+        uint32_t index = _tick & slotMask;
+        if (!index)
+        {
+            for (uint32_t level = 1; level < levels; level++)
+            {
+                uint32_t upper = (_tick >> (level * slotBits)) & slotMask;
+                if (_occupied[level] & (1u << upper))
+                    _cascade(level, upper);
+                if (upper)
+                    break;
+            }
+        }
+        if (_occupied[0] & (1u << index))
+            _collect(index);
+
+        uint32_t next = _skip(_tick + 1);
+        _tick         = (int32_t)(next - (now + 1)) < 0 ? next : now + 1;
+    }
+}
+
+TimerWheelTimer* TimerWheel::expire(uint32_t now)
+{
+    if (!_due)
+        _advance(now);
+    TimerWheelTimer* timer = _due;
+    if (!timer)
+        return nullptr;
+    cancel(*timer);
+
+    uint32_t late = (int32_t)(now - timer->_expiry) > 0 ? now - timer->_expiry : 0;
+    timer->_stats.runs++;
+    timer->_stats.lateTotal += late;
+    if (late > timer->_stats.lateMax)
+        timer->_stats.lateMax = late;
+
+    if (timer->_period)
+    {
+        uint32_t missed = late / timer->_period;
+        timer->_stats.overruns += missed;
+        timer->_expiry += (missed + 1) * timer->_period;
+        _count++;
+        _place(timer);
+    }
+    return timer;
+}
+
+bool TimerWheel::nextTick(uint32_t& tick) const
+{
+    if (!_count)
+        return false;
+    tick = _due ? _tick - 1 : _skip(_tick);
+    return true;
+}
@@ -0,0 +1,152 @@
+/*
+    TimerWheel.h - hierarchical timing wheel
+    Copyright (c) 2026 esp8266/Arduino community.  All right reserved.
+
+    This library is free software; you can redistribute it and/or
+    modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    This library is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+    Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with this library; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef __TIMERWHEEL_H
+#define __TIMERWHEEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Many timers sharing one time source, with work proportional to the timers
+// that expire rather than to the timers that exist.  Ticker (milliseconds)
+// and the recurrent scheduled functions (microseconds) each keep one.
+//
+// Timers sit in slots by expiry tick, on levels of 32 slots each covering 32
+// times the span of the one below.  Adding and cancelling are O(1).  expire()
+// visits only occupied slots, found through a bitmap per level, and moves the
+// timers of a coarse slot one level down when its time comes, so a timer is
+// moved at most once per level.  Timers further than 2^25 ticks wait on the
+// last level and are placed again when reached; delays are limited to 2^31-1
+// ticks.  Timers expiring at the same tick run in no particular order.
+//
+// Ticks are a free running uint32_t counter (millis(), micros()...), time is
+// given to each call.  A wheel is not interrupt safe, its owner serializes
+// the calls.
+
+// Per timer counters, since the timer was created or resetStats()
+struct TimerWheelStats
+{
+    uint32_t runs;       // expirations returned by expire()
+    uint32_t overruns;   // periods skipped, the timer expired over a period late
+    uint32_t lateMax;    // ticks from expiry to expire()
+    uint32_t lateTotal;  // sum, for the average
+};
+
+class TimerWheel;
+
+class TimerWheelTimer
+{
+public:
+    TimerWheelTimer() = default;
+    // copies are not armed
+    TimerWheelTimer(const TimerWheelTimer&) { }
+    TimerWheelTimer& operator=(const TimerWheelTimer&)
+    {
+        return *this;
+    }
+
+    bool armed() const
+    {
+        return _pprev != nullptr;
+    }
+    // next expiry tick, and period (0: one shot)
+    uint32_t expiry() const
+    {
+        return _expiry;
+    }
+    uint32_t period() const
+    {
+        return _period;
+    }
+
+    const TimerWheelStats& stats() const
+    {
+        return _stats;
+    }
+    void resetStats()
+    {
+        _stats = TimerWheelStats();
+    }
+
+private:
+    friend class TimerWheel;
+
+    TimerWheelTimer*  _next  = nullptr;
+    TimerWheelTimer** _pprev = nullptr;  // link pointing to this one, null when not armed
+    uint32_t          _expiry = 0;
+    uint32_t          _period = 0;
+    uint8_t           _level  = 0;  // slot, or levels for the due list
+    uint8_t           _index  = 0;
+    TimerWheelStats   _stats {};
+};
+
+class TimerWheel
+{
+public:
+    static constexpr uint32_t slotBits = 5;
+    static constexpr uint32_t slots    = 1 << slotBits;
+    static constexpr uint32_t levels   = 5;
+    static constexpr uint32_t maxDelay = 0x7fffffff;
+
+    TimerWheel() = default;
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    ~TimerWheel();
+
+    // (Re)arms timer to expire delay ticks after now, then every period
+    // ticks unless period is 0.  Stats keep counting, see resetStats().
+    void add(TimerWheelTimer& timer, uint32_t now, uint32_t delay, uint32_t period = 0);
+    // Disarms timer, also from its own callback
+    void cancel(TimerWheelTimer& timer);
+
+    // Next timer expired by now, or nullptr.  Periodic timers are already
+    // armed for their next period (missed ones are skipped and counted as
+    // overruns), one shots are disarmed.  Call until nullptr, timers added
+    // meanwhile with no delay expire at the next call after now.
+    TimerWheelTimer* expire(uint32_t now);
+
+    // Earliest tick expire() may return a timer at, false when no timer is
+    // armed.  It can be earlier than the first expiry, when timers have to
+    // move down a level.
+    bool nextTick(uint32_t& tick) const;
+
+    size_t count() const
+    {
+        return _count;
+    }
+
+private:
+    static constexpr uint8_t due = levels;
+
+    void     _place(TimerWheelTimer* timer);
+    void     _link(TimerWheelTimer** head, TimerWheelTimer* timer);
+    void     _cascade(uint32_t level, uint32_t index);
+    void     _collect(uint32_t index);
+    void     _advance(uint32_t now);
+    uint32_t _skip(uint32_t from) const;
+
+    TimerWheelTimer*  _slots[levels][slots] = {};
+    uint32_t          _occupied[levels]     = {};  // bitmaps of non empty slots
+    TimerWheelTimer*  _due                  = nullptr;
+    TimerWheelTimer** _dueTail              = &_due;
+    uint32_t          _tick                 = 0;  // next tick to process
+    size_t            _count                = 0;
+};
+
+#endif  // __TIMERWHEEL_H
@@ -51,6 +51,14 @@ void UpdaterClass::_reset(bool callback) {
 
   _buffer = nullptr;
   _bufferLen = 0;
+  if (!_decodeBusy) {
+    _inflate.reset();
+    _delta.reset();
+  }
+  _decoding = false;
+  _decoded = false;
+  _inputSize = 0;
+  _inputProgress = 0;
   _startAddress = 0;
   _currentAddress = 0;
   _size = 0;
@@ -120,6 +128,21 @@ bool UpdaterClass::begin(size_t size, int command, int ledPin, uint8_t ledOn) {
   //size of the update rounded to a sector
   size_t roundedSize = (size + FLASH_SECTOR_SIZE - 1) & (~(FLASH_SECTOR_SIZE - 1));
 
+  bool decode = _inflateBits || (_deltaEnabled && command == U_FLASH);
+  if (decode) {
+    // the image size is only known at the end, reserve all there is
+    uintptr_t sketchSpace = FS_start - 0x40200000;
+    sketchSpace = (sketchSpace > currentSketchSize) ? (sketchSpace - currentSketchSize) : 0;
+    if (command == U_FS) {
+      roundedSize = FS_end - FS_start;
+#ifdef ATOMIC_FS_UPDATE
+      roundedSize = std::min<size_t>(roundedSize, sketchSpace);
+#endif
+    } else {
+      roundedSize = sketchSpace;
+    }
+  }
+
   if (command == U_FLASH) {
     //address of the end of the space available for sketch and update
     uintptr_t updateEndAddress = FS_start - 0x40200000;
@@ -167,6 +190,31 @@ bool UpdaterClass::begin(size_t size, int command, int ledPin, uint8_t ledOn) {
     return false;
   }
 
+  if (decode) {
+    if (_deltaEnabled && command == U_FLASH) {
+      _delta.reset(new (std::nothrow) DeltaPatch);
+      if (!_delta) {
+        _setError(UPDATE_ERROR_OOM);
+        return false;
+      }
+      // the running sketch, from the start of the flash
+      _delta->begin(_imageOutput, [](uint32_t offset, uint8_t *data, size_t size) {
+        return ESP.flashRead(offset, data, size);
+      }, ESP.getSketchSize());
+    }
+    if (_inflateBits) {
+      _inflate.reset(new (std::nothrow) Inflate);
+      if (!_inflate || !_inflate->begin(_delta ? _patchOutput : _imageOutput, INFLATE_GZIP, _inflateBits)) {
+        _setError(UPDATE_ERROR_OOM);
+        return false;
+      }
+    }
+    _decoding = true;
+    _inputSize = size;
+    _inputMd5.begin();
+    size = roundedSize;
+  }
+
   //initialize
   _startAddress = updateStartAddress;
   _currentAddress = _startAddress;
@@ -225,7 +273,8 @@ bool UpdaterClass::end(bool evenIfRemaining){
     _setError(UPDATE_ERROR_NO_DATA);
   }
 
-  if(hasError() || (!isFinished() && !evenIfRemaining)){
+  // a compressed image or a patch is only complete with the end of its data
+  if(hasError() || (!isFinished() && (!evenIfRemaining || _decoding))){
 #ifdef DEBUG_UPDATER
     DEBUG_UPDATER.printf_P(PSTR("premature end: res:%u, pos:%zu/%zu\n"), getError(), progress(), _size);
 #endif
@@ -233,7 +282,7 @@ bool UpdaterClass::end(bool evenIfRemaining){
     return false;
   }
 
-  if(evenIfRemaining) {
+  if(evenIfRemaining && !_decoding) {
     if(_bufferLen > 0) {
       _writeBuffer();
     }
@@ -329,7 +378,13 @@ bool UpdaterClass::end(bool evenIfRemaining){
 #endif
   } else if (_target_md5.length()) {
     _md5.calculate();
-    if (strcasecmp(_target_md5.c_str(), _md5.toString().c_str())) {
+    bool md5Match = !strcasecmp(_target_md5.c_str(), _md5.toString().c_str());
+    if (!md5Match && _decoding) {
+      // espota.py and update servers give the MD5 of the file they send
+      _inputMd5.calculate();
+      md5Match = !strcasecmp(_target_md5.c_str(), _inputMd5.toString().c_str());
+    }
+    if (!md5Match) {
       _setError(UPDATE_ERROR_MD5);
       return false;
     }
@@ -439,6 +494,15 @@ size_t UpdaterClass::write(uint8_t *data, size_t len) {
   if(hasError() || !isRunning())
     return 0;
 
+  if (_decoding) {
+    if (_inputProgress || !len || (_inflate && data[0] == 0x1f) || (_delta && DeltaPatch::isPatchStart(data[0]))) {
+      return _decodeWrite(data, len);
+    }
+    if (!_decodeSkip()) {
+      return 0;
+    }
+  }
+
   if(progress() + _bufferLen + len > _size) {
     _setError(UPDATE_ERROR_SPACE);
     return 0;
@@ -468,6 +532,112 @@ size_t UpdaterClass::write(uint8_t *data, size_t len) {
   return len;
 }
 
+// a plain image with setInflate() or setDelta(), written as it is
+bool UpdaterClass::_decodeSkip() {
+  _inflate.reset();
+  _delta.reset();
+  _decoding = false;
+  if (_inputSize > _size) {
+    _setError(UPDATE_ERROR_SPACE);
+    return false;
+  }
+  _size = _inputSize;
+  _inputSize = 0;
+  return true;
+}
+
+size_t UpdaterClass::_decodeWrite(uint8_t *data, size_t len) {
+  if (_inputProgress + len > _inputSize) {
+    _setError(UPDATE_ERROR_SPACE);
+    return 0;
+  }
+  if (!_inputProgress && len && data[0] != 0x1f) {
+    // an uncompressed patch
+    _inflate.reset();
+  }
+  _inputMd5.add(data, len);
+  _inputProgress += len;
+
+  // trailing bytes after the end of the gzip data or the patch are ignored
+  if (_decoded) {
+    return len;
+  }
+
+  // errors writing the output _reset(), which must not free the decoders here
+  _decodeBusy = true;
+  size_t decoded = _inflate ? _inflate->write(data, len) : _patchWrite(data, len);
+  _decodeBusy = false;
+  if (hasError()) {
+    _inflate.reset();
+    _delta.reset();
+    return 0;
+  }
+  if (decoded != len) {
+#ifdef DEBUG_UPDATER
+    DEBUG_UPDATER.printf_P(PSTR("[Updater] inflate error: %d, delta error: %d\n"),
+      _inflate ? _inflate->getError() : 0, _delta ? _delta->getError() : 0);
+#endif
+    _setError((_delta && _delta->getError()) ? UPDATE_ERROR_DELTA : UPDATE_ERROR_INFLATE);
+    return 0;
+  }
+
+  bool done = _inflate ? _inflate->finished() : _delta->finished();
+  if (done) {
+    if (_delta && !_delta->finished()) {
+      // the compressed patch was cut short
+      _setError(UPDATE_ERROR_DELTA);
+      return 0;
+    }
+    if (_bufferLen > 0 && !_writeBuffer()) {
+      return 0;
+    }
+    // the image is complete, release the decoders before end() checks it
+    _inflate.reset();
+    _delta.reset();
+    _decoded = true;
+    _size = _currentAddress - _startAddress;
+#ifdef DEBUG_UPDATER
+    DEBUG_UPDATER.printf_P(PSTR("[Updater] decoded %zu bytes to %zu\n"), _inputProgress, _size);
+#endif
+  }
+  return len;
+}
+
+// decompressed data, a patch or a plain image
+size_t UpdaterClass::_patchWrite(const uint8_t *data, size_t len) {
+  if (_delta && !_delta->started()) {
+    if (!len) {
+      return 0;
+    }
+    if (!DeltaPatch::isPatchStart(data[0])) {
+      _delta.reset();
+    }
+  }
+  return _delta ? _delta->write(data, len) : _imageWrite(data, len);
+}
+
+size_t UpdaterClass::_imageWrite(const uint8_t *data, size_t len) {
+  if (hasError()) {
+    return 0;
+  }
+  if (_currentAddress - _startAddress + _bufferLen + len > _size) {
+    _setError(UPDATE_ERROR_SPACE);
+    return 0;
+  }
+  size_t left = len;
+  while (left) {
+    size_t toBuff = std::min(left, _bufferSize - _bufferLen);
+    memcpy(_buffer + _bufferLen, data, toBuff);
+    _bufferLen += toBuff;
+    data += toBuff;
+    left -= toBuff;
+    if (_bufferLen == _bufferSize && !_writeBuffer()) {
+      return 0;
+    }
+  }
+  return len;
+}
+
 bool UpdaterClass::_verifyHeader(uint8_t data) {
     if(_command == U_FLASH) {
         // check for valid first magic byte (is always 0xE9)
@@ -542,7 +712,7 @@ size_t UpdaterClass::writeStream(Stream &data, uint16_t streamTimeout) {
     }
     esp8266::polledTimeout::oneShotMs timeOut(streamTimeout);
     if (_progress_callback) {
-        _progress_callback(0, _size);
+        _progress_callback(0, size());
     }
     if(_ledPin != -1) {
         pinMode(_ledPin, OUTPUT);
@@ -552,11 +722,14 @@ size_t UpdaterClass::writeStream(Stream &data, uint16_t streamTimeout) {
         if(_ledPin != -1) {
             digitalWrite(_ledPin, _ledOn); // Switch LED on
         }
-        size_t bytesToRead = _bufferSize - _bufferLen;
+        bool decode = _decoding;
+        uint8_t decodeBuf[256];
+        uint8_t *buf = decode ? decodeBuf : _buffer + _bufferLen;
+        size_t bytesToRead = decode ? sizeof(decodeBuf) : _bufferSize - _bufferLen;
         if(bytesToRead > remaining()) {
             bytesToRead = remaining();
         }
-        toRead = data.readBytes(_buffer + _bufferLen,  bytesToRead);
+        toRead = data.readBytes(buf, bytesToRead);
         if(toRead == 0) { //Timeout
           if (timeOut) {
             _currentAddress = (_startAddress + _size);
@@ -571,17 +744,22 @@ size_t UpdaterClass::writeStream(Stream &data, uint16_t streamTimeout) {
         if(_ledPin != -1) {
             digitalWrite(_ledPin, !_ledOn); // Switch LED off
         }
-        _bufferLen += toRead;
-        if((_bufferLen == remaining() || _bufferLen == _bufferSize) && !_writeBuffer())
-            return written;
+        if(decode) {
+            if(toRead && write(buf, toRead) != toRead)
+                return written;
+        } else {
+            _bufferLen += toRead;
+            if((_bufferLen == remaining() || _bufferLen == _bufferSize) && !_writeBuffer())
+                return written;
+        }
         written += toRead;
         if(_progress_callback) {
-            _progress_callback(progress(), _size);
+            _progress_callback(progress(), size());
         }
         yield();
     }
     if(_progress_callback) {
-        _progress_callback(progress(), _size);
+        _progress_callback(progress(), size());
     }
     return written;
 }
@@ -657,6 +835,12 @@ String UpdaterClass::getErrorString() const {
   case UPDATE_ERROR_UNKNOWN_COMMAND:
     out = F("Unknown update command");
     break;
+  case UPDATE_ERROR_INFLATE:
+    out = F("Decompression failed");
+    break;
+  case UPDATE_ERROR_DELTA:
+    out = F("Delta patch does not apply");
+    break;
   default:
     out = F("UNKNOWN");
     break;
@@ -4,7 +4,10 @@
 #include <Arduino.h>
 #include <flash_utils.h>
 #include <MD5Builder.h>
+#include <Inflate.h>
+#include <DeltaPatch.h>
 #include <functional>
+#include <memory>
 
 #define UPDATE_ERROR_OK                 (0)
 #define UPDATE_ERROR_WRITE              (1)
@@ -23,6 +26,8 @@
 #define UPDATE_ERROR_OOM                (14)
 #define UPDATE_ERROR_RUNNING_ALREADY    (15)
 #define UPDATE_ERROR_UNKNOWN_COMMAND    (16)
+#define UPDATE_ERROR_INFLATE            (17)
+#define UPDATE_ERROR_DELTA              (18)
 
 #define U_FLASH   0
 #define U_FS      100
@@ -75,6 +80,31 @@ class UpdaterClass {
     */
     void runAsync(bool async){ _async = async; }
 
+    /*
+      Inflate gzip compressed images while they are written, call before begin()
+      The size given to begin(), progress() and the written counts are then
+      those of the compressed data, flash space is reserved for the largest
+      image that fits.  MD5 and signature are checked against the decompressed
+      image, so sign before compressing.  The MD5 of the compressed file is
+      accepted too.
+      Needs (1 << windowBits) bytes of heap during the update, the image must
+      be compressed with a window no larger (32KB for gzip: windowBits = 15)
+      0 disables, uncompressed images are written as they are either way
+    */
+    void setInflate(uint8_t windowBits = 15){ _inflateBits = windowBits; }
+    uint8_t getInflate() const { return _inflateBits; }
+
+    /*
+      Accept delta patches made by tools/delta.py against the running sketch,
+      call before begin(), U_FLASH only
+      The new image is rebuilt in flash from the running one, then checked
+      as any other: MD5 and signature are those of the new image (the MD5 of
+      the patch file is accepted too).  Patches are best sent gzip compressed,
+      along with setInflate().  Full images are written as they are.
+    */
+    void setDelta(bool delta = true){ _deltaEnabled = delta; }
+    bool getDelta() const { return _deltaEnabled; }
+
     /*
       Writes a buffer to the flash and increments the address
       Returns the amount written
@@ -164,10 +194,10 @@ class UpdaterClass {
     void clearError(){ _error = UPDATE_ERROR_OK; }
     bool hasError(){ return _error != UPDATE_ERROR_OK; }
     bool isRunning(){ return _size > 0; }
-    bool isFinished(){ return _currentAddress == (_startAddress + _size); }
-    size_t size(){ return _size; }
-    size_t progress(){ return _currentAddress - _startAddress; }
-    size_t remaining(){ return _size - (_currentAddress - _startAddress); }
+    bool isFinished(){ return _decoding ? _decoded : _currentAddress == (_startAddress + _size); }
+    size_t size(){ return _decoding ? _inputSize : _size; }
+    size_t progress(){ return _decoding ? _inputProgress : _currentAddress - _startAddress; }
+    size_t remaining(){ return size() - progress(); }
 
     /*
       Template to write from objects that expose
@@ -181,6 +211,22 @@ class UpdaterClass {
       if (hasError() || !isRunning())
         return 0;
 
+      if (_decoding) {
+        // through write(), until the first byte shows a plain image
+        uint8_t buf[256];
+        size_t available = data.available();
+        while(available && _decoding && remaining()) {
+          size_t toBuff = std::min(std::min(available, remaining()), sizeof(buf));
+          data.read(buf, toBuff);
+          if(write(buf, toBuff) != toBuff)
+            return written;
+          written += toBuff;
+          available = data.available();
+        }
+        if (_decoding || hasError())
+          return written;
+      }
+
       size_t available = data.available();
       while(available) {
         if(_bufferLen + available > remaining()){
@@ -212,8 +258,25 @@ class UpdaterClass {
     }
 
   private:
+    // decoder outputs: the patch once decompressed, or the image
+    class DecodedOutput: public Print {
+      public:
+        DecodedOutput(UpdaterClass& updater, bool patch): _updater(updater), _patch(patch) {}
+        size_t write(uint8_t data) override { return write(&data, 1); }
+        size_t write(const uint8_t *data, size_t len) override {
+          return _patch ? _updater._patchWrite(data, len) : _updater._imageWrite(data, len);
+        }
+      private:
+        UpdaterClass& _updater;
+        bool _patch;
+    };
+
     void _reset(bool callback = true);
     bool _writeBuffer();
+    size_t _decodeWrite(uint8_t *data, size_t len);
+    bool _decodeSkip();
+    size_t _patchWrite(const uint8_t *data, size_t len);
+    size_t _imageWrite(const uint8_t *data, size_t len);
 
     bool _verifyHeader(uint8_t data);
     bool _verifyEnd();
@@ -233,6 +296,21 @@ class UpdaterClass {
     String _target_md5;
     MD5Builder _md5;
 
+    // Optional decoding of the data written, gzip decompression and/or
+    // delta patching, sizes are those of the data written
+    uint8_t _inflateBits = 0;
+    bool _deltaEnabled = false;
+    bool _decoding = false;
+    bool _decoded = false;
+    bool _decodeBusy = false; // decoders are in use, _reset() leaves them
+    std::unique_ptr<Inflate> _inflate;
+    std::unique_ptr<DeltaPatch> _delta;
+    DecodedOutput _patchOutput{*this, true};
+    DecodedOutput _imageOutput{*this, false};
+    size_t _inputSize = 0;
+    size_t _inputProgress = 0;
+    MD5Builder _inputMd5;
+
     int _ledPin = -1;
     uint8_t _ledOn;
 
@@ -28,8 +28,10 @@
 
 extern "C" {
 
-#define SLC_BUF_CNT (8)  // Number of buffers in the I2S circular buffer
-#define SLC_BUF_LEN (64) // Length of one buffer, in 32-bit words.
+#define SLC_BUF_CNT (8)  // Default number of buffers in the I2S circular buffer
+#define SLC_BUF_LEN (64) // Default length of one buffer, in 32-bit words.
+#define SLC_BUF_CNT_MAX (128)
+#define SLC_BUF_LEN_MAX (1023) // 12-bit blocksize of the descriptors, in bytes
 
 // We use a queue to keep track of the DMA buffers that are empty. The ISR
 // will push buffers to the back of the queue, the I2S transmitter will pull
@@ -42,6 +44,19 @@ extern "C" {
 // For RX, it's a little different.  The buffers in i2s_slc_queue are
 // placed onto the list when they're filled by DMA
 
+// The block API lends these buffers to the application as they are, instead
+// of copying samples into them.  slc_state[] tells for each one who has it:
+// free (in the queue for TX, for the DMA to fill for RX), lent to the
+// application (by the block API or as the sample API buffer), or ready for the
+// other side (submitted or filled by the sample API for TX, in the queue for
+// RX).  The DMA goes through the buffers whatever their state: a lent buffer
+// is neither zeroed nor queued then, and is counted in xruns like a TX buffer
+// played free or an RX buffer refilled unread.
+
+#define SLC_BUF_FREE  (0)
+#define SLC_BUF_LENT  (1)
+#define SLC_BUF_READY (2)
+
 typedef struct slc_queue_item {
   uint32_t                blocksize : 12;
   uint32_t                datalen   : 12;
@@ -54,10 +69,12 @@ typedef struct slc_queue_item {
 } slc_queue_item_t;
 
 typedef struct i2s_state {
-  uint32_t *       slc_queue[SLC_BUF_CNT];
+  uint32_t **      slc_queue; // _i2s_buf_cnt entries
   volatile uint8_t slc_queue_len;
-  uint32_t *       slc_buf_pntr[SLC_BUF_CNT]; // Pointer to the I2S DMA buffer data
-  slc_queue_item_t slc_items[SLC_BUF_CNT]; // I2S DMA buffer descriptors
+  uint32_t *       slc_buf; // I2S DMA buffers data, _i2s_buf_cnt times _i2s_buf_len words
+  slc_queue_item_t *slc_items; // I2S DMA buffer descriptors
+  volatile uint8_t *slc_state; // Per buffer, see above
+  volatile uint32_t xruns; // TX underruns, RX overruns
   uint32_t *       curr_slc_buf; // Current buffer for writing
   uint32_t         curr_slc_buf_pos; // Position in the current buffer
   void             (*callback) (void);
@@ -75,6 +92,10 @@ static i2s_state_t *tx = NULL;
 static uint32_t _i2s_sample_rate;
 static int _i2s_bits = 16;
 
+// DMA buffers geometry
+static uint8_t _i2s_buf_cnt = SLC_BUF_CNT;
+static uint16_t _i2s_buf_len = SLC_BUF_LEN;
+
 // IOs used for I2S. Not defined in i2s.h, unfortunately.
 // Note these are internal GPIO numbers and not pins on an
 // Arduino board. Users need to verify their particular wiring.
@@ -93,11 +114,24 @@ bool i2s_set_bits(int bits) {
   return true;
 }
 
+bool i2s_set_dma_buffers(int count, int samples) {
+  if (tx || rx || count < 2 || count > SLC_BUF_CNT_MAX || samples < 1 || samples > SLC_BUF_LEN_MAX) {
+    return false;
+  }
+  _i2s_buf_cnt = count;
+  _i2s_buf_len = samples;
+  return true;
+}
+
+uint16_t i2s_block_samples() {
+  return _i2s_buf_len;
+}
+
 static bool _i2s_is_full(const i2s_state_t *ch) {
   if (!ch) {
     return false;
   }
-  return (ch->curr_slc_buf_pos==SLC_BUF_LEN || ch->curr_slc_buf==NULL) && (ch->slc_queue_len == 0);
+  return (ch->curr_slc_buf_pos==_i2s_buf_len || ch->curr_slc_buf==NULL) && (ch->slc_queue_len == 0);
 }
 
 bool i2s_is_full() {
@@ -112,7 +146,7 @@ static bool _i2s_is_empty(const i2s_state_t *ch) {
   if (!ch) {
     return false;
   }
-  return (ch->slc_queue_len >= SLC_BUF_CNT-1);
+  return (ch->slc_queue_len >= _i2s_buf_cnt-1);
 }
 
 bool i2s_is_empty() {
@@ -123,22 +157,32 @@ bool i2s_rx_is_empty() {
   return _i2s_is_empty( rx );
 }
 
-static uint16_t _i2s_available(const i2s_state_t *ch) {
+// Up to SLC_BUF_CNT_MAX * SLC_BUF_LEN_MAX samples, beyond 16 bits
+static uint32_t _i2s_available(const i2s_state_t *ch) {
   if (!ch) {
     return 0;
   }
-  return (SLC_BUF_CNT - ch->slc_queue_len) * SLC_BUF_LEN;
+  return (uint32_t)(_i2s_buf_cnt - ch->slc_queue_len) * _i2s_buf_len;
 }
 
-uint16_t i2s_available(){
+uint32_t i2s_available(){
   return _i2s_available( tx );
 }
 
-uint16_t i2s_rx_available(){
+uint32_t i2s_rx_available(){
   return _i2s_available( rx );
 }
 
-// Pop the top off of the queue and return it
+// Index of a DMA buffer in slc_items[] and slc_state[], -1 if buf is not one
+static inline int i2s_slc_block_index(const i2s_state_t *ch, const uint32_t *buf) {
+  if (buf < ch->slc_buf || buf >= ch->slc_buf + _i2s_buf_cnt * _i2s_buf_len) {
+    return -1;
+  }
+  size_t offset = buf - ch->slc_buf;
+  return (offset % _i2s_buf_len) ? -1 : (int)(offset / _i2s_buf_len);
+}
+
+// Pop the top off of the queue and lend it, with the SLC interrupt off
 static uint32_t * IRAM_ATTR i2s_slc_queue_next_item(i2s_state_t *ch) {
   uint8_t i;
   uint32_t *item = ch->slc_queue[0];
@@ -146,22 +190,27 @@ static uint32_t * IRAM_ATTR i2s_slc_queue_next_item(i2s_state_t *ch) {
   for ( i = 0; i < ch->slc_queue_len; i++) {
     ch->slc_queue[i] = ch->slc_queue[i+1];
   }
+  ch->slc_state[(item - ch->slc_buf) / _i2s_buf_len] = SLC_BUF_LENT;
   return item;
 }
 
-// Append an item to the end of the queue from receive
-static void IRAM_ATTR i2s_slc_queue_append_item(i2s_state_t *ch, uint32_t *item) {
+// Take an item out of the queue, if there
+static void IRAM_ATTR i2s_slc_queue_remove_item(i2s_state_t *ch, uint32_t *item) {
   // Shift everything up, except for the one corresponding to this item
-  for (int i=0, dest=0; i < ch->slc_queue_len; i++) {
+  int dest = 0;
+  for (int i=0; i < ch->slc_queue_len; i++) {
     if (ch->slc_queue[i] != item) {
       ch->slc_queue[dest++] = ch->slc_queue[i];
     }
   }
-  if (ch->slc_queue_len < SLC_BUF_CNT - 1) {
-    ch->slc_queue[ch->slc_queue_len++] = item;
-  } else {
-    ch->slc_queue[ch->slc_queue_len] = item;
-  }
+  ch->slc_queue_len = dest;
+}
+
+// Append an item to the end of the queue, from the ISR.  One the DMA went
+// past again without it being taken moves to the end.
+static void IRAM_ATTR i2s_slc_queue_append_item(i2s_state_t *ch, uint32_t *item) {
+  i2s_slc_queue_remove_item(ch, item);
+  ch->slc_queue[ch->slc_queue_len++] = item;
 }
 
 static void IRAM_ATTR i2s_slc_isr(void) {
@@ -170,13 +219,22 @@ static void IRAM_ATTR i2s_slc_isr(void) {
   SLCIC = 0xFFFFFFFF;
   if (slc_intr_status & SLCIRXEOF) {
     slc_queue_item_t *finished_item = (slc_queue_item_t *)SLCRXEDA;
-    // Zero the buffer so it is mute in case of underflow
-    ets_memset((void *)finished_item->buf_ptr, 0x00, SLC_BUF_LEN * 4);
-    if (tx->slc_queue_len >= SLC_BUF_CNT-1) {
-      // All buffers are empty. This means we have an underflow
-      i2s_slc_queue_next_item(tx); // Free space for finished_item
+    int block = finished_item - tx->slc_items;
+    // The DMA plays the next one now, not to be lent meanwhile
+    i2s_slc_queue_remove_item(tx, finished_item->next_link_ptr->buf_ptr);
+    if (tx->slc_state[block] == SLC_BUF_READY) {
+      // Zero the buffer so it is mute in case of underflow
+      ets_memset((void *)finished_item->buf_ptr, 0x00, _i2s_buf_len * 4);
+      tx->slc_state[block] = SLC_BUF_FREE;
+      i2s_slc_queue_append_item(tx, finished_item->buf_ptr);
+    } else {
+      // Played while still free or lent: an underflow.  A lent one stays
+      // with the application, to be played once submitted.
+      tx->xruns++;
+      if (tx->slc_state[block] == SLC_BUF_FREE) {
+        i2s_slc_queue_append_item(tx, finished_item->buf_ptr);
+      }
     }
-    tx->slc_queue[tx->slc_queue_len++] = finished_item->buf_ptr;
     if (tx->callback) {
       tx->callback();
     }
@@ -185,7 +243,15 @@ static void IRAM_ATTR i2s_slc_isr(void) {
     slc_queue_item_t *finished_item = (slc_queue_item_t *)SLCTXEDA;
     // Set owner back to 1 (SW) or else RX stops.  TX has no such restriction.
     finished_item->owner = 1;
-    i2s_slc_queue_append_item(rx, finished_item->buf_ptr);
+    int block = finished_item - rx->slc_items;
+    if (rx->slc_state[block] != SLC_BUF_FREE) {
+      // Refilled before it was read
+      rx->xruns++;
+    }
+    if (rx->slc_state[block] != SLC_BUF_LENT) {
+      rx->slc_state[block] = SLC_BUF_READY;
+      i2s_slc_queue_append_item(rx, finished_item->buf_ptr);
+    }
     if (rx->callback) {
       rx->callback();
     }
@@ -201,36 +267,52 @@ void i2s_rx_set_callback(void (*callback) (void)) {
   if (rx) rx->callback = callback;
 }
 
-static bool _alloc_channel(i2s_state_t *ch) {
+static bool _alloc_channel(i2s_state_t *ch, uint8_t state) {
   ch->slc_queue_len = 0;
-  for (int x=0; x<SLC_BUF_CNT; x++) {
-    ch->slc_buf_pntr[x] = (uint32_t *)malloc(SLC_BUF_LEN * sizeof(ch->slc_buf_pntr[0][0]));
-    if (!ch->slc_buf_pntr[x]) {
-      // OOM, the upper layer will free up any partially allocated channels.
-      return false;
-    }
-    memset(ch->slc_buf_pntr[x], 0, SLC_BUF_LEN * sizeof(ch->slc_buf_pntr[x][0]));
+  ch->xruns = 0;
+  ch->slc_queue = (uint32_t **)malloc(_i2s_buf_cnt * sizeof(ch->slc_queue[0]));
+  ch->slc_buf = (uint32_t *)calloc(_i2s_buf_cnt * _i2s_buf_len, sizeof(ch->slc_buf[0]));
+  ch->slc_items = (slc_queue_item_t *)malloc(_i2s_buf_cnt * sizeof(ch->slc_items[0]));
+  ch->slc_state = (volatile uint8_t *)malloc(_i2s_buf_cnt);
+  if (!ch->slc_queue || !ch->slc_buf || !ch->slc_items || !ch->slc_state) {
+    // OOM, the upper layer will free up any partially allocated channels.
+    return false;
+  }
 
+  for (int x=0; x<_i2s_buf_cnt; x++) {
     ch->slc_items[x].unused = 0;
     ch->slc_items[x].owner = 1;
     ch->slc_items[x].eof = 1;
     ch->slc_items[x].sub_sof = 0;
-    ch->slc_items[x].datalen = SLC_BUF_LEN * 4;
-    ch->slc_items[x].blocksize = SLC_BUF_LEN * 4;
-    ch->slc_items[x].buf_ptr = (uint32_t*)&ch->slc_buf_pntr[x][0];
-    ch->slc_items[x].next_link_ptr = (x<(SLC_BUF_CNT-1))?(&ch->slc_items[x+1]):(&ch->slc_items[0]);
+    ch->slc_items[x].datalen = _i2s_buf_len * 4;
+    ch->slc_items[x].blocksize = _i2s_buf_len * 4;
+    ch->slc_items[x].buf_ptr = &ch->slc_buf[x * _i2s_buf_len];
+    ch->slc_items[x].next_link_ptr = (x<(_i2s_buf_cnt-1))?(&ch->slc_items[x+1]):(&ch->slc_items[0]);
+    // The initial TX silence is no underrun
+    ch->slc_state[x] = state;
   }
   return true;
 }
 
+static void _free_channel(i2s_state_t *ch) {
+  free(ch->slc_queue);
+  free(ch->slc_buf);
+  free(ch->slc_items);
+  free((void *)ch->slc_state);
+  ch->slc_queue = NULL;
+  ch->slc_buf = NULL;
+  ch->slc_items = NULL;
+  ch->slc_state = NULL;
+}
+
 static bool i2s_slc_begin() {
   if (tx) {
-    if (!_alloc_channel(tx)) {
+    if (!_alloc_channel(tx, SLC_BUF_READY)) {
       return false;
     }
   }
   if (rx) {
-    if (!_alloc_channel(rx)) {
+    if (!_alloc_channel(rx, SLC_BUF_FREE)) {
       return false;
     }
   }
@@ -284,15 +366,11 @@ static void i2s_slc_end(){
   SLCTXL &= ~(SLCTXLAM << SLCTXLA); // clear TX descriptor address
   SLCRXL &= ~(SLCRXLAM << SLCRXLA); // clear RX descriptor address
 
-  for (int x = 0; x<SLC_BUF_CNT; x++) {
-    if (tx) {
-      free(tx->slc_buf_pntr[x]);
-      tx->slc_buf_pntr[x] = NULL;
-    }
-    if (rx) {
-      free(rx->slc_buf_pntr[x]);
-      rx->slc_buf_pntr[x] = NULL;
-    }
+  if (tx) {
+    _free_channel(tx);
+  }
+  if (rx) {
+    _free_channel(rx);
   }
 }
 
@@ -303,7 +381,7 @@ static bool _i2s_write_sample(uint32_t sample, bool nb) {
     return false;
   }
 
-  if (tx->curr_slc_buf_pos==SLC_BUF_LEN || tx->curr_slc_buf==NULL) {
+  if (tx->curr_slc_buf_pos==_i2s_buf_len || tx->curr_slc_buf==NULL) {
     if (tx->slc_queue_len == 0) {
       if (nb) {
         // Don't wait if nonblocking, just notify upper levels
@@ -323,6 +401,9 @@ static bool _i2s_write_sample(uint32_t sample, bool nb) {
     tx->curr_slc_buf_pos=0;
   }
   tx->curr_slc_buf[tx->curr_slc_buf_pos++]=sample;
+  if (tx->curr_slc_buf_pos==_i2s_buf_len) {
+    tx->slc_state[i2s_slc_block_index(tx, tx->curr_slc_buf)] = SLC_BUF_READY;
+  }
   return true;
 }
 
@@ -349,7 +430,7 @@ static uint16_t _i2s_write_buffer(const int16_t *frames, uint16_t frame_count, b
     while(frame_count>0) {
    
         // make sure we have room in the current buffer
-        if (tx->curr_slc_buf_pos==SLC_BUF_LEN || tx->curr_slc_buf==NULL) {
+        if (tx->curr_slc_buf_pos==_i2s_buf_len || tx->curr_slc_buf==NULL) {
             // no room in the current buffer? if there are no buffers available then exit
             if (tx->slc_queue_len == 0)
             {
@@ -376,7 +457,7 @@ static uint16_t _i2s_write_buffer(const int16_t *frames, uint16_t frame_count, b
         }       
 
         //space available in the current buffer
-        uint16_t	available = SLC_BUF_LEN - tx->curr_slc_buf_pos;
+        uint16_t	available = _i2s_buf_len - tx->curr_slc_buf_pos;
 
         uint16_t fc = (available < frame_count) ? available : frame_count;
 
@@ -395,6 +476,10 @@ static uint16_t _i2s_write_buffer(const int16_t *frames, uint16_t frame_count, b
             }
         }        
         
+        if (tx->curr_slc_buf_pos==_i2s_buf_len) {
+            tx->slc_state[i2s_slc_block_index(tx, tx->curr_slc_buf)] = SLC_BUF_READY;
+        }
+
         frame_count -= fc;
         frames_written += fc;
     }
@@ -413,7 +498,7 @@ bool i2s_read_sample(int16_t *left, int16_t *right, bool blocking) {
   if (!rx) {
     return false;
   }
-  if (rx->curr_slc_buf_pos==SLC_BUF_LEN || rx->curr_slc_buf==NULL) {
+  if (rx->curr_slc_buf_pos==_i2s_buf_len || rx->curr_slc_buf==NULL) {
     if (rx->slc_queue_len == 0) {
       if (!blocking) {
         return false;
@@ -433,6 +518,9 @@ bool i2s_read_sample(int16_t *left, int16_t *right, bool blocking) {
   }
 
   uint32_t sample = rx->curr_slc_buf[rx->curr_slc_buf_pos++];
+  if (rx->curr_slc_buf_pos==_i2s_buf_len) {
+    rx->slc_state[i2s_slc_block_index(rx, rx->curr_slc_buf)] = SLC_BUF_FREE;
+  }
   if (left) {
     *left  = sample & 0xffff;
   }
@@ -443,6 +531,58 @@ bool i2s_read_sample(int16_t *left, int16_t *right, bool blocking) {
   return true;
 }
 
+// Lends whole DMA buffers, in the order the DMA uses them
+static uint32_t *_i2s_block_get(i2s_state_t *ch, bool blocking) {
+  if (!ch) {
+    return NULL;
+  }
+  while (ch->slc_queue_len == 0) {
+    if (!blocking) {
+      return NULL;
+    }
+    optimistic_yield(10000);
+  }
+  ETS_SLC_INTR_DISABLE();
+  uint32_t *block = i2s_slc_queue_next_item(ch);
+  ETS_SLC_INTR_ENABLE();
+  return block;
+}
+
+uint32_t *i2s_tx_block_get(bool blocking) {
+  return _i2s_block_get(tx, blocking);
+}
+
+// Hands back a lent block, anything else is ignored
+static void _i2s_block_return(i2s_state_t *ch, const uint32_t *block, uint8_t state) {
+  if (!ch) {
+    return;
+  }
+  int index = i2s_slc_block_index(ch, block);
+  if (index >= 0 && ch->slc_state[index] == SLC_BUF_LENT) {
+    ch->slc_state[index] = state;
+  }
+}
+
+void i2s_tx_block_submit(uint32_t *block) {
+  _i2s_block_return(tx, block, SLC_BUF_READY);
+}
+
+const uint32_t *i2s_rx_block_get(bool blocking) {
+  return _i2s_block_get(rx, blocking);
+}
+
+void i2s_rx_block_release(const uint32_t *block) {
+  _i2s_block_return(rx, block, SLC_BUF_FREE);
+}
+
+uint32_t i2s_tx_underruns() {
+  return tx ? tx->xruns : 0;
+}
+
+uint32_t i2s_rx_overruns() {
+  return rx ? rx->xruns : 0;
+}
+
 
 void i2s_set_rate(uint32_t rate) { //Rate in HZ
   if (rate == _i2s_sample_rate) {
@@ -579,7 +719,7 @@ bool i2s_rxtxdrive_begin(bool enableRx, bool enableTx, bool driveRxClocks, bool
 
   if (rx) {
     // Need to prime the # of samples to receive in the engine
-    I2SRXEN = SLC_BUF_LEN;
+    I2SRXEN = _i2s_buf_len;
   }
 
   I2SC |= (rx?I2SRXS:0) | (tx?I2STXS:0); // Start transmission/reception
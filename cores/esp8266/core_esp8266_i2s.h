@@ -37,6 +37,17 @@ the left and right channel) concatenated as (Rout<<16)+Lout
 i2s_write_sample will block when you're sending data too quickly, so you can just
 generate and push data as fast as you can and i2s_write_sample will regulate the
 speed.
+
+Instead of copying samples, i2s_tx_block_get() lends the next free DMA block, of
+i2s_block_samples() samples, to be filled in place and handed back with
+i2s_tx_block_submit() before the DMA gets to it again (else it is counted in
+i2s_tx_underruns(), and played once submitted, the DMA having gone round all
+blocks again).  Blocks are played in the order they are lent, and the
+i2s_set_callback() function is called from the interrupt each time one frees up.
+RX works the same with i2s_rx_block_get() and i2s_rx_block_release(), blocks
+refilled before they were released are counted in i2s_rx_overruns().  Submitting
+or releasing a block which is not lent does nothing.  Mixing the block and
+sample calls on a channel is only safe at block boundaries.
 */
 
 #ifdef __cplusplus
@@ -46,6 +57,8 @@ extern "C" {
 bool i2s_set_bits(int bits); // Set bits per sample, only 16 or 24 supported.  Call before begin.
 // Note that in 24 bit mode each sample must be left-aligned (i.e. 0x00000000 .. 0xffffff00) as the
 // hardware shifts starting at bit 31, not bit 23.
+bool i2s_set_dma_buffers(int count, int samples); // Number of DMA blocks (2..128, default 8) and their size in 32-bit
+// samples (1..1023, default 64) for each channel.  Call before begin.
 
 void i2s_begin(); // Enable TX only, for compatibility
 bool i2s_rxtx_begin(bool enableRx, bool enableTx); // Allow TX and/or RX, returns false on OOM error
@@ -62,8 +75,8 @@ bool i2s_is_full();//returns true if DMA is full and can not take more bytes (ov
 bool i2s_is_empty();//returns true if DMA is empty (underflow)
 bool i2s_rx_is_full();
 bool i2s_rx_is_empty();
-uint16_t i2s_available();// returns the number of samples than can be written before blocking
-uint16_t i2s_rx_available();// returns the number of samples than can be written before blocking
+uint32_t i2s_available();// returns the number of samples than can be written before blocking
+uint32_t i2s_rx_available();// returns the number of samples than can be written before blocking
 void i2s_set_callback(void (*callback) (void));
 void i2s_rx_set_callback(void (*callback) (void));
 
@@ -74,6 +87,15 @@ uint16_t i2s_write_buffer_mono_nb(const int16_t *frames, uint16_t frame_count);
 uint16_t i2s_write_buffer(const int16_t *frames, uint16_t frame_count);
 uint16_t i2s_write_buffer_nb(const int16_t *frames, uint16_t frame_count);
 
+// zero-copy access to the DMA blocks, see above
+uint16_t i2s_block_samples(); // samples in a block
+uint32_t *i2s_tx_block_get(bool blocking); // next free TX block, or NULL when none and not blocking
+void i2s_tx_block_submit(uint32_t *block); // hands a filled TX block over to the DMA
+const uint32_t *i2s_rx_block_get(bool blocking); // oldest received block, or NULL when none and not blocking
+void i2s_rx_block_release(const uint32_t *block); // hands a read RX block back to the DMA
+uint32_t i2s_tx_underruns(); // TX blocks played before they were submitted
+uint32_t i2s_rx_overruns(); // RX blocks refilled before they were released
+
 #ifdef __cplusplus
 }
 #endif
@@ -111,10 +111,29 @@ int stopWaveform(uint8_t pin);
 void setTimer1Callback(uint32_t (*fn)());
 
 
+#ifdef WAVEFORM_PWM_STATS
+// Timing histograms of the default (PWM locked) generator, in CPU clock cycles.
+// Bucket 0 counts 0, bucket n the values of 2^(n-1) to 2^n - 1 and the last
+// bucket the larger ones too.
+#define WAVEFORM_STATS_BUCKETS 16
+typedef struct {
+  uint32_t irqCount;
+  uint32_t irqLatency[WAVEFORM_STATS_BUCKETS]; // Timer1 NMI entry after the timer was due
+  uint32_t irqLatencyMax;
+  uint32_t edgeError[WAVEFORM_STATS_BUCKETS];  // PWM edges after their scheduled cycle
+  uint32_t edgeErrorMax;
+} WaveformStats;
+
+// Copy the histograms out, if stats isn't NULL, and optionally clear them.
+void getWaveformStats(WaveformStats *stats, bool reset);
+#endif
+
+
 // Internal-only calls, not for applications
 extern void _setPWMFreq(uint32_t freq);
 extern bool _stopPWM(uint8_t pin);
 extern bool _setPWM(int pin, uint32_t val, uint32_t range);
+extern bool _setPWMBatch(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range);
 
 #ifdef __cplusplus
 }
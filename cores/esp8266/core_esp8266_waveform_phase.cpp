@@ -57,6 +57,7 @@ extern "C" void enablePhaseLockedWaveform (void)
 extern "C" void _setPWMFreq_weak(uint32_t freq) { (void) freq; }
 extern "C" IRAM_ATTR bool _stopPWM_weak(int pin) { (void) pin; return false; }
 extern "C" bool _setPWM_weak(int pin, uint32_t val, uint32_t range) { (void) pin; (void) val; (void) range; return false; }
+extern "C" bool _setPWMBatch_weak(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range) { (void) pins; (void) vals; (void) count; (void) range; return false; }
 
 
 // Timer is 80MHz fixed. 160MHz CPU frequency need scaling.
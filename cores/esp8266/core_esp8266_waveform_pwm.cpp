@@ -88,7 +88,18 @@ static WVFState wvfState;
 
 
 // Ensure everything is read/written to RAM
+#ifndef CORE_MOCK
 #define MEMBARRIER() { __asm__ volatile("" ::: "memory"); }
+#else
+// On host, time passes and the emulated timer fires when the cycle counter is read
+#define MEMBARRIER() { esp_get_cycle_count(); }
+#endif
+
+#ifdef WAVEFORM_PWM_STATS
+static WaveformStats wvfStats;
+static bool wvfStatsDue = false; // The ISR programmed the timer, wvfStatsDueCycle is valid
+static uint32_t wvfStatsDueCycle;
+#endif
 
 // Non-speed critical bits
 #pragma GCC optimize ("Os")
@@ -104,12 +115,18 @@ static __attribute__((noinline)) void initTimer() {
     ETS_FRC_TIMER1_NMI_INTR_ATTACH(timer1Interrupt);
     timer1_enable(TIM_DIV1, TIM_EDGE, TIM_SINGLE);
     timerRunning = true;
+#ifdef WAVEFORM_PWM_STATS
+    wvfStatsDue = false;
+#endif
     timer1_write(microsecondsToClockCycles(10));
   }
 }
 
 static IRAM_ATTR void forceTimerInterrupt() {
   if (T1L > microsecondsToClockCycles(10)) {
+#ifdef WAVEFORM_PWM_STATS
+    wvfStatsDue = false;
+#endif
     T1L = microsecondsToClockCycles(10);
   }
 }
@@ -171,22 +188,28 @@ static IRAM_ATTR void _notifyPWM(PWMState *p, bool idle) {
 
 static void _addPWMtoList(PWMState &p, int pin, uint32_t val, uint32_t range);
 
-
-// Called when analogWriteFreq() changed to update the PWM total period
-extern void _setPWMFreq_weak(uint32_t freq) __attribute__((weak)); 
-void _setPWMFreq_weak(uint32_t freq) {
-  _pwmFreq = freq;
-
+// PWM period in clock cycles for a frequency and a number of PWM pins
+static uint32_t _pwmPeriodCycles(uint32_t freq, uint32_t cnt) {
   // Convert frequency into clock cycles
   uint32_t cc = microsecondsToClockCycles(1000000UL) / freq;
 
   // Simple static adjustment to bring period closer to requested due to overhead
   // Empirically determined as a constant PWM delay and a function of the number of PWMs
 #if F_CPU == 80000000
-  cc -= ((microsecondsToClockCycles(pwmState.cnt) * 13) >> 4) + 110;
+  cc -= ((microsecondsToClockCycles(cnt) * 13) >> 4) + 110;
 #else
-  cc -= ((microsecondsToClockCycles(pwmState.cnt) * 10) >> 4) + 75;
+  cc -= ((microsecondsToClockCycles(cnt) * 10) >> 4) + 75;
 #endif
+  return cc;
+}
+
+
+// Called when analogWriteFreq() changed to update the PWM total period
+extern void _setPWMFreq_weak(uint32_t freq) __attribute__((weak)); 
+void _setPWMFreq_weak(uint32_t freq) {
+  _pwmFreq = freq;
+
+  uint32_t cc = _pwmPeriodCycles(freq, pwmState.cnt);
 
   if (cc == _pwmPeriod) {
     return; // No change
@@ -347,6 +370,97 @@ bool _setPWM(int pin, uint32_t val, uint32_t range) {
   return _setPWM_bound(pin, val, range);
 }
 
+// Sets the PWM duty of several pins with a single state update, so that
+// they all change at the same PWM period start.  Duplicated pins take
+// their last value.  Nothing is changed if the PWM pins would not fit.
+extern bool _setPWMBatch_weak(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range) __attribute__((weak));
+bool _setPWMBatch_weak(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range) {
+  uint32_t batchMask = 0; // Pins in the batch
+  uint32_t pwmMask = 0;   // Pins of the batch to PWM, the others are set to all-on/off
+  uint32_t highMask = 0;  // All-on pins of the batch
+  uint32_t newVal[17];
+  for (size_t i = 0; i < count; i++) {
+    uint8_t pin = pins[i];
+    if (pin > 16) {
+      return false;
+    }
+    uint32_t cc = (_pwmPeriod * vals[i]) / range;
+    batchMask |= 1<<pin;
+    pwmMask &= ~(1<<pin);
+    highMask &= ~(1<<pin);
+    if (cc >= _pwmPeriod) {
+      highMask |= 1<<pin;
+    } else if (cc) {
+      pwmMask |= 1<<pin;
+    }
+    newVal[pin] = vals[i];
+  }
+
+  PWMState p;  // Working copy
+  p = pwmState;
+  for (int pin = 0; pin <= 16; pin++) {
+    if (batchMask & (1<<pin)) {
+      _cleanAndRemovePWM(&p, pin);
+    }
+  }
+  uint32_t cnt = p.cnt + __builtin_popcount(pwmMask);
+  if (cnt > maxPWMs) {
+    return false; // No space left
+  }
+  for (int pin = 0; pin <= 16; pin++) {
+    if (batchMask & (1<<pin)) {
+      stopWaveform(pin);
+    }
+  }
+
+  // The period depends on the number of pins, rebuild the list for the new one
+  _pwmPeriod = _pwmPeriodCycles(_pwmFreq, cnt);
+  PWMState next;
+  next.mask = 0;
+  next.cnt = 0;
+  for (uint32_t i = 0; i < p.cnt; i++) {
+    auto pin = p.pin[i];
+    _addPWMtoList(next, pin, wvfState.waveform[pin].desiredHighCycles, wvfState.waveform[pin].desiredLowCycles);
+  }
+  for (int pin = 0; pin <= 16; pin++) {
+    if (pwmMask & (1<<pin)) {
+      _addPWMtoList(next, pin, newVal[pin], range);
+    }
+  }
+
+  // Set mailbox and wait for ISR to copy it over, once for all pins
+  if (next.cnt || pwmState.cnt) {
+    initTimer();
+    _notifyPWM(&next, true);
+    disableIdleTimer();
+  }
+
+  for (int pin = 0; pin <= 16; pin++) {
+    if ((batchMask & ~pwmMask) & (1<<pin)) {
+      digitalWrite(pin, (highMask & (1<<pin)) ? HIGH : LOW);
+    }
+  }
+
+  return true;
+}
+static bool _setPWMBatch_bound(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range) __attribute__((weakref("_setPWMBatch_weak")));
+bool _setPWMBatch(const uint8_t *pins, const uint32_t *vals, size_t count, uint32_t range) {
+  return _setPWMBatch_bound(pins, vals, count, range);
+}
+
+#ifdef WAVEFORM_PWM_STATS
+void getWaveformStats(WaveformStats *stats, bool reset) {
+  uint32_t savedPS = xt_rsil(15);
+  if (stats) {
+    *stats = wvfStats;
+  }
+  if (reset) {
+    memset(&wvfStats, 0, sizeof(wvfStats));
+  }
+  xt_wsr_ps(savedPS);
+}
+#endif
+
 // Start up a waveform on a pin, or change the current one.  Will change to the new
 // waveform smoothly on next low->high transition.  For immediate change, stopWaveform()
 // first, then it will immediately begin.
@@ -466,9 +580,13 @@ IRAM_ATTR int stopWaveform(uint8_t pin) {
 // optimization levels the inline attribute gets lost if we try the
 // other version.
 static inline IRAM_ATTR uint32_t GetCycleCountIRQ() {
+#ifndef CORE_MOCK
   uint32_t ccount;
   __asm__ __volatile__("rsr %0,ccount":"=a"(ccount));
   return ccount;
+#else
+  return esp_get_cycle_count();
+#endif
 }
 
 // Find the earliest cycle as compared to right now
@@ -497,9 +615,29 @@ static inline IRAM_ATTR uint32_t earliest(uint32_t a, uint32_t b) {
 // When the time to the next edge is greater than this, RTI and set another IRQ to minimize CPU usage
 #define MINIRQTIME microsecondsToClockCycles(4)
 
+#ifdef WAVEFORM_PWM_STATS
+// Bucket n > 0 of a histogram counts the values of 2^(n-1) to 2^n - 1, the last one the larger ones too
+static inline IRAM_ATTR void statsRecord(uint32_t *histogram, uint32_t *max, int32_t value) {
+  uint32_t v = value < 0 ? 0 : value;
+  uint32_t bucket = v ? 32 - __builtin_clz(v) : 0;
+  if (bucket >= WAVEFORM_STATS_BUCKETS) {
+    bucket = WAVEFORM_STATS_BUCKETS - 1;
+  }
+  histogram[bucket]++;
+  if (v > *max) {
+    *max = v;
+  }
+}
+#endif
+
 static IRAM_ATTR void timer1Interrupt() {
+#ifdef WAVEFORM_PWM_STATS
+  if (wvfStatsDue) {
+    statsRecord(wvfStats.irqLatency, &wvfStats.irqLatencyMax, GetCycleCountIRQ() - wvfStatsDueCycle);
+  }
+#endif
   // Flag if the core is at 160 MHz, for use by adjust()
-  bool turbo = (*(uint32_t*)0x3FF00014) & 1 ? true : false;
+  bool turbo = CPU2X & 1 ? true : false;
 
   uint32_t nextEventCycle = GetCycleCountIRQ() + microsecondsToClockCycles(MAXIRQUS);
   uint32_t timeoutCycle = GetCycleCountIRQ() + microsecondsToClockCycles(14);
@@ -534,6 +672,9 @@ static IRAM_ATTR void timer1Interrupt() {
         do {
             cyclesToGo = pwmState.nextServiceCycle - GetCycleCountIRQ();
             if (cyclesToGo < 0) {
+#ifdef WAVEFORM_PWM_STATS
+                statsRecord(wvfStats.edgeError, &wvfStats.edgeErrorMax, -cyclesToGo);
+#endif
                 if (pwmState.idx == pwmState.cnt) { // Start of pulses, possibly copy new
                   if (pwmState.pwmUpdate) {
                     // Do the memory copy from temp to global and clear mailbox
@@ -660,6 +801,12 @@ static IRAM_ATTR void timer1Interrupt() {
   }
   nextEventCycles -= DELTAIRQ;
 
+#ifdef WAVEFORM_PWM_STATS
+  wvfStats.irqCount++;
+  wvfStatsDueCycle = GetCycleCountIRQ() + nextEventCycles;
+  wvfStatsDue = true;
+#endif
+
   // Do it here instead of global function to save time and because we know it's edge-IRQ
   T1L = nextEventCycles >> (turbo ? 1 : 0);
 }
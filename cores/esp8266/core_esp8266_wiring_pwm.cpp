@@ -83,6 +83,35 @@ extern void __analogWriteMode(uint8_t pin, int val, bool openDrain) {
   }
 }
 
+extern void __analogWriteBatch(const uint8_t *pins, const int *values, size_t count) {
+  uint32_t vals[17];
+  if (count <= 17) {
+    for (size_t i = 0; i < count; i++) {
+      int val = values[i];
+      if (val < 0) {
+        val = 0;
+      } else if (val > analogScale) {
+        val = analogScale;
+      }
+      vals[i] = val;
+      if ((pins[i] <= 16) && !(analogMap & (1UL << pins[i]))) {
+        pinMode(pins[i], OUTPUT);
+      }
+    }
+    // All the new duties start in the same PWM period
+    if (_setPWMBatch(pins, vals, count, analogScale)) {
+      for (size_t i = 0; i < count; i++) {
+        analogMap |= (1 << pins[i]);
+      }
+      return;
+    }
+  }
+  // Too many pins or not supported by the waveform generator, one at a time
+  for (size_t i = 0; i < count; i++) {
+    analogWrite(pins[i], values[i]);
+  }
+}
+
 extern void __analogWriteRange(uint32_t range) {
   if ((range >= 15) && (range <= 65535)) {
     analogScale = range;
@@ -97,6 +126,7 @@ extern void __analogWriteResolution(int res) {
 
 extern void analogWrite(uint8_t pin, int val) __attribute__((weak, alias("__analogWrite")));
 extern void analogWriteMode(uint8_t pin, int val, bool openDrain) __attribute__((weak, alias("__analogWriteMode")));
+extern void analogWriteBatch(const uint8_t *pins, const int *values, size_t count) __attribute__((weak, alias("__analogWriteBatch")));
 extern void analogWriteFreq(uint32_t freq) __attribute__((weak, alias("__analogWriteFreq")));
 extern void analogWriteRange(uint32_t range) __attribute__((weak, alias("__analogWriteRange")));
 extern void analogWriteResolution(int res) __attribute__((weak, alias("__analogWriteResolution")));
@@ -29,6 +29,9 @@
 
 #define ESP8266_REG(addr) *((volatile uint32_t *)(0x60000000+(addr)))
 #define ESP8266_DREG(addr) *((volatile uint32_t *)(0x3FF00000+(addr)))
+
+#endif // ifndef CORE_MOCK
+
 #define ESP8266_CLOCK 80000000UL
 
 #define i2c_readReg_Mask(block, host_id, reg_add, Msb, Lsb)  rom_i2c_readReg_Mask(block, host_id, reg_add, Msb, Lsb)
@@ -848,8 +851,8 @@ extern volatile uint32_t* const esp8266_gpioToFn[16];
  Random Number Generator 32bit
  http://esp8266-re.foogod.com/wiki/Random_Number_Generator
 **/
+#ifndef CORE_MOCK
 #define RANDOM_REG32  ESP8266_DREG(0x20E44)
-
-#endif // ifndef CORE_MOCK
+#endif
 
 #endif
@@ -29,10 +29,9 @@ extern "C" {
 #include "spi_flash.h"
 }
 
-int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t *dst) {
+int32_t flash_hal_read_aligned(uint32_t addr, uint32_t size, uint32_t *dst) {
     optimistic_yield(10000);
 
-    // We use flashRead overload that handles proper alignment
     if (ESP.flashRead(addr, dst, size)) {
         return FLASH_HAL_OK;
     } else {
@@ -40,11 +39,11 @@ int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t *dst) {
     }
 }
 
-int32_t flash_hal_write(uint32_t addr, uint32_t size, const uint8_t *src) {
+int32_t flash_hal_write_aligned(uint32_t addr, uint32_t size, const uint32_t *src) {
     optimistic_yield(10000);
 
-    // We use flashWrite overload that handles proper alignment
-    if (ESP.flashWrite(addr, src, size)) {
+    // Takes care of page boundaries and PUYA chips
+    if ((addr & 3) == 0 && ESP.flashWrite(addr, src, size)) {
         return FLASH_HAL_OK;
     } else {
         return FLASH_HAL_WRITE_ERROR;
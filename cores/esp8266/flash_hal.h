@@ -87,10 +87,18 @@ extern uint32_t _EEPROM_start;
 #define FLASH_HAL_WRITE_ERROR (-2)
 #define FLASH_HAL_ERASE_ERROR (-3)
 
+// Any address, buffer and size. Reads take one additional flash access for
+// unaligned sizes or buffers, writes are copied through the stack page by
+// page unless address, buffer and size are all aligned
 extern int32_t flash_hal_write(uint32_t addr, uint32_t size, const uint8_t *src);
 extern int32_t flash_hal_erase(uint32_t addr, uint32_t size);
 extern int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t *dst);
 
+// Bulk transfers, one flash access each (writes are split at flash pages).
+// The buffer and size must be 4 byte aligned, and so must the address when writing
+extern int32_t flash_hal_read_aligned(uint32_t addr, uint32_t size, uint32_t *dst);
+extern int32_t flash_hal_write_aligned(uint32_t addr, uint32_t size, const uint32_t *src);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
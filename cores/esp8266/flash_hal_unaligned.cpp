@@ -0,0 +1,99 @@
+/*
+ flash_hal_unaligned.cpp - flash reads and writes of any alignment, on top
+ of the aligned bulk transfers of flash_hal.cpp
+ This file is part of the esp8266 core for Arduino environment.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <spi_flash_geometry.h>
+#include "flash_hal.h"
+
+static constexpr uint32_t Alignment { 4 };
+
+static bool isAligned(uintptr_t value) {
+    return (value & (Alignment - 1)) == 0;
+}
+
+static uint32_t alignDown(uint32_t value) {
+    return value & ~(Alignment - 1);
+}
+
+static uint32_t alignUp(uint32_t value) {
+    return alignDown(value + Alignment - 1);
+}
+
+int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t *dst) {
+    // Reads may start anywhere on flash, only the buffer needs aligning. The
+    // bulk is read into the aligned part of dst and moved down in place, the
+    // remaining few bytes take a second read.
+    uint32_t head = (Alignment - ((uintptr_t)dst & (Alignment - 1))) & (Alignment - 1);
+    uint32_t body = size > head ? alignDown(size - head) : 0;
+    if (body) {
+        int32_t rc = flash_hal_read_aligned(addr, body, reinterpret_cast<uint32_t *>(dst + head));
+        if (rc != FLASH_HAL_OK) {
+            return rc;
+        }
+        if (head) {
+            memmove(dst, dst + head, body);
+        }
+    }
+
+    uint32_t rest = size - body;
+    if (rest) {
+        // at most 6 bytes
+        uint32_t buf[2];
+        int32_t rc = flash_hal_read_aligned(addr + body, alignUp(rest), buf);
+        if (rc != FLASH_HAL_OK) {
+            return rc;
+        }
+        memcpy(dst + body, buf, rest);
+    }
+    return FLASH_HAL_OK;
+}
+
+int32_t flash_hal_write(uint32_t addr, uint32_t size, const uint8_t *src) {
+    if (!src) {
+        return FLASH_HAL_WRITE_ERROR;
+    }
+    if (isAligned(addr) && isAligned((uintptr_t)src) && isAligned(size)) {
+        return size ? flash_hal_write_aligned(addr, size, reinterpret_cast<const uint32_t *>(src)) : FLASH_HAL_OK;
+    }
+
+    // Copy into whole flash pages, one program operation per page touched.
+    // Bytes outside of [addr, addr + size) are padded with 0xff: programming
+    // only clears bits, so they keep their contents and need not be read first.
+    alignas(alignof(uint32_t)) uint8_t buf[FLASH_PAGE_SIZE];
+    const uint32_t end = addr + size;
+    uint32_t chunk = alignDown(addr);
+    while (chunk < end) {
+        uint32_t chunkEnd = std::min(alignUp(end), (chunk / FLASH_PAGE_SIZE + 1) * FLASH_PAGE_SIZE);
+        uint32_t from = std::max(chunk, addr);
+        uint32_t to = std::min(chunkEnd, end);
+        if (from != chunk || to != chunkEnd) {
+            memset(buf, 0xff, chunkEnd - chunk);
+        }
+        memcpy(&buf[from - chunk], src + (from - addr), to - from);
+        int32_t rc = flash_hal_write_aligned(chunk, chunkEnd - chunk, reinterpret_cast<const uint32_t *>(buf));
+        if (rc != FLASH_HAL_OK) {
+            return rc;
+        }
+        chunk = chunkEnd;
+    }
+    return FLASH_HAL_OK;
+}
@@ -88,6 +88,14 @@ struct uart_rx_buffer_
     uint8_t * buffer;
 };
 
+struct uart_tx_buffer_
+{
+    size_t size;
+    size_t rpos;
+    size_t wpos;
+    uint8_t * buffer;
+};
+
 struct uart_
 {
     int uart_nr;
@@ -96,11 +104,21 @@ struct uart_
     bool tx_enabled;
     bool rx_overrun;
     bool rx_error;
+    bool tx_blocking;
     uint8_t rx_pin;
     uint8_t tx_pin;
     struct uart_rx_buffer_ * rx_buffer;
+    struct uart_tx_buffer_ * tx_buffer;
 };
 
+/*
+  Both UARTs share one interrupt. Its handler is attached with the receiving
+  uart as argument, and also refills the TX FIFO of the uarts which have a
+  TX ring buffer (set by uart_resize_tx_buffer()) from there.
+*/
+static uart_t* s_uart_rx_isr = NULL;
+static uart_t* s_uart_tx_ring[2] = { NULL, NULL };
+
 
 /*
    In the context of the naming conventions in this file, "_unsafe" means two things:
@@ -405,21 +423,84 @@ uart_get_rx_buffer_size(uart_t* uart)
     return uart && uart->rx_enabled? uart->rx_buffer->size: 0;
 }
 
+/*
+  Reference for uart_tx_fifo_available() and uart_tx_fifo_full():
+  -Espressif Techinical Reference doc, chapter 11.3.7
+  -tools/sdk/uart_register.h
+  -cores/esp8266/esp8266_peri.h
+  */
+inline __attribute__((always_inline)) size_t
+uart_tx_fifo_available(const int uart_nr)
+{
+    return (USS(uart_nr) >> USTXC) & 0xff;
+}
+
+inline __attribute__((always_inline)) bool
+uart_tx_fifo_full(const int uart_nr)
+{
+    return uart_tx_fifo_available(uart_nr) >= 0x7f;
+}
+
+
+// Move what fits of the TX ring buffer into the TX FIFO
+// called by ISR
+static void IRAM_ATTR
+uart_tx_copy_buffer_to_fifo_unsafe(uart_t* uart)
+{
+    struct uart_tx_buffer_ *tx_buffer = uart->tx_buffer;
+    const int uart_nr = uart->uart_nr;
+    size_t count = uart_tx_fifo_available(uart_nr);
+
+    while(count < 0x7f && tx_buffer->rpos != tx_buffer->wpos) {
+        USF(uart_nr) = tx_buffer->buffer[tx_buffer->rpos];
+        if(++tx_buffer->rpos == tx_buffer->size)
+            tx_buffer->rpos = 0;
+        ++count;
+    }
+}
+
+// TX FIFO below the UCFET threshold, refill it or stop the interrupt
+// once the ring buffer is empty
+// called by ISR
+static void IRAM_ATTR
+uart_tx_isr(uart_t* uart)
+{
+    const int uart_nr = uart->uart_nr;
+    if(!(USIS(uart_nr) & (1 << UIFE)))
+        return;
+
+    uart_tx_copy_buffer_to_fifo_unsafe(uart);
+    if(uart->tx_buffer->rpos == uart->tx_buffer->wpos)
+        USIE(uart_nr) &= ~(1 << UIFE);
+    USIC(uart_nr) = (1 << UIFE);
+}
+
 // The default ISR handler called when GDB is not enabled
 void IRAM_ATTR
 uart_isr(void * arg, void * frame)
 {
     (void) frame;
     uart_t* uart = (uart_t*)arg;
-    uint32_t usis = USIS(uart->uart_nr);
+
+    bool tx_ring = false;
+    for(int uart_nr = UART0; uart_nr <= UART1; uart_nr++) {
+        if(s_uart_tx_ring[uart_nr]) {
+            uart_tx_isr(s_uart_tx_ring[uart_nr]);
+            tx_ring = true;
+        }
+    }
 
     if(uart == NULL || !uart->rx_enabled)
     {
-        USIC(uart->uart_nr) = usis;
-        ETS_UART_INTR_DISABLE();
+        if(uart != NULL)
+            USIC(uart->uart_nr) = USIS(uart->uart_nr);
+        if(!tx_ring)
+            ETS_UART_INTR_DISABLE();
         return;
     }
 
+    uint32_t usis = USIS(uart->uart_nr);
+
     if(usis & (1 << UIFF))
         uart_rx_copy_fifo_to_buffer_unsafe(uart);
 
@@ -432,7 +513,8 @@ uart_isr(void * arg, void * frame)
     if (usis & ((1 << UIFR) | (1 << UIPE) | (1 << UITO)))
         uart->rx_error = true;
 
-    USIC(uart->uart_nr) = usis;
+    // UIFE is for uart_tx_isr() to clear
+    USIC(uart->uart_nr) = usis & ~(1 << UIFE);
 }
 
 static void
@@ -457,7 +539,8 @@ uart_start_isr(uart_t* uart)
     #define INTRIGG 16
 
     //was:USC1(uart->uart_nr) = (INTRIGG << UCFFT) | (0x02 << UCTOT) | (1 <<UCTOE);
-    USC1(uart->uart_nr) = (INTRIGG << UCFFT);
+    // keep the TX FIFO empty threshold of a TX ring buffer
+    USC1(uart->uart_nr) = (INTRIGG << UCFFT) | (USC1(uart->uart_nr) & (0x7f << UCFET));
     USIC(uart->uart_nr) = 0xffff;
     //was: USIE(uart->uart_nr) = (1 << UIFF) | (1 << UIFR) | (1 << UITO);
     // UIFF: rx fifo full
@@ -465,7 +548,9 @@ uart_start_isr(uart_t* uart)
     // UIFR: frame error
     // UIPE: parity error
     // UITO: rx fifo timeout
-    USIE(uart->uart_nr) = (1 << UIFF) | (1 << UIOF) | (1 << UIFR) | (1 << UIPE) | (1 << UITO);
+    // UIFE: tx fifo empty, left as the TX ring buffer set it
+    USIE(uart->uart_nr) = (1 << UIFF) | (1 << UIOF) | (1 << UIFR) | (1 << UIPE) | (1 << UITO) | (USIE(uart->uart_nr) & (1 << UIFE));
+    s_uart_rx_isr = uart;
     ETS_UART_INTR_ATTACH(uart_isr,  (void *)uart);
     ETS_UART_INTR_ENABLE();
 }
@@ -482,31 +567,50 @@ uart_stop_isr(uart_t* uart)
     }
 
     ETS_UART_INTR_DISABLE();
-    USC1(uart->uart_nr) = 0;
-    USIC(uart->uart_nr) = 0xffff;
-    USIE(uart->uart_nr) = 0;
-    ETS_UART_INTR_ATTACH(NULL, NULL);
+    USC1(uart->uart_nr) &= (0x7f << UCFET);
+    USIC(uart->uart_nr) = 0xffff & ~(1 << UIFE);
+    USIE(uart->uart_nr) &= (1 << UIFE);
+    s_uart_rx_isr = NULL;
+    if(s_uart_tx_ring[UART0] || s_uart_tx_ring[UART1]) {
+        // still needed by the TX ring buffers
+        ETS_UART_INTR_ATTACH(uart_isr,  NULL);
+        ETS_UART_INTR_ENABLE();
+    } else {
+        ETS_UART_INTR_ATTACH(NULL, NULL);
+    }
 }
 
-/*
-  Reference for uart_tx_fifo_available() and uart_tx_fifo_full():
-  -Espressif Techinical Reference doc, chapter 11.3.7
-  -tools/sdk/uart_register.h
-  -cores/esp8266/esp8266_peri.h
-  */
-inline __attribute__((always_inline)) size_t
-uart_tx_fifo_available(const int uart_nr)
+static void
+uart_start_tx_isr(uart_t* uart)
 {
-    return (USS(uart_nr) >> USTXC) & 0xff;
+    // UCFET value is when the TX fifo empty interrupt triggers, the ISR
+    // refills the fifo when fewer bytes than this are left to send (1.4ms
+    // at 115200 bauds with 16).  UIFE itself is only enabled while the
+    // ring buffer holds data.
+    #define TXTRIGG 16
+
+    ETS_UART_INTR_DISABLE();
+    USC1(uart->uart_nr) = (USC1(uart->uart_nr) & ~(0x7f << UCFET)) | (TXTRIGG << UCFET);
+    s_uart_tx_ring[uart->uart_nr] = uart;
+    if(s_uart_rx_isr == NULL)
+        ETS_UART_INTR_ATTACH(uart_isr,  NULL);
+    ETS_UART_INTR_ENABLE();
 }
 
-inline __attribute__((always_inline)) bool
-uart_tx_fifo_full(const int uart_nr)
+static void
+uart_stop_tx_isr(uart_t* uart)
 {
-    return uart_tx_fifo_available(uart_nr) >= 0x7f;
+    ETS_UART_INTR_DISABLE();
+    USIE(uart->uart_nr) &= ~(1 << UIFE);
+    USIC(uart->uart_nr) = (1 << UIFE);
+    USC1(uart->uart_nr) &= ~(0x7f << UCFET);
+    s_uart_tx_ring[uart->uart_nr] = NULL;
+    if(s_uart_rx_isr || s_uart_tx_ring[UART0] || s_uart_tx_ring[UART1])
+        ETS_UART_INTR_ENABLE();
+    else
+        ETS_UART_INTR_ATTACH(NULL, NULL);
 }
 
-
 static void
 uart_do_write_char(const int uart_nr, char c)
 {
@@ -515,6 +619,75 @@ uart_do_write_char(const int uart_nr, char c)
     USF(uart_nr) = c;
 }
 
+inline size_t
+uart_tx_buffer_available_unsafe(const struct uart_tx_buffer_ * tx_buffer)
+{
+    if(tx_buffer->wpos < tx_buffer->rpos)
+        return (tx_buffer->wpos + tx_buffer->size) - tx_buffer->rpos;
+
+    return tx_buffer->wpos - tx_buffer->rpos;
+}
+
+// Queue data behind what the TX ring buffer holds, straight into the FIFO
+// when it is empty.  When the ring buffer is full, either wait for room,
+// keeping the FIFO filled meanwhile in case the ISR can't run, or return
+// what was queued.
+static size_t
+uart_tx_buffer_write(uart_t* uart, const char* buf, size_t size, bool progmem)
+{
+    struct uart_tx_buffer_ *tx_buffer = uart->tx_buffer;
+    const int uart_nr = uart->uart_nr;
+    size_t ret = 0;
+
+    while(true) {
+        ETS_UART_INTR_DISABLE();
+        uart_tx_copy_buffer_to_fifo_unsafe(uart);
+        if(tx_buffer->rpos == tx_buffer->wpos) {
+            while(ret < size && !uart_tx_fifo_full(uart_nr))
+                USF(uart_nr) = progmem? pgm_read_byte(buf + ret++): buf[ret++];
+        }
+        while(ret < size) {
+            // one byte is always left free to tell full from empty
+            size_t chunk = tx_buffer->size - 1 - uart_tx_buffer_available_unsafe(tx_buffer);
+            if(chunk > tx_buffer->size - tx_buffer->wpos)
+                chunk = tx_buffer->size - tx_buffer->wpos;
+            if(chunk > size - ret)
+                chunk = size - ret;
+            if(!chunk)
+                break;
+            if(progmem)
+                memcpy_P(tx_buffer->buffer + tx_buffer->wpos, buf + ret, chunk);
+            else
+                memcpy(tx_buffer->buffer + tx_buffer->wpos, buf + ret, chunk);
+            tx_buffer->wpos = (tx_buffer->wpos + chunk) % tx_buffer->size;
+            ret += chunk;
+        }
+        if(tx_buffer->rpos != tx_buffer->wpos)
+            USIE(uart_nr) |= (1 << UIFE);
+        ETS_UART_INTR_ENABLE();
+
+        if(ret == size || !uart->tx_blocking)
+            return ret;
+        optimistic_yield(10000UL);
+    }
+}
+
+// Wait for the TX ring buffer to be all in the FIFO
+static void
+uart_tx_buffer_drain(uart_t* uart)
+{
+    struct uart_tx_buffer_ *tx_buffer = uart->tx_buffer;
+    while(true) {
+        ETS_UART_INTR_DISABLE();
+        uart_tx_copy_buffer_to_fifo_unsafe(uart);
+        bool empty = (tx_buffer->rpos == tx_buffer->wpos);
+        ETS_UART_INTR_ENABLE();
+        if(empty)
+            return;
+        optimistic_yield(10000UL);
+    }
+}
+
 size_t
 uart_write_char(uart_t* uart, char c)
 {
@@ -525,6 +698,8 @@ uart_write_char(uart_t* uart, char c)
         gdbstub_write_char(c);
         return 1;
     }
+    if(uart->tx_buffer)
+        return uart_tx_buffer_write(uart, &c, 1, false);
     uart_do_write_char(uart->uart_nr, c);
     return 1;
 }
@@ -540,6 +715,9 @@ uart_write(uart_t* uart, const char* buf, size_t size)
         return 0;
     }
 
+    if(uart->tx_buffer)
+        return uart_tx_buffer_write(uart, buf, size, true);
+
     size_t ret = size;
     const int uart_nr = uart->uart_nr;
     while (size--) {
@@ -550,6 +728,62 @@ uart_write(uart_t* uart, const char* buf, size_t size)
     return ret;
 }
 
+size_t
+uart_resize_tx_buffer(uart_t* uart, size_t new_size)
+{
+    // GDB owns the UART interrupt
+    if(uart == NULL || !uart->tx_enabled || gdbstub_has_uart_isr_control())
+        return 0;
+
+    if(uart_get_tx_buffer_size(uart) == new_size)
+        return new_size;
+
+    struct uart_tx_buffer_ * tx_buffer = NULL;
+    if(new_size)
+    {
+        tx_buffer = (struct uart_tx_buffer_ *)malloc(sizeof(struct uart_tx_buffer_));
+        uint8_t * buffer = (uint8_t *)malloc(new_size);
+        if(tx_buffer == NULL || buffer == NULL)
+        {
+            free(tx_buffer);
+            free(buffer);
+            return uart_get_tx_buffer_size(uart);
+        }
+        tx_buffer->size = new_size;
+        tx_buffer->rpos = 0;
+        tx_buffer->wpos = 0;
+        tx_buffer->buffer = buffer;
+    }
+
+    // what was queued goes out before
+    if(uart->tx_buffer)
+    {
+        uart_tx_buffer_drain(uart);
+        uart_stop_tx_isr(uart);
+        free(uart->tx_buffer->buffer);
+        free(uart->tx_buffer);
+    }
+    uart->tx_buffer = tx_buffer;
+    if(tx_buffer)
+        uart_start_tx_isr(uart);
+    return new_size;
+}
+
+size_t
+uart_get_tx_buffer_size(uart_t* uart)
+{
+    return uart && uart->tx_buffer? uart->tx_buffer->size: 0;
+}
+
+void
+uart_set_tx_blocking(uart_t* uart, bool blocking)
+{
+    if(uart == NULL)
+        return;
+
+    uart->tx_blocking = blocking;
+}
+
 
 size_t
 uart_tx_free(uart_t* uart)
@@ -557,7 +791,17 @@ uart_tx_free(uart_t* uart)
     if(uart == NULL || !uart->tx_enabled)
         return 0;
 
-    return UART_TX_FIFO_SIZE - uart_tx_fifo_available(uart->uart_nr);
+    size_t ret = UART_TX_FIFO_SIZE - uart_tx_fifo_available(uart->uart_nr);
+    if(uart->tx_buffer)
+    {
+        // writes first move what they can of the ring buffer to the FIFO,
+        // which they fill up to 0x7f bytes
+        ret = ret > 1? ret - 1: 0;
+        ETS_UART_INTR_DISABLE();
+        ret += uart->tx_buffer->size - 1 - uart_tx_buffer_available_unsafe(uart->tx_buffer);
+        ETS_UART_INTR_ENABLE();
+    }
+    return ret;
 }
 
 void
@@ -566,6 +810,9 @@ uart_wait_tx_empty(uart_t* uart)
     if(uart == NULL || !uart->tx_enabled)
         return;
 
+    if(uart->tx_buffer)
+        uart_tx_buffer_drain(uart);
+
     while(uart_tx_fifo_available(uart->uart_nr) > 0)
         esp_yield();
 
@@ -588,7 +835,16 @@ uart_flush(uart_t* uart)
     }
 
     if(uart->tx_enabled)
+    {
         tmp |= (1 << UCTXRST);
+        if(uart->tx_buffer)
+        {
+            ETS_UART_INTR_DISABLE();
+            uart->tx_buffer->rpos = 0;
+            uart->tx_buffer->wpos = 0;
+            ETS_UART_INTR_ENABLE();
+        }
+    }
 
     if(!gdbstub_has_uart_isr_control() || uart->uart_nr != UART0) {
         USC0(uart->uart_nr) |= (tmp);
@@ -625,13 +881,17 @@ uart_init(int uart_nr, int baudrate, int config, int mode, int tx_pin, size_t rx
     uart->uart_nr = uart_nr;
     uart->rx_overrun = false;
     uart->rx_error = false;
+    uart->tx_blocking = true;
+    uart->tx_buffer = NULL;
 
     switch(uart->uart_nr)
     {
     case UART0:
         ETS_UART_INTR_DISABLE();
         if(!gdbstub_has_uart_isr_control()) {
-            ETS_UART_INTR_ATTACH(NULL, NULL);
+            // a TX ring buffer of UART1 keeps using the handler
+            s_uart_rx_isr = NULL;
+            ETS_UART_INTR_ATTACH(s_uart_tx_ring[UART1]? uart_isr: NULL, NULL);
         }
         uart->rx_enabled = (mode != UART_TX_ONLY);
         uart->tx_enabled = (mode != UART_RX_ONLY);
@@ -712,7 +972,7 @@ uart_init(int uart_nr, int baudrate, int config, int mode, int tx_pin, size_t rx
         if(uart->rx_enabled) {
             uart_start_isr(uart);
         }
-        if(gdbstub_has_uart_isr_control()) {
+        if(gdbstub_has_uart_isr_control() || s_uart_tx_ring[UART1]) {
             ETS_UART_INTR_ENABLE(); // Undo the disable in the switch() above
         }
     }
@@ -726,6 +986,13 @@ uart_uninit(uart_t* uart)
     if(uart == NULL)
         return;
 
+    if(uart->tx_buffer) {
+        uart_tx_buffer_drain(uart);
+        uart_stop_tx_isr(uart);
+        free(uart->tx_buffer->buffer);
+        free(uart->tx_buffer);
+    }
+
     uart_stop_isr(uart);
 
     if(uart->tx_enabled && (!gdbstub_has_uart_isr_control() || uart->uart_nr != UART0)) {
@@ -944,9 +1211,24 @@ uart_ignore_char(char c)
     (void) c;
 }
 
+// os_printf() and ets_putc() output.  What the TX ring buffer holds was
+// written before: it goes to the FIFO first, with the interrupt off as in
+// uart_tx_buffer_write().
 inline __attribute__((always_inline)) void
 uart_write_char_delay(const int uart_nr, char c)
 {
+    uart_t* uart = s_uart_tx_ring[uart_nr];
+    if(uart) {
+        ETS_UART_INTR_DISABLE();
+        while(true) {
+            uart_tx_copy_buffer_to_fifo_unsafe(uart);
+            if(uart->tx_buffer->rpos == uart->tx_buffer->wpos)
+                break;
+            while(uart_tx_fifo_full(uart_nr));
+        }
+        ETS_UART_INTR_ENABLE();
+    }
+
     while(uart_tx_fifo_full(uart_nr))
         esp_yield();
 
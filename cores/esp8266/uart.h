@@ -127,6 +127,13 @@ int uart_get_baudrate(uart_t* uart);
 
 size_t uart_resize_rx_buffer(uart_t* uart, size_t new_size);
 size_t uart_get_rx_buffer_size(uart_t* uart);
+// Optional TX ring buffer, drained by the TX FIFO empty interrupt, so that
+// writes return once queued (0 removes it, also not available under GDB).
+// When it is full, writes wait for room, or return what was queued when
+// blocking was disabled.
+size_t uart_resize_tx_buffer(uart_t* uart, size_t new_size);
+size_t uart_get_tx_buffer_size(uart_t* uart);
+void uart_set_tx_blocking(uart_t* uart, bool blocking);
 
 size_t uart_write_char(uart_t* uart, char c);
 size_t uart_write(uart_t* uart, const char* buf, size_t size);
@@ -45,7 +45,7 @@ void *umm_info(void *ptr, bool force) {
 
     DBGLOG_FORCE(force, "\n");
     DBGLOG_FORCE(force, "+----------+-------+--------+--------+-------+--------+--------+\n");
-    DBGLOG_FORCE(force, "|0x%08lx|B %5d|NB %5d|PB %5d|Z %5d|NF %5d|PF %5d|\n",
+    DBGLOG_FORCE(force, "|0x%08x|B %5d|NB %5d|PB %5d|Z %5d|NF %5d|PF %5d|\n",
         DBGLOG_32_BIT_PTR(&UMM_BLOCK(blockNo)),
         blockNo,
         UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK,
@@ -79,7 +79,7 @@ void *umm_info(void *ptr, bool force) {
                 _context->info.maxFreeContiguousBlocks = curBlocks;
             }
 
-            DBGLOG_FORCE(force, "|0x%08lx|B %5d|NB %5d|PB %5d|Z %5u|NF %5d|PF %5d|\n",
+            DBGLOG_FORCE(force, "|0x%08x|B %5d|NB %5d|PB %5d|Z %5u|NF %5d|PF %5d|\n",
                 DBGLOG_32_BIT_PTR(&UMM_BLOCK(blockNo)),
                 blockNo,
                 UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK,
@@ -101,7 +101,7 @@ void *umm_info(void *ptr, bool force) {
             ++_context->info.usedEntries;
             _context->info.usedBlocks += curBlocks;
 
-            DBGLOG_FORCE(force, "|0x%08lx|B %5d|NB %5d|PB %5d|Z %5u|\n",
+            DBGLOG_FORCE(force, "|0x%08x|B %5d|NB %5d|PB %5d|Z %5u|\n",
                 DBGLOG_32_BIT_PTR(&UMM_BLOCK(blockNo)),
                 blockNo,
                 UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK,
@@ -119,7 +119,7 @@ void *umm_info(void *ptr, bool force) {
      * ALWAYS be exactly 1 !
      */
 
-    DBGLOG_FORCE(force, "|0x%08lx|B %5d|NB %5d|PB %5d|Z %5d|NF %5d|PF %5d|\n",
+    DBGLOG_FORCE(force, "|0x%08x|B %5d|NB %5d|PB %5d|Z %5d|NF %5d|PF %5d|\n",
         DBGLOG_32_BIT_PTR(&UMM_BLOCK(blockNo)),
         blockNo,
         UMM_NBLOCK(blockNo) & UMM_BLOCKNO_MASK,
@@ -152,9 +152,9 @@ void *umm_info(void *ptr, bool force) {
     if (_context->info.freeBlocks == _context->stats.free_blocks) {
         DBGLOG_FORCE(force, "heap info Free blocks and heap statistics Free blocks match.\n");
     } else {
-        DBGLOG_FORCE(force, "\nheap info Free blocks  %5d != heap statistics Free Blocks  %5d\n\n",
-            _context->info.freeBlocks,
-            _context->stats.free_blocks);
+        DBGLOG_FORCE(force, "\nheap info Free blocks  %5u != heap statistics Free Blocks  %5u\n\n",
+            (unsigned int)_context->info.freeBlocks,
+            (unsigned int)_context->stats.free_blocks);
     }
     DBGLOG_FORCE(force, "+--------------------------------------------------------------+\n");
     #endif
@@ -162,6 +162,10 @@ void *umm_info(void *ptr, bool force) {
     umm_print_stats(force);
     #endif
 
+    #ifdef UMM_SLAB
+    umm_print_slab_stats(_context, force);
+    #endif
+
     /* Release the critical section... */
     UMM_CRITICAL_EXIT(id_info);
 
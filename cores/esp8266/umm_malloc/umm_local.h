@@ -61,9 +61,27 @@ int ICACHE_FLASH_ATTR umm_info_safe_printf_P(const char *fmt, ...) __attribute__
 
 typedef struct umm_block_t umm_block;
 
+#ifdef UMM_SLAB
+static constexpr uint16_t umm_slab_size[] = { UMM_SLAB_SIZES };
+#define UMM_SLAB_NUM_CLASSES (sizeof(umm_slab_size) / sizeof(umm_slab_size[0]))
+
+typedef struct UMM_SLAB_CLASS_t {
+    void *free;          // singly linked list of free slots
+    char *end;           // end of the slots of this class
+    UMM_SLAB_STATS stats;
+} UMM_SLAB_CLASS;
+
+static void ICACHE_FLASH_ATTR umm_print_slab_stats(umm_heap_context_t *_context, int force);
+#endif
+
 struct UMM_HEAP_CONTEXT {
     umm_block *heap;
     void *heap_end;
+    #ifdef UMM_SLAB
+    char *slab_start;
+    char *slab_end;
+    UMM_SLAB_CLASS slab[UMM_SLAB_NUM_CLASSES];
+    #endif
     #if (!defined(UMM_INLINE_METRICS) && defined(UMM_STATS)) || defined(UMM_STATS_FULL)
     UMM_STATISTICS stats;
     #endif
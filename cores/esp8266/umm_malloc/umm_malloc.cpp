@@ -467,6 +467,10 @@ static uint16_t umm_assimilate_down(umm_heap_context_t *_context, uint16_t c, ui
 // Freeup IRAM
 #define ICACHE_MAYBE ICACHE_FLASH_ATTR
 #endif
+static void *umm_malloc_core(umm_heap_context_t *_context, size_t size);
+
+#include "umm_slab.c"       // pools of fixed size slots, needs ICACHE_MAYBE
+
 /*
  * In this port, we split the upstream version of umm_init_heap() into two
  * parts: _umm_init_heap and umm_init_heap. Then add multiple heap support.
@@ -545,6 +549,10 @@ void ICACHE_MAYBE umm_init_heap(size_t id, void *start_addr, size_t size, bool f
 
         /* Set up internal data structures */
         _umm_init_heap(_context);
+
+        #ifdef UMM_SLAB
+        umm_slab_init(_context);
+        #endif
     }
 }
 
@@ -682,8 +690,13 @@ void umm_free(void *ptr) {
 
     UMM_CRITICAL_ENTRY(id_free);
 
-    /* Need to be in the heap in which this block lives */
-    umm_free_core(umm_get_ptr_context(ptr), ptr);
+    #ifdef UMM_SLAB
+    if (!umm_slab_free_core(ptr))
+    #endif
+    {
+        /* Need to be in the heap in which this block lives */
+        umm_free_core(umm_get_ptr_context(ptr), ptr);
+    }
 
     UMM_CRITICAL_EXIT(id_free);
 }
@@ -907,9 +920,15 @@ void *umm_malloc(size_t size) {
         _context = umm_get_heap_by_id(UMM_HEAP_DRAM);
     }
 
-    ptr = umm_malloc_core(_context, size);
+    #ifdef UMM_SLAB
+    ptr = umm_slab_malloc_core(_context, size);
+    if (NULL == ptr)
+    #endif
+    {
+        ptr = umm_malloc_core(_context, size);
 
-    ptr = POISON_CHECK_SET_POISON(ptr, size);
+        ptr = POISON_CHECK_SET_POISON(ptr, size);
+    }
 
     UMM_CRITICAL_EXIT(id_malloc);
 
@@ -946,6 +965,28 @@ void *umm_realloc(void *ptr, size_t size) {
         return umm_malloc(size);
     }
 
+    #ifdef UMM_SLAB
+    /*
+     * Pool slots cannot grow: keep the slot while the new size fits in it,
+     * otherwise move the content to a new allocation.
+     */
+    size_t slotSize = umm_slab_usable_size(ptr);
+    if (slotSize) {
+        void *newptr = NULL;
+        if (size > slotSize) {
+            newptr = umm_malloc(size);
+            if (NULL == newptr) {
+                return NULL;
+            }
+            memcpy(newptr, ptr, slotSize);
+        } else if (size) {
+            return ptr;
+        }
+        umm_free(ptr);
+        return newptr;
+    }
+    #endif
+
     /*
      * Now we're sure that we have a non_NULL ptr, but we're not sure what
      * we should do with it. If the size is 0, then the ANSI C standard says that
@@ -670,6 +670,67 @@ void  umm_poison_free_fl(void *ptr, const char *file, int line);
 #endif
 
 
+/*
+ * -D UMM_SLAB
+ *
+ * Serves small requests from pools of fixed size slots, one pool per size
+ * class, placed in front of each heap. The pools are carved out of the heap
+ * once at init, so the steady traffic of same sized small blocks (pbufs,
+ * String buffers, std::function captures) no longer splits and scatters the
+ * free space that large allocations, like TLS buffers, need later on.
+ *
+ * A request goes to the smallest class it fits in; when that class has no
+ * free slot, or the request is larger than all classes, umm_malloc handles
+ * it as usual. Memory held by the pools is not reported as free Heap.
+ *
+ *    UMM_SLAB_SIZES
+ *      Slot sizes in bytes, ascending multiples of 4, e.g. `16, 32, 64`
+ *    UMM_SLAB_DRAM_COUNTS
+ *      Slots per class in the DRAM Heap
+ *    UMM_SLAB_IRAM_COUNTS
+ *      Slots per class in the IRAM Heap, if any
+ *
+ * Per class statistics of the current Heap are available from
+ * umm_slab_get_stats() and printed by umm_info().
+ *
+ * Not available with UMM_POISON_CHECK or UMM_POISON_CHECK_LITE, as pool slots
+ * have no room for poison.
+ */
+/*
+#define UMM_SLAB
+ */
+
+#if defined(UMM_SLAB) && (defined(UMM_POISON_CHECK) || defined(UMM_POISON_CHECK_LITE))
+#undef UMM_SLAB
+#endif
+
+#ifdef UMM_SLAB
+#ifndef UMM_SLAB_SIZES
+#define UMM_SLAB_SIZES       16, 32, 64
+#endif
+#ifndef UMM_SLAB_DRAM_COUNTS
+#define UMM_SLAB_DRAM_COUNTS 32, 32, 16
+#endif
+#ifndef UMM_SLAB_IRAM_COUNTS
+#define UMM_SLAB_IRAM_COUNTS 16, 16, 8
+#endif
+
+typedef struct UMM_SLAB_STATS_t {
+    uint16_t size;       // bytes per slot
+    uint16_t count;      // slots
+    uint16_t used;       // slots in use
+    uint16_t used_max;   // high watermark
+    uint32_t allocs;     // requests served by the class
+    uint32_t fallbacks;  // requests for the class passed on to umm_malloc
+}
+UMM_SLAB_STATS;
+
+extern ICACHE_FLASH_ATTR size_t umm_slab_classes(void);
+extern ICACHE_FLASH_ATTR bool umm_slab_get_stats(size_t which, UMM_SLAB_STATS *stats);
+extern ICACHE_FLASH_ATTR void umm_slab_reset_stats(void);
+#endif
+
+
 /////////////////////////////////////////////////
 #undef DBGLOG_FUNCTION
 #undef DBGLOG_FUNCTION_P
@@ -53,7 +53,7 @@
  */
 extern char _heap_start[];
 #define UMM_HEAP_END_ADDR          0x3FFFC000UL
-#define UMM_MALLOC_CFG_HEAP_ADDR   ((uint32_t)&_heap_start[0])
+#define UMM_MALLOC_CFG_HEAP_ADDR   ((uintptr_t)&_heap_start[0])
 #define UMM_MALLOC_CFG_HEAP_SIZE   ((size_t)(UMM_HEAP_END_ADDR - UMM_MALLOC_CFG_HEAP_ADDR))
 
 /*
@@ -0,0 +1,185 @@
+/*
+ * Local Additions/Enhancements
+ *
+ * Pools of fixed size slots in front of each Heap, see UMM_SLAB in
+ * umm_malloc_cfg.h. Like the other supplemental files, this one is included
+ * by umm_malloc.cpp so that the hot paths stay in IRAM with the allocator.
+ */
+#ifdef BUILD_UMM_MALLOC_C
+
+#ifdef UMM_SLAB
+
+static const uint16_t umm_slab_dram_count[] = { UMM_SLAB_DRAM_COUNTS };
+static_assert(sizeof(umm_slab_dram_count) == sizeof(umm_slab_size),
+    "UMM_SLAB_DRAM_COUNTS needs one count per UMM_SLAB_SIZES entry");
+#ifdef UMM_HEAP_IRAM
+static const uint16_t umm_slab_iram_count[] = { UMM_SLAB_IRAM_COUNTS };
+static_assert(sizeof(umm_slab_iram_count) == sizeof(umm_slab_size),
+    "UMM_SLAB_IRAM_COUNTS needs one count per UMM_SLAB_SIZES entry");
+#endif
+
+static constexpr bool umm_slab_sizes_valid(size_t i = 0) {
+    return i == UMM_SLAB_NUM_CLASSES ||
+           (umm_slab_size[i] >= sizeof(void *) && umm_slab_size[i] % 4 == 0 &&
+            (i == 0 || umm_slab_size[i] > umm_slab_size[i - 1]) &&
+            umm_slab_sizes_valid(i + 1));
+}
+static_assert(umm_slab_sizes_valid(), "UMM_SLAB_SIZES must be ascending multiples of 4");
+
+/* ------------------------------------------------------------------------
+ * Carves the pools out of a freshly initialized Heap.
+ */
+static void ICACHE_MAYBE umm_slab_init(umm_heap_context_t *_context) {
+    const uint16_t *count = NULL;
+    if (UMM_HEAP_DRAM == _context->id) {
+        count = umm_slab_dram_count;
+    }
+    #ifdef UMM_HEAP_IRAM
+    else if (UMM_HEAP_IRAM == _context->id) {
+        count = umm_slab_iram_count;
+    }
+    #endif
+    if (NULL == count) {
+        return;
+    }
+
+    size_t total = 0;
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+        total += (size_t)umm_slab_size[i] * count[i];
+    }
+    char *slot = (0 == total) ? NULL : (char *)umm_malloc_core(_context, total);
+    if (NULL == slot) {
+        return;
+    }
+
+    _context->slab_start = slot;
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+        UMM_SLAB_CLASS *cls = &_context->slab[i];
+        cls->stats.size = umm_slab_size[i];
+        cls->stats.count = count[i];
+        cls->free = NULL;
+        // Link slots in address order. 32-bit stores only, IRAM friendly.
+        for (size_t n = count[i]; n > 0; n--) {
+            void **link = (void **)(slot + (n - 1) * umm_slab_size[i]);
+            *link = cls->free;
+            cls->free = link;
+        }
+        slot += (size_t)umm_slab_size[i] * count[i];
+        cls->end = slot;
+    }
+    _context->slab_end = slot;
+}
+
+/* ------------------------------------------------------------------------
+ * Must be called only from within critical sections. Returns NULL when the
+ * request is to be served by umm_malloc_core().
+ */
+static void *umm_slab_malloc_core(umm_heap_context_t *_context, size_t size) {
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+        UMM_SLAB_CLASS *cls = &_context->slab[i];
+        if (size > cls->stats.size) {
+            continue;
+        }
+
+        void **slot = (void **)cls->free;
+        if (NULL == slot) {
+            cls->stats.fallbacks += 1;
+            return NULL;
+        }
+        cls->free = *slot;
+        cls->stats.allocs += 1;
+        cls->stats.used += 1;
+        if (cls->stats.used > cls->stats.used_max) {
+            cls->stats.used_max = cls->stats.used;
+        }
+        return slot;
+    }
+    return NULL;
+}
+
+/* ------------------------------------------------------------------------
+ * Slot size of a pool allocation, or 0 when ptr does not belong to a pool.
+ * The pools do not move after init, no critical section needed.
+ */
+static size_t umm_slab_usable_size(const void *ptr) {
+    for (size_t id = 0; id < UMM_NUM_HEAPS; id++) {
+        umm_heap_context_t *_context = &heap_context[id];
+        if ((const char *)ptr >= _context->slab_start && (const char *)ptr < _context->slab_end) {
+            for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+                if ((const char *)ptr < _context->slab[i].end) {
+                    return _context->slab[i].stats.size;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* ------------------------------------------------------------------------
+ * Must be called only from within critical sections. Returns false when
+ * ptr is to be released by umm_free_core().
+ */
+static bool umm_slab_free_core(void *ptr) {
+    for (size_t id = 0; id < UMM_NUM_HEAPS; id++) {
+        umm_heap_context_t *_context = &heap_context[id];
+        if ((char *)ptr < _context->slab_start || (char *)ptr >= _context->slab_end) {
+            continue;
+        }
+        for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+            UMM_SLAB_CLASS *cls = &_context->slab[i];
+            if ((char *)ptr < cls->end) {
+                *(void **)ptr = cls->free;
+                cls->free = ptr;
+                cls->stats.used -= 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* ------------------------------------------------------------------------ */
+
+size_t ICACHE_FLASH_ATTR umm_slab_classes(void) {
+    return UMM_SLAB_NUM_CLASSES;
+}
+
+bool ICACHE_FLASH_ATTR umm_slab_get_stats(size_t which, UMM_SLAB_STATS *stats) {
+    if (which >= UMM_SLAB_NUM_CLASSES || NULL == stats) {
+        return false;
+    }
+    UMM_CRITICAL_DECL(id_no_tag);
+    UMM_CRITICAL_ENTRY(id_no_tag);
+    *stats = umm_get_current_heap()->slab[which].stats;
+    UMM_CRITICAL_EXIT(id_no_tag);
+    return true;
+}
+
+void ICACHE_FLASH_ATTR umm_slab_reset_stats(void) {
+    UMM_CRITICAL_DECL(id_no_tag);
+    UMM_CRITICAL_ENTRY(id_no_tag);
+    umm_heap_context_t *_context = umm_get_current_heap();
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+        UMM_SLAB_STATS *stats = &_context->slab[i].stats;
+        stats->used_max = stats->used;
+        stats->allocs = 0;
+        stats->fallbacks = 0;
+    }
+    UMM_CRITICAL_EXIT(id_no_tag);
+}
+
+static void ICACHE_FLASH_ATTR umm_print_slab_stats(umm_heap_context_t *_context, int force) {
+    DBGLOG_FORCE(force, "umm slab statistics:\n");
+    DBGLOG_FORCE(force, "|  Size| Count|  Used|   Max|    Allocs| Fallbacks|\n");
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++) {
+        const UMM_SLAB_STATS *stats = &_context->slab[i].stats;
+        DBGLOG_FORCE(force, "|%6u|%6u|%6u|%6u|%10u|%10u|\n",
+            stats->size, stats->count, stats->used, stats->used_max,
+            stats->allocs, stats->fallbacks);
+    }
+    DBGLOG_FORCE(force, "+--------------------------------------------------------------+\n");
+}
+
+#endif // UMM_SLAB
+
+#endif  // BUILD_UMM_MALLOC_C
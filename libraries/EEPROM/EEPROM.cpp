@@ -38,6 +38,12 @@ EEPROMClass::EEPROMClass(uint32_t sector)
 {
 }
 
+EEPROMClass::EEPROMClass(uint32_t sector, uint32_t sectors)
+: _sector(sector)
+, _journal(sector, sectors)
+{
+}
+
 EEPROMClass::EEPROMClass(void)
 : _sector(((EEPROM_start - 0x40200000) / SPI_FLASH_SEC_SIZE))
 {
@@ -52,6 +58,14 @@ void EEPROMClass::begin(size_t size) {
     DEBUGV("EEPROMClass::begin error, %d > %d\n", size, SPI_FLASH_SEC_SIZE);
     size = SPI_FLASH_SEC_SIZE;
   }
+  if (_journal.sectors() && size > EEPROMJournal::maxSize()) {
+    DEBUGV("EEPROMClass::begin error, %d > %d with a journal\n", size, EEPROMJournal::maxSize());
+    delete[] _data;
+    _data = nullptr;
+    _size = 0;
+    _dirty = false;
+    return;
+  }
 
   size = (size + 3) & (~3);
 
@@ -65,8 +79,14 @@ void EEPROMClass::begin(size_t size) {
 
   _size = size;
 
-  if (!ESP.flashRead(_sector * SPI_FLASH_SEC_SIZE, reinterpret_cast<uint32_t*>(_data), _size)) {
-    DEBUGV("EEPROMClass::begin flash read failed\n");
+  if (_journal.sectors()) {
+    memset(_data, 0xff, _size);
+  }
+  // without a journal yet, the first sector may hold plain EEPROM contents
+  if (!_journal.sectors() || !_journal.load(_data, _size)) {
+    if (!ESP.flashRead(_sector * SPI_FLASH_SEC_SIZE, reinterpret_cast<uint32_t*>(_data), _size)) {
+      DEBUGV("EEPROMClass::begin flash read failed\n");
+    }
   }
 
   _dirty = false; //make sure dirty is cleared in case begin() is called 2nd+ time
@@ -119,7 +139,7 @@ void EEPROMClass::write(int const address, uint8_t const value) {
   if (*pData != value)
   {
     *pData = value;
-    _dirty = true;
+    _setDirty(address, 1);
   }
 }
 
@@ -131,7 +151,12 @@ bool EEPROMClass::commit() {
   if(!_data)
     return false;
 
-  if (ESP.flashEraseSector(_sector)) {
+  if (_journal.sectors()) {
+    if (_journal.append(_data, _size, _dirtyStart, _dirtyEnd - _dirtyStart)) {
+      _dirty = false;
+      return true;
+    }
+  } else if (ESP.flashEraseSector(_sector)) {
     if (ESP.flashWrite(_sector * SPI_FLASH_SEC_SIZE, reinterpret_cast<uint32_t*>(_data), _size)) {
       _dirty = false;
       return true;
@@ -143,7 +168,7 @@ bool EEPROMClass::commit() {
 }
 
 uint8_t * EEPROMClass::getDataPtr() {
-  _dirty = true;
+  _setDirty(0, _size);
   return &_data[0];
 }
 
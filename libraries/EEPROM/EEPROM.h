@@ -26,9 +26,15 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "EEPROMJournal.h"
+
 class EEPROMClass {
 public:
   EEPROMClass(uint32_t sector);
+  // Journal of changes in the given number of sectors starting at sector,
+  // see EEPROMJournal.h. Commits then write the changed bytes only.
+  // begin() fails, leaving length() 0, above EEPROMJournal::maxSize().
+  EEPROMClass(uint32_t sector, uint32_t sectors);
   EEPROMClass(void);
 
   void begin(size_t size);
@@ -54,7 +60,7 @@ public:
     if (address < 0 || address + sizeof(T) > _size)
       return t;
     if (memcmp(_data + address, (const uint8_t*)&t, sizeof(T)) != 0) {
-      _dirty = true;
+      _setDirty(address, sizeof(T));
       memcpy(_data + address, (const uint8_t*)&t, sizeof(T));
     }
 
@@ -67,10 +73,22 @@ public:
   uint8_t const & operator[](int const address) const {return getConstDataPtr()[address];}
 
 protected:
+  void _setDirty(size_t address, size_t length) {
+    if (!_dirty || address < _dirtyStart)
+      _dirtyStart = address;
+    if (!_dirty || address + length > _dirtyEnd)
+      _dirtyEnd = address + length;
+    _dirty = true;
+  }
+
   uint32_t _sector;
   uint8_t* _data = nullptr;
   size_t _size = 0;
   bool _dirty = false;
+  // changed since the last commit
+  size_t _dirtyStart = 0;
+  size_t _dirtyEnd = 0;
+  EEPROMJournal _journal{0, 0};
 };
 
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EEPROM)
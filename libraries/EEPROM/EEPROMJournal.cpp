@@ -0,0 +1,191 @@
+/*
+  EEPROMJournal.cpp - append-only journal of EEPROM changes in a ring of
+  flash sectors
+
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "Arduino.h"
+#include "EEPROMJournal.h"
+#include "coredecls.h"
+#include "debug.h"
+
+#include <algorithm>
+#include <flash_hal.h>
+#include <spi_flash_geometry.h>
+
+static uint32_t recordSize(size_t length) {
+  return sizeof(uint32_t) * 2 + ((length + 3) & ~3);
+}
+
+static uint32_t recordCrc(uint16_t offset, uint16_t length) {
+  uint16_t range[2] = { offset, length };
+  return crc32(range, sizeof(range));
+}
+
+uint32_t EEPROMJournal::_address(uint32_t index, uint32_t pos) const {
+  return (_sector + index) * FLASH_SECTOR_SIZE + pos;
+}
+
+size_t EEPROMJournal::maxSize() {
+  return FLASH_SECTOR_SIZE - sizeof(SectorHeader) - recordSize(0);
+}
+
+bool EEPROMJournal::load(uint8_t* image, size_t size) {
+  _full = true;
+  _sequence = 0;
+
+  // newest first, falling back to older sectors when a snapshot is damaged
+  uint32_t below = UINT32_MAX;
+  while (true) {
+    SectorHeader header;
+    uint32_t newest = 0;
+    bool found = false;
+    for (uint32_t i = 0; i < _sectors; i++) {
+      if (flash_hal_read(_address(i, 0), sizeof(header), reinterpret_cast<uint8_t*>(&header)) != FLASH_HAL_OK) {
+        return false;
+      }
+      if (header.magic == _magic && header.sequence < below && (!found || header.sequence > _sequence)) {
+        found = true;
+        newest = i;
+        _sequence = header.sequence;
+      }
+    }
+    if (!found) {
+      _sequence = 0;
+      return false;
+    }
+    if (_replay(newest, image, size)) {
+      _current = newest;
+      return true;
+    }
+    below = _sequence;
+  }
+}
+
+bool EEPROMJournal::_replay(uint32_t index, uint8_t* image, size_t size) {
+  uint8_t buf[64];
+  uint32_t pos = sizeof(SectorHeader);
+  bool first = true;
+
+  while (pos + sizeof(RecordHeader) <= FLASH_SECTOR_SIZE) {
+    RecordHeader record;
+    if (flash_hal_read(_address(index, pos), sizeof(record), reinterpret_cast<uint8_t*>(&record)) != FLASH_HAL_OK) {
+      return false;
+    }
+    if (record.offset == 0xffff && record.length == 0xffff && record.crc == 0xffffffff) {
+      break;
+    }
+
+    // checksum before touching the image, the last record may be torn
+    bool valid = pos + recordSize(record.length) <= FLASH_SECTOR_SIZE;
+    uint32_t crc = recordCrc(record.offset, record.length);
+    for (uint32_t done = 0; valid && done < record.length; done += sizeof(buf)) {
+      uint32_t len = std::min<uint32_t>(sizeof(buf), record.length - done);
+      valid = flash_hal_read(_address(index, pos + sizeof(record) + done), len, buf) == FLASH_HAL_OK;
+      crc = crc32(buf, len, crc);
+    }
+    if (!valid || crc != record.crc || (first && record.offset != 0)) {
+      if (first) {
+        DEBUGV("EEPROMJournal: no snapshot in sector %u\n", _sector + index);
+        return false;
+      }
+      DEBUGV("EEPROMJournal: dropped damaged record at %u\n", pos);
+      _pos = pos;
+      return true;
+    }
+
+    if (record.offset < size) {
+      size_t len = std::min<size_t>(record.length, size - record.offset);
+      if (flash_hal_read(_address(index, pos + sizeof(record)), len, image + record.offset) != FLASH_HAL_OK) {
+        return false;
+      }
+    }
+    pos += recordSize(record.length);
+    first = false;
+  }
+  if (first) {
+    return false;
+  }
+
+  // appends need erased flash, a torn record may have left programmed bits
+  _pos = pos;
+  for (uint32_t check = pos; check < FLASH_SECTOR_SIZE; check += sizeof(buf)) {
+    uint32_t len = std::min<uint32_t>(sizeof(buf), FLASH_SECTOR_SIZE - check);
+    if (flash_hal_read(_address(index, check), len, buf) != FLASH_HAL_OK) {
+      return true;
+    }
+    for (uint32_t i = 0; i < len; i++) {
+      if (buf[i] != 0xff) {
+        return true;
+      }
+    }
+  }
+  _full = false;
+  return true;
+}
+
+bool EEPROMJournal::append(const uint8_t* image, size_t size, size_t offset, size_t length) {
+  if (offset + length > size || size > maxSize()) {
+    return false;
+  }
+  if (!length) {
+    return true;
+  }
+  if (_full || _pos + recordSize(length) > FLASH_SECTOR_SIZE) {
+    return _startSector(image, size);
+  }
+  return _writeRecord(image, offset, length);
+}
+
+bool EEPROMJournal::_writeRecord(const uint8_t* image, size_t offset, size_t length) {
+  RecordHeader record;
+  record.offset = offset;
+  record.length = length;
+  record.crc = crc32(image + offset, length, recordCrc(record.offset, record.length));
+
+  // the header goes last and makes the record valid
+  uint32_t pos = _pos;
+  _pos += recordSize(length);
+  if (flash_hal_write(_address(_current, pos + sizeof(record)), length, image + offset) != FLASH_HAL_OK ||
+      flash_hal_write(_address(_current, pos), sizeof(record), reinterpret_cast<const uint8_t*>(&record)) != FLASH_HAL_OK) {
+    _full = true;
+    return false;
+  }
+  return true;
+}
+
+bool EEPROMJournal::_startSector(const uint8_t* image, size_t size) {
+  // the current sector stays valid until the new one has its snapshot
+  uint32_t next = _sequence ? (_current + 1) % _sectors : 0;
+  _full = true;
+  if (flash_hal_erase(_address(next, 0), FLASH_SECTOR_SIZE) != FLASH_HAL_OK) {
+    return false;
+  }
+  _current = next;
+  _pos = sizeof(SectorHeader);
+  if (!_writeRecord(image, 0, size)) {
+    return false;
+  }
+  SectorHeader header = { _magic, _sequence + 1 };
+  if (flash_hal_write(_address(_current, 0), sizeof(header), reinterpret_cast<const uint8_t*>(&header)) != FLASH_HAL_OK) {
+    return false;
+  }
+  _sequence++;
+  _full = false;
+  return true;
+}
@@ -0,0 +1,78 @@
+/*
+  EEPROMJournal.h - append-only journal of EEPROM changes in a ring of
+  flash sectors
+
+  This file is part of the esp8266 core for Arduino environment.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef EEPROMJournal_h
+#define EEPROMJournal_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Every sector starts with a header and a snapshot of the whole image,
+// followed by records of the byte ranges changed by each commit. When a
+// record does not fit anymore, the next sector of the ring is erased and
+// starts over with a new snapshot: one erase per sector worth of commits
+// instead of one per commit, spread over all sectors.
+//
+// Records are checksummed, a commit interrupted by a power loss is
+// dropped at the next load. With a single sector, a power loss while it
+// is being rewritten loses the contents, as with plain EEPROM.
+class EEPROMJournal {
+public:
+  EEPROMJournal(uint32_t sector, uint32_t sectors) : _sector(sector), _sectors(sectors) { }
+
+  // Rebuilds image from the newest valid sector. False when there is
+  // none, image is left untouched then.
+  bool load(uint8_t* image, size_t size);
+  // Saves image[offset, offset + length), or all of image when a new
+  // sector has to be started
+  bool append(const uint8_t* image, size_t size, size_t offset, size_t length);
+
+  uint32_t sectors() const { return _sectors; }
+  // Largest image: a sector holds its header and the snapshot record
+  static size_t maxSize();
+
+protected:
+  struct SectorHeader {
+    uint32_t magic;
+    uint32_t sequence;
+  };
+  struct RecordHeader {
+    uint16_t offset;
+    uint16_t length;
+    uint32_t crc;
+  };
+
+  static constexpr uint32_t _magic = 0x4c4e524a; // "JRNL"
+
+  uint32_t _address(uint32_t index, uint32_t pos) const;
+  bool _replay(uint32_t index, uint8_t* image, size_t size);
+  bool _writeRecord(const uint8_t* image, size_t offset, size_t length);
+  bool _startSector(const uint8_t* image, size_t size);
+
+  uint32_t _sector;
+  uint32_t _sectors;
+  uint32_t _current = 0;   // sector being appended to
+  uint32_t _sequence = 0;  // of the current sector, 0 before the first
+  uint32_t _pos = 0;       // where the next record goes in the current sector
+  bool _full = true;       // the next append starts a new sector
+};
+
+#endif
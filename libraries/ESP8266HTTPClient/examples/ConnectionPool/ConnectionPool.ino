@@ -0,0 +1,76 @@
+/**
+   ConnectionPool.ino
+
+   This example talks to two servers in turn, keeping one idle
+   keep-alive connection per server in a shared pool so that switching
+   between them doesn't reconnect every time
+*/
+
+#include <ESP8266WiFi.h>
+#include <ESP8266WiFiMulti.h>
+#include <ESP8266HTTPClient.h>
+
+#ifndef STASSID
+#define STASSID "your-ssid"
+#define STAPSK "your-password"
+#endif
+
+ESP8266WiFiMulti WiFiMulti;
+
+// up to 4 idle connections, of which 1 TLS, closed after 20s of inactivity
+HTTPConnectionPool pool(4, 1, 20000);
+
+const char* urls[] = {
+  "http://jigsaw.w3.org/HTTP/connection.html",
+  "http://httpbin.org/get",
+};
+
+void setup() {
+
+  Serial.begin(115200);
+  // Serial.setDebugOutput(true);
+
+  Serial.println();
+  Serial.println();
+  Serial.println("Connecting to WiFi...");
+
+  WiFi.mode(WIFI_STA);
+  WiFiMulti.addAP(STASSID, STAPSK);
+
+  // wait for WiFi connection
+  while ((WiFiMulti.run() != WL_CONNECTED)) {
+    Serial.write('.');
+    delay(500);
+  }
+  Serial.println(" connected to WiFi");
+}
+
+int pass = 0;
+
+void loop() {
+  // close connections idle for too long
+  pool.expire();
+
+  if (pass < 10) {
+    const char* url = urls[pass % 2];
+    pass++;
+
+    WiFiClient client;
+    HTTPClient http;
+    http.setConnectionPool(&pool);
+
+    unsigned long start = millis();
+    http.begin(client, url);
+    int httpCode = http.GET();
+    if (httpCode > 0) {
+      Serial.printf("[HTTP] GET %s... code: %d, %lums, %d idle in pool\n", url, httpCode, millis() - start, (int)pool.idle());
+      http.getString();
+    } else {
+      Serial.printf("[HTTP] GET %s... failed, error: %s\n", url, http.errorToString(httpCode).c_str());
+    }
+    // hands a keep-alive connection over to the pool
+    http.end();
+
+    delay(2000);
+  }
+}
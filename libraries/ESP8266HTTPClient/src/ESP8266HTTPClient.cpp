@@ -27,6 +27,7 @@
 #include "ESP8266HTTPClient.h"
 #include <ESP8266WiFi.h>
 #include <StreamDev.h>
+#include <Inflate.h>
 #include <base64.h>
 
 // per https://github.com/esp8266/Arduino/issues/8231
@@ -84,6 +85,10 @@ bool HTTPClient::begin(WiFiClient &client, const String& url) {
         return false;
     }
 
+    // pooled under the previous host and port, before they change
+    if(_pool) {
+        disconnect(false); // keep the previous connection in the pool
+    }
     _port = (protocol == "https" ? 443 : 80);
     _client = client.clone();
 
@@ -102,6 +107,10 @@ bool HTTPClient::begin(WiFiClient &client, const String& url) {
  */
 bool HTTPClient::begin(WiFiClient &client, const String& host, uint16_t port, const String& uri, bool https)
 {
+    if(_pool) {
+        disconnect(false); // keep the previous connection in the pool
+    }
+
     // Disconnect when reusing HTTPClient to talk to a different host
     if (!_host.isEmpty() && _host != host) {
         _canReuse = false;
@@ -215,7 +224,12 @@ void HTTPClient::disconnect(bool preserveClient)
             }
         }
 
-        if(_reuse && _canReuse) {
+        // pooled from end() or begin(): writeToStream() and getString() keep
+        // _client to send the next request with, or reconnect
+        if(_reuse && _canReuse && _pool && !preserveClient) {
+            DEBUG_HTTPCLIENT("[HTTP-Client][end] tcp keep open in pool\n");
+            _pool->checkin(_host, _port, _protocol == "https", std::move(_client), _keepAliveTimeout);
+        } else if(_reuse && _canReuse) {
             DEBUG_HTTPCLIENT("[HTTP-Client][end] tcp keep open for reuse\n");
         } else {
             DEBUG_HTTPCLIENT("[HTTP-Client][end] tcp stop\n");
@@ -257,6 +271,17 @@ void HTTPClient::setReuse(bool reuse)
     _reuse = reuse;
 }
 
+/**
+ * share idle keep-alive connections through a pool: end() hands the
+ * connection over, connecting takes one for the same host, port
+ * and protocol out of it when available
+ * @param pool HTTPConnectionPool* (nullptr to stop using one)
+ */
+void HTTPClient::setConnectionPool(HTTPConnectionPool* pool)
+{
+    _pool = pool;
+}
+
 /**
  * set User Agent
  * @param userAgent const char *
@@ -351,6 +376,20 @@ void HTTPClient::setRedirectLimit(uint16_t limit)
     _redirectLimit = limit;
 }
 
+/**
+ * ask for gzip or deflate compressed responses and decompress them,
+ * the window has to hold what the server compresses with (usually 32KB,
+ * windowBits = 15) unless responses are smaller than the window.
+ * It is allocated for the time of writeToStream() / getString().
+ * getSize() keeps returning the compressed length.
+ * @param decode bool
+ * @param windowBits uint8_t 8..15
+ */
+void HTTPClient::setContentDecoding(bool decode, uint8_t windowBits)
+{
+    _decodeWindowBits = decode ? windowBits : 0;
+}
+
 /**
  * use HTTP1.0
  * @param useHTTP10 bool
@@ -651,6 +690,124 @@ const String& HTTPClient::getString(int reserve)
     return *_payload;
 }
 
+/**
+ * write a chunked and/or compressed body
+ * @param output Print*
+ * @return bytes written ( negative values are error codes )
+ */
+int HTTPClient::writeDecoded(Print * output)
+{
+    int ret;
+
+    std::unique_ptr<Inflate> inflate;
+    Print * sink = output;
+    if(_contentEncoded) {
+        inflate.reset(new (std::nothrow) Inflate);
+        if(!inflate || !inflate->begin(*output, INFLATE_AUTO, _decodeWindowBits)) {
+            return HTTPC_ERROR_TOO_LESS_RAM;
+        }
+        sink = inflate.get();
+    }
+
+    if(_transferEncoding == HTTPC_TE_IDENTITY) {
+        // only compressed identity bodies come here, len < 0: until closed
+        ret = _client->sendSize(inflate.get(), _size);
+
+        // do we have an error?
+        if(_client->getLastSendReport() != Stream::Report::Success) {
+            ret = StreamReportToHttpClientReport(_client->getLastSendReport());
+        }
+    } else if(_transferEncoding == HTTPC_TE_CHUNKED) {
+        ret = writeChunked(sink);
+    } else {
+        return HTTPC_ERROR_ENCODING;
+    }
+
+    if(!inflate) {
+        return ret;
+    }
+    if(inflate->getError() != INFLATE_OK && inflate->getError() != INFLATE_ERR_OUTPUT) {
+        DEBUG_HTTPCLIENT("[HTTP-Client] inflate error: %d\n", inflate->getError());
+        return HTTPC_ERROR_DECODING;
+    }
+    if(ret < 0) {
+        return ret;
+    }
+    // an empty body (HEAD, 204, 304) has nothing to decode
+    if(ret > 0 && !inflate->finished()) {
+        return HTTPC_ERROR_DECODING;
+    }
+    return inflate->inflated();
+}
+
+/**
+ * strip the chunk framing, straight from the receive buffer
+ * when the client has one
+ * @param output Print*
+ * @return chunk data bytes written ( negative values are error codes )
+ */
+int HTTPClient::writeChunked(Print * output)
+{
+    HTTPChunkDecoder chunks;
+    bool peek = _client->hasPeekBufferAPI();
+    uint8_t buf[64];
+    size_t bufLen = 0;
+    size_t bufPos = 0;
+    unsigned long lastDataTime = millis();
+
+    while(!chunks.finished()) {
+        const uint8_t * data;
+        size_t len;
+        if(peek) {
+            data = (const uint8_t *) _client->peekBuffer();
+            len = _client->peekAvailable();
+        } else {
+            if(bufPos == bufLen) {
+                int r = _client->read(buf, std::min(sizeof(buf), chunks.want()));
+                bufLen = r > 0 ? r : 0;
+                bufPos = 0;
+            }
+            data = buf + bufPos;
+            len = bufLen - bufPos;
+        }
+
+        size_t n = len ? chunks.decode(data, len, *output) : 0;
+        if(peek) {
+            _client->peekConsume(n);
+        } else {
+            bufPos += n;
+        }
+
+        if(chunks.failed()) {
+            return chunks.writeFailed() ? HTTPC_ERROR_STREAM_WRITE : HTTPC_ERROR_ENCODING;
+        }
+        if(n) {
+            lastDataTime = millis();
+            continue;
+        }
+        if(!len && !connected()) {
+            return HTTPC_ERROR_CONNECTION_LOST;
+        }
+        if((millis() - lastDataTime) > _tcpTimeout) {
+            return HTTPC_ERROR_READ_TIMEOUT;
+        }
+        esp_yield();
+    }
+
+    DEBUG_HTTPCLIENT("[HTTP-Client] read chunked body: %u\n", chunks.decoded());
+
+    // if no length Header use global chunk size
+    if(_size <= 0) {
+        _size = chunks.decoded();
+    }
+
+    // check if we have write all data out
+    if((int) chunks.decoded() != _size) {
+        return HTTPC_ERROR_STREAM_WRITE;
+    }
+    return chunks.decoded();
+}
+
 /**
  * converts error code to String
  * @param error int
@@ -681,6 +838,8 @@ String HTTPClient::errorToString(int error)
         return F("Stream write error");
     case HTTPC_ERROR_READ_TIMEOUT:
         return F("read Timeout");
+    case HTTPC_ERROR_DECODING:
+        return F("Content-Encoding decoding error");
     default:
         return String();
     }
@@ -789,6 +948,16 @@ bool HTTPClient::connect(void)
         return true;
     }
 
+    if(_pool) {
+        std::unique_ptr<WiFiClient> pooled = _pool->checkout(_host, _port, _protocol == "https");
+        if(pooled) {
+            DEBUG_HTTPCLIENT("[HTTP-Client] connect: reusing pooled connection\n");
+            _client = std::move(pooled);
+            _client->setTimeout(_tcpTimeout);
+            return true;
+        }
+    }
+
     if(!_client) {
         DEBUG_HTTPCLIENT("[HTTP-Client] connect: HTTPClient::begin was not called or returned error\n");
         return false;
@@ -851,7 +1020,9 @@ bool HTTPClient::sendHeader(const char * type)
         header += _userAgent;
     }
 
-    if (!_useHTTP10) {
+    if (_decodeWindowBits) {
+        header += F("\r\nAccept-Encoding: gzip,deflate,identity;q=0.5");
+    } else if (!_useHTTP10) {
         header += F("\r\nAccept-Encoding: identity;q=1,chunked;q=0.1,*;q=0");
     }
 
@@ -887,10 +1058,12 @@ int HTTPClient::handleHeaderResponse()
     clear();
 
     _canReuse = _reuse;
+    _keepAliveTimeout = 0;
 
     String transferEncoding;
 
     _transferEncoding = HTTPC_TE_IDENTITY;
+    _contentEncoded = false;
     unsigned long lastDataTime = millis();
 
     while(connected()) {
@@ -926,10 +1099,24 @@ int HTTPClient::handleHeaderResponse()
                     }
                 }
 
+                if(headerName.equalsIgnoreCase(F("Keep-Alive"))) {
+                    int timeoutIdx = headerValue.indexOf(F("timeout="));
+                    if(timeoutIdx >= 0) {
+                        _keepAliveTimeout = headerValue.substring(timeoutIdx + sizeof "timeout=" - 1).toInt() * 1000;
+                    }
+                }
+
                 if(headerName.equalsIgnoreCase(F("Transfer-Encoding"))) {
                     transferEncoding = headerValue;
                 }
 
+                // anything else was not asked for and is passed through as is
+                if(_decodeWindowBits && headerName.equalsIgnoreCase(F("Content-Encoding"))) {
+                    _contentEncoded = headerValue.equalsIgnoreCase(F("gzip")) ||
+                                      headerValue.equalsIgnoreCase(F("x-gzip")) ||
+                                      headerValue.equalsIgnoreCase(F("deflate"));
+                }
+
                 if(headerName.equalsIgnoreCase(F("Location"))) {
                     _location = headerValue;
                 }
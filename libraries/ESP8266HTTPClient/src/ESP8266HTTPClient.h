@@ -32,6 +32,9 @@
 
 #include <memory>
 
+#include "HTTPChunkDecoder.h"
+#include "HTTPConnectionPool.h"
+
 #ifdef DEBUG_ESP_HTTP_CLIENT
 #ifdef DEBUG_ESP_PORT
 #define DEBUG_HTTPCLIENT(fmt, ...) DEBUG_ESP_PORT.printf_P( (PGM_P)PSTR(fmt), ## __VA_ARGS__ )
@@ -43,6 +46,7 @@
 #endif
 
 #define HTTPCLIENT_DEFAULT_TCP_TIMEOUT (5000)
+#define HTTPCLIENT_DEFAULT_DECODING_WINDOW_BITS (15)
 
 /// HTTP client errors
 #define HTTPC_ERROR_CONNECTION_FAILED   (-1)
@@ -56,6 +60,7 @@
 #define HTTPC_ERROR_ENCODING            (-9)
 #define HTTPC_ERROR_STREAM_WRITE        (-10)
 #define HTTPC_ERROR_READ_TIMEOUT        (-11)
+#define HTTPC_ERROR_DECODING            (-12)
 
 constexpr int HTTPC_ERROR_CONNECTION_REFUSED __attribute__((deprecated)) = HTTPC_ERROR_CONNECTION_FAILED;
 
@@ -173,11 +178,13 @@ public:
     bool connected(void);
 
     void setReuse(bool reuse); /// keep-alive
+    void setConnectionPool(HTTPConnectionPool* pool); /// keep-alive across hosts and clients
     void setUserAgent(const String& userAgent);
     void setAuthorization(const char * user, const char * password);
     void setAuthorization(const char * auth);
     void setAuthorization(String auth);
     void setTimeout(uint16_t timeout);
+    void setContentDecoding(bool decode, uint8_t windowBits = HTTPCLIENT_DEFAULT_DECODING_WINDOW_BITS); /// gzip / deflate
 
     // Redirections
     void setFollowRedirects(followRedirects_t follow);
@@ -240,6 +247,8 @@ protected:
     bool sendHeader(const char * type);
     int handleHeaderResponse();
     int writeToStreamDataBlock(Stream * stream, int len);
+    int writeDecoded(Print * output);
+    int writeChunked(Print * output);
     static int StreamReportToHttpClientReport (Stream::Report streamSendError);
 
     // The common pattern to use the class is to
@@ -256,8 +265,11 @@ protected:
     String _host;
     uint16_t _port = 0;
     bool _reuse = true;
+    HTTPConnectionPool* _pool = nullptr;
+    uint32_t _keepAliveTimeout = 0;
     uint16_t _tcpTimeout = HTTPCLIENT_DEFAULT_TCP_TIMEOUT;
     bool _useHTTP10 = false;
+    uint8_t _decodeWindowBits = 0;
 
     String _uri;
     String _protocol;
@@ -278,6 +290,7 @@ protected:
     uint16_t _redirectLimit = 10;
     String _location;
     transferEncoding_t _transferEncoding = HTTPC_TE_IDENTITY;
+    bool _contentEncoded = false;
     std::unique_ptr<StreamString> _payload;
 };
 
@@ -303,7 +316,7 @@ int HTTPClient::writeToStream(S * output)
     int len = _size;
     int ret = 0;
 
-    if(_transferEncoding == HTTPC_TE_IDENTITY) {
+    if(_transferEncoding == HTTPC_TE_IDENTITY && !_contentEncoded) {
         // len < 0: transfer all of it, with timeout
         // len >= 0: max:len, with timeout
         ret = _client->sendSize(output, len);
@@ -312,58 +325,11 @@ int HTTPClient::writeToStream(S * output)
         if(_client->getLastSendReport() != Stream::Report::Success) {
             return returnError(StreamReportToHttpClientReport(_client->getLastSendReport()));
         }
-    } else if(_transferEncoding == HTTPC_TE_CHUNKED) {
-        int size = 0;
-        while(1) {
-            if(!connected()) {
-                return returnError(HTTPC_ERROR_CONNECTION_LOST);
-            }
-            String chunkHeader = _client->readStringUntil('\n');
-
-            if(chunkHeader.length() <= 0) {
-                return returnError(HTTPC_ERROR_READ_TIMEOUT);
-            }
-
-            chunkHeader.trim(); // remove \r
-
-            // read size of chunk
-            len = (uint32_t) strtol((const char *) chunkHeader.c_str(), NULL, 16);
-            size += len;
-            DEBUG_HTTPCLIENT("[HTTP-Client] read chunk len: %d\n", len);
-
-            // data left?
-            if(len > 0) {
-                // read len bytes with timeout
-                int r = _client->sendSize(output, len);
-                if (_client->getLastSendReport() != Stream::Report::Success)
-                    // not all data transferred
-                    return returnError(StreamReportToHttpClientReport(_client->getLastSendReport()));
-                ret += r;
-            } else {
-
-                // if no length Header use global chunk size
-                if(_size <= 0) {
-                    _size = size;
-                }
-
-                // check if we have write all data out
-                if(ret != _size) {
-                    return returnError(HTTPC_ERROR_STREAM_WRITE);
-                }
-                break;
-            }
-
-            // read trailing \r\n at the end of the chunk
-            char buf[2];
-            auto trailing_seq_len = _client->readBytes((uint8_t*)buf, 2);
-            if (trailing_seq_len != 2 || buf[0] != '\r' || buf[1] != '\n') {
-                return returnError(HTTPC_ERROR_READ_TIMEOUT);
-            }
-
-            esp_yield();
-        }
     } else {
-        return returnError(HTTPC_ERROR_ENCODING);
+        ret = writeDecoded(output);
+        if(ret < 0) {
+            return returnError(ret);
+        }
     }
 
     disconnect(true);
@@ -0,0 +1,138 @@
+/**
+ * HTTPChunkDecoder.cpp
+ *
+ * Incremental decoder for the chunked transfer coding (RFC 7230 4.1).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "HTTPChunkDecoder.h"
+
+void HTTPChunkDecoder::reset()
+{
+    _state = SIZE;
+    _digits = false;
+    _remaining = 0;
+    _decoded = 0;
+}
+
+size_t HTTPChunkDecoder::want() const
+{
+    switch(_state) {
+    case DATA:
+        return _remaining;
+    case DONE:
+    case FAILED:
+    case WRITE_FAILED:
+        return 0;
+    default:
+        // framing is taken a byte at a time, its end isn't known before
+        return 1;
+    }
+}
+
+void HTTPChunkDecoder::endSizeLine()
+{
+    if(!_digits) {
+        _state = FAILED;
+    } else if(_remaining) {
+        _state = DATA;
+    } else {
+        _state = TRAILER;
+    }
+}
+
+size_t HTTPChunkDecoder::decode(const uint8_t* data, size_t len, Print& output)
+{
+    size_t pos = 0;
+    while(pos < len && _state != DONE && !failed()) {
+
+        if(_state == DATA) {
+            size_t n = std::min((size_t)_remaining, len - pos);
+            int room = output.availableForWrite();
+            if(room <= 0) {
+                break;
+            }
+            n = std::min(n, (size_t)room);
+            size_t written = output.write(data + pos, n);
+            pos += written;
+            _remaining -= written;
+            _decoded += written;
+            if(written != n) {
+                _state = WRITE_FAILED;
+            } else if(!_remaining) {
+                _state = DATA_CR;
+            }
+            continue;
+        }
+
+        char c = data[pos++];
+        switch(_state) {
+        case SIZE:
+            if(isxdigit(c)) {
+                // a chunk can't be larger than the heap anyway
+                if(_remaining >> 24) {
+                    _state = FAILED;
+                    break;
+                }
+                _remaining = (_remaining << 4) | (isdigit(c) ? c - '0' : (c | 0x20) - 'a' + 10);
+                _digits = true;
+            } else if(c == ';' || c == ' ' || c == '\t') {
+                _state = EXTENSION;
+            } else if(c == '\r') {
+                _state = SIZE_LF;
+            } else if(c == '\n') {
+                endSizeLine();
+            } else {
+                _state = FAILED;
+            }
+            break;
+        case EXTENSION:
+            if(c == '\n') {
+                endSizeLine();
+            }
+            break;
+        case SIZE_LF:
+            if(c == '\n') {
+                endSizeLine();
+            } else {
+                _state = FAILED;
+            }
+            break;
+        case DATA_CR:
+            _state = c == '\r' ? DATA_LF : c == '\n' ? SIZE : FAILED;
+            _digits = false;
+            break;
+        case DATA_LF:
+            _state = c == '\n' ? SIZE : FAILED;
+            break;
+        case TRAILER:
+            _state = c == '\r' ? TRAILER_LF : c == '\n' ? DONE : TRAILER_FIELD;
+            break;
+        case TRAILER_FIELD:
+            if(c == '\n') {
+                _state = TRAILER;
+            }
+            break;
+        case TRAILER_LF:
+            _state = c == '\n' ? DONE : FAILED;
+            break;
+        default:
+            break;
+        }
+    }
+    return pos;
+}
@@ -0,0 +1,77 @@
+/**
+ * HTTPChunkDecoder.h
+ *
+ * Incremental decoder for the chunked transfer coding (RFC 7230 4.1).
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HTTPChunkDecoder_H_
+#define HTTPChunkDecoder_H_
+
+#include <Arduino.h>
+
+/**
+ * Strips the chunk framing from a response body handed over in pieces of any
+ * size, typically the peeked receive buffer of the connection, and writes
+ * the chunk data to a Print.  decode() never consumes bytes past the final
+ * chunk and trailer, which are left for the next response on the connection.
+ * As with Stream::send(), no more than output.availableForWrite() bytes are
+ * written at once.
+ */
+class HTTPChunkDecoder
+{
+public:
+    void reset();
+
+    // returns the number of bytes consumed
+    size_t decode(const uint8_t* data, size_t len, Print& output);
+
+    // bytes decode() can take without going past the end of the body
+    size_t want() const;
+
+    bool finished() const { return _state == DONE; }
+    bool failed() const { return _state == FAILED || _state == WRITE_FAILED; }
+    // failed because output didn't take the bytes it had room for
+    bool writeFailed() const { return _state == WRITE_FAILED; }
+    // chunk data bytes written so far
+    uint32_t decoded() const { return _decoded; }
+
+protected:
+    enum State : uint8_t {
+        SIZE,
+        EXTENSION,
+        SIZE_LF,
+        DATA,
+        DATA_CR,
+        DATA_LF,
+        TRAILER,
+        TRAILER_FIELD,
+        TRAILER_LF,
+        DONE,
+        FAILED,
+        WRITE_FAILED
+    };
+
+    void endSizeLine();
+
+    State _state = SIZE;
+    bool _digits = false;
+    uint32_t _remaining = 0; // size of the current chunk, then its bytes left
+    uint32_t _decoded = 0;
+};
+
+#endif /* HTTPChunkDecoder_H_ */
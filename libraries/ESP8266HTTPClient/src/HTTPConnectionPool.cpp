@@ -0,0 +1,175 @@
+/**
+ * HTTPConnectionPool.cpp
+ *
+ * Idle keep-alive connections shared between HTTPClient instances.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "HTTPConnectionPool.h"
+#include "ESP8266HTTPClient.h"
+
+HTTPConnectionPool::HTTPConnectionPool(size_t maxIdle, size_t maxIdleSecure, uint32_t idleTimeout)
+    : _maxIdle(maxIdle), _maxIdleSecure(maxIdleSecure), _idleTimeout(idleTimeout)
+{
+}
+
+/**
+ * maximum number of idle connections kept
+ * @param maxIdle size_t
+ */
+void HTTPConnectionPool::setMaxIdle(size_t maxIdle)
+{
+    _maxIdle = maxIdle;
+    trim(_maxIdle, false);
+}
+
+/**
+ * maximum number of idle https connections kept, each one holds
+ * the TLS buffers of its WiFiClientSecure
+ * @param maxIdleSecure size_t
+ */
+void HTTPConnectionPool::setMaxIdleSecure(size_t maxIdleSecure)
+{
+    _maxIdleSecure = maxIdleSecure;
+    trim(_maxIdleSecure, true);
+}
+
+/**
+ * close connections idle for longer than this
+ * @param ms uint32_t
+ */
+void HTTPConnectionPool::setIdleTimeout(uint32_t ms)
+{
+    _idleTimeout = ms;
+    expire();
+}
+
+std::unique_ptr<WiFiClient> HTTPConnectionPool::checkout(const String& host, uint16_t port, bool https)
+{
+    expire();
+    for(size_t i = _entries.size(); i-- > 0;) {
+        Entry& e = _entries[i];
+        if(e.port != port || e.https != https || !e.host.equalsIgnoreCase(host)) {
+            continue;
+        }
+        if(!sameConnection(e)) {
+            DEBUG_HTTPCLIENT("[HTTP-Pool] connection to %s:%u reused by its context elsewhere\n", host.c_str(), port);
+            _entries.erase(_entries.begin() + i);
+            continue;
+        }
+        // closed by the server, or unsolicited data: not usable for a new request
+        if(!e.client->connected() || e.client->available() > 0) {
+            DEBUG_HTTPCLIENT("[HTTP-Pool] drop stale connection to %s:%u\n", host.c_str(), port);
+            close(i);
+            continue;
+        }
+        DEBUG_HTTPCLIENT("[HTTP-Pool] reuse connection to %s:%u\n", host.c_str(), port);
+        std::unique_ptr<WiFiClient> client = std::move(e.client);
+        _entries.erase(_entries.begin() + i);
+        return client;
+    }
+    return nullptr;
+}
+
+void HTTPConnectionPool::checkin(const String& host, uint16_t port, bool https, std::unique_ptr<WiFiClient> client, uint32_t serverTimeout)
+{
+    if(!client) {
+        return;
+    }
+    size_t max = https ? std::min(_maxIdle, _maxIdleSecure) : _maxIdle;
+    if(!max || !client->connected()) {
+        client->stop();
+        return;
+    }
+
+    // one idle connection per server is enough
+    for(size_t i = _entries.size(); i-- > 0;) {
+        if(_entries[i].port == port && _entries[i].https == https && _entries[i].host.equalsIgnoreCase(host)) {
+            close(i);
+        }
+    }
+    // the TLS cap first, which may already make room
+    if(https) {
+        trim(_maxIdleSecure - 1, true);
+    }
+    trim(_maxIdle - 1, false);
+
+    uint32_t timeout = _idleTimeout;
+    if(serverTimeout && serverTimeout < timeout) {
+        timeout = serverTimeout;
+    }
+    DEBUG_HTTPCLIENT("[HTTP-Pool] keep connection to %s:%u for %ums\n", host.c_str(), port, timeout);
+    IPAddress remoteIP = client->remoteIP();
+    uint16_t remotePort = client->remotePort();
+    uint16_t localPort = client->localPort();
+    _entries.push_back(Entry { host, port, https, std::move(client), millis(), timeout, remoteIP, remotePort, localPort });
+}
+
+void HTTPConnectionPool::expire()
+{
+    unsigned long now = millis();
+    for(size_t i = _entries.size(); i-- > 0;) {
+        // setIdleTimeout() applies to the connections already kept
+        if(now - _entries[i].since >= std::min(_entries[i].timeout, _idleTimeout)) {
+            close(i);
+        }
+    }
+}
+
+void HTTPConnectionPool::clear()
+{
+    while(!_entries.empty()) {
+        close(_entries.size() - 1);
+    }
+}
+
+// false when a WiFiClientSecure context shared with the pooled clone was
+// connected again since checkin(), a closed one is ours to stop anyway
+bool HTTPConnectionPool::sameConnection(Entry& e)
+{
+    if(!e.client->connected()) {
+        return true;
+    }
+    return e.client->remoteIP() == e.remoteIP && e.client->remotePort() == e.remotePort && e.client->localPort() == e.localPort;
+}
+
+void HTTPConnectionPool::close(size_t i)
+{
+    // stop explicitly, a WiFiClientSecure context outlives its clones, but
+    // not the connection its owner made since
+    if(sameConnection(_entries[i])) {
+        _entries[i].client->stop();
+    }
+    _entries.erase(_entries.begin() + i);
+}
+
+// close the oldest (https only, or any) connections until at most max remain
+void HTTPConnectionPool::trim(size_t max, bool secureOnly)
+{
+    size_t count = 0;
+    for(const Entry& e : _entries) {
+        count += (!secureOnly || e.https);
+    }
+    for(size_t i = 0; count > max && i < _entries.size();) {
+        if(!secureOnly || _entries[i].https) {
+            close(i);
+            count--;
+        } else {
+            i++;
+        }
+    }
+}
@@ -0,0 +1,102 @@
+/**
+ * HTTPConnectionPool.h
+ *
+ * Idle keep-alive connections shared between HTTPClient instances.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef HTTPConnectionPool_H_
+#define HTTPConnectionPool_H_
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include <memory>
+#include <vector>
+
+#define HTTPCLIENT_POOL_DEFAULT_MAX_IDLE (4)
+#define HTTPCLIENT_POOL_DEFAULT_MAX_IDLE_SECURE (1)
+#define HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT (30000)
+
+/**
+ * Bounded set of idle connections keyed by host, port and https.
+ * HTTPClient::setConnectionPool() makes a client hand its keep-alive
+ * connection to the pool from end() or the next begin(), and take one from
+ * it before connecting.
+ * Each idle TLS connection holds on to its WiFiClientSecure buffers, so
+ * those are capped separately.  The least recently used connection is closed
+ * when a cap is reached.
+ *
+ * A TLS connection is owned by the WiFiClientSecure object it was made with,
+ * use one such object per host for its connection to stay pooled.  When that
+ * object connects elsewhere, the pooled clone follows it: the pool notices
+ * from the remote address and ports, and forgets the entry without closing
+ * the other connection.
+ */
+class HTTPConnectionPool
+{
+public:
+    HTTPConnectionPool(size_t maxIdle = HTTPCLIENT_POOL_DEFAULT_MAX_IDLE,
+                       size_t maxIdleSecure = HTTPCLIENT_POOL_DEFAULT_MAX_IDLE_SECURE,
+                       uint32_t idleTimeout = HTTPCLIENT_POOL_DEFAULT_IDLE_TIMEOUT);
+    ~HTTPConnectionPool() { clear(); }
+
+    HTTPConnectionPool(const HTTPConnectionPool&) = delete;
+    HTTPConnectionPool& operator=(const HTTPConnectionPool&) = delete;
+
+    void setMaxIdle(size_t maxIdle);
+    void setMaxIdleSecure(size_t maxIdleSecure);
+    void setIdleTimeout(uint32_t ms);
+
+    // idle connection to this server which is still usable, or nullptr
+    std::unique_ptr<WiFiClient> checkout(const String& host, uint16_t port, bool https);
+    // keep a connection after a keep-alive response, serverTimeout in ms
+    // (0 if the server didn't say) shortens the idle timeout
+    void checkin(const String& host, uint16_t port, bool https, std::unique_ptr<WiFiClient> client, uint32_t serverTimeout = 0);
+
+    // close expired connections, e.g. from loop() to release their memory early
+    void expire();
+    // close all idle connections
+    void clear();
+
+    size_t idle() const { return _entries.size(); }
+
+protected:
+    struct Entry {
+        String host;
+        uint16_t port;
+        bool https;
+        std::unique_ptr<WiFiClient> client;
+        unsigned long since;
+        uint32_t timeout;
+        // of the connection checked in
+        IPAddress remoteIP;
+        uint16_t remotePort;
+        uint16_t localPort;
+    };
+
+    static bool sameConnection(Entry& e);
+    void close(size_t i);
+    void trim(size_t max, bool secureOnly);
+
+    std::vector<Entry> _entries; // oldest first
+    size_t _maxIdle;
+    size_t _maxIdleSecure;
+    uint32_t _idleTimeout;
+};
+
+#endif /* HTTPConnectionPool_H_ */
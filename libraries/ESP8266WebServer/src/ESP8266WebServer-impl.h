@@ -75,18 +75,42 @@ void ESP8266WebServerTemplate<ServerType>::enableETag(bool enable, ETagFunction
   _eTagFunction = fn;
 }
 
+template <typename ServerType>
+bool ESP8266WebServerTemplate<ServerType>::saveETags() {
+  bool saved = true;
+  for (RequestHandlerType* handler = _firstHandler; handler; handler = handler->next())
+    saved &= handler->saveETags();
+  return saved;
+}
+
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::begin() {
   close();
+  _allocateSlots();
+  _buildRoutes();
   _server.begin();
 }
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::begin(uint16_t port) {
   close();
+  _allocateSlots();
+  _buildRoutes();
   _server.begin(port);
 }
 
+template <typename ServerType>
+void ESP8266WebServerTemplate<ServerType>::_allocateSlots() {
+  if (_slots && _slotCount == _maxClients)
+    return;
+  _currentSlot = nullptr;
+  _slots.reset(new ClientSlot[_maxClients]);
+  _slotCount = _maxClients;
+  _nextSlot = 0;
+  for (int i = 0; i < _slotCount; i++)
+    _slots[i].parser.setHeaderFilter(_headerFilter, this);
+}
+
 template <typename ServerType>
 String ESP8266WebServerTemplate<ServerType>::_extractParam(String& authReq,const String& param,const char delimit) const {
   int _begin = authReq.indexOf(param);
@@ -299,6 +323,7 @@ bool ESP8266WebServerTemplate<ServerType>::removeHandler(RequestHandlerType *han
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::_addRequestHandler(RequestHandlerType* handler) {
+    _routesBuilt = false;
     if (!_lastHandler) {
       _firstHandler = handler;
       _lastHandler = handler;
@@ -309,6 +334,48 @@ void ESP8266WebServerTemplate<ServerType>::_addRequestHandler(RequestHandlerType
     }
 }
 
+template <typename ServerType>
+void ESP8266WebServerTemplate<ServerType>::_buildRoutes() {
+  _routes.clear();
+  _routeHandlers.clear();
+  for (RequestHandlerType* handler = _firstHandler; handler; handler = handler->next()) {
+    RouteIndex::Id id = _routeHandlers.size();
+    _routeHandlers.push_back(handler);
+    const Uri* uri = handler->routeUri();
+    switch (uri ? uri->routeKind() : Uri::ROUTE_ANY) {
+      case Uri::ROUTE_EXACT:
+        _routes.addExact(uri->str(), id);
+        break;
+      case Uri::ROUTE_PREFIX: {
+        int brace = uri->str().indexOf('{');
+        _routes.addPrefix(brace < 0 ? uri->str() : uri->str().substring(0, brace), id);
+        break;
+      }
+      default:
+        _routes.addAlways(id);
+        break;
+    }
+  }
+  _routes.build();
+  _routesBuilt = true;
+}
+
+template <typename ServerType>
+typename ESP8266WebServerTemplate<ServerType>::RequestHandlerType* ESP8266WebServerTemplate<ServerType>::_findHandler() {
+  // handlers added or removed after begin()
+  if (!_routesBuilt)
+    _buildRoutes();
+  // first handler in registration order accepting the request,
+  // among those the index did not rule out
+  _routes.candidates(_currentUri, _routeCandidates);
+  for (RouteIndex::Id id : _routeCandidates) {
+    RequestHandlerType* handler = _routeHandlers[id];
+    if (handler->canHandle(*this, _currentMethod, _currentUri))
+      return handler;
+  }
+  return nullptr;
+}
+
 template <typename ServerType>
 bool ESP8266WebServerTemplate<ServerType>::_removeRequestHandler(RequestHandlerType *handler) {
   RequestHandlerType *current = _firstHandler;
@@ -328,6 +395,7 @@ bool ESP8266WebServerTemplate<ServerType>::_removeRequestHandler(RequestHandlerT
 
       // Delete 'matching' handler
       delete current;
+      _routesBuilt = false;
       return true;
     }
     previous = current;
@@ -355,95 +423,156 @@ void ESP8266WebServerTemplate<ServerType>::serveStatic(const char* uri, FS& fs,
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::handleClient() {
-  if (_currentStatus == HC_NONE) {
-    _currentClient = _server.accept();
-    if (!_currentClient) {
-      return;
-    }
+  if (!_slots)
+    return;
+
+  // accept new clients while there is room for them
+  for (int i = 0; i < _slotCount; i++) {
+    ClientSlot& slot = _slots[i];
+    if (slot.status != HC_NONE)
+      continue;
+    slot.client = _server.accept();
+    if (!slot.client)
+      break;
+
+    DBGWS("New client (slot %d)\n", i);
 
-    DBGWS("New client\n");
+    slot.status = HC_WAIT_READ;
+    slot.statusChange = millis();
+    slot.requests = 0;
+    slot.keepAlive = false;
+    slot.parser.reset();
+  }
 
-    _currentStatus = HC_WAIT_READ;
-    _statusChange = millis();
+  // advance every connection, starting from a different one on each call
+  bool callYield = false;
+  int first = _nextSlot;
+  _nextSlot = (_nextSlot + 1) % _slotCount;
+  for (int i = 0; i < _slotCount; i++) {
+    ClientSlot& slot = _slots[(first + i) % _slotCount];
+    if (slot.status != HC_NONE)
+      callYield |= _handleClientSlot(slot);
   }
 
+  // write the new ETags of static files once no more are coming
+  if (_eTagsUnsaved) {
+    _eTagsUnsaved = false;
+    for (RequestHandlerType* handler = _firstHandler; handler; handler = handler->next())
+      _eTagsUnsaved |= !handler->saveETagsIdle();
+  }
+
+  if (callYield) {
+    yield();
+  }
+}
+
+template <typename ServerType>
+bool ESP8266WebServerTemplate<ServerType>::_handleClientSlot(ClientSlot& slot) {
+  _currentSlot = &slot;
+  _currentClient = slot.client;
+  _keepAlive = slot.keepAlive;
+
   bool keepCurrentClient = false;
   bool callYield = false;
 
 #ifdef DEBUG_ESP_HTTP_SERVER
 
-  struct compare_s
+  // trace the changes of each connection
+  uint8_t connected = _currentClient.connected();
+  int available = _currentClient.available();
+  if (slot.traced.connected != connected
+      || slot.traced.available != available
+      || slot.traced.status != slot.status)
   {
-    uint8_t connected;
-    int available;
-    HTTPClientStatus status;
-    bool operator != (const compare_s& o)
-    {
-      return    o.connected != connected
-             || o.available != available
-             || o.status != status;
-    }
-  };
-  static compare_s last { false, 0, HC_NONE };
-  compare_s now { _currentClient.connected(), _currentClient.available(), _currentStatus };
-
-  if (last != now)
-  {
-    DBGWS("http-server loop: conn=%d avail=%d status=%s\n",
-      _currentClient.connected(), _currentClient.available(),
-      _currentStatus==HC_NONE?"none":
-      _currentStatus==HC_WAIT_READ?"wait-read":
-      _currentStatus==HC_WAIT_CLOSE?"wait-close":
+    DBGWS("http-server loop: slot=%d conn=%d avail=%d status=%s\n",
+      (int)(&slot - &_slots[0]),
+      connected, available,
+      slot.status==HC_NONE?"none":
+      slot.status==HC_WAIT_READ?"wait-read":
+      slot.status==HC_WAIT_CLOSE?"wait-close":
       "??");
-    last = now;
+    slot.traced.connected = connected;
+    slot.traced.available = available;
+    slot.traced.status = slot.status;
   }
 
 #endif // DEBUG_ESP_HTTP_SERVER
 
   if (_currentClient.connected() || _currentClient.available()) {
-    if (_currentClient.available() && _keepAlive) {
-      _currentStatus = HC_WAIT_READ;
+    if (_currentClient.available() && _keepAlive && slot.status != HC_WAIT_READ) {
+      // a new request begins, its head is timed from now on
+      slot.status = HC_WAIT_READ;
+      slot.statusChange = millis();
     }
 
-    switch (_currentStatus) {
+    switch (slot.status) {
     case HC_NONE:
       // No-op to avoid C++ compiler warning
       break;
     case HC_WAIT_READ:
-      // Wait for data from client to become available
-      if (_currentClient.available()) {
-        switch (_parseRequest(_currentClient))
-        {
-        case CLIENT_REQUEST_CAN_CONTINUE:
-          _currentClient.setTimeout(HTTP_MAX_SEND_WAIT);
-          _contentLength = CONTENT_LENGTH_NOT_SET;
-          _handleRequest();
-          /* fallthrough */
-        case CLIENT_REQUEST_IS_HANDLED:
-          if (_currentClient.connected() || _currentClient.available()) {
-            _currentStatus = HC_WAIT_CLOSE;
-            _statusChange = millis();
-            keepCurrentClient = true;
-          }
-          else
-            DBGWS("webserver: peer has closed after served\n");
-          break;
-        case CLIENT_MUST_STOP:
-          DBGWS("Close client\n");
-          _currentClient.stop();
-          break;
-        case CLIENT_IS_GIVEN:
-          // client must not be stopped but must not be handled here anymore
-          // (example: tcp connection given to websocket)
-          DBGWS("Give client\n");
-          break;
-        } // switch _parseRequest()
+      // Parse the request head and gather the body as they arrive,
+      // without blocking the other connections
+      if (_readRequestHead(_currentClient) && _readRequestBody(_currentClient)) {
+        bool pipelined;
+        do {
+          pipelined = false;
+          switch (_parseRequest(_currentClient))
+          {
+          case CLIENT_REQUEST_CAN_CONTINUE:
+            slot.requests++;
+            _currentClient.setTimeout(HTTP_MAX_SEND_WAIT);
+            _contentLength = CONTENT_LENGTH_NOT_SET;
+            _handleRequest();
+            /* fallthrough */
+          case CLIENT_REQUEST_IS_HANDLED:
+            if (_currentClient.connected() || _currentClient.available()) {
+              slot.status = HC_WAIT_CLOSE;
+              slot.statusChange = millis();
+              keepCurrentClient = true;
+              // next request is already received: serve it without going
+              // through the idle state
+              pipelined = _keepAlive && _currentClient.available();
+            }
+            else
+              DBGWS("webserver: peer has closed after served\n");
+            break;
+          case CLIENT_MUST_STOP:
+            DBGWS("Close client\n");
+            _currentClient.stop();
+            break;
+          case CLIENT_IS_GIVEN:
+            // client must not be stopped but must not be handled here anymore
+            // (example: tcp connection given to websocket)
+            DBGWS("Give client\n");
+            break;
+          } // switch _parseRequest()
+          slot.parser.reset();
+          slot.body = String();
+        } while (pipelined && _readRequestHead(_currentClient) && _readRequestBody(_currentClient));
+      } else if (slot.parser.failed()) {
+        DBGWS("Invalid request (%d)\n", slot.parser.error());
+        // tell the client why before closing
+        int code = slot.parser.error();
+        String response(F("HTTP/1.1 "));
+        response += code;
+        response += ' ';
+        response += responseCodeToString(code);
+        response += F("\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+        _currentClient.write(response.c_str(), response.length());
+        _currentClient.stop();
       } else {
-        // !_currentClient.available(): waiting for more data
-        unsigned long timeSinceChange = millis() - _statusChange;
+        // waiting for more data
+        unsigned long timeSinceChange = millis() - slot.statusChange;
+        if (slot.parser.done()) {
+          // body, timed from the last data received
+          if (timeSinceChange > HTTP_MAX_POST_WAIT)
+            DBGWS("webserver: closing after body read timeout\n");
+          else
+            keepCurrentClient = true;
+        }
         // Use faster connection drop timeout if any other client has data
         // or the buffer of pending clients is full
-        if ((_server.hasClientData() || _server.hasMaxPendingClients())
+        else if ((_server.hasClientData() || _server.hasMaxPendingClients())
           && timeSinceChange > HTTP_MAX_DATA_AVAILABLE_WAIT)
             DBGWS("webserver: closing since there's another connection to read from\n");
         else {
@@ -457,33 +586,37 @@ void ESP8266WebServerTemplate<ServerType>::handleClient() {
       break;
     case HC_WAIT_CLOSE:
       // Wait for client to close the connection
-      if (!_server.hasClient() && (millis() - _statusChange <= HTTP_MAX_CLOSE_WAIT)) {
+      if (!_server.hasClient() && (millis() - slot.statusChange <= (_keepAlive ? _keepAliveTimeout : HTTP_MAX_CLOSE_WAIT))) {
         keepCurrentClient = true;
         callYield = true;
-        if (_currentClient.available())
+        if (_currentClient.available()) {
             // continue serving current client
-            _currentStatus = HC_WAIT_READ;
+            slot.status = HC_WAIT_READ;
+            slot.statusChange = millis();
+        }
       }
       break;
-    } // switch _currentStatus
+    } // switch slot.status
   }
 
+  slot.keepAlive = _keepAlive;
   if (!keepCurrentClient) {
     DBGWS("Drop client\n");
-    _currentClient = ClientType();
-    _currentStatus = HC_NONE;
+    slot.client = _currentClient = ClientType();
+    slot.status = HC_NONE;
+    slot.body = String();
     _currentUpload.reset();
   }
+  _currentSlot = nullptr;
 
-  if (callYield) {
-    yield();
-  }
+  return callYield;
 }
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::close() {
   _server.close();
-  _currentStatus = HC_NONE;
+  for (int i = 0; i < _slotCount; i++)
+    _slots[i].status = HC_NONE;
   if(!_headerKeysCount)
     collectHeaders();
 }
@@ -543,15 +676,57 @@ void ESP8266WebServerTemplate<ServerType>::_prepareHeader(String& response, int
     if (_keepAlive && _server.hasClient()) { // Disable keep alive if another client is waiting.
       _keepAlive = false;
     }
+    if (_keepAlive && _keepAliveMaxRequests && _currentSlot && _currentSlot->requests >= _keepAliveMaxRequests) {
+      _keepAlive = false;
+    }
     sendHeader(String(F("Connection")), String(_keepAlive ? F("keep-alive") : F("close")));
     if (_keepAlive) {
-      sendHeader(String(F("Keep-Alive")), String(F("timeout=")) + HTTP_MAX_CLOSE_WAIT);
+      String keepAliveParams(F("timeout="));
+      keepAliveParams += _keepAliveTimeout / 1000;
+      if (_keepAliveMaxRequests) {
+        keepAliveParams += F(", max=");
+        keepAliveParams += _keepAliveMaxRequests - (_currentSlot ? _currentSlot->requests : 0);
+      }
+      sendHeader(String(F("Keep-Alive")), keepAliveParams);
     }
+}
 
+template <typename ServerType>
+void ESP8266WebServerTemplate<ServerType>::_sendGathered(const String* statusLine, const char* content, size_t length) {
+  // status line, headers, empty line, chunk size, content, chunk end
+  Print::Buffer buffers[6];
+  size_t count = 0;
+  size_t total = 0;
+  auto add = [&](const char* data, size_t size) {
+    if (size) {
+      buffers[count++] = { (const uint8_t*)data, size };
+      total += size;
+    }
+  };
 
-    response += _responseHeaders;
-    response += "\r\n";
+  if (statusLine) {
+    add(statusLine->c_str(), statusLine->length());
+    add(_responseHeaders.c_str(), _responseHeaders.length());
+    add("\r\n", 2);
+  }
+  // without a head, an empty chunk ends a chunked response
+  bool body = _currentMethod != HTTP_HEAD && (length || (_chunked && !statusLine));
+  char chunkSize[12];
+  if (body) {
+    if (_chunked)
+      add(chunkSize, sprintf(chunkSize, "%zx\r\n", length));
+    add(content, length);
+    if (_chunked)
+      add("\r\n", 2);
+  }
+
+  size_t sent = _currentClient.writev(buffers, count);
+  if (sent != total)
+    DBGWS("HTTPServer: error: sent %zu on %zu bytes\n", sent, total);
+  if (statusLine)
     _responseHeaders = "";
+  if (body && _chunked && !length)
+    _chunked = false;
 }
 
 template <typename ServerType>
@@ -577,27 +752,33 @@ void ESP8266WebServerTemplate<ServerType>::sendContent(const String& content) {
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::send(int code, const char* content_type, Stream* stream, size_t content_length /*= 0*/) {
-  String header;
+  String statusLine;
   if (content_length == 0)
       content_length = std::max((ssize_t)0, stream->streamRemaining());
-  _prepareHeader(header, code, content_type, content_length);
-  size_t sent = StreamConstPtr(header).sendAll(&_currentClient);
-  if (sent != header.length())
-      DBGWS("HTTPServer: error: sent %zd on %u bytes\n", sent, header.length());
+  _prepareHeader(statusLine, code, content_type, content_length);
+  if (stream->hasPeekBufferAPI() && stream->peekAvailable() >= content_length) {
+    // content is in RAM: head and content go out in one write
+    _sendGathered(&statusLine, stream->peekBuffer(), content_length);
+    stream->peekConsume(content_length);
+    return;
+  }
+  _sendGathered(&statusLine, nullptr, 0);
   if (content_length)
     return sendContent(stream, content_length);
 }
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::send_P(int code, PGM_P content_type, PGM_P content) {
-  StreamConstPtr ref(content, strlen_P(content));
-  return send(code, String(content_type).c_str(), &ref);
+  return send_P(code, content_type, content, strlen_P(content));
 }
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::send_P(int code, PGM_P content_type, PGM_P content, size_t contentLength) {
-  StreamConstPtr ref(content, contentLength);
-  return send(code, String(content_type).c_str(), &ref);
+  String statusLine;
+  _prepareHeader(statusLine, code, String(content_type).c_str(), contentLength);
+  _sendGathered(&statusLine, nullptr, 0);
+  if (contentLength)
+    sendContent_P(content, contentLength);
 }
 
 template <typename ServerType>
@@ -606,6 +787,12 @@ void ESP8266WebServerTemplate<ServerType>::sendContent(Stream* content, ssize_t
     return;
   if (content_length <= 0)
     content_length = std::max((ssize_t)0, content->streamRemaining());
+  if (content->hasPeekBufferAPI() && content->peekAvailable() >= (size_t)content_length) {
+    // chunk size, content and chunk end in one write
+    _sendGathered(nullptr, content->peekBuffer(), content_length);
+    content->peekConsume(content_length);
+    return;
+  }
   if(_chunked) {
     _currentClient.printf("%zx\r\n", content_length);
   }
@@ -629,8 +816,23 @@ void ESP8266WebServerTemplate<ServerType>::sendContent_P(PGM_P content) {
 
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::sendContent_P(PGM_P content, size_t size) {
-  StreamConstPtr ptr(content, size);
-  return sendContent(&ptr, size);
+  if (_currentMethod == HTTP_HEAD)
+    return;
+  if(_chunked) {
+    _currentClient.printf("%zx\r\n", size);
+  }
+  // WiFiClient::write_P() reads flash once into buffers lwIP sends from
+  size_t sent = _currentClient.write_P(content, size);
+  if (sent != size)
+  {
+    DBGWS("HTTPServer: error: short send after timeout (%zu < %zu)\n", sent, size);
+  }
+  if(_chunked) {
+    _currentClient.printf_P(PSTR("\r\n"));
+    if (size == 0) {
+      _chunked = false;
+    }
+  }
 }
 
 template <typename ServerType>
@@ -665,6 +867,7 @@ const String& ESP8266WebServerTemplate<ServerType>::pathArg(unsigned int i) cons
 
 template <typename ServerType>
 const String& ESP8266WebServerTemplate<ServerType>::arg(const String& name) const {
+  _parseDeferredArguments();
   for (int i = 0; i < _currentArgCount + _currentArgsHavePlain; ++i) {
     if ( _currentArgs[i].key == name )
       return _currentArgs[i].value;
@@ -674,6 +877,7 @@ const String& ESP8266WebServerTemplate<ServerType>::arg(const String& name) cons
 
 template <typename ServerType>
 const String& ESP8266WebServerTemplate<ServerType>::arg(int i) const {
+  _parseDeferredArguments();
   if (i >= 0 && i < _currentArgCount + _currentArgsHavePlain)
     return _currentArgs[i].value;
   return emptyString;
@@ -681,6 +885,7 @@ const String& ESP8266WebServerTemplate<ServerType>::arg(int i) const {
 
 template <typename ServerType>
 const String& ESP8266WebServerTemplate<ServerType>::argName(int i) const {
+  _parseDeferredArguments();
   if (i >= 0 && i < _currentArgCount + _currentArgsHavePlain)
     return _currentArgs[i].key;
   return emptyString;
@@ -688,11 +893,13 @@ const String& ESP8266WebServerTemplate<ServerType>::argName(int i) const {
 
 template <typename ServerType>
 int ESP8266WebServerTemplate<ServerType>::args() const {
+  _parseDeferredArguments();
   return _currentArgCount;
 }
 
 template <typename ServerType>
 bool ESP8266WebServerTemplate<ServerType>::hasArg(const String& name) const {
+  _parseDeferredArguments();
   for (int i = 0; i < _currentArgCount + _currentArgsHavePlain; ++i) {
     if (_currentArgs[i].key == name)
       return true;
@@ -804,6 +1011,8 @@ void ESP8266WebServerTemplate<ServerType>::_handleRequest() {
   delete[] _currentArgs;
   _currentArgs = nullptr;
   _currentArgCount = 0;
+  _currentArgsHavePlain = 0;
+  _currentArgsDeferred = false;
 }
 
 template <typename ServerType>
@@ -923,6 +1132,9 @@ String ESP8266WebServerTemplate<ServerType>::responseCodeToString(const int code
     case 417:
         r = F("Expectation Failed");
         break;
+    case 431:
+        r = F("Request Header Fields Too Large");
+        break;
     case 500:
         r = F("Internal Server Error");
         break;
@@ -1,6 +1,6 @@
 /*
   ESP8266WebServer.h - Dead simple web-server.
-  Supports only one simultaneous client, knows how to handle GET and POST.
+  Supports a configurable number of simultaneous clients, knows how to handle GET and POST.
 
   Copyright (c) 2014 Ivan Grokhotkov. All rights reserved.
 
@@ -30,6 +30,9 @@
 #include <ESP8266WiFi.h>
 #include <FS.h>
 #include "detail/mimetable.h"
+#include "detail/RequestParser.h"
+#include "detail/BoundaryScanner.h"
+#include "detail/RouteIndex.h"
 #include "Uri.h"
 
 //#define DEBUG_ESP_HTTP_SERVER
@@ -64,6 +67,14 @@ enum HTTPAuthMethod { BASIC_AUTH, DIGEST_AUTH };
 #define HTTP_MAX_SEND_WAIT 5000 //ms to wait for data chunk to be ACKed
 #define HTTP_MAX_CLOSE_WAIT 2000 //ms to wait for the client to close the connection
 
+#ifndef WEBSERVER_MAX_CLIENTS
+#define WEBSERVER_MAX_CLIENTS 1 //clients served concurrently, see setMaxClients()
+#endif
+
+#ifndef HTTP_MAX_KEEPALIVE_REQUESTS
+#define HTTP_MAX_KEEPALIVE_REQUESTS 100 //requests served on a persistent connection before closing it (0: no limit)
+#endif
+
 #define CONTENT_LENGTH_UNKNOWN ((size_t) -1)
 #define CONTENT_LENGTH_NOT_SET ((size_t) -2)
 
@@ -107,6 +118,11 @@ public:
   void begin();
   void begin(uint16_t port);
   void handleClient();
+  // Number of connections served concurrently (default WEBSERVER_MAX_CLIENTS),
+  // to be called before begin(). Each connection costs about
+  // WEBSERVER_REQUEST_ARENA bytes of heap for its request parser, and up to
+  // WEBSERVER_REQUEST_MAX_HEAD while parsing a larger request head.
+  void setMaxClients(uint8_t maxClients) { _maxClients = maxClients ? maxClients : 1; }
   void close();
   void stop();
 
@@ -132,6 +148,11 @@ public:
   void onFileUpload(THandlerFunction fn); //handle file uploads
   void enableCORS(bool enable);
   void enableETag(bool enable, ETagFunction fn = nullptr);
+  // Write the ETags of static files, cached in RAM, to the index files
+  // next to them so that they survive a reboot. handleClient() does it once
+  // no new ETag was calculated for WEBSERVER_ETAG_SAVE_DELAY ms, this writes
+  // them now (before a deep sleep, say). Returns false on error.
+  bool saveETags();
 
   const String& uri() const { return _currentUri; }
   HTTPMethod method() const { return _currentMethod; }
@@ -245,6 +266,13 @@ public:
   void keepAlive(bool keepAlive) { _keepAlive = keepAlive; }
   bool keepAlive() { return _keepAlive; }
 
+  // How long an idle persistent connection is kept open waiting for the next
+  // request (default HTTP_MAX_CLOSE_WAIT), and how many requests are served on
+  // it before it is closed (default HTTP_MAX_KEEPALIVE_REQUESTS, 0 for no limit).
+  // Requests pipelined by the client are served back-to-back.
+  void setKeepAliveTimeout(uint32_t timeoutMs) { _keepAliveTimeout = timeoutMs; }
+  void setKeepAliveMaxRequests(uint16_t maxRequests) { _keepAliveMaxRequests = maxRequests; }
+
   static String credentialHash(const String& username, const String& realm, const String& password);
 
   static String urlDecode(const String& text);
@@ -309,20 +337,49 @@ public:
 
   bool             _eTagEnabled = false;
   ETagFunction     _eTagFunction = nullptr;
+  bool             _eTagsUnsaved = false; // static handlers calculated new ETags
 
 protected:
+  struct ClientSlot {
+    ClientType       client;
+    HTTPClientStatus status = HC_NONE;
+    unsigned long    statusChange = 0;
+    uint16_t         requests = 0; // requests served on this connection
+    bool             keepAlive = false;
+    RequestParser    parser;
+    String           body;  // gathered by _readRequestBody()
+#ifdef DEBUG_ESP_HTTP_SERVER
+    // last state traced by _handleClientSlot()
+    struct {
+      uint8_t          connected = false;
+      int              available = 0;
+      HTTPClientStatus status = HC_NONE;
+    } traced;
+#endif
+  };
+
+  void _allocateSlots();
+  bool _handleClientSlot(ClientSlot& slot);
   void _addRequestHandler(RequestHandlerType* handler);
   bool _removeRequestHandler(RequestHandlerType *handler);
+  void _buildRoutes();
+  RequestHandlerType* _findHandler();
   void _handleRequest();
   void _finalizeResponse();
   ClientFuture _parseRequest(ClientType& client);
+  bool _readRequestHead(ClientType& client);
+  bool _readRequestBody(ClientType& client);
+  static bool _headerFilter(void* context, const char* name);
   void _parseArguments(const String& data);
+  void _parseDeferredArguments() const;
   int _parseArgumentsPrivate(const String& data, std::function<void(String&,String&,const String&,int,int,int,int)> handler);
   bool _parseForm(ClientType& client, const String& boundary, uint32_t len);
   bool _parseFormUploadAborted();
-  void _uploadWriteByte(uint8_t b);
-  int _uploadReadByte(ClientType& client);
+  bool _uploadFileContent(ClientType& client, const BoundaryScanner& delimiter);
+  // builds the status line and completes _responseHeaders
   void _prepareHeader(String& response, int code, const char* content_type, size_t contentLength);
+  // sends the head (when statusLine is given) and a block of content with a single writev()
+  void _sendGathered(const String* statusLine, const char* content, size_t length);
   bool _collectHeader(const char* headerName, const char* headerValue);
 
   void _streamFileCore(const size_t fileSize, const String & fileName, const String & contentType);
@@ -341,18 +398,27 @@ protected:
   HTTPMethod  _currentMethod = HTTP_ANY;
   String      _currentUri;
   uint8_t     _currentVersion = 0;
-  HTTPClientStatus _currentStatus = HC_NONE;
-  unsigned long _statusChange = 0;
+  std::unique_ptr<ClientSlot[]> _slots;
+  ClientSlot* _currentSlot = nullptr; // connection being served
+  uint8_t     _slotCount = 0;
+  uint8_t     _maxClients = WEBSERVER_MAX_CLIENTS;
+  uint8_t     _nextSlot = 0;
 
   RequestHandlerType*  _currentHandler = nullptr;
   RequestHandlerType*  _firstHandler = nullptr;
   RequestHandlerType*  _lastHandler = nullptr;
+  // handlers in registration order, indexed by _routes
+  std::vector<RequestHandlerType*> _routeHandlers;
+  std::vector<esp8266webserver::RouteIndex::Id> _routeCandidates;
+  esp8266webserver::RouteIndex _routes;
+  bool             _routesBuilt = false;
   THandlerFunction _notFoundHandler;
   THandlerFunction _fileUploadHandler;
 
   int              _currentArgCount = 0;
   RequestArgument* _currentArgs = nullptr;
   int              _currentArgsHavePlain = 0;
+  bool             _currentArgsDeferred = false;
   std::unique_ptr<HTTPUpload> _currentUpload;
 
   int              _headerKeysCount = 0;
@@ -365,6 +431,8 @@ protected:
   bool             _chunked = false;
   bool             _corsEnabled = false;
   bool             _keepAlive = false;
+  uint32_t         _keepAliveTimeout = HTTP_MAX_CLOSE_WAIT;
+  uint16_t         _keepAliveMaxRequests = HTTP_MAX_KEEPALIVE_REQUESTS;
 
   String           _snonce;  // Store noance and opaque for future comparison
   String           _sopaque;
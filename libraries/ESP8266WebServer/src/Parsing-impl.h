@@ -24,12 +24,16 @@
 #include "WiFiClient.h"
 #include "ESP8266WebServer.h"
 #include "detail/mimetable.h"
+#include "detail/BoundaryScanner.h"
+#include <PolledTimeout.h>
 
 #ifndef WEBSERVER_MAX_POST_ARGS
 #define WEBSERVER_MAX_POST_ARGS 32
 #endif
 
 static const char Content_Type[] PROGMEM = "Content-Type";
+static const char HOST_HEADER[] PROGMEM = "Host";
+static const char CONNECTION_HEADER[] PROGMEM = "Connection";
 static const char filename[] PROGMEM = "filename";
 
 namespace esp8266webserver {
@@ -41,58 +45,122 @@ static bool readBytesWithTimeout(typename ServerType::ClientType& client, size_t
   return client.sendSize(dataStream, maxLength, timeout_ms) == maxLength;
 }
 
+template <typename ServerType>
+bool ESP8266WebServerTemplate<ServerType>::_headerFilter(void* context, const char* name) {
+  auto server = static_cast<ESP8266WebServerTemplate<ServerType>*>(context);
+  if (   strcasecmp_P(name, Content_Type) == 0
+      || strcasecmp_P(name, Content_Length) == 0
+      || strcasecmp_P(name, HOST_HEADER) == 0
+      || strcasecmp_P(name, CONNECTION_HEADER) == 0)
+    return true;
+  for (int i = 0; i < server->_headerKeysCount; i++) {
+    if (server->_currentHeaders[i].key.equalsIgnoreCase(name))
+      return true;
+  }
+  return false;
+}
+
+template <typename ServerType>
+bool ESP8266WebServerTemplate<ServerType>::_readRequestHead(ClientType& client) {
+  // Feed what is already received to the parser without waiting for more,
+  // what follows the head stays in the client.
+  RequestParser& parser = _currentSlot->parser;
+  while (!parser.done() && !parser.failed()) {
+    if (client.hasPeekBufferAPI()) {
+      size_t avail = client.peekAvailable();
+      if (!avail)
+        break;
+      client.peekConsume(parser.feed(client.peekBuffer(), avail));
+    } else if (client.available()) {
+      char c = client.read();
+      parser.feed(&c, 1);
+    } else {
+      break;
+    }
+  }
+  return parser.done();
+}
+
+template <typename ServerType>
+bool ESP8266WebServerTemplate<ServerType>::_readRequestBody(ClientType& client) {
+  // Gather the body of a complete head in the slot without waiting for
+  // more. Multipart bodies are left to _parseForm(), which passes uploads
+  // on as they arrive, and the body is left in the client for a hook.
+  ClientSlot& slot = *_currentSlot;
+  const RequestParser& parser = slot.parser;
+  const char* method = parser.method();
+  if (_hook
+      || (   strcmp_P(method, PSTR("POST")) != 0
+          && strcmp_P(method, PSTR("PUT")) != 0
+          && strcmp_P(method, PSTR("PATCH")) != 0
+          && strcmp_P(method, PSTR("DELETE")) != 0))
+    return true;
+  const char* contentType = parser.header(FPSTR(Content_Type));
+  if (contentType && strncmp_P(contentType, PSTR("multipart/"), 10) == 0)
+    return true;
+  const char* contentLengthStr = parser.header(FPSTR(Content_Length));
+  size_t contentLength = contentLengthStr ? atol(contentLengthStr) : 0;
+  if (slot.body.length() == 0 && contentLength && !slot.body.reserve(contentLength))
+    return true; // _parseRequest() drops the client on the short body
+
+  size_t length = slot.body.length();
+  while (slot.body.length() < contentLength) {
+    size_t want = contentLength - slot.body.length();
+    if (client.hasPeekBufferAPI()) {
+      size_t avail = std::min(client.peekAvailable(), want);
+      if (!avail)
+        break;
+      slot.body.concat(client.peekBuffer(), avail);
+      client.peekConsume(avail);
+    } else if (client.available()) {
+      slot.body += (char)client.read();
+    } else {
+      break;
+    }
+  }
+  if (slot.body.length() != length)
+    slot.statusChange = millis();
+  return slot.body.length() >= contentLength;
+}
+
 template <typename ServerType>
 typename ESP8266WebServerTemplate<ServerType>::ClientFuture ESP8266WebServerTemplate<ServerType>::_parseRequest(ClientType& client) {
-  // Read the first line of HTTP request
-  String req = client.readStringUntil('\r');
-  DBGWS("request: %s\n", req.c_str());
-  client.readStringUntil('\n');
   //reset header value
   for (int i = 0; i < _headerKeysCount; ++i) {
     _currentHeaders[i].value.clear();
-   }
-
-  // First line of HTTP request looks like "GET /path HTTP/1.1"
-  // Retrieve the "/path" part by finding the spaces
-  int addr_start = req.indexOf(' ');
-  int addr_end = req.indexOf(' ', addr_start + 1);
-  if (addr_start == -1 || addr_end == -1) {
-    DBGWS("Invalid request\n");
-    return CLIENT_MUST_STOP;
   }
+  _hostHeader = emptyString;
 
-  String methodStr = req.substring(0, addr_start);
-  String url = req.substring(addr_start + 1, addr_end);
-  String versionEnd = req.substring(addr_end + 8);
-  _currentVersion = atoi(versionEnd.c_str());
-  String searchStr;
-  int hasSearch = url.indexOf('?');
-  if (hasSearch != -1){
-    searchStr = url.substring(hasSearch + 1);
-    url = url.substring(0, hasSearch);
-  }
-  _currentUri = url;
+  // The request line and the headers are already in the parser's arena,
+  // only the ones we use are turned into Strings
+  const RequestParser& parser = _currentSlot->parser;
+  DBGWS("request: %s %s%s%s %s\n", parser.method(), parser.uri(),
+    parser.hasQuery() ? "?" : "", parser.query(), parser.version());
+
+  _currentVersion = parser.versionMinor();
+  _currentUri = parser.uri();
   _chunked = false;
 
   if (_hook)
   {
-    auto whatNow = _hook(methodStr, url, &client, mime::getContentType);
+    auto whatNow = _hook(String(parser.method()), _currentUri, &client, mime::getContentType);
     if (whatNow != CLIENT_REQUEST_CAN_CONTINUE)
         return whatNow;
   }
 
+  const char* methodStr = parser.method();
   HTTPMethod method = HTTP_GET;
-  if (methodStr == F("HEAD")) {
+  if (strcmp_P(methodStr, PSTR("HEAD")) == 0) {
     method = HTTP_HEAD;
-  } else if (methodStr == F("POST")) {
+  } else if (strcmp_P(methodStr, PSTR("POST")) == 0) {
     method = HTTP_POST;
-  } else if (methodStr == F("DELETE")) {
+  } else if (strcmp_P(methodStr, PSTR("DELETE")) == 0) {
     method = HTTP_DELETE;
-  } else if (methodStr == F("OPTIONS")) {
+  } else if (strcmp_P(methodStr, PSTR("OPTIONS")) == 0) {
     method = HTTP_OPTIONS;
-  } else if (methodStr == F("PUT")) {
+  } else if (strcmp_P(methodStr, PSTR("PUT")) == 0) {
     method = HTTP_PUT;
-  } else if (methodStr == F("PATCH")) {
+  } else if (strcmp_P(methodStr, PSTR("PATCH")) == 0) {
     method = HTTP_PATCH;
   }
   _currentMethod = method;
@@ -100,71 +168,62 @@ typename ESP8266WebServerTemplate<ServerType>::ClientFuture ESP8266WebServerTemp
   _keepAlive = _currentVersion > 0; // Keep the connection alive by default
                                     // if the protocol version is greater than HTTP 1.0
 
+  for (int i = 0; i < parser.headerCount(); i++) {
+    const char* headerName = parser.headerName(i);
+    const char* headerValue = parser.headerValue(i);
+    _collectHeader(headerName, headerValue);
+
+    DBGWS("headerName: %s\nheaderValue: %s\n", headerName, headerValue);
+
+    if (strcasecmp_P(headerName, HOST_HEADER) == 0) {
+      _hostHeader = headerValue;
+    } else if (strcasecmp_P(headerName, CONNECTION_HEADER) == 0) {
+      _keepAlive = strcasecmp_P(headerValue, PSTR("keep-alive")) == 0;
+    }
+  }
+
   DBGWS("method: %s url: %s search: %s keepAlive=: %d\n",
-      methodStr.c_str(), url.c_str(), searchStr.c_str(), _keepAlive);
+      methodStr, _currentUri.c_str(), parser.query(), _keepAlive);
 
   //attach handler
-  RequestHandlerType* handler;
-  for (handler = _firstHandler; handler; handler = handler->next()) {
-    if (handler->canHandle(*this, _currentMethod, _currentUri))
-      break;
-  }
-  _currentHandler = handler;
+  _currentHandler = _findHandler();
 
-  String formData;
   // below is needed only when POST type request
   if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_DELETE){
+    String searchStr = parser.query();
     String boundaryStr;
-    String headerName;
-    String headerValue;
     bool isForm = false;
     bool isEncoded = false;
     uint32_t contentLength = 0;
-    //parse headers
-    while(1){
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req.isEmpty()) break; //no more headers
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1){
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 1);
-      headerValue.trim();
-       _collectHeader(headerName.c_str(),headerValue.c_str());
-
-      DBGWS("headerName: %s\nheaderValue: %s\n", headerName.c_str(), headerValue.c_str());
-
-      if (headerName.equalsIgnoreCase(FPSTR(Content_Type))){
-        using namespace mime;
-        if (headerValue.startsWith(FPSTR(mimeTable[txt].mimeType))){
-          isForm = false;
-        } else if (headerValue.startsWith(F("application/x-www-form-urlencoded"))){
-          isForm = false;
-          isEncoded = true;
-        } else if (headerValue.startsWith(F("multipart/"))){
-          boundaryStr = headerValue.substring(headerValue.indexOf('=') + 1);
-          boundaryStr.replace("\"","");
-          isForm = true;
-        }
-      } else if (headerName.equalsIgnoreCase(F("Content-Length"))){
-        contentLength = headerValue.toInt();
-      } else if (headerName.equalsIgnoreCase(F("Host"))){
-        _hostHeader = headerValue;
-      } else if (headerName.equalsIgnoreCase(F("Connection"))){
-        _keepAlive = headerValue.equalsIgnoreCase(F("keep-alive"));
+
+    const char* contentType = parser.header(FPSTR(Content_Type));
+    if (contentType) {
+      using namespace mime;
+      if (strncmp_P(contentType, mimeTable[txt].mimeType, strlen_P(mimeTable[txt].mimeType)) == 0) {
+        isForm = false;
+      } else if (strncmp_P(contentType, PSTR("application/x-www-form-urlencoded"), 33) == 0) {
+        isForm = false;
+        isEncoded = true;
+      } else if (strncmp_P(contentType, PSTR("multipart/"), 10) == 0) {
+        const char* boundary = strchr(contentType, '=');
+        boundaryStr = boundary ? boundary + 1 : contentType;
+        boundaryStr.replace("\"","");
+        isForm = true;
       }
     }
+    const char* contentLengthStr = parser.header(FPSTR(Content_Length));
+    if (contentLengthStr) {
+      contentLength = atol(contentLengthStr);
+    }
 
     String plainBuf;
-    if (   !isForm
-        && // read content into plainBuf
-           (   !readBytesWithTimeout<ServerType>(client, contentLength, plainBuf, HTTP_MAX_POST_WAIT)
-            || (plainBuf.length() < contentLength)
-           )
-       )
-    {
+    if (!isForm) {
+      // gathered by _readRequestBody(), read here after a hook
+      if (_hook)
+        readBytesWithTimeout<ServerType>(client, contentLength, plainBuf, HTTP_MAX_POST_WAIT);
+      else
+        plainBuf = std::move(_currentSlot->body);
+      if (plainBuf.length() < contentLength)
         return CLIENT_MUST_STOP;
     }
 
@@ -194,37 +253,15 @@ typename ESP8266WebServerTemplate<ServerType>::ClientFuture ESP8266WebServerTemp
       }
     }
   } else {
-    String headerName;
-    String headerValue;
-    //parse headers
-    while(1){
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req.isEmpty()) break;//no moar headers
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1){
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 2);
-      _collectHeader(headerName.c_str(),headerValue.c_str());
-
-      DBGWS("headerName: %s\nheaderValue: %s\n", headerName.c_str(), headerValue.c_str());
-
-      if (headerName.equalsIgnoreCase(F("Host"))){
-        _hostHeader = headerValue;
-      } else if (headerName.equalsIgnoreCase(F("Connection"))){
-        _keepAlive = headerValue.equalsIgnoreCase(F("keep-alive"));
-      }
-    }
-    _parseArguments(searchStr);
+    // query arguments are decoded on first access by the handler
+    _currentArgsDeferred = parser.hasQuery();
   }
   client.flush();
 
 #ifdef DEBUG_ESP_HTTP_SERVER
   DBGWS("Request: %s\nArguments: %s\nfinal list of key/value pairs:\n",
-    url.c_str(), searchStr.c_str());
-  for (int i = 0; i < _currentArgCount; i++)
+    _currentUri.c_str(), parser.query());
+  for (int i = 0; i < args(); i++)
     DBGWS("  key:'%s' value:'%s'\r\n",
       _currentArgs[i].key.c_str(),
       _currentArgs[i].value.c_str());
@@ -263,6 +300,16 @@ struct nullArgHandler
   }
 };
 
+template <typename ServerType>
+void ESP8266WebServerTemplate<ServerType>::_parseDeferredArguments() const {
+  if (_currentArgsDeferred) {
+    // args lookups are const but arguments are materialized on first use
+    auto self = const_cast<ESP8266WebServerTemplate<ServerType>*>(this);
+    self->_currentArgsDeferred = false;
+    self->_parseArguments(String(_currentSlot->parser.query()));
+  }
+}
+
 template <typename ServerType>
 void ESP8266WebServerTemplate<ServerType>::_parseArguments(const String& data) {
   if (_currentArgs)
@@ -322,28 +369,64 @@ int ESP8266WebServerTemplate<ServerType>::_parseArgumentsPrivate(const String& d
 }
 
 template <typename ServerType>
-void ESP8266WebServerTemplate<ServerType>::_uploadWriteByte(uint8_t b){
-  if (_currentUpload->currentSize == HTTP_UPLOAD_BUFLEN){
-    if(_currentHandler && _currentHandler->canUpload(*this, _currentUri))
-      _currentHandler->upload(*this, _currentUri, *_currentUpload);
-    _currentUpload->totalSize += _currentUpload->currentSize;
-    _currentUpload->currentSize = 0;
-  }
-  _currentUpload->buf[_currentUpload->currentSize++] = b;
-}
-
-template <typename ServerType>
-int ESP8266WebServerTemplate<ServerType>::_uploadReadByte(ClientType& client){
-  int res = client.read();
-  if(res == -1){
-    while(!client.available() && client.connected())
+bool ESP8266WebServerTemplate<ServerType>::_uploadFileContent(ClientType& client, const BoundaryScanner& delimiter) {
+  // Content is copied by blocks from the client's buffers into upload.buf,
+  // only up to the delimiter so that what follows stays in the client.
+  // On success upload.buf holds the last part of the file.
+  uint8_t* buf = _currentUpload->buf;
+  size_t used = 0;    // bytes in buf
+  size_t scanned = 0; // the delimiter does not start before this position
+  esp8266::polledTimeout::oneShotFastMs timeout(HTTP_MAX_POST_WAIT);
+  while (true) {
+    const bool peek = client.hasPeekBufferAPI();
+    const char* data = nullptr;
+    size_t avail = 0;
+    char c;
+    if (peek) {
+      avail = client.peekAvailable();
+      data = client.peekBuffer();
+    } else if (client.available()) {
+      c = client.read();
+      data = &c;
+      avail = 1;
+    }
+    if (!avail) {
+      if (!client.connected() || timeout)
+        return false;
       yield();
-    res = client.read();
+      continue;
+    }
+    timeout.reset();
+
+    size_t take = std::min(avail, (size_t)HTTP_UPLOAD_BUFLEN - used);
+    memcpy(buf + used, data, take);
+    int found = delimiter.find(buf, used + take, scanned);
+    if (found >= 0) {
+      if (peek)
+        client.peekConsume(found + delimiter.length() - used);
+      _currentUpload->currentSize = found;
+      return true;
+    }
+    if (peek)
+      client.peekConsume(take);
+    used += take;
+    scanned = used >= delimiter.length() ? used - delimiter.length() + 1 : 0;
+
+    if (used == HTTP_UPLOAD_BUFLEN) {
+      // keep what may be the start of the delimiter for the next block
+      size_t keep = delimiter.partial(buf, used);
+      _currentUpload->currentSize = used - keep;
+      if(_currentHandler && _currentHandler->canUpload(*this, _currentUri))
+        _currentHandler->upload(*this, _currentUri, *_currentUpload);
+      _currentUpload->totalSize += _currentUpload->currentSize;
+      _currentUpload->currentSize = 0;
+      memmove(buf, buf + used - keep, keep);
+      used = keep;
+      scanned = 0;
+    }
   }
-  return res;
 }
 
-
 template <typename ServerType>
 bool ESP8266WebServerTemplate<ServerType>::_parseForm(ClientType& client, const String& boundary, uint32_t len){
   (void) len;
@@ -356,8 +439,9 @@ bool ESP8266WebServerTemplate<ServerType>::_parseForm(ClientType& client, const
   } while (line.length() == 0 && retry < 3);
 
   client.readStringUntil('\n');
+  BoundaryScanner delimiter;
   //start reading the form
-  if (line == ("--"+boundary)){
+  if (delimiter.begin(boundary) && line == ("--"+boundary)){
     std::unique_ptr<RequestArgument[]> postArgs(new RequestArgument[WEBSERVER_MAX_POST_ARGS]);
     int postArgsLen = 0;
     while(1){
@@ -429,38 +513,8 @@ bool ESP8266WebServerTemplate<ServerType>::_parseForm(ClientType& client, const
               _currentHandler->upload(*this, _currentUri, *_currentUpload);
             _currentUpload->status = UPLOAD_FILE_WRITE;
 
-            int fastBoundaryLen = 4 /* \r\n-- */ + boundary.length() + 1 /* \0 */;
-            char fastBoundary[ fastBoundaryLen ];
-            snprintf(fastBoundary, fastBoundaryLen, "\r\n--%s", boundary.c_str());
-            int boundaryPtr = 0;
-            while ( true ) {
-                int ret = _uploadReadByte(client);
-                if (ret < 0) {
-                    // Unexpected, we should have had data available per above
-                    return _parseFormUploadAborted();
-                }
-                char in = (char) ret;
-                if (in == fastBoundary[ boundaryPtr ]) {
-                    // The input matched the current expected character, advance and possibly exit this file
-                    boundaryPtr++;
-                    if (boundaryPtr == fastBoundaryLen - 1) {
-                        // We read the whole boundary line, we're done here!
-                        break;
-                    }
-                } else {
-                    // The char doesn't match what we want, so dump whatever matches we had, the read in char, and reset ptr to start
-                    for (int i = 0; i < boundaryPtr; i++) {
-                        _uploadWriteByte( fastBoundary[ i ] );
-                    }
-                    if (in == fastBoundary[ 0 ]) {
-                       // This could be the start of the real end, mark it so and don't emit/skip it
-                       boundaryPtr = 1;
-                    } else {
-                      // Not the 1st char of our pattern, so emit and ignore
-                      _uploadWriteByte( in );
-                      boundaryPtr = 0;
-                    }
-                }
+            if (!_uploadFileContent(client, delimiter)) {
+                return _parseFormUploadAborted();
             }
             // Found the boundary string, finish processing this file upload
             if (_currentHandler && _currentHandler->canUpload(*this, _currentUri))
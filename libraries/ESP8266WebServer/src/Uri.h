@@ -6,8 +6,19 @@
 
 class Uri {
 
+    public:
+        // How the server may index this uri instead of calling canHandle()
+        // for every request. Only set by clone() of the classes the server
+        // knows about, subclasses are otherwise always asked.
+        enum RouteKind : uint8_t {
+            ROUTE_ANY,      // canHandle() must be called
+            ROUTE_EXACT,    // matches _uri only
+            ROUTE_PREFIX,   // matches uris starting with _uri up to the first '{'
+        };
+
     protected:
         const String _uri;
+        RouteKind _routeKind = ROUTE_ANY;
 
     public:
         Uri(const char *uri) : _uri(uri) {}
@@ -16,9 +27,14 @@ class Uri {
         virtual ~Uri() {}
 
         virtual Uri* clone() const {
-            return new Uri(_uri);
+            Uri* uri = new Uri(_uri);
+            uri->_routeKind = ROUTE_EXACT;
+            return uri;
         };
 
+        RouteKind routeKind() const { return _routeKind; }
+        const String& str() const { return _uri; }
+
         virtual bool canHandle(const String &requestUri, __attribute__((unused)) std::vector<String> &pathArgs) {
             return _uri == requestUri;
         }
@@ -0,0 +1,46 @@
+#include <string.h>
+#include "BoundaryScanner.h"
+
+namespace esp8266webserver {
+
+bool BoundaryScanner::begin(const String& boundary) {
+    _length = 0;
+    if (boundary.isEmpty() || boundary.length() > maxBoundaryLength)
+        return false;
+
+    memcpy(_delimiter, "\r\n--", 4);
+    memcpy(_delimiter + 4, boundary.c_str(), boundary.length());
+    _length = 4 + boundary.length();
+    _delimiter[_length] = 0;
+
+    // how far the window can move when its last byte is a given value
+    memset(_skip, _length, sizeof(_skip));
+    for (size_t i = 0; i < (size_t)_length - 1; i++)
+        _skip[(uint8_t)_delimiter[i]] = _length - 1 - i;
+    return true;
+}
+
+int BoundaryScanner::find(const uint8_t* data, size_t len, size_t from) const {
+    if (!_length)
+        return -1;
+    const uint8_t last = _delimiter[_length - 1];
+    size_t pos = from;
+    while (pos + _length <= len) {
+        uint8_t c = data[pos + _length - 1];
+        if (c == last && memcmp(data + pos, _delimiter, _length - 1) == 0)
+            return pos;
+        pos += _skip[c];
+    }
+    return -1;
+}
+
+size_t BoundaryScanner::partial(const uint8_t* data, size_t len) const {
+    size_t k = len < _length ? len : _length - 1;
+    for (; k > 0; k--) {
+        if (data[len - k] == '\r' && memcmp(data + len - k, _delimiter, k) == 0)
+            break;
+    }
+    return k;
+}
+
+} // namespace esp8266webserver
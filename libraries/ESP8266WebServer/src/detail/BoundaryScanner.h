@@ -0,0 +1,39 @@
+#ifndef BOUNDARYSCANNER_H
+#define BOUNDARYSCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+namespace esp8266webserver {
+
+// Finds the multipart delimiter ("\r\n--" + boundary) inside blocks of
+// data with a Boyer-Moore-Horspool skip table, so that uploaded content
+// can be moved in whole chunks instead of being checked byte per byte.
+class BoundaryScanner {
+public:
+    // rfc2046: boundaries are at most 70 characters long
+    static constexpr size_t maxBoundaryLength = 70;
+
+    // returns false when the boundary is empty or too long
+    bool begin(const String& boundary);
+
+    size_t length() const { return _length; }
+
+    // position of the first delimiter starting in data[from, len),
+    // or -1 when there is none
+    int find(const uint8_t* data, size_t len, size_t from = 0) const;
+
+    // length of the longest end of data[0, len) which may be the beginning
+    // of a delimiter completed by the next block
+    size_t partial(const uint8_t* data, size_t len) const;
+
+protected:
+    char _delimiter[4 + maxBoundaryLength + 1];
+    uint8_t _length = 0;
+    uint8_t _skip[256];
+};
+
+} // namespace
+
+#endif //BOUNDARYSCANNER_H
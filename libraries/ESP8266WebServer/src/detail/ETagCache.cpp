@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <algorithm>
+#include "ETagCache.h"
+
+namespace esp8266webserver {
+
+bool ETagCache::lookup(FS& fs, const String& path, String& eTag) {
+    FSStat st;
+    if (!fs.stat(path, st) || st.isDir || !st.lastWrite)
+        return false;
+
+    if (!_loaded)
+        _load(fs);
+    Entry* entry = _entry(path);
+    if (!entry || entry->size != st.size || entry->mtime != (uint32_t)st.lastWrite)
+        return false;
+    eTag = entry->eTag;
+    return true;
+}
+
+String ETagCache::get(FS& fs, const String& path, File& file) {
+    size_t size = file.size();
+    time_t mtime = file.getLastWrite();
+    if (!mtime) {
+        // size alone does not tell whether the content changed
+        return calcETag(file);
+    }
+
+    if (!_loaded)
+        _load(fs);
+    Entry* entry = _entry(path);
+    if (entry && entry->size == size && entry->mtime == (uint32_t)mtime)
+        return entry->eTag;
+
+    String eTag = calcETag(file);
+    _insert(path, size, mtime, eTag);
+    _dirty = true;
+    _changed = millis();
+    return eTag;
+}
+
+bool ETagCache::save(FS& fs) {
+    if (!_dirty)
+        return true;
+    File index = fs.open(_indexPath, "w");
+    if (!index)
+        return false;
+    for (const Entry& entry : _entries) {
+        if (!index.printf("%u %u %s %s\n", (unsigned)entry.size, (unsigned)entry.mtime, entry.eTag.c_str(), entry.path.c_str()))
+            return false;
+    }
+    _dirty = false;
+    return true;
+}
+
+bool ETagCache::saveIdle(FS& fs) {
+    if (!_dirty)
+        return true;
+    if (millis() - _changed < WEBSERVER_ETAG_SAVE_DELAY)
+        return false;
+    if (!save(fs)) {
+        // try again later, not on every call
+        _changed = millis();
+        return false;
+    }
+    return true;
+}
+
+ETagCache::Entry* ETagCache::_entry(const String& path) {
+    for (auto it = _entries.begin(); it != _entries.end(); ++it) {
+        if (it->path == path) {
+            // now the most recently used
+            std::rotate(it, it + 1, _entries.end());
+            return &_entries.back();
+        }
+    }
+    return nullptr;
+}
+
+void ETagCache::_insert(const String& path, size_t size, time_t mtime, const String& eTag) {
+    Entry* entry = _entry(path);
+    if (entry) {
+        entry->size = size;
+        entry->mtime = mtime;
+        entry->eTag = eTag;
+        return;
+    }
+    if (_entries.size() >= WEBSERVER_ETAG_CACHE_SIZE)
+        _entries.erase(_entries.begin());
+    _entries.push_back({ path, eTag, (uint32_t)size, (uint32_t)mtime });
+}
+
+void ETagCache::_load(FS& fs) {
+    _loaded = true;
+    File index = fs.open(_indexPath, "r");
+    if (!index)
+        return;
+    // "<size> <mtime> <etag> <path>", least recently used first
+    while (index.available()) {
+        String line = index.readStringUntil('\n');
+        const char* p = line.c_str();
+        char* end;
+        unsigned long size = strtoul(p, &end, 10);
+        if (*end != ' ')
+            continue;
+        unsigned long mtime = strtoul(end + 1, &end, 10);
+        if (*end != ' ')
+            continue;
+        const char* eTag = end + 1;
+        const char* path = strchr(eTag, ' ');
+        if (!path || path == eTag || !path[1])
+            continue;
+        String eTagStr;
+        eTagStr.concat(eTag, path - eTag);
+        _insert(path + 1, size, mtime, eTagStr);
+    }
+}
+
+} // namespace esp8266webserver
@@ -0,0 +1,76 @@
+#ifndef ETAGCACHE_H
+#define ETAGCACHE_H
+
+#include <vector>
+#include <FS.h>
+
+// Maximum number of ETags an ETagCache keeps in RAM
+#ifndef WEBSERVER_ETAG_CACHE_SIZE
+#define WEBSERVER_ETAG_CACHE_SIZE 32
+#endif
+
+// Time without new ETags before they are written to the index file
+#ifndef WEBSERVER_ETAG_SAVE_DELAY
+#define WEBSERVER_ETAG_SAVE_DELAY 2000
+#endif
+
+namespace esp8266webserver {
+
+String calcETag(FS &, const String &);
+String calcETag(File &);
+
+// ETags of static files, keyed by path, size and modification time.
+//
+// The most recently used entries are kept in RAM. They are written to a
+// sidecar index file on the same filesystem by save(), or by saveIdle() once
+// no new ETag was calculated for a while, and the index is loaded on first
+// use so that ETags survive reboots. A file whose size or
+// modification time changed gets a new ETag, and files without a
+// modification time are never cached.
+class ETagCache {
+public:
+    explicit ETagCache(const String& indexPath) : _indexPath(indexPath) { }
+
+    const String& indexPath() const { return _indexPath; }
+
+    // Cached ETag of the file at path, when FS::stat() tells it did not
+    // change since, so that the file need not be opened. False otherwise.
+    bool lookup(FS& fs, const String& path, String& eTag);
+
+    // ETag of file, opened from path: cached when its size and modification
+    // time did not change, otherwise calculated with calcETag() and stored
+    String get(FS& fs, const String& path, File& file);
+
+    // Write the entries to the index file, when they changed since it was
+    // loaded or saved. Returns false when it could not be written.
+    bool save(FS& fs);
+
+    // Same, once the entries did not change for WEBSERVER_ETAG_SAVE_DELAY ms.
+    // Returns false while some are left to write.
+    bool saveIdle(FS& fs);
+
+    bool dirty() const { return _dirty; }
+
+protected:
+    struct Entry {
+        String path;
+        String eTag;
+        uint32_t size;
+        uint32_t mtime;
+    };
+
+    Entry* _entry(const String& path);
+    void _insert(const String& path, size_t size, time_t mtime, const String& eTag);
+    void _load(FS& fs);
+
+    String _indexPath;
+    // least recently used first
+    std::vector<Entry> _entries;
+    bool _loaded = false;
+    bool _dirty = false;
+    unsigned long _changed = 0; // millis() of the last change
+};
+
+} // namespace
+
+#endif //ETAGCACHE_H
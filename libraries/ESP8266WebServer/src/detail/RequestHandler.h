@@ -54,6 +54,24 @@ public:
         (void) upload;
     }
 
+    // uri checked by canHandle() (besides method and filter), lets the
+    // server index this handler, nullptr when it must always be asked
+    virtual const Uri* routeUri() const {
+        return nullptr;
+    }
+
+    // static file handlers: write the ETags cached in RAM to their index
+    // file, returns false when it could not be written
+    virtual bool saveETags() {
+        return true;
+    }
+
+    // same, when no new ETag was calculated for WEBSERVER_ETAG_SAVE_DELAY ms,
+    // returns false while some are left to write
+    virtual bool saveETagsIdle() {
+        return true;
+    }
+
     RequestHandler<ServerType>* next() {
         return _next;
     }
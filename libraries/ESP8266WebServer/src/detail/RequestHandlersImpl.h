@@ -6,11 +6,10 @@
 #include "mimetable.h"
 #include "WString.h"
 #include "Uri.h"
+#include "ETagCache.h"
 
 namespace esp8266webserver {
 
-String calcETag(FS &, const String &);
-
 template<typename ServerType>
 class FunctionRequestHandler : public RequestHandler<ServerType> {
     using WebServerType = ESP8266WebServerTemplate<ServerType>;
@@ -69,6 +68,10 @@ public:
             _ufn();
     }
 
+    const Uri* routeUri() const override {
+        return _uri;
+    }
+
     FunctionRequestHandler& setFilter(typename WebServerType::FilterFunction filter) {
         _filter = filter;
         return *this;
@@ -124,7 +127,8 @@ public:
     StaticDirectoryRequestHandler(FS& fs, const char* path, const char* uri, const char* cache_header)
         :
     SRH(fs, path, uri, cache_header),
-    _baseUriLength{SRH::_uri.length()}
+    _baseUriLength{SRH::_uri.length()},
+    _eTags{SRH::_path + (SRH::_path.endsWith("/") ? ".etags" : "/.etags")}
     {}
 
     bool canHandle(HTTPMethod requestMethod, const String& requestUri) override {
@@ -173,6 +177,19 @@ public:
                 path += FPSTR(mimeTable[gz].endsWith);
         }
 
+        // the ETag index is not part of the content
+        if (path == _eTags.indexPath())
+            return false;
+
+        // a conditional request for an unchanged file is answered without
+        // opening it
+        bool cached = server._eTagEnabled && !server._eTagFunction
+                      && _eTags.lookup(SRH::_fs, path, eTagCode);
+        if (cached && server.header("If-None-Match") == eTagCode) {
+            server.send(304);
+            return true;
+        }
+
         File f = SRH::_fs.open(path, "r");
         if (!f)
             return false;
@@ -182,11 +199,12 @@ public:
             return false;
         }
 
-        if (server._eTagEnabled) {
+        if (server._eTagEnabled && !cached) {
             if (server._eTagFunction) {
                 eTagCode = (server._eTagFunction)(SRH::_fs, path);
             } else {
-                eTagCode = esp8266webserver::calcETag(SRH::_fs, path);
+                eTagCode = _eTags.get(SRH::_fs, path, f);
+                server._eTagsUnsaved |= _eTags.dirty();
             }
 
             if (server.header("If-None-Match") == eTagCode) {
@@ -212,8 +230,17 @@ public:
         return *this;
     }
 
+    bool saveETags() override {
+        return _eTags.save(SRH::_fs);
+    }
+
+    bool saveETagsIdle() override {
+        return _eTags.saveIdle(SRH::_fs);
+    }
+
 protected:
     size_t _baseUriLength;
+    ETagCache _eTags; // <path>/.etags
     typename WebServerType::FilterFunction _filter;
 };
 
@@ -230,7 +257,8 @@ public StaticRequestHandler<ServerType> {
 public:
     StaticFileRequestHandler(FS& fs, const char* path, const char* uri, const char* cache_header)
         :
-    StaticRequestHandler<ServerType>{fs, path, uri, cache_header}
+    StaticRequestHandler<ServerType>{fs, path, uri, cache_header},
+    _eTags{SRH::_path + ".etag"}
     {
     }
 
@@ -246,17 +274,12 @@ public:
         if (!canHandle(server, requestMethod, requestUri))
             return false;
 
-        if (server._eTagEnabled) {
-            if (server._eTagFunction) {
-                _eTagCode = (server._eTagFunction)(SRH::_fs, SRH::_path);
-            } else  if (_eTagCode.isEmpty()) {
-                _eTagCode = esp8266webserver::calcETag(SRH::_fs, SRH::_path);
-            }
-
-            if (server.header("If-None-Match") == _eTagCode) {
-                server.send(304);
-                return true;
-            }
+        String eTagCode;
+        bool cached = server._eTagEnabled && !server._eTagFunction
+                      && _eTags.lookup(SRH::_fs, SRH::_path, eTagCode);
+        if (cached && server.header("If-None-Match") == eTagCode) {
+            server.send(304);
+            return true;
         }
 
         File f = SRH::_fs.open(SRH::_path, "r");
@@ -269,11 +292,25 @@ public:
             return false;
         }
 
+        if (server._eTagEnabled && !cached) {
+            if (server._eTagFunction) {
+                eTagCode = (server._eTagFunction)(SRH::_fs, SRH::_path);
+            } else {
+                eTagCode = _eTags.get(SRH::_fs, SRH::_path, f);
+                server._eTagsUnsaved |= _eTags.dirty();
+            }
+
+            if (server.header("If-None-Match") == eTagCode) {
+                server.send(304);
+                return true;
+            }
+        }
+
         if (SRH::_cache_header.length() != 0)
             server.sendHeader("Cache-Control", SRH::_cache_header);
 
-        if ((server._eTagEnabled) && (_eTagCode.length() > 0)) {
-            server.sendHeader("ETag", _eTagCode);
+        if ((server._eTagEnabled) && (eTagCode.length() > 0)) {
+            server.sendHeader("ETag", eTagCode);
         }
 
         server.streamFile(f, mime::getContentType(SRH::_path), requestMethod);
@@ -285,8 +322,16 @@ public:
         return *this;
     }
 
+    bool saveETags() override {
+        return _eTags.save(SRH::_fs);
+    }
+
+    bool saveETagsIdle() override {
+        return _eTags.saveIdle(SRH::_fs);
+    }
+
 protected:
-    String _eTagCode; // ETag code calculated for this file as used in http header include quotes.
+    ETagCache _eTags; // <path>.etag
     typename WebServerType::FilterFunction _filter;
 };
 
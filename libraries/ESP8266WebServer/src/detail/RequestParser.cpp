@@ -0,0 +1,226 @@
+#include <stdlib.h>
+#include <string.h>
+#include "pgmspace.h"
+#include "RequestParser.h"
+
+namespace esp8266webserver {
+
+static_assert(WEBSERVER_REQUEST_MAX_HEAD >= WEBSERVER_REQUEST_ARENA
+              && WEBSERVER_REQUEST_MAX_HEAD <= 0xffff, "slices are 16 bits offsets");
+
+void RequestParser::reset() {
+    // back to the embedded arena
+    _release();
+    // offset 0 is an empty string, shared by all empty slices
+    _arena[0] = 0;
+    _used = 1;
+    _mark = 1;
+    _method = _uri = _query = _version = { 0, 0 };
+    _headerCount = 0;
+    _state = S_METHOD;
+    _keep = false;
+    _error = 0;
+}
+
+int RequestParser::versionMinor() const {
+    // "HTTP/1.x"
+    if (_version.length < 8)
+        return 0;
+    return atoi(version() + 7);
+}
+
+const char* RequestParser::header(const __FlashStringHelper* name) const {
+    for (int i = 0; i < _headerCount; i++) {
+        if (strcasecmp_P(headerName(i), (PGM_P)name) == 0)
+            return headerValue(i);
+    }
+    return nullptr;
+}
+
+bool RequestParser::_push(char c) {
+    // always keep room for the terminating nul
+    if (_used >= _size - 1 && !_grow())
+        return false;
+    _arena[_used++] = c;
+    return true;
+}
+
+bool RequestParser::_grow() {
+    if (_size >= WEBSERVER_REQUEST_MAX_HEAD)
+        return false;
+    size_t size = 2 * (size_t)_size;
+    if (size > WEBSERVER_REQUEST_MAX_HEAD)
+        size = WEBSERVER_REQUEST_MAX_HEAD;
+    char* arena;
+    if (_arena == _inline) {
+        arena = (char*)malloc(size);
+        if (arena)
+            memcpy(arena, _inline, _used);
+    } else {
+        arena = (char*)realloc(_arena, size);
+    }
+    if (!arena)
+        return false;
+    _arena = arena;
+    _size = size;
+    return true;
+}
+
+void RequestParser::_release() {
+    if (_arena != _inline)
+        free(_arena);
+    _arena = _inline;
+    _size = sizeof(_inline);
+}
+
+void RequestParser::_fail(int error) {
+    _state = S_ERROR;
+    _error = error;
+}
+
+void RequestParser::_begin() {
+    _mark = _used;
+}
+
+bool RequestParser::_end(Slice& s) {
+    if (_used == _mark) {
+        s = { 0, 0 };
+        return false;
+    }
+    s.offset = _mark;
+    s.length = _used - _mark;
+    _arena[_used++] = 0;
+    return true;
+}
+
+size_t RequestParser::feed(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len && _state != S_DONE && _state != S_ERROR) {
+        char c = data[i++];
+        switch (_state) {
+        case S_METHOD:
+            if (c == ' ') {
+                if (_end(_method))
+                    _state = S_URI;
+                else
+                    _fail(400);
+                _begin();
+            } else if (c == '\r' || c == '\n') {
+                _fail(400);
+            } else if (!_push(c)) {
+                _fail(414);
+            }
+            break;
+
+        case S_URI:
+        case S_QUERY:
+            if (c == ' ' || (c == '?' && _state == S_URI)) {
+                if (_state == S_URI) {
+                    if (!_end(_uri)) {
+                        _fail(400);
+                        break;
+                    }
+                } else {
+                    _end(_query);
+                }
+                _state = c == '?' ? S_QUERY : S_VERSION;
+                _begin();
+            } else if (c == '\r' || c == '\n') {
+                _fail(400);
+            } else if (!_push(c)) {
+                _fail(414);
+            }
+            break;
+
+        case S_VERSION:
+            if (c == '\r' || c == '\n') {
+                _end(_version);
+                _state = c == '\r' ? S_LINE_LF : S_HEADER_START;
+            } else if (!_push(c)) {
+                _fail(414);
+            }
+            break;
+
+        case S_LINE_LF:
+            if (c == '\n')
+                _state = S_HEADER_START;
+            else
+                _fail(400);
+            break;
+
+        case S_HEADER_START:
+            if (c == '\r') {
+                _state = S_END_LF;
+                break;
+            }
+            if (c == '\n') {
+                _state = S_DONE;
+                break;
+            }
+            _begin();
+            _state = S_HEADER_NAME;
+            /* fall through */
+
+        case S_HEADER_NAME:
+            if (c == ':') {
+                Slice name;
+                _keep = _end(name) && (!_filter || _filter(_filterContext, _ptr(name)));
+                if (!_keep) {
+                    // forget about this header
+                    _used = _mark;
+                } else if (_headerCount == WEBSERVER_REQUEST_MAX_HEADERS) {
+                    // never silently drop a wanted one (Content-Length...)
+                    _fail(431);
+                    break;
+                } else {
+                    _headers[_headerCount].name = name;
+                }
+                _state = S_VALUE_SPACE;
+            } else if (c == '\r' || c == '\n') {
+                // not a header line, ignore it
+                _used = _mark;
+                _state = c == '\r' ? S_LINE_LF : S_HEADER_START;
+            } else if (!_push(c)) {
+                // names are kept until the filter has seen them
+                _fail(431);
+            }
+            break;
+
+        case S_VALUE_SPACE:
+            if (c == ' ' || c == '\t')
+                break;
+            _begin();
+            _state = S_VALUE;
+            /* fall through */
+
+        case S_VALUE:
+            if (c == '\r' || c == '\n') {
+                if (_keep) {
+                    while (_used > _mark && (_arena[_used - 1] == ' ' || _arena[_used - 1] == '\t'))
+                        _used--;
+                    _end(_headers[_headerCount].value);
+                    _headerCount++;
+                }
+                _state = c == '\r' ? S_LINE_LF : S_HEADER_START;
+            } else if (_keep && !_push(c)) {
+                // a wanted header does not fit
+                _fail(431);
+            }
+            break;
+
+        case S_END_LF:
+            if (c == '\n')
+                _state = S_DONE;
+            else
+                _fail(400);
+            break;
+
+        case S_DONE:
+        case S_ERROR:
+            break;
+        }
+    }
+    return i;
+}
+
+} // namespace esp8266webserver
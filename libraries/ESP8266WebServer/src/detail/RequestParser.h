@@ -0,0 +1,140 @@
+#ifndef REQUESTPARSER_H
+#define REQUESTPARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "WString.h"
+
+// Size of the buffer embedded in the parser holding the request line and the
+// collected header names/values of one request. Longer request heads move to
+// the heap, up to WEBSERVER_REQUEST_MAX_HEAD bytes.
+#ifndef WEBSERVER_REQUEST_ARENA
+#define WEBSERVER_REQUEST_ARENA 1024
+#endif
+
+// Largest request line and collected headers, above that the request is
+// rejected with 414 (request line) or 431 (headers)
+#ifndef WEBSERVER_REQUEST_MAX_HEAD
+#define WEBSERVER_REQUEST_MAX_HEAD 8192
+#endif
+
+// Maximum number of header lines kept per request, one more collected header
+// rejects the request with 431
+#ifndef WEBSERVER_REQUEST_MAX_HEADERS
+#define WEBSERVER_REQUEST_MAX_HEADERS 16
+#endif
+
+namespace esp8266webserver {
+
+// Incremental HTTP request-head parser.
+//
+// Bytes are fed as they come (typically straight from a client's
+// peekBuffer()) and are never copied into String objects: method, uri,
+// query, version and the header lines selected by the filter are stored
+// as nul-terminated slices of a single arena, which stays valid until the
+// next reset().  The arena is embedded, and moves to the heap for the
+// requests which do not fit.
+class RequestParser {
+public:
+    // called with a nul-terminated header name, return true to store its value
+    using HeaderFilter = bool (*)(void* context, const char* name);
+
+    RequestParser() : _arena(_inline), _size(sizeof(_inline)) { reset(); }
+    ~RequestParser() { _release(); }
+    RequestParser(const RequestParser&) = delete;
+    RequestParser& operator=(const RequestParser&) = delete;
+
+    void reset();
+    void setHeaderFilter(HeaderFilter filter, void* context) {
+        _filter = filter;
+        _filterContext = context;
+    }
+
+    // parse up to len bytes, returns how many were used.
+    // Parsing stops right after the empty line ending the request head,
+    // leaving any body or pipelined data unconsumed.
+    size_t feed(const char* data, size_t len);
+
+    bool done() const { return _state == S_DONE; }
+    bool failed() const { return _state == S_ERROR; }
+    // HTTP status to answer a failed request with: 400, 414 or 431
+    int error() const { return _error; }
+
+    const char* method() const { return _ptr(_method); }
+    const char* uri() const { return _ptr(_uri); }
+    const char* query() const { return _ptr(_query); }
+    const char* version() const { return _ptr(_version); }
+    bool hasQuery() const { return _query.length > 0; }
+    // minor version number of "HTTP/1.x", 0 when unknown
+    int versionMinor() const;
+
+    int headerCount() const { return _headerCount; }
+    const char* headerName(int i) const { return _ptr(_headers[i].name); }
+    const char* headerValue(int i) const { return _ptr(_headers[i].value); }
+    // case insensitive lookup, returns nullptr when the header was not kept
+    const char* header(const __FlashStringHelper* name) const;
+
+    // bytes of the arena used by the current request, and its size
+    size_t used() const { return _used; }
+    size_t capacity() const { return _size; }
+
+protected:
+    struct Slice {
+        uint16_t offset;
+        uint16_t length;
+    };
+
+    struct Header {
+        Slice name;
+        Slice value;
+    };
+
+    enum State : uint8_t {
+        S_METHOD,
+        S_URI,
+        S_QUERY,
+        S_VERSION,
+        S_LINE_LF,
+        S_HEADER_START,
+        S_HEADER_NAME,
+        S_VALUE_SPACE,
+        S_VALUE,
+        S_END_LF,
+        S_DONE,
+        S_ERROR,
+    };
+
+    const char* _ptr(const Slice& s) const { return _arena + s.offset; }
+    bool _push(char c);
+    bool _grow();
+    void _release();
+    void _fail(int error);
+    void _begin();
+    bool _end(Slice& s);
+
+    char _inline[WEBSERVER_REQUEST_ARENA];
+    // _inline or heap
+    char* _arena;
+    uint16_t _size;
+    uint16_t _used;
+    // arena position where the slice being parsed starts
+    uint16_t _mark;
+
+    Slice _method;
+    Slice _uri;
+    Slice _query;
+    Slice _version;
+    Header _headers[WEBSERVER_REQUEST_MAX_HEADERS];
+    uint8_t _headerCount;
+    State _state;
+    // whether the header line being parsed is kept
+    bool _keep;
+    uint16_t _error;
+
+    HeaderFilter _filter = nullptr;
+    void* _filterContext = nullptr;
+};
+
+} // namespace
+
+#endif //REQUESTPARSER_H
@@ -0,0 +1,144 @@
+#include <string.h>
+#include <algorithm>
+#include "RouteIndex.h"
+
+namespace esp8266webserver {
+
+void RouteIndex::clear() {
+    _exact.clear();
+    _buckets.clear();
+    _mask = 0;
+    _nodes.clear();
+    _always.clear();
+}
+
+uint32_t RouteIndex::hash(const char* str, size_t len) {
+    // FNV-1a
+    uint32_t h = 2166136261u;
+    while (len--) {
+        h ^= (uint8_t)*str++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void RouteIndex::addExact(const String& path, Id id) {
+    _exact.push_back({ hash(path.c_str(), path.length()), id });
+}
+
+void RouteIndex::addAlways(Id id) {
+    _always.push_back(id);
+}
+
+void RouteIndex::addPrefix(const String& prefix, Id id) {
+    if (_nodes.empty())
+        _nodes.emplace_back();
+
+    size_t node = 0;
+    size_t pos = 0;
+    while (pos < prefix.length()) {
+        int next = -1;
+        for (uint16_t child : _nodes[node].children) {
+            if (_nodes[child].label[0] == prefix[pos]) {
+                next = child;
+                break;
+            }
+        }
+
+        if (next < 0) {
+            Node leaf;
+            leaf.label = prefix.substring(pos);
+            _nodes.push_back(std::move(leaf));
+            _nodes[node].children.push_back(_nodes.size() - 1);
+            node = _nodes.size() - 1;
+            break;
+        }
+
+        const String& label = _nodes[next].label;
+        size_t common = 1;
+        while (common < label.length() && pos + common < prefix.length()
+               && label[common] == prefix[pos + common])
+            common++;
+
+        if (common < label.length()) {
+            // split the edge: the new node takes the common part
+            Node split;
+            split.label = label.substring(0, common);
+            split.children.push_back(next);
+            _nodes[next].label = _nodes[next].label.substring(common);
+            _nodes.push_back(std::move(split));
+            uint16_t splitIndex = _nodes.size() - 1;
+            for (uint16_t& child : _nodes[node].children) {
+                if (child == next)
+                    child = splitIndex;
+            }
+            next = splitIndex;
+        }
+
+        node = next;
+        pos += common;
+    }
+    _nodes[node].ids.push_back(id);
+}
+
+void RouteIndex::build() {
+    // power of two number of buckets, at least as many as paths
+    size_t count = 1;
+    while (count < _exact.size())
+        count <<= 1;
+    _mask = count - 1;
+
+    // group by bucket, keeping the registration order inside each one
+    std::stable_sort(_exact.begin(), _exact.end(), [this](const Exact& a, const Exact& b) {
+        return (a.hash & _mask) < (b.hash & _mask);
+    });
+    _buckets.assign(count + 1, 0);
+    for (const Exact& e : _exact)
+        _buckets[(e.hash & _mask) + 1]++;
+    for (size_t i = 0; i < count; i++)
+        _buckets[i + 1] += _buckets[i];
+}
+
+void RouteIndex::candidates(const String& uri, std::vector<Id>& ids) const {
+    ids.clear();
+
+    if (!_exact.empty()) {
+        uint32_t h = hash(uri.c_str(), uri.length());
+        size_t bucket = h & _mask;
+        for (size_t i = _buckets[bucket]; i < _buckets[bucket + 1]; i++) {
+            if (_exact[i].hash == h)
+                ids.push_back(_exact[i].id);
+        }
+    }
+
+    if (!_nodes.empty()) {
+        const char* str = uri.c_str();
+        size_t len = uri.length();
+        size_t pos = 0;
+        size_t node = 0;
+        while (true) {
+            ids.insert(ids.end(), _nodes[node].ids.begin(), _nodes[node].ids.end());
+            if (pos >= len)
+                break;
+            int next = -1;
+            for (uint16_t child : _nodes[node].children) {
+                const String& label = _nodes[child].label;
+                if (label[0] == str[pos]) {
+                    if (label.length() <= len - pos && memcmp(label.c_str(), str + pos, label.length()) == 0)
+                        next = child;
+                    break;
+                }
+            }
+            if (next < 0)
+                break;
+            pos += _nodes[next].label.length();
+            node = next;
+        }
+    }
+
+    ids.insert(ids.end(), _always.begin(), _always.end());
+    if (ids.size() > 1)
+        std::sort(ids.begin(), ids.end());
+}
+
+} // namespace esp8266webserver
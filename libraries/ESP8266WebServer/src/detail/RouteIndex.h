@@ -0,0 +1,55 @@
+#ifndef ROUTEINDEX_H
+#define ROUTEINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "WString.h"
+
+namespace esp8266webserver {
+
+// Index of the routes of a server, numbered in registration order.
+//
+// Exact paths are kept in a hash table and the literal beginning of
+// UriBraces patterns (up to the first '{') in a compressed prefix trie.
+// Routes the index cannot reason about (UriGlob, UriRegex, custom
+// handlers) are always candidates. candidates() only narrows the search:
+// the caller still asks each candidate, in order, whether it matches.
+class RouteIndex {
+public:
+    using Id = uint16_t;
+
+    void clear();
+    void addExact(const String& path, Id id);
+    void addPrefix(const String& prefix, Id id);
+    void addAlways(Id id);
+    // to be called after the last add*() and before candidates()
+    void build();
+
+    // ids of the routes which may match uri, in ascending order
+    void candidates(const String& uri, std::vector<Id>& ids) const;
+
+    static uint32_t hash(const char* str, size_t len);
+
+protected:
+    struct Exact {
+        uint32_t hash;
+        Id id;
+    };
+
+    struct Node {
+        String label;                  // characters from the parent node
+        std::vector<uint16_t> children;
+        std::vector<Id> ids;           // routes whose prefix ends here
+    };
+
+    std::vector<Exact> _exact;         // grouped by bucket after build()
+    std::vector<uint16_t> _buckets;    // start of each bucket in _exact
+    uint16_t _mask = 0;
+    std::vector<Node> _nodes;          // _nodes[0] is the root
+    std::vector<Id> _always;
+};
+
+} // namespace
+
+#endif //ROUTEINDEX_H
@@ -2,23 +2,32 @@
 
 namespace esp8266webserver {
 
-// calculate an ETag for a file in filesystem based on md5 checksum
+// calculate an ETag for an open file based on md5 checksum
 // that can be used in the http headers - include quotes.
-String calcETag(FS &fs, const String &path) {
+// The file is read from its current position, then rewound.
+String calcETag(File &f) {
     String result;
 
     // calculate eTag using md5 checksum
     uint8_t md5_buf[16];
-    File f = fs.open(path, "r");
     MD5Builder calcMD5;
     calcMD5.begin();
     calcMD5.addStream(f, f.size());
     calcMD5.calculate();
     calcMD5.getBytes(md5_buf);
-    f.close();
+    f.seek(0);
     // create a minimal-length eTag using base64 byte[]->text encoding.
     result = "\"" + base64::encode(md5_buf, 16, false) + "\"";
     return(result);
 }
 
+// calculate an ETag for a file in filesystem based on md5 checksum
+// that can be used in the http headers - include quotes.
+String calcETag(FS &fs, const String &path) {
+    File f = fs.open(path, "r");
+    String result = calcETag(f);
+    f.close();
+    return(result);
+}
+
 } // namespace esp8266webserver
@@ -10,7 +10,9 @@ class UriBraces : public Uri {
         explicit UriBraces(const String &uri) : Uri(uri) {};
 
         Uri* clone() const override final {
-            return new UriBraces(_uri);
+            UriBraces* uri = new UriBraces(_uri);
+            uri->_routeKind = ROUTE_PREFIX;
+            return uri;
         };
 
         bool canHandle(const String &requestUri, std::vector<String> &pathArgs) override final {
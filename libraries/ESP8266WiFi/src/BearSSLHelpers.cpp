@@ -30,6 +30,7 @@
 #include <Arduino.h>
 #include <StackThunk.h>
 #include <Updater_Signing.h>
+#include <coredecls.h>
 #ifndef ARDUINO_SIGNING
   #define ARDUINO_SIGNING 0
 #endif
@@ -893,6 +894,197 @@ const br_ssl_session_cache_class **ServerSessions::getCache() {
   return _size > 0 ? &_cache.vtable : nullptr;
 }
 
+SessionCache::SessionCache(uint8_t size) :
+  _entries(size > 0 ? new Entry[size] : nullptr),
+  _size(_entries != nullptr ? size : 0), _stamp(0) {
+    clear();
+}
+
+SessionCache::~SessionCache() {
+  delete[] _entries;
+}
+
+uint8_t SessionCache::count() const {
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < _size; i++) {
+    if (_entries[i].key) {
+      n++;
+    }
+  }
+  return n;
+}
+
+void SessionCache::clear() {
+  for (uint8_t i = 0; i < _size; i++) {
+    memset(&_entries[i], 0, sizeof(Entry));
+  }
+  _stamp = 0;
+}
+
+// FNV-1a over the lowercased host name (or the address when connecting by IP) and the port
+uint32_t SessionCache::makeKey(const char *hostName, IPAddress ip, uint16_t port) {
+  uint32_t h = 2166136261u;
+  auto mix = [&h](uint8_t b) { h = (h ^ b) * 16777619u; };
+  if (hostName && *hostName) {
+    for (const char *c = hostName; *c; c++) {
+      mix(tolower(*c));
+    }
+  } else {
+    for (int i = 0; i < 4; i++) {
+      mix(ip[i]);
+    }
+  }
+  mix(port & 0xff);
+  mix(port >> 8);
+  return h ? h : 1; // 0 marks a free slot
+}
+
+const br_ssl_session_parameters *SessionCache::find(uint32_t key) {
+  for (uint8_t i = 0; i < _size; i++) {
+    if (_entries[i].key == key) {
+      _entries[i].used = ++_stamp;
+      return &_entries[i].params;
+    }
+  }
+  return nullptr;
+}
+
+void SessionCache::store(uint32_t key, const br_ssl_session_parameters *params) {
+  if (!_size || !params->session_id_len) {
+    return;
+  }
+  // Same host, a free slot, or else the least recently used one
+  Entry *slot = &_entries[0];
+  for (uint8_t i = 0; i < _size; i++) {
+    Entry *e = &_entries[i];
+    if (e->key == key) {
+      slot = e;
+      break;
+    }
+    if (slot->key && (!e->key || e->used < slot->used)) {
+      slot = e;
+    }
+  }
+  slot->key = key;
+  slot->used = ++_stamp;
+  memcpy(&slot->params, params, sizeof(slot->params));
+}
+
+void SessionCache::remove(uint32_t key) {
+  for (uint8_t i = 0; i < _size; i++) {
+    if (_entries[i].key == key) {
+      memset(&_entries[i], 0, sizeof(Entry));
+    }
+  }
+}
+
+// Serialized form: magic, count, CRC32 of the records, then count records of
+// key + session parameters, most recently used first.
+static constexpr uint32_t SESSION_CACHE_MAGIC = 0x31435354; // "TSC1"
+static constexpr size_t SESSION_CACHE_HEADER = 3 * sizeof(uint32_t);
+static constexpr size_t SESSION_CACHE_RECORD = sizeof(uint32_t) + sizeof(br_ssl_session_parameters);
+
+size_t SessionCache::serialize(uint8_t *buf, size_t len) const {
+  if (len < SESSION_CACHE_HEADER) {
+    return 0;
+  }
+  uint32_t n = 0;
+  uint32_t last = UINT32_MAX;
+  uint8_t *rec = buf + SESSION_CACHE_HEADER;
+  while (len - (rec - buf) >= SESSION_CACHE_RECORD) {
+    // Next most recent entry below the last one written
+    const Entry *best = nullptr;
+    for (uint8_t i = 0; i < _size; i++) {
+      const Entry *e = &_entries[i];
+      if (e->key && e->used < last && (!best || e->used > best->used)) {
+        best = e;
+      }
+    }
+    if (!best) {
+      break;
+    }
+    memcpy(rec, &best->key, sizeof(uint32_t));
+    memcpy(rec + sizeof(uint32_t), &best->params, sizeof(best->params));
+    rec += SESSION_CACHE_RECORD;
+    last = best->used;
+    n++;
+  }
+  uint32_t hdr[3] = { SESSION_CACHE_MAGIC, n, crc32(buf + SESSION_CACHE_HEADER, n * SESSION_CACHE_RECORD) };
+  memcpy(buf, hdr, sizeof(hdr));
+  return rec - buf;
+}
+
+bool SessionCache::deserialize(const uint8_t *buf, size_t len) {
+  uint32_t hdr[3];
+  if (len < SESSION_CACHE_HEADER) {
+    return false;
+  }
+  memcpy(hdr, buf, sizeof(hdr));
+  if ((hdr[0] != SESSION_CACHE_MAGIC) || (hdr[1] > (len - SESSION_CACHE_HEADER) / SESSION_CACHE_RECORD) ||
+      (hdr[2] != crc32(buf + SESSION_CACHE_HEADER, hdr[1] * SESSION_CACHE_RECORD))) {
+    return false;
+  }
+  clear();
+  // Insert oldest first so the LRU order is kept, extra ones fall out
+  for (uint32_t i = hdr[1]; i > 0; i--) {
+    const uint8_t *rec = buf + SESSION_CACHE_HEADER + (i - 1) * SESSION_CACHE_RECORD;
+    uint32_t key;
+    br_ssl_session_parameters params;
+    memcpy(&key, rec, sizeof(key));
+    memcpy(&params, rec + sizeof(key), sizeof(params));
+    if (key) {
+      store(key, &params);
+    }
+  }
+  return true;
+}
+
+bool SessionCache::saveToRTC(uint32_t offset) {
+  if (offset * 4 >= 512) {
+    return false;
+  }
+  uint32_t buf[128];
+  size_t len = serialize((uint8_t *)buf, 512 - offset * 4);
+  len = (len + 3) & ~3;
+  return len && ESP.rtcUserMemoryWrite(offset, buf, len);
+}
+
+bool SessionCache::loadFromRTC(uint32_t offset) {
+  if (offset * 4 >= 512) {
+    return false;
+  }
+  uint32_t buf[128];
+  size_t len = 512 - offset * 4;
+  return ESP.rtcUserMemoryRead(offset, buf, len) && deserialize((const uint8_t *)buf, len);
+}
+
+size_t SessionCache::save(Print &out) const {
+  size_t len = SESSION_CACHE_HEADER + _size * SESSION_CACHE_RECORD;
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[len]);
+  if (!buf) {
+    return 0;
+  }
+  len = serialize(buf.get(), len);
+  return out.write(buf.get(), len);
+}
+
+bool SessionCache::load(Stream &in) {
+  uint32_t hdr[3];
+  if (in.readBytes((uint8_t *)hdr, sizeof(hdr)) != sizeof(hdr) || hdr[0] != SESSION_CACHE_MAGIC || hdr[1] > 255) {
+    return false;
+  }
+  size_t len = SESSION_CACHE_HEADER + hdr[1] * SESSION_CACHE_RECORD;
+  std::unique_ptr<uint8_t[]> buf(new uint8_t[len]);
+  if (!buf) {
+    return false;
+  }
+  memcpy(buf.get(), hdr, sizeof(hdr));
+  if (in.readBytes(buf.get() + sizeof(hdr), len - sizeof(hdr)) != len - sizeof(hdr)) {
+    return false;
+  }
+  return deserialize(buf.get(), len);
+}
+
 // SHA256 hash for updater
 void HashSHA256::begin() {
   br_sha256_init( &_cc );
@@ -26,6 +26,7 @@
 #include <bearssl/bearssl.h>
 #include <StackThunk.h>
 #include <Updater.h>
+#include <IPAddress.h>
 
 // Internal opaque structures, not needed by user applications
 namespace brssl {
@@ -150,6 +151,60 @@ class Session {
     br_ssl_session_parameters _session;
 };
 
+// Bounded cache of client sessions for multiple servers, keyed by host name
+// (or IP address) and port, with least recently used replacement.
+// Use with BearSSL::WiFiClientSecure::setSessionCache to have sessions
+// looked up on connect and stored after each handshake automatically.
+// BearSSL resumes through session IDs (RFC 5077 tickets are not supported).
+class SessionCache {
+  friend class WiFiClientSecureCtx;
+
+  public:
+    // Dynamically allocates room for the given number of sessions.
+    // If the allocation wasn't successful, the value returned by size() will be 0.
+    SessionCache(uint8_t size = 4);
+    SessionCache(const SessionCache&) = delete;
+    SessionCache& operator=(const SessionCache&) = delete;
+    ~SessionCache();
+
+    // Returns the number of sessions the cache can hold, and currently holds.
+    uint8_t size() const { return _size; }
+    uint8_t count() const;
+
+    // Forget all sessions, e.g. after the device's time or trust anchors changed.
+    void clear();
+
+    // Save to/restore from RTC user memory (offset in 4-byte blocks) so
+    // sessions survive deep sleep.  The most recently used sessions are kept
+    // when not all fit.  Blocks below 32 are used by OTA, so start above.
+    bool saveToRTC(uint32_t offset = 32);
+    bool loadFromRTC(uint32_t offset = 32);
+
+    // Save to/restore from a stream, e.g. a file.  Returns bytes written, or success.
+    size_t save(Print &out) const;
+    bool load(Stream &in);
+
+  private:
+    struct Entry {
+      uint32_t key; // Hash of host and port, 0 for free slots
+      uint32_t used; // LRU stamp
+      br_ssl_session_parameters params;
+    };
+
+    static uint32_t makeKey(const char *hostName, IPAddress ip, uint16_t port);
+    const br_ssl_session_parameters *find(uint32_t key);
+    void store(uint32_t key, const br_ssl_session_parameters *params);
+    void remove(uint32_t key);
+
+    // Serialized form shared by RTC and stream storage
+    size_t serialize(uint8_t *buf, size_t len) const;
+    bool deserialize(const uint8_t *buf, size_t len);
+
+    Entry *_entries;
+    uint8_t _size;
+    uint32_t _stamp;
+};
+
 // Represents a single server session.
 // Use with BearSSL::ServerSessions.
 typedef uint8_t ServerSession[100];
@@ -18,7 +18,9 @@
 */
 
 #include "CertStoreBearSSL.h"
+#include <algorithm>
 #include <memory>
+#include <stdlib.h>
 
 
 #if defined(DEBUG_ESP_SSL) && defined(DEBUG_ESP_PORT)
@@ -41,6 +43,27 @@ extern "C" {
 CertStore::~CertStore() {
   free(_indexName);
   free(_dataName);
+  _clearCache();
+  free(_cache);
+}
+
+void CertStore::_clearCache() {
+  for (uint8_t i = 0; i < _cacheSize; i++) {
+    delete _cache[i].x509;
+    _cache[i].x509 = nullptr;
+  }
+}
+
+bool CertStore::setCacheSize(uint8_t count) {
+  _clearCache();
+  CachedTA *cache = (CachedTA *)realloc(_cache, count * sizeof(CachedTA));
+  if (count && !cache) {
+    return false;
+  }
+  _cache = count ? cache : nullptr;
+  _cacheSize = count;
+  memset(_cache, 0, count * sizeof(CachedTA));
+  return true;
 }
 
 CertStore::CertInfo CertStore::_preprocessCert(uint32_t length, uint32_t offset, const void *raw) {
@@ -78,13 +101,61 @@ CertStore::CertInfo CertStore::_preprocessCert(uint32_t length, uint32_t offset,
   return ci;
 }
 
+static int _compareCertInfo(const void *a, const void *b) {
+  return memcmp(a, b, 32); // sha256 is the first member
+}
+
 // The certs.ar file is a UNIX ar format file, concatenating all the 
 // individual certificates into a single blob in a space-efficient way.
-int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *dataFileName) {
-  int count = 0;
-  uint32_t offset = 0;
+// Calls fn(fileHeader, length, offset) for each member, offset being that
+// of its contents, which fn reads or not.  False on a damaged archive.
+template <typename Fn>
+static bool _walkArchive(fs::File &data, Fn fn) {
+  uint8_t magic[8];
+  if (!data.seek(0, fs::SeekSet) ||
+      data.read(magic, sizeof(magic)) != sizeof(magic) ||
+      memcmp(magic, "!<arch>\n", sizeof(magic)) ) {
+    return false;
+  }
+  uint32_t offset = sizeof(magic);
+
+  while (true) {
+    uint8_t fileHeader[60];
+    // 0..15 = filename in ASCII
+    // 48...57 = length in decimal ASCII
+    int32_t length;
+    int got = data.read(fileHeader, sizeof(fileHeader));
+    if (got == 0) {
+      return true;
+    }
+    if (got != sizeof(fileHeader)) {
+      return false;
+    }
+    offset += sizeof(fileHeader);
+    fileHeader[58] = 0;
+    if (1 != sscanf((char *)(fileHeader + 48), "%d", &length) || length <= 0) {
+      return false;
+    }
+    if (offset + length > data.size() || !fn(fileHeader, length, offset)) {
+      return false;
+    }
+    // Members are 2-byte aligned, the last one may miss its padding
+    offset += length + (length & 1);
+    if (offset >= data.size()) {
+      return true;
+    }
+    if (!data.seek(offset, fs::SeekSet)) {
+      return false;
+    }
+  }
+}
 
+// The index is written sorted by hashed DN for the lookups in findHashedTA.
+// A first pass counts the certificates, so that their records are allocated
+// at once.  Any failure leaves no index rather than a partial one.
+int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *dataFileName) {
   _fs = &fs;
+  _clearCache();
 
   // In case initCertStore called multiple times, don't leak old filenames
   free(_indexName);
@@ -96,74 +167,77 @@ int CertStore::initCertStore(fs::FS &fs, const char *indexFileName, const char *
   if (!_indexName || !_dataName) {
     free(_indexName);
     free(_dataName);
+    _indexName = nullptr;
+    _dataName = nullptr;
     return 0;
   }
   memcpy_P(_indexName, indexFileName, strlen_P(indexFileName) + 1);
   memcpy_P(_dataName, dataFileName, strlen_P(dataFileName) + 1);
 
-  fs::File index = _fs->open(_indexName, "w");
-  if (!index) {
-    return 0;
-  }
-
   fs::File data = _fs->open(_dataName, "r");
   if (!data) {
-    index.close();
+    _fs->remove(_indexName);
     return 0;
   }
 
-  uint8_t magic[8];
-  if (data.read(magic, sizeof(magic)) != sizeof(magic) ||
-      memcmp(magic, "!<arch>\n", sizeof(magic)) ) {
-    data.close();
-    index.close();
-    return 0;
-  }
-  offset += sizeof(magic);
-
-  while (true) {
-    uint8_t fileHeader[60];
-    // 0..15 = filename in ASCII
-    // 48...57 = length in decimal ASCII
-    int32_t length;
-    if (data.read(fileHeader, sizeof(fileHeader)) != sizeof(fileHeader)) {
-      break;
-    }
-    offset += sizeof(fileHeader);
-    fileHeader[58] = 0;
-    if (1 != sscanf((char *)(fileHeader + 48), "%d", &length) || !length) {
-      break;
-    }
+  // If the filename starts with "//" then this is a rename file, skip it
+  auto isCert = [](const uint8_t *fileHeader) {
+    return fileHeader[0] != '/' || fileHeader[1] != '/';
+  };
 
-    void *raw = malloc(length);
-    if (!raw) {
-      break;
+  int count = 0;
+  int32_t largest = 0;
+  bool ok = _walkArchive(data, [&](const uint8_t *fileHeader, int32_t length, uint32_t) {
+    if (isCert(fileHeader)) {
+      count++;
+      largest = std::max(largest, length);
     }
-    if (data.read((uint8_t *)raw, length) != length) {
-      free(raw);
-      break;
+    return true;
+  });
+
+  CertStore::CertInfo *infos = nullptr;
+  void *raw = nullptr;
+  if (ok && count) {
+    infos = (CertStore::CertInfo *)malloc(count * sizeof(CertStore::CertInfo));
+    raw = malloc(largest);
+    if (!infos || !raw) {
+      DEBUG_BSSL("CertStore::initCertStore: OOM for %d certificates\n", count);
+      ok = false;
     }
+  }
 
-    // If the filename starts with "//" then this is a rename file, skip it
-    if (fileHeader[0] != '/' || fileHeader[1] != '/') {
-      CertStore::CertInfo ci = _preprocessCert(length, offset, raw);
-      if (index.write((uint8_t *)&ci, sizeof(ci)) != (ssize_t)sizeof(ci)) {
-        free(raw);
-        break;
+  int done = 0;
+  if (ok && count) {
+    ok = _walkArchive(data, [&](const uint8_t *fileHeader, int32_t length, uint32_t offset) {
+      if (!isCert(fileHeader)) {
+        return true;
       }
-      count++;
-    }
+      if (done == count || data.read((uint8_t *)raw, length) != length) {
+        return false;
+      }
+      infos[done] = _preprocessCert(length, offset, raw);
+      // Zeroed when it could not be processed
+      return infos[done++].length != 0;
+    }) && done == count;
+  }
+  data.close();
+  free(raw);
 
-    offset += length;
-    free(raw);
-    if (offset & 1) {
-      uint8_t x;
-      data.read(&x, 1);
-      offset++;
+  if (ok) {
+    if (count) {
+      qsort(infos, count, sizeof(CertStore::CertInfo), _compareCertInfo);
     }
+    fs::File index = _fs->open(_indexName, "w");
+    ok = index && index.write((uint8_t *)infos, count * sizeof(CertStore::CertInfo)) == count * sizeof(CertStore::CertInfo);
+    index.close();
+  }
+  free(infos);
+
+  if (!ok) {
+    DEBUG_BSSL("CertStore::initCertStore: failed, no index\n");
+    _fs->remove(_indexName);
+    return 0;
   }
-  data.close();
-  index.close();
   return count;
 }
 
@@ -179,54 +253,77 @@ const br_x509_trust_anchor *CertStore::findHashedTA(void *ctx, void *hashed_dn,
     return nullptr;
   }
 
+  // Recently used ones are still decoded
+  for (uint8_t i = 0; i < cs->_cacheSize; i++) {
+    CertStore::CachedTA *c = &cs->_cache[i];
+    if (c->x509 && !memcmp(c->sha256, hashed_dn, sizeof(c->sha256))) {
+      c->used = ++cs->_cacheStamp;
+      return c->x509->getTrustAnchors();
+    }
+  }
+
   fs::File index = cs->_fs->open(cs->_indexName, "r");
   if (!index) {
     return nullptr;
   }
+  bool found = _findIndex(index, hashed_dn, ci);
+  index.close();
+  if (!found) {
+    return nullptr;
+  }
 
-  while (index.read((uint8_t *)&ci, sizeof(ci)) == sizeof(ci)) {
-    if (!memcmp(ci.sha256, hashed_dn, sizeof(ci.sha256))) {
-      index.close();
-      uint8_t *der = (uint8_t*)malloc(ci.length);
-      if (!der) {
-        return nullptr;
-      }
-      fs::File data = cs->_fs->open(cs->_dataName, "r");
-      if (!data) {
-        free(der);
-        return nullptr;
-      }
-      if (!data.seek(ci.offset, fs::SeekSet)) {
-        data.close();
-        free(der);
-        return nullptr;
-      }
-      if (data.read(der, ci.length) != (int)ci.length) {
-        free(der);
-        return nullptr;
-      }
-      data.close();
-      cs->_x509 = new (std::nothrow) X509List(der, ci.length);
-      free(der);
-      if (!cs->_x509) {
-        DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
-        return nullptr;
-      }
+  uint8_t *der = (uint8_t*)malloc(ci.length);
+  if (!der) {
+    return nullptr;
+  }
+  fs::File data = cs->_fs->open(cs->_dataName, "r");
+  if (!data) {
+    free(der);
+    return nullptr;
+  }
+  if (!data.seek(ci.offset, fs::SeekSet)) {
+    data.close();
+    free(der);
+    return nullptr;
+  }
+  if (data.read(der, ci.length) != (int)ci.length) {
+    free(der);
+    return nullptr;
+  }
+  data.close();
+  cs->_x509 = new (std::nothrow) X509List(der, ci.length);
+  free(der);
+  if (!cs->_x509) {
+    DEBUG_BSSL("CertStore::findHashedTA: OOM\n");
+    return nullptr;
+  }
 
-      br_x509_trust_anchor *ta = (br_x509_trust_anchor*)cs->_x509->getTrustAnchors();
-      memcpy(ta->dn.data, ci.sha256, sizeof(ci.sha256));
-      ta->dn.len = sizeof(ci.sha256);
+  br_x509_trust_anchor *ta = (br_x509_trust_anchor*)cs->_x509->getTrustAnchors();
+  memcpy(ta->dn.data, ci.sha256, sizeof(ci.sha256));
+  ta->dn.len = sizeof(ci.sha256);
 
-      return ta;
+  // Replace the least recently used cache entry, if caching
+  if (cs->_cacheSize) {
+    CertStore::CachedTA *slot = &cs->_cache[0];
+    for (uint8_t i = 1; i < cs->_cacheSize && slot->x509; i++) {
+      if (!cs->_cache[i].x509 || cs->_cache[i].used < slot->used) {
+        slot = &cs->_cache[i];
+      }
     }
+    delete slot->x509;
+    slot->x509 = cs->_x509;
+    memcpy(slot->sha256, ci.sha256, sizeof(slot->sha256));
+    slot->used = ++cs->_cacheStamp;
+    cs->_x509 = nullptr; // Owned by the cache now
   }
-  index.close();
-  return nullptr;
+
+  return ta;
 }
 
 void CertStore::freeHashedTA(void *ctx, const br_x509_trust_anchor *ta) {
   CertStore *cs = static_cast<CertStore*>(ctx);
   (void) ta; // Unused
+  // Cached anchors stay around, only an uncached one is freed
   delete cs->_x509;
   cs->_x509 = nullptr;
 }
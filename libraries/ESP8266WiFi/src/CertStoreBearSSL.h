@@ -50,6 +50,10 @@ class CertStore: public CertStoreBase {
     // Installs the cert store into the X509 decoder (normally via static function callbacks)
     void installCertStore(br_x509_minimal_context *ctx);
 
+    // Keep up to count recently used trust anchors decoded in RAM (~1KB each)
+    // instead of reading them back from the FS on every handshake.  Default 0.
+    bool setCacheSize(uint8_t count);
+
   protected:
     fs::FS *_fs = nullptr;
     char *_indexName = nullptr;
@@ -60,7 +64,7 @@ class CertStore: public CertStoreBase {
     static const br_x509_trust_anchor *findHashedTA(void *ctx, void *hashed_dn, size_t len);
     static void freeHashedTA(void *ctx, const br_x509_trust_anchor *ta);
 
-    // The binary format of the index file
+    // The binary format of the index file, records are sorted by sha256
     class CertInfo {
     public:
       uint8_t sha256[32];
@@ -69,6 +73,40 @@ class CertStore: public CertStoreBase {
     };
     static CertInfo _preprocessCert(uint32_t length, uint32_t offset, const void *raw);
 
+    // Binary search of the sorted index file, reads O(log n) records
+    static bool _findIndex(fs::File &index, const void *hashed_dn, CertInfo &ci) {
+      uint32_t lo = 0;
+      uint32_t hi = index.size() / sizeof(CertInfo);
+      while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (!index.seek(mid * sizeof(CertInfo), fs::SeekSet) ||
+            index.read((uint8_t *)&ci, sizeof(ci)) != sizeof(ci)) {
+          return false;
+        }
+        int cmp = memcmp(ci.sha256, hashed_dn, sizeof(ci.sha256));
+        if (!cmp) {
+          return true;
+        }
+        if (cmp < 0) {
+          lo = mid + 1;
+        } else {
+          hi = mid;
+        }
+      }
+      return false;
+    }
+
+    // Least recently used decoded trust anchors, see setCacheSize()
+    class CachedTA {
+    public:
+      X509List *x509;
+      uint8_t sha256[32];
+      uint32_t used;
+    };
+    CachedTA *_cache = nullptr;
+    uint8_t _cacheSize = 0;
+    uint32_t _cacheStamp = 0;
+    void _clearCache();
 };
 
 };
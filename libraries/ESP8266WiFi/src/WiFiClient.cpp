@@ -239,8 +239,28 @@ size_t WiFiClient::write_P(PGM_P buf, size_t size)
         return 0;
     }
     _client->setTimeout(_timeout);
-    StreamConstPtr nopeek(buf, size);
-    return nopeek.sendAll(this);
+    return _client->write_P(buf, size);
+}
+
+size_t WiFiClient::writev(const Buffer *buffers, size_t count)
+{
+    if (!_client)
+    {
+        return 0;
+    }
+    _client->setTimeout(_timeout);
+    return _client->writev(buffers, count);
+}
+
+size_t WiFiClient::writeNoCopy(const uint8_t *buf, size_t size, release_cb_t release, void* arg)
+{
+    if (!_client || !size)
+    {
+        release(arg);
+        return 0;
+    }
+    _client->setTimeout(_timeout);
+    return _client->write_nocopy((const char*)buf, size, release, arg);
 }
 
 int WiFiClient::available()
@@ -71,6 +71,13 @@ public:
   virtual size_t write(uint8_t) override;
   virtual size_t write(const uint8_t *buf, size_t size) override;
   virtual size_t write_P(PGM_P buf, size_t size);
+  // buffers are queued together and sent in as few TCP segments as possible
+  virtual size_t writev(const Buffer *buffers, size_t count) override;
+  // Send a buffer lwIP references instead of copying. It must stay unchanged
+  // until release(arg) is called from the network stack, once the peer has
+  // acknowledged it or the connection is gone (possibly before returning).
+  typedef void (*release_cb_t)(void* arg);
+  virtual size_t writeNoCopy(const uint8_t *buf, size_t size, release_cb_t release, void* arg);
   [[ deprecated("use stream.sendHow(client...)") ]]
   size_t write(Stream& stream);
 
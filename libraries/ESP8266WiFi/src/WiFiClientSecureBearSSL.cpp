@@ -68,6 +68,10 @@ extern "C" {
 
 namespace BearSSL {
 
+// Following constants taken from bearssl/src/ssl/ssl_engine.c (not exported unfortunately)
+static constexpr int MAX_OUT_OVERHEAD = 85;
+static constexpr int MAX_IN_OVERHEAD = 325;
+
 void WiFiClientSecureCtx::_clear() {
   // TLS handshake may take more than the 5 second default timeout
   _timeout = 15000;
@@ -83,11 +87,15 @@ void WiFiClientSecureCtx::_clear() {
   _now = 0; // You can override or ensure time() is correct w/configTime
   _ta = nullptr;
   setBufferSizes(16384, 512); // Minimum safe
+  _iobuf_in_alloc = 0;
+  _adaptive_buffers = true;
   _handshake_done = false;
   _recvapp_buf = nullptr;
   _recvapp_len = 0;
   _oom_err = false;
   _session = nullptr;
+  _sessionCache = nullptr;
+  _sessionKey = 0;
   _cipher_list = nullptr;
   _cipher_cnt = 0;
   _tls_min = BR_TLS10;
@@ -176,10 +184,6 @@ void WiFiClientSecureCtx::setClientECCert(const X509List *chain,
 }
 
 void WiFiClientSecureCtx::setBufferSizes(int recv, int xmit) {
-  // Following constants taken from bearssl/src/ssl/ssl_engine.c (not exported unfortunately)
-  const int MAX_OUT_OVERHEAD = 85;
-  const int MAX_IN_OVERHEAD = 325;
-
   // The data buffers must be between 512B and 16KB
   recv = std::max(512, std::min(16384, recv));
   xmit = std::max(512, std::min(16384, xmit));
@@ -343,6 +347,12 @@ size_t WiFiClientSecureCtx::write_P(PGM_P buf, size_t size) {
   return _write((const uint8_t *)buf, size, true);
 }
 
+size_t WiFiClientSecureCtx::writeNoCopy(const uint8_t *buf, size_t size, release_cb_t release, void* arg) {
+  size_t ret = _write(buf, size, false);
+  release(arg);
+  return ret;
+}
+
 size_t WiFiClientSecureCtx::write(Stream& stream) {
   if (!_engineConnected()) {
     DEBUG_BSSL("write: no br_ssl engine to work with\n");
@@ -1106,6 +1116,34 @@ bool WiFiClientSecureCtx::_installClientX509Validator() {
   return true;
 }
 
+// Resize the receive buffer to what the handshake settled on.  A server which
+// accepted our MFLN request never sends larger records, so the buffer can shrink
+// to that.  One which didn't may send up to 16KB, so grow back to the requested
+// size if the heap made us start smaller.  Incoming records always begin at the
+// start of the buffer, so moving it is a copy and repointing the engine.
+void WiFiClientSecureCtx::_adaptRecvBuffer() {
+  int want = _iobuf_in_size;
+  if (br_ssl_engine_get_mfln_negotiated(_eng)) {
+    want = std::min(want, (int)_eng->max_frag_len + MAX_IN_OVERHEAD);
+  }
+  if ((want == _iobuf_in_alloc) || (std::max({_eng->ixa, _eng->ixb, _eng->ixc}) > (size_t)want)) {
+    return;
+  }
+  auto buf = _alloc_iobuf(want);
+  if (!buf) {
+    return; // Keep what we have, it worked for the handshake
+  }
+  memcpy(buf.get(), _iobuf_in.get(), std::min(want, _iobuf_in_alloc));
+  if (_recvapp_buf) {
+    _recvapp_buf = buf.get() + (_recvapp_buf - _iobuf_in.get());
+  }
+  _eng->ibuf = buf.get();
+  _eng->ibuf_len = want;
+  DEBUG_BSSL("_adaptRecvBuffer: %d -> %d bytes\n", _iobuf_in_alloc, want);
+  _iobuf_in = buf;
+  _iobuf_in_alloc = want;
+}
+
 std::shared_ptr<unsigned char> WiFiClientSecureCtx::_alloc_iobuf(size_t sz)
 { // Allocate buffer with preference to IRAM
   HeapSelectIram primary;
@@ -1133,11 +1171,18 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
 
   _sc = std::make_shared<br_ssl_client_context>();
   _eng = &_sc->eng; // Allocation/deallocation taken care of by the _sc shared_ptr
-  _iobuf_in = _alloc_iobuf(_iobuf_in_size);
   _iobuf_out = _alloc_iobuf(_iobuf_out_size);
+  _iobuf_in_alloc = _iobuf_in_size;
+  _iobuf_in = _alloc_iobuf(_iobuf_in_alloc);
+  // Short on heap: halve the receive buffer, which makes BearSSL request a
+  // correspondingly smaller MFLN, rather than failing outright
+  while (!_iobuf_in && _adaptive_buffers && _iobuf_in_alloc > 512 + MAX_IN_OVERHEAD) {
+    _iobuf_in_alloc = std::max(512, (_iobuf_in_alloc - MAX_IN_OVERHEAD) / 2) + MAX_IN_OVERHEAD;
+    _iobuf_in = _alloc_iobuf(_iobuf_in_alloc);
+  }
   DBG_MMU_PRINTF("\n_iobuf_in:       %p\n", _iobuf_in.get());
   DBG_MMU_PRINTF(  "_iobuf_out:      %p\n", _iobuf_out.get());
-  DBG_MMU_PRINTF(  "_iobuf_in_size:  %u\n", _iobuf_in_size);
+  DBG_MMU_PRINTF(  "_iobuf_in_size:  %u\n", _iobuf_in_alloc);
   DBG_MMU_PRINTF(  "_iobuf_out_size: %u\n", _iobuf_out_size);
 
   if (!_sc || !_iobuf_in || !_iobuf_out) {
@@ -1160,7 +1205,7 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
     DEBUG_BSSL("_connectSSL: Can't install x509 validator\n");
     return false;
   }
-  br_ssl_engine_set_buffers_bidi(_eng, _iobuf_in.get(), _iobuf_in_size, _iobuf_out.get(), _iobuf_out_size);
+  br_ssl_engine_set_buffers_bidi(_eng, _iobuf_in.get(), _iobuf_in_alloc, _iobuf_out.get(), _iobuf_out_size);
   br_ssl_engine_set_versions(_eng, _tls_min, _tls_max);
 
   // Apply any client certificates, if supplied.
@@ -1179,12 +1224,20 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
 #endif
   }
 
-  // Restore session from the storage spot, if present
+  // Restore session from the storage spot, if present, else from the per-host cache
+  const br_ssl_session_parameters *params = nullptr;
+  _sessionKey = 0;
   if (_session) {
-    br_ssl_engine_set_session_parameters(_eng, _session->getSession());
+    params = _session->getSession();
+  } else if (_sessionCache) {
+    _sessionKey = SessionCache::makeKey(hostName, remoteIP(), remotePort());
+    params = _sessionCache->find(_sessionKey);
+  }
+  if (params) {
+    br_ssl_engine_set_session_parameters(_eng, params);
   }
 
-  if (!br_ssl_client_reset(_sc.get(), hostName, _session?1:0)) {
+  if (!br_ssl_client_reset(_sc.get(), hostName, params?1:0)) {
     _freeSSL();
     DEBUG_BSSL("_connectSSL: Can't reset client\n");
     return false;
@@ -1201,6 +1254,18 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
   }
 #endif
 
+  // Keep the (possibly new) session for the next connection, or drop the
+  // cached one in case it was what the server choked on
+  if (_sessionKey) {
+    if (ret) {
+      br_ssl_session_parameters fresh;
+      br_ssl_engine_get_session_parameters(_eng, &fresh);
+      _sessionCache->store(_sessionKey, &fresh);
+    } else {
+      _sessionCache->remove(_sessionKey);
+    }
+  }
+
   // Session is already validated here, there is no need to keep following
   _x509_minimal = nullptr;
   _x509_insecure = nullptr;
@@ -1209,6 +1274,10 @@ bool WiFiClientSecureCtx::_connectSSL(const char* hostName) {
   // reduce timeout after successful handshake to fail fast if server stop accepting our data for whathever reason
   if (ret) _timeout = 5000;
 
+  if (ret && _adaptive_buffers) {
+    _adaptRecvBuffer();
+  }
+
   return ret;
 }
 
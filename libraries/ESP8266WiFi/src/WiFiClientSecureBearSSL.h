@@ -53,6 +53,9 @@ class WiFiClientSecureCtx : public WiFiClient {
     uint8_t connected() override;
     size_t write(const uint8_t *buf, size_t size) override;
     size_t write_P(PGM_P buf, size_t size) override;
+    size_t writev(const Buffer *buffers, size_t count) override { return Print::writev(buffers, count); }
+    // data is encrypted into the TLS buffer, so it is released right away
+    size_t writeNoCopy(const uint8_t *buf, size_t size, release_cb_t release, void* arg) override;
     size_t write(Stream& stream); // Note this is not virtual
     int read(uint8_t *buf, size_t size) override;
     int read(char *buf, size_t size) { return read((uint8_t*)buf, size); }
@@ -70,6 +73,9 @@ class WiFiClientSecureCtx : public WiFiClient {
     // Allow sessions to be saved/restored automatically to a memory area
     void setSession(Session *session) { _session = session; }
 
+    // Look up and store sessions per host automatically (used when no setSession())
+    void setSessionCache(SessionCache *cache) { _sessionCache = cache; }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() {
       _clearAuthenticationSettings();
@@ -111,6 +117,10 @@ class WiFiClientSecureCtx : public WiFiClient {
     // Sets the requested buffer size for transmit and receive
     void setBufferSizes(int recv, int xmit);
 
+    // Let the receive buffer start smaller when the heap is short, and follow
+    // the fragment length negotiated in the handshake.  Enabled by default.
+    void setAdaptiveBuffers(bool enable) { _adaptive_buffers = enable; }
+
     // Returns whether MFLN negotiation for the above buffer sizes succeeded (after connection)
     int getMFLNStatus() {
       return connected() && br_ssl_engine_get_mfln_negotiated(_eng);
@@ -170,6 +180,8 @@ class WiFiClientSecureCtx : public WiFiClient {
     CertStoreBase *_certStore;
     int _iobuf_in_size;
     int _iobuf_out_size;
+    int _iobuf_in_alloc; // Actual receive buffer size, see setAdaptiveBuffers()
+    bool _adaptive_buffers;
     bool _handshake_done;
     bool _oom_err;
 
@@ -177,6 +189,10 @@ class WiFiClientSecureCtx : public WiFiClient {
     // Will be used on connect and updated on close
     Session *_session;
 
+    // Optional per-host session storage, with the current connection's key
+    SessionCache *_sessionCache;
+    uint32_t _sessionKey;
+
     bool _use_insecure;
     bool _use_fingerprint;
     uint8_t _fingerprint[20];
@@ -203,6 +219,7 @@ class WiFiClientSecureCtx : public WiFiClient {
     bool _engineConnected(); // Are both socket and the bearssl engine alive?
 
     std::shared_ptr<unsigned char> _alloc_iobuf(size_t sz);
+    void _adaptRecvBuffer();
     void _freeSSL();
     int _run_until(unsigned target, bool blocking = true);
     size_t _write(const uint8_t *buf, size_t size, bool pmem);
@@ -270,6 +287,8 @@ class WiFiClientSecure : public WiFiClient {
     uint8_t connected() override { return _ctx->connected(); }
     size_t write(const uint8_t *buf, size_t size) override { return _ctx->write(buf, size); }
     size_t write_P(PGM_P buf, size_t size) override { return _ctx->write_P(buf, size); }
+    size_t writev(const Buffer *buffers, size_t count) override { return _ctx->writev(buffers, count); }
+    size_t writeNoCopy(const uint8_t *buf, size_t size, release_cb_t release, void* arg) override { return _ctx->writeNoCopy(buf, size, release, arg); }
     size_t write(const char *buf) { return write((const uint8_t*)buf, strlen(buf)); }
     size_t write_P(const char *buf) { return write_P((PGM_P)buf, strlen_P(buf)); }
     size_t write(Stream& stream) /* Note this is not virtual */ { return _ctx->write(stream); }
@@ -292,6 +311,9 @@ class WiFiClientSecure : public WiFiClient {
     // Allow sessions to be saved/restored automatically to a memory area
     void setSession(Session *session) { _ctx->setSession(session); }
 
+    // Look up and store sessions per host automatically (used when no setSession())
+    void setSessionCache(SessionCache *cache) { _ctx->setSessionCache(cache); }
+
     // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
     void setInsecure() { _ctx->setInsecure(); }
 
@@ -321,6 +343,10 @@ class WiFiClientSecure : public WiFiClient {
     // Sets the requested buffer size for transmit and receive
     void setBufferSizes(int recv, int xmit) { _ctx->setBufferSizes(recv, xmit); }
 
+    // Let the receive buffer start smaller when the heap is short, and follow
+    // the fragment length negotiated in the handshake.  Enabled by default.
+    void setAdaptiveBuffers(bool enable) { _ctx->setAdaptiveBuffers(enable); }
+
     // Returns whether MFLN negotiation for the above buffer sizes succeeded (after connection)
     int getMFLNStatus() { return _ctx->getMFLNStatus(); }
 
@@ -25,8 +25,15 @@ class ClientContext;
 class WiFiClient;
 
 typedef void (*discard_cb_t)(void*, ClientContext*);
+typedef void (*release_cb_t)(void*);
+
+// number of write_nocopy() buffers lwIP can reference at the same time
+#ifndef CLIENTCONTEXT_TX_REFS
+#define CLIENTCONTEXT_TX_REFS 4
+#endif
 
 #include <assert.h>
+#include <new>
 #include <esp_priv.h>
 #include <coredecls.h>
 
@@ -67,6 +74,8 @@ public:
             tcp_abort(_pcb);
             _pcb = nullptr;
         }
+        if (_tx)
+            _tx->release(true);
         return ERR_ABRT;
     }
 
@@ -75,16 +84,31 @@ public:
         err_t err = ERR_OK;
         if(_pcb) {
             DEBUGV(":close\r\n");
-            tcp_arg(_pcb, NULL);
-            tcp_sent(_pcb, NULL);
+            TxRing* linger = nullptr;
+            if (_tx && _tx->count) {
+                // lwIP keeps sending from write_nocopy() buffers after
+                // tcp_close(): the ring follows the pcb and releases them
+                // as they are acked, or when lwIP drops the pcb
+                linger = _tx;
+                _tx = nullptr;
+            }
+            // lwIP resets and frees the pcb right away, without error
+            // callback, when received data was not read
+            bool reset = (_pcb->state == ESTABLISHED || _pcb->state == CLOSE_WAIT)
+                         && (_pcb->refused_data || _pcb->rcv_wnd != TCP_WND_MAX(_pcb));
+            tcp_arg(_pcb, linger);
+            tcp_sent(_pcb, linger? &_s_linger_acked: NULL);
             tcp_recv(_pcb, NULL);
-            tcp_err(_pcb, NULL);
+            tcp_err(_pcb, linger? &_s_linger_error: NULL);
             tcp_poll(_pcb, NULL, 0);
             err = tcp_close(_pcb);
             if(err != ERR_OK) {
                 DEBUGV(":tc err %d\r\n", (int) err);
+                // calls _s_linger_error()
                 tcp_abort(_pcb);
                 err = ERR_ABRT;
+            } else if (linger && reset) {
+                _s_linger_error(linger, ERR_RST);
             }
             _pcb = nullptr;
         }
@@ -93,6 +117,7 @@ public:
 
     ~ClientContext()
     {
+        delete _tx;
     }
 
     ClientContext* next() const
@@ -378,6 +403,86 @@ public:
         return _write_from_source(ds, dl);
     }
 
+    // Queue all buffers before letting lwIP output anything, so that they
+    // are sent in as few segments as possible.
+    size_t writev(const Print::Buffer* buffers, size_t count)
+    {
+        size_t written = 0;
+        size_t last = count;
+        while (last && !buffers[last - 1].size)
+            last--;
+        for (size_t i = 0; i < last && _pcb; i++) {
+            _more = i + 1 < last;
+            size_t ret = _write_from_source((const char*)buffers[i].data, buffers[i].size);
+            written += ret;
+            if (ret != buffers[i].size) {
+                // push what was queued with TCP_WRITE_FLAG_MORE
+                _more = false;
+                if (_pcb)
+                    tcp_output(_pcb);
+                break;
+            }
+        }
+        _more = false;
+        return written;
+    }
+
+    // Same as write() but lwIP references the data instead of copying it.
+    // The buffer must stay unchanged until release(arg) is called, which
+    // happens from the network stack once the peer has acknowledged it
+    // or the connection is gone, possibly before write_nocopy() returns.
+    size_t write_nocopy(const char* ds, const size_t dl, release_cb_t release, void* arg)
+    {
+        if (_pcb && !_tx) {
+            _tx = new (std::nothrow) TxRing;
+            if (_tx)
+                _tx->acked = _tx_acked;
+        }
+        if (!_pcb || !_tx || _tx->count == CLIENTCONTEXT_TX_REFS) {
+            // no slot to track the buffer: copy it
+            size_t written = write(ds, dl);
+            release(arg);
+            return written;
+        }
+        TxRef& ref = _tx->refs[(_tx->head + _tx->count++) % CLIENTCONTEXT_TX_REFS];
+        ref.release = release;
+        ref.arg = arg;
+        ref.open = true;
+        _nocopy = true;
+        size_t written = _write_from_source(ds, dl);
+        _nocopy = false;
+        ref.end = _tx_queued;
+        ref.open = false;
+        _tx->release(!_pcb);
+        return written;
+    }
+
+    // Flash can only be read by aligned words, so data is loaded into
+    // heap chunks which lwIP then references, instead of being copied
+    // through a stack buffer and once more into lwIP's own buffers.
+    size_t write_P(PGM_P ds, const size_t dl)
+    {
+        size_t written = 0;
+        while (written < dl && _pcb) {
+            size_t chunk = std::min(dl - written, (size_t)TCP_MSS);
+            char* buf = (char*)malloc(chunk);
+            size_t ret;
+            if (buf) {
+                memcpy_P(buf, ds + written, chunk);
+                ret = write_nocopy(buf, chunk, &_s_free, buf);
+            } else {
+                char tmp[128];
+                chunk = std::min(chunk, sizeof(tmp));
+                memcpy_P(tmp, ds + written, chunk);
+                ret = write(tmp, chunk);
+            }
+            written += ret;
+            if (ret != chunk)
+                break;
+        }
+        return written;
+    }
+
     void keepAlive (uint16_t idle_sec = TCP_DEFAULT_KEEPALIVE_IDLE_SEC, uint16_t intv_sec = TCP_DEFAULT_KEEPALIVE_INTERVAL_SEC, uint8_t count = TCP_DEFAULT_KEEPALIVE_COUNT)
     {
         if (idle_sec && intv_sec && count) {
@@ -488,7 +593,7 @@ protected:
             _send_waiting = false;
         } while(true);
 
-        if (_sync)
+        if (_sync && !_more)
             wait_until_acked();
 
         return _written;
@@ -514,16 +619,17 @@ protected:
             const char* buf = _datasource + _written;
 
             uint8_t flags = 0;
-            if (next_chunk_size < remaining)
+            if (next_chunk_size < remaining || _more)
                 //   PUSH is meant for peer, telling to give data to user app as soon as received
                 //   PUSH "may be set" when sender has finished sending a "meaningful" data block
                 //   PUSH does not break Nagle
                 //   #5173: windows needs this flag
                 //   more info: https://lists.gnu.org/archive/html/lwip-users/2009-11/msg00018.html
                 flags |= TCP_WRITE_FLAG_MORE; // do not tcp-PuSH (yet)
-            if (!_sync)
+            if (!_sync && !_nocopy)
                 // user data must be copied when data are sent but not yet acknowledged
-                // (with sync, we wait for acknowledgment before returning to user)
+                // (with sync, we wait for acknowledgment before returning to user,
+                // write_nocopy() users keep their buffer until it is released)
                 flags |= TCP_WRITE_FLAG_COPY;
 
             err_t err = tcp_write(_pcb, buf, next_chunk_size, flags);
@@ -532,6 +638,7 @@ protected:
 
             if (err == ERR_OK) {
                 _written += next_chunk_size;
+                _tx_queued += next_chunk_size;
                 has_written = true;
             } else {
                 // ERR_MEM(-1) is a valid error meaning
@@ -540,7 +647,8 @@ protected:
             }
         }
 
-        if (has_written)
+        // with more buffers coming from writev(), only push when waiting for room
+        if (_more ? _written < _datalen : has_written)
         {
             // lwIP's tcp_output doc: "Find out what we can send and send it"
             // *with respect to Nagle*
@@ -565,6 +673,11 @@ protected:
         (void) pcb;
         (void) len;
         DEBUGV(":ack %d\r\n", len);
+        _tx_acked += len;
+        if (_tx) {
+            _tx->acked = _tx_acked;
+            _tx->release(false);
+        }
         _write_some_from_cb();
         return ERR_OK;
     }
@@ -634,6 +747,8 @@ protected:
         tcp_recv(_pcb, NULL);
         tcp_err(_pcb, NULL);
         _pcb = nullptr;
+        if (_tx)
+            _tx->release(true);
         _notify_error();
     }
 
@@ -650,6 +765,35 @@ protected:
         return ERR_OK;
     }
 
+    // lwIP callbacks of a closed pcb still sending write_nocopy() buffers
+    static err_t _s_linger_acked(void *arg, struct tcp_pcb *tpcb, uint16_t len)
+    {
+        TxRing* ring = reinterpret_cast<TxRing*>(arg);
+        ring->acked += len;
+        ring->release(false);
+        if (!ring->count) {
+            tcp_arg(tpcb, NULL);
+            tcp_sent(tpcb, NULL);
+            tcp_err(tpcb, NULL);
+            delete ring;
+        }
+        return ERR_OK;
+    }
+
+    static void _s_linger_error(void *arg, err_t err)
+    {
+        (void) err;
+        // the pcb and its segments are gone
+        TxRing* ring = reinterpret_cast<TxRing*>(arg);
+        ring->release(true);
+        delete ring;
+    }
+
+    static void _s_free(void* arg)
+    {
+        free(arg);
+    }
+
     err_t _poll(tcp_pcb*)
     {
         _write_some_from_cb();
@@ -697,6 +841,40 @@ private:
     uint32_t _op_start_time = 0;
     bool _send_waiting = false;
     bool _connect_pending = false;
+    bool _nocopy = false;
+    bool _more = false;   // writev(): more buffers follow
+
+    struct TxRef {
+        uint32_t end; // value of _tx_queued after the last byte
+        release_cb_t release;
+        void* arg;
+        bool open;    // still being written
+    };
+    // write_nocopy() buffers referenced by lwIP, allocated on first use.
+    // It outlives the ClientContext when closed before they are acked.
+    struct TxRing {
+        TxRef refs[CLIENTCONTEXT_TX_REFS];
+        uint8_t head = 0;
+        uint8_t count = 0;
+        uint32_t acked = 0;
+
+        // call release() of the buffers the peer has fully acknowledged,
+        // or of all finished ones when lwIP dropped the connection
+        void release(bool all)
+        {
+            while (count) {
+                TxRef& ref = refs[head];
+                if (ref.open || (!all && (int32_t)(acked - ref.end) < 0))
+                    break;
+                head = (head + 1) % CLIENTCONTEXT_TX_REFS;
+                count--;
+                ref.release(ref.arg);
+            }
+        }
+    };
+    TxRing* _tx = nullptr;
+    uint32_t _tx_queued = 0;
+    uint32_t _tx_acked = 0;
 
     int8_t _refcnt;
     ClientContext* _next;
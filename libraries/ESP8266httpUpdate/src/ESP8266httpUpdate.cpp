@@ -180,6 +180,9 @@ HTTPUpdateResult ESP8266HTTPUpdate::handleUpdate(HTTPClient& http, const String&
         http.addHeader(F("x-ESP8266-mode"), F("spiffs"));
     } else {
         http.addHeader(F("x-ESP8266-mode"), F("sketch"));
+        if(_delta) {
+            http.addHeader(F("x-ESP8266-delta"), _deltaWindowBits ? F("gzip") : F("raw"));
+        }
     }
 
     if(currentVersion && currentVersion[0] != 0x00) {
@@ -302,7 +305,7 @@ HTTPUpdateResult ESP8266HTTPUpdate::handleUpdate(HTTPClient& http, const String&
                     }
 
                     // check for valid first magic byte
-                    if(buf[0] != 0xE9 && buf[0] != 0x1f) {
+                    if(buf[0] != 0xE9 && buf[0] != 0x1f && !(_delta && DeltaPatch::isPatchStart(buf[0]))) {
                         DEBUG_HTTP_UPDATE("[httpUpdate] Magic header does not start with 0xE9\n");
                         _setLastError(HTTP_UE_BIN_VERIFY_HEADER_FAILED);
                         http.end();
@@ -398,6 +401,21 @@ bool ESP8266HTTPUpdate::runUpdate(Stream& in, uint32_t size, const String& md5,
         Update.onProgress(_cbProgress);
     }
 
+    // the global Update is left as the sketch configured it
+    struct DecodeSettings {
+        bool delta = Update.getDelta();
+        uint8_t inflate = Update.getInflate();
+        ~DecodeSettings() {
+            Update.setDelta(delta);
+            Update.setInflate(inflate);
+        }
+    } restore;
+
+    if(_delta && command == U_FLASH) {
+        Update.setDelta();
+        Update.setInflate(_deltaWindowBits);
+    }
+
     if(!Update.begin(size, command, _ledPin, _ledOn)) {
         _setLastError(Update.getError());
         Update.printError(error);
@@ -110,6 +110,19 @@ public:
         _ledOn = ledOn;
     }
 
+    /**
+      * accept delta patches against the running sketch (see tools/delta.py),
+      * the server is told so by an x-ESP8266-delta request header and picks
+      * the patch by x-ESP8266-sketch-md5
+      * @param delta
+      * @param windowBits gzip window of compressed patches, 0 for uncompressed ones
+      */
+    void setDelta(bool delta, uint8_t windowBits = 15)
+    {
+        _delta = delta;
+        _deltaWindowBits = windowBits;
+    }
+
     void setMD5sum(const String &md5Sum) 
     {
         _md5Sum = md5Sum;
@@ -159,6 +172,8 @@ protected:
     String _md5Sum;
     int _httpClientTimeout;
     followRedirects_t _followRedirects = HTTPC_DISABLE_FOLLOW_REDIRECTS;
+    bool _delta = false;
+    uint8_t _deltaWindowBits = 15;
 private:
     // Callbacks
     HTTPUpdateStartCB    _cbStart;
@@ -0,0 +1,170 @@
+/*
+ FlashCache.cpp - Block device buffering between LittleFS and the flash HAL
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <Arduino.h>
+#include <string.h>
+#include <algorithm>
+#include "FlashCache.h"
+#include "debug.h"
+#include "flash_hal.h"
+
+namespace littlefs_impl {
+
+bool FlashCache::begin(uint32_t start, uint32_t end, uint32_t readAheadMax, uint32_t writeBackSize) {
+    _start = start;
+    _end = end;
+    _readAheadLen = 0;
+    _window = 0;
+    _nextRead = ~0u;
+    _writeBackLen = 0;
+
+    if (readAheadMax && readAheadMax < readAheadMin) {
+        readAheadMax = readAheadMin;
+    }
+    if (readAheadMax != _readAheadMax || !_readAhead) {
+        _readAhead.reset(readAheadMax ? new (std::nothrow) uint8_t[readAheadMax] : nullptr);
+        _readAheadMax = _readAhead ? readAheadMax : 0;
+    }
+    if (writeBackSize != _writeBackSize || !_writeBack) {
+        _writeBack.reset(writeBackSize ? new (std::nothrow) uint8_t[writeBackSize] : nullptr);
+        _writeBackSize = _writeBack ? writeBackSize : 0;
+    }
+    return _readAheadMax == readAheadMax && _writeBackSize == writeBackSize;
+}
+
+int FlashCache::end() {
+    int rc = sync();
+    _readAhead.reset();
+    _readAheadMax = 0;
+    _readAheadLen = 0;
+    _writeBack.reset();
+    _writeBackSize = 0;
+    return rc;
+}
+
+int FlashCache::read(uint32_t addr, uint32_t size, uint8_t* dst) {
+    if (_writeBackLen && _overlaps(addr, size, _writeBackAddr, _writeBackLen) && sync() != 0) {
+        return -1;
+    }
+
+    bool sequential = addr == _nextRead;
+    _nextRead = addr + size;
+
+    if (_readAheadLen && addr >= _readAheadAddr && addr + size <= _readAheadAddr + _readAheadLen) {
+        memcpy(dst, &_readAhead[addr - _readAheadAddr], size);
+        return 0;
+    }
+
+    if (!_readAheadMax || !sequential) {
+        _window = 0;
+        return flash_hal_read(addr, size, dst) == FLASH_HAL_OK ? 0 : -1;
+    }
+
+    _window = std::min(_window ? _window * 2 : readAheadMin, _readAheadMax);
+    uint32_t len = std::min(_window, _end - addr);
+    if (size >= len) {
+        // large enough on its own
+        return flash_hal_read(addr, size, dst) == FLASH_HAL_OK ? 0 : -1;
+    }
+
+    _readAheadLen = 0;
+    if (_writeBackLen && _overlaps(addr, len, _writeBackAddr, _writeBackLen) && sync() != 0) {
+        return -1;
+    }
+    if (flash_hal_read(addr, len, _readAhead.get()) != FLASH_HAL_OK) {
+        return -1;
+    }
+    _readAheadAddr = addr;
+    _readAheadLen = len;
+    memcpy(dst, _readAhead.get(), size);
+    return 0;
+}
+
+int FlashCache::prog(uint32_t addr, uint32_t size, const uint8_t* src) {
+    _invalidate(addr, size);
+
+    if (!_writeBackSize) {
+        return flash_hal_write(addr, size, src) == FLASH_HAL_OK ? 0 : -1;
+    }
+
+    if (_writeBackLen && addr != _writeBackAddr + _writeBackLen && sync() != 0) {
+        return -1;
+    }
+
+    while (size) {
+        if (!_writeBackLen) {
+            _writeBackAddr = addr;
+            if (size >= _writeBackSize && (addr % _writeBackSize) == 0) {
+                // whole aligned buffers need no copy
+                uint32_t len = size - (size % _writeBackSize);
+                if (flash_hal_write(addr, len, src) != FLASH_HAL_OK) {
+                    return -1;
+                }
+                addr += len;
+                src += len;
+                size -= len;
+                continue;
+            }
+        }
+
+        // the buffer ends at the next multiple of its size
+        uint32_t room = _writeBackSize - ((_writeBackAddr % _writeBackSize) + _writeBackLen);
+        uint32_t len = std::min(room, size);
+        memcpy(&_writeBack[_writeBackLen], src, len);
+        _writeBackLen += len;
+        addr += len;
+        src += len;
+        size -= len;
+        if (len == room && sync() != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int FlashCache::erase(uint32_t addr, uint32_t size) {
+    if (_writeBackLen && _overlaps(addr, size, _writeBackAddr, _writeBackLen)) {
+        // littlefs never erases what it has not synced, keep it safe anyway
+        if (sync() != 0) {
+            return -1;
+        }
+    }
+    _invalidate(addr, size);
+    return flash_hal_erase(addr, size) == FLASH_HAL_OK ? 0 : -1;
+}
+
+int FlashCache::sync() {
+    if (!_writeBackLen) {
+        return 0;
+    }
+    uint32_t len = _writeBackLen;
+    _writeBackLen = 0;
+    if (flash_hal_write(_writeBackAddr, len, _writeBack.get()) != FLASH_HAL_OK) {
+        DEBUGV("FlashCache: write back of %u bytes at 0x%08x failed\n", len, _writeBackAddr);
+        return -1;
+    }
+    return 0;
+}
+
+void FlashCache::_invalidate(uint32_t addr, uint32_t size) {
+    if (_readAheadLen && _overlaps(addr, size, _readAheadAddr, _readAheadLen)) {
+        _readAheadLen = 0;
+    }
+}
+
+}; // namespace
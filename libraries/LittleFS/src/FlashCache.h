@@ -0,0 +1,79 @@
+/*
+ FlashCache.h - Block device buffering between LittleFS and the flash HAL
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+
+ This library is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ Lesser General Public License for more details.
+
+ You should have received a copy of the GNU Lesser General Public
+ License along with this library; if not, write to the Free Software
+ Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef __FLASHCACHE_H
+#define __FLASHCACHE_H
+
+#include <stdint.h>
+#include <memory>
+
+namespace littlefs_impl {
+
+// littlefs reads and programs flash in small units (its read, prog and
+// cache sizes). FlashCache turns runs of them into fewer, larger flash_hal
+// calls:
+//
+// * reads continuing the previous one are served from a read-ahead window
+//   which doubles, from readAheadMin up to readAheadMax bytes, for as long
+//   as the access pattern stays sequential;
+// * consecutive progs are gathered in a write-back buffer and written when
+//   it holds a full, aligned buffer, when a prog does not follow on, before
+//   a read or erase touching it, and when littlefs syncs the device.
+//
+// With both sizes at 0 every call goes straight to the flash HAL.
+class FlashCache
+{
+public:
+    static constexpr uint32_t readAheadMin = 1024;
+
+    // [start, end) bounds read-ahead, both sizes 0 disable the feature
+    bool begin(uint32_t start, uint32_t end, uint32_t readAheadMax, uint32_t writeBackSize);
+    // writes back and releases the buffers
+    int end();
+
+    int read(uint32_t addr, uint32_t size, uint8_t* dst);
+    int prog(uint32_t addr, uint32_t size, const uint8_t* src);
+    int erase(uint32_t addr, uint32_t size);
+    int sync();
+
+protected:
+    void _invalidate(uint32_t addr, uint32_t size);
+
+    static bool _overlaps(uint32_t a, uint32_t aSize, uint32_t b, uint32_t bSize) {
+        return a < b + bSize && b < a + aSize;
+    }
+
+    uint32_t _start = 0;
+    uint32_t _end = 0;
+
+    std::unique_ptr<uint8_t[]> _readAhead;
+    uint32_t _readAheadMax = 0;
+    uint32_t _readAheadAddr = 0;
+    uint32_t _readAheadLen = 0;
+    uint32_t _window = 0;    // current read-ahead size, 0 after a random read
+    uint32_t _nextRead = ~0u;// where a sequential read would start
+
+    std::unique_ptr<uint8_t[]> _writeBack;
+    uint32_t _writeBackSize = 0;
+    uint32_t _writeBackAddr = 0;
+    uint32_t _writeBackLen = 0;
+};
+
+}; // namespace
+
+#endif // __FLASHCACHE_H
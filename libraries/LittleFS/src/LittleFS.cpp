@@ -168,7 +168,7 @@ int LittleFSImpl::lfs_flash_read(const struct lfs_config *c,
     lfs_block_t block, lfs_off_t off, void *dst, lfs_size_t size) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
     uint32_t addr = me->_start + (block * me->_blockSize) + off;
-    return flash_hal_read(addr, size, static_cast<uint8_t*>(dst)) == FLASH_HAL_OK ? 0 : -1;
+    return me->_flash.read(addr, size, static_cast<uint8_t*>(dst));
 }
 
 int LittleFSImpl::lfs_flash_prog(const struct lfs_config *c,
@@ -176,20 +176,19 @@ int LittleFSImpl::lfs_flash_prog(const struct lfs_config *c,
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
     uint32_t addr = me->_start + (block * me->_blockSize) + off;
     const uint8_t *src = reinterpret_cast<const uint8_t *>(buffer);
-    return flash_hal_write(addr, size, static_cast<const uint8_t*>(src)) == FLASH_HAL_OK ? 0 : -1;
+    return me->_flash.prog(addr, size, src);
 }
 
 int LittleFSImpl::lfs_flash_erase(const struct lfs_config *c, lfs_block_t block) {
     LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
     uint32_t addr = me->_start + (block * me->_blockSize);
     uint32_t size = me->_blockSize;
-    return flash_hal_erase(addr, size) == FLASH_HAL_OK ? 0 : -1;
+    return me->_flash.erase(addr, size);
 }
 
 int LittleFSImpl::lfs_flash_sync(const struct lfs_config *c) {
-    /* NOOP */
-    (void) c;
-    return 0;
+    LittleFSImpl *me = reinterpret_cast<LittleFSImpl*>(c->context);
+    return me->_flash.sync();
 }
 
 
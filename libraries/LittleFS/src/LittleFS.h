@@ -36,6 +36,7 @@
 
 #define LFS_NAME_MAX 32
 #include "../lib/littlefs/lfs.h"
+#include "FlashCache.h"
 
 using namespace fs;
 
@@ -49,6 +50,41 @@ class LittleFSConfig : public FSConfig
 public:
     static constexpr uint32_t FSId = 0x4c495454;
     LittleFSConfig(bool autoFormat = true) : FSConfig(FSId, autoFormat) { }
+
+    LittleFSConfig setAutoFormat(bool val = true) {
+        _autoFormat = val;
+        return *this;
+    }
+    // littlefs cache, also allocated for every open file. A multiple of 64
+    // which divides the block size. littlefs has no separate file buffer
+    // size (lfs_file_config passes a buffer of this size), larger file
+    // transfers come from setReadAhead() and setWriteBack()
+    LittleFSConfig setCacheSize(uint32_t size) {
+        _cacheSize = size;
+        return *this;
+    }
+    // bytes of the block allocator bitmap, one bit per block. A multiple of 8
+    LittleFSConfig setLookaheadSize(uint32_t size) {
+        _lookaheadSize = size;
+        return *this;
+    }
+    // largest read-ahead window for sequential reads, grown from 1KB. 0 disables
+    LittleFSConfig setReadAhead(uint32_t size) {
+        _readAhead = size;
+        return *this;
+    }
+    // buffer gathering littlefs programs into larger flash writes, a multiple
+    // of the flash page size. 0 disables
+    LittleFSConfig setWriteBack(uint32_t size) {
+        _writeBack = size;
+        return *this;
+    }
+
+    // Inherit _type and _autoFormat
+    uint32_t _cacheSize = 64;
+    uint32_t _lookaheadSize = 64;
+    uint32_t _readAhead = 0;
+    uint32_t _writeBack = 0;
 };
 
 class LittleFSImpl : public FSImpl
@@ -99,6 +135,24 @@ public:
         return rc == 0;
     }
 
+    bool stat(const char* path, FSStat& st) override {
+        if (!_mounted || !path || !path[0]) {
+            return false;
+        }
+        lfs_info info;
+        if (lfs_stat(&_lfs, path, &info) < 0) {
+            return false;
+        }
+        st.isDir = info.type == LFS_TYPE_DIR;
+        st.size = st.isDir ? 0 : info.size;
+        time_t ftime = 0;
+        int rc = lfs_getattr(&_lfs, path, 't', (void *)&ftime, sizeof(ftime));
+        if (rc != sizeof(ftime))
+            ftime = 0; // Error, so clear read value
+        st.lastWrite = ftime;
+        return true;
+    }
+
     bool rename(const char* pathFrom, const char* pathTo) override {
         if (!_mounted || !pathFrom || !pathFrom[0] || !pathTo || !pathTo[0]) {
             return false;
@@ -186,8 +240,24 @@ public:
         if ((cfg._type != LittleFSConfig::FSId) || _mounted) {
             return false;
         }
-        _cfg = *static_cast<const LittleFSConfig *>(&cfg);
-       return true;
+        const LittleFSConfig& lcfg = *static_cast<const LittleFSConfig *>(&cfg);
+        // read and prog sizes are 64, see the constructor
+        if (!lcfg._cacheSize || (lcfg._cacheSize % 64) || (_blockSize % lcfg._cacheSize)) {
+            DEBUGV("LittleFS cache size %u invalid\n", lcfg._cacheSize);
+            return false;
+        }
+        if (!lcfg._lookaheadSize || (lcfg._lookaheadSize % 8)) {
+            DEBUGV("LittleFS lookahead size %u invalid\n", lcfg._lookaheadSize);
+            return false;
+        }
+        if (lcfg._writeBack && (!_pageSize || (lcfg._writeBack % _pageSize))) {
+            DEBUGV("LittleFS write back size %u invalid\n", lcfg._writeBack);
+            return false;
+        }
+        _cfg = lcfg;
+        _lfs_cfg.cache_size = _cfg._cacheSize;
+        _lfs_cfg.lookahead_size = _cfg._lookaheadSize;
+        return true;
     }
 
     bool begin() override {
@@ -212,6 +282,7 @@ public:
             return;
         }
         lfs_unmount(&_lfs);
+        _flash.end();
         _mounted = false;
     }
 
@@ -228,7 +299,11 @@ public:
         }
 
         memset(&_lfs, 0, sizeof(_lfs));
+        _beginFlash();
         int rc = lfs_format(&_lfs, &_lfs_cfg);
+        if (rc == 0) {
+            rc = _flash.sync();
+        }
         if (rc != 0) {
             DEBUGV("lfs_format: rc=%d\n", rc);
             return false;
@@ -289,6 +364,7 @@ protected:
             _mounted = false;
         }
         memset(&_lfs, 0, sizeof(_lfs));
+        _beginFlash();
         int rc = lfs_mount(&_lfs, &_lfs_cfg);
         if (rc==0) {
             _mounted = true;
@@ -296,6 +372,12 @@ protected:
         return _mounted;
     }
 
+    void _beginFlash() {
+        if (!_flash.begin(_start, _start + _size, _cfg._readAhead, _cfg._writeBack)) {
+            DEBUGV("LittleFS no memory for read ahead or write back, running without\n");
+        }
+    }
+
     int _getUsedBlocks() {
         if (!_mounted) {
             return 0;
@@ -353,6 +435,7 @@ protected:
 
     lfs_t       _lfs;
     lfs_config  _lfs_cfg;
+    FlashCache  _flash;
 
     LittleFSConfig _cfg;
 
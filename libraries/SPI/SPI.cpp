@@ -21,6 +21,7 @@
 
 #include "SPI.h"
 #include "HardwareSerial.h"
+#include <ets_sys.h>
 
 #define SPI_PINS_HSPI			0 // Normal HSPI mode (MISO = GPIO12, MOSI = GPIO13, SCLK = GPIO14);
 #define SPI_PINS_HSPI_OVERLAP	1 // HSPI Overllaped in spi0 pins (MISO = SD0, MOSI = SDD1, SCLK = CLK);
@@ -42,6 +43,9 @@ typedef union {
 SPIClass::SPIClass() {
     useHwCs = false;
     pinSet = SPI_PINS_HSPI;
+    _queueHead = nullptr;
+    _queueTail = nullptr;
+    _queueUser = 0;
 }
 
 bool SPIClass::pins(int8_t sck, int8_t miso, int8_t mosi, int8_t ss)
@@ -87,6 +91,7 @@ void SPIClass::begin() {
 }
 
 void SPIClass::end() {
+    waitQueue();
     switch (pinSet) {
     case SPI_PINS_HSPI:
         pinMode(SCK, INPUT);
@@ -140,7 +145,7 @@ void SPIClass::setHwCs(bool use) {
 }
 
 void SPIClass::beginTransaction(SPISettings settings) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     setFrequency(settings._clock);
     setBitOrder(settings._bitOrder);
     setDataMode(settings._dataMode);
@@ -306,7 +311,7 @@ inline void SPIClass::setDataBits(uint16_t bits) {
 }
 
 uint8_t SPIClass::transfer(uint8_t data) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // reset to 8Bit mode
     setDataBits(8);
     SPI1W0 = data;
@@ -357,7 +362,7 @@ void SPIClass::transfer(void *buf, uint16_t count) {
 }
 
 void SPIClass::write(uint8_t data) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // reset to 8Bit mode
     setDataBits(8);
     SPI1W0 = data;
@@ -370,7 +375,7 @@ void SPIClass::write16(uint16_t data) {
 }
 
 void SPIClass::write16(uint16_t data, bool msb) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // Set to 16Bits transfer
     setDataBits(16);
     if(msb) {
@@ -389,7 +394,7 @@ void SPIClass::write32(uint32_t data) {
 }
 
 void SPIClass::write32(uint32_t data, bool msb) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // Set to 32Bits transfer
     setDataBits(32);
     if(msb) {
@@ -427,7 +432,7 @@ void SPIClass::writeBytes(const uint8_t * data, uint32_t size) {
 }
 
 void SPIClass::writeBytes_(const uint8_t * data, uint8_t size) {
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // Set Bits to transfer
     setDataBits(size * 8);
 
@@ -454,7 +459,7 @@ void SPIClass::writeBytes_(const uint8_t * data, uint8_t size) {
 void SPIClass::writePattern(const uint8_t * data, uint8_t size, uint32_t repeat) {
     if(size > 64) return; //max Hardware FIFO
 
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
 
     uint32_t buffer[16];
     uint8_t *bufferPtr=(uint8_t *)&buffer;
@@ -556,7 +561,7 @@ void SPIClass::transferBytesAligned_(const uint8_t * out, uint8_t * in, uint8_t
     if (!size)
         return;
 
-    while(SPI1CMD & SPIBUSY) {}
+    waitQueue();
     // Set in/out Bits to transfer
 
     setDataBits(size * 8);
@@ -599,7 +604,7 @@ void SPIClass::transferBytesAligned_(const uint8_t * out, uint8_t * in, uint8_t
 
 
 void SPIClass::transferBytes_(const uint8_t * out, uint8_t * in, uint8_t size) {
-    if (!((uint32_t)out & 3) && !((uint32_t)in & 3)) {
+    if (!((uintptr_t)out & 3) && !((uintptr_t)in & 3)) {
         // Input and output are both 32b aligned or NULL
         transferBytesAligned_(out, in, size);
     } else {
@@ -618,6 +623,156 @@ void SPIClass::transferBytes_(const uint8_t * out, uint8_t * in, uint8_t size) {
 }
 
 
+/**
+ * Queue a transaction, started at once when the bus is idle, else after the
+ * ones already queued.  Can be called from a transaction callback, so it is
+ * in IRAM with all it calls.
+ * @param transaction SPITransaction &
+ * @return false if invalid or already queued
+ */
+bool IRAM_ATTR SPIClass::queue(SPITransaction & transaction) {
+    if(transaction._pending || transaction.commandBits > 16 || transaction.addressBits > 32) {
+        return false;
+    }
+    if(!transaction.commandBits && !transaction.addressBits && !transaction.length) {
+        return false;
+    }
+
+    transaction._next = nullptr;
+    transaction._done = 0;
+    transaction._pending = true;
+
+    ETS_SPI_INTR_DISABLE();
+    if(_queueHead) {
+        _queueTail->_next = &transaction;
+        _queueTail = &transaction;
+    } else {
+        _queueHead = _queueTail = &transaction;
+        while(SPI1CMD & SPIBUSY) {}
+        _queueUser = SPI1U;
+        ETS_SPI_INTR_ATTACH(queueISR_, this);
+        SPI1S = (SPI1S & ~SPISTRIS) | SPISTRIE;
+        queueStart_(&transaction);
+    }
+    ETS_SPI_INTR_ENABLE();
+    return true;
+}
+
+/**
+ * Wait until the queued transactions are done.
+ * Not to be called from a transaction callback.
+ */
+void SPIClass::waitQueue() {
+    while((SPI1CMD & SPIBUSY) || _queueHead) {}
+}
+
+/**
+ * Start the next transfer of a transaction: the command and address phases
+ * then up to 64 bytes of data.
+ */
+void IRAM_ATTR SPIClass::queueStart_(SPITransaction * transaction) {
+    uint32_t user = _queueUser & ~(SPIUCOMMAND | SPIUADDR | SPIUDUMMY | SPIUMOSI | SPIUMISO | SPIUDUPLEX);
+    uint32_t user1 = SPI1U1 & ~((SPIMADDR << SPILADDR) | (SPIMMOSI << SPILMOSI) | (SPIMMISO << SPILMISO) | (SPIMDUMMY << SPILDUMMY));
+    const uint32_t done = transaction->_done;
+    const uint32_t size = std::min(transaction->length - done, (uint32_t)64);
+
+    if(!done) {
+        if(transaction->csPin >= 0) {
+            digitalWrite(transaction->csPin, LOW);
+        }
+        if(transaction->commandBits) {
+            // the command register is sent bits 7..0 then 15..8
+            const uint32_t bits = transaction->commandBits;
+            const uint16_t command = transaction->command << (16 - bits);
+            user |= SPIUCOMMAND;
+            SPI1U2 = ((bits - 1) << SPILCOMMAND) | (command >> 8) | ((command & 0xff) << 8);
+        }
+        if(transaction->addressBits) {
+            // the address register is sent from bit 31
+            const uint32_t bits = transaction->addressBits;
+            user |= SPIUADDR;
+            user1 |= (bits - 1) << SPILADDR;
+            SPI1A = bits < 32 ? transaction->address << (32 - bits) : transaction->address;
+        }
+    }
+
+    if(size) {
+        user |= SPIUMOSI;
+        user1 |= (size * 8 - 1) << SPILMOSI;
+        if(transaction->in) {
+            user |= SPIUDUPLEX;
+            user1 |= (size * 8 - 1) << SPILMISO;
+        }
+
+        volatile uint32_t * fifoPtr = &SPI1W0;
+        const uint8_t * out = transaction->out ? transaction->out + done : nullptr;
+        for(uint32_t i = 0; i < size; i += 4) {
+            uint32_t word = 0xFFFFFFFF;
+            if(out) {
+                // out may not be 32bits-aligned
+                word = 0;
+                for(uint32_t b = 0; b < 4 && i + b < size; b++) {
+                    word |= out[i + b] << (b * 8);
+                }
+            }
+            *(fifoPtr++) = word;
+        }
+    }
+
+    SPI1U = user;
+    SPI1U1 = user1;
+    __sync_synchronize();
+    SPI1CMD |= SPIBUSY;
+}
+
+void IRAM_ATTR SPIClass::queueISR_(void * arg, void * frame) {
+    (void) frame;
+    SPIClass * self = static_cast<SPIClass*>(arg);
+    if(!(SPI1S & SPISTRIS)) {
+        return;
+    }
+    SPI1S &= ~SPISTRIS;
+
+    SPITransaction * transaction = self->_queueHead;
+    if(!transaction) {
+        return;
+    }
+
+    const uint32_t size = std::min(transaction->length - transaction->_done, (uint32_t)64);
+    if(transaction->in) {
+        volatile uint32_t * fifoPtr = &SPI1W0;
+        uint8_t * in = transaction->in + transaction->_done;
+        for(uint32_t i = 0; i < size; i += 4) {
+            uint32_t word = *(fifoPtr++);
+            for(uint32_t b = 0; b < 4 && i + b < size; b++) {
+                in[i + b] = word >> (b * 8);
+            }
+        }
+    }
+    transaction->_done += size;
+    if(transaction->_done < transaction->length) {
+        self->queueStart_(transaction);
+        return;
+    }
+
+    if(transaction->csPin >= 0) {
+        digitalWrite(transaction->csPin, HIGH);
+    }
+    // the next transaction runs during the callback
+    self->_queueHead = transaction->_next;
+    if(self->_queueHead) {
+        self->queueStart_(self->_queueHead);
+    } else {
+        SPI1S &= ~SPISTRIE;
+        SPI1U = self->_queueUser;
+    }
+    transaction->_next = nullptr;
+    transaction->_pending = false;
+    if(transaction->callback) {
+        transaction->callback(transaction);
+    }
+}
+
 #if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_SPI)
 SPIClass SPI;
 #endif
@@ -49,6 +49,39 @@ public:
   uint8_t  _dataMode;
 };
 
+/**
+ * A transaction for SPIClass::queue(): an optional command phase (up to 16
+ * bits), an optional address phase (up to 32 bits), then length data bytes
+ * sent from out and received into in, with the clock, mode and bit order in
+ * effect when it starts.  Its memory must stay valid until it completes.
+ * Longer than 64 bytes, the data goes as 64-byte transfers, between which
+ * the hardware CS (setHwCs()) is released: a csPin is held LOW for the whole
+ * transaction.
+ */
+class SPITransaction {
+public:
+  uint16_t command = 0;
+  uint8_t commandBits = 0;        ///< 0: no command phase
+  uint8_t addressBits = 0;        ///< 0: no address phase
+  uint32_t address = 0;
+  const uint8_t * out = nullptr;  ///< nullptr: sends 0xff
+  uint8_t * in = nullptr;         ///< nullptr: received data is dropped
+  uint32_t length = 0;
+  int8_t csPin = -1;              ///< -1: none
+  /// called from the SPI interrupt, so an IRAM_ATTR function, where
+  /// SPIClass::queue() is the only SPI call allowed
+  void (*callback)(SPITransaction * transaction) = nullptr;
+  void * arg = nullptr;
+
+  bool pending() const { return _pending; }
+
+private:
+  friend class SPIClass;
+  SPITransaction * _next = nullptr;
+  uint32_t _done = 0;
+  volatile bool _pending = false;
+};
+
 class SPIClass {
 public:
   SPIClass();
@@ -73,9 +106,18 @@ public:
   void writePattern(const uint8_t * data, uint8_t size, uint32_t repeat);
   void transferBytes(const uint8_t * out, uint8_t * in, uint32_t size);
   void endTransaction(void);
+  // asynchronous transactions, beginTransaction() and the transfers wait for them
+  bool queue(SPITransaction & transaction);
+  bool queueIdle() const { return !_queueHead; }
+  void waitQueue();
 private:
   bool useHwCs;
   uint8_t pinSet;
+  SPITransaction * volatile _queueHead;
+  SPITransaction * _queueTail;
+  uint32_t _queueUser;
+  void queueStart_(SPITransaction * transaction);
+  static void queueISR_(void * arg, void * frame);
   void writeBytes_(const uint8_t * data, uint8_t size);
   void transferBytes_(const uint8_t * out, uint8_t * in, uint8_t size);
   void transferBytesAligned_(const uint8_t * out, uint8_t * in, uint8_t size);
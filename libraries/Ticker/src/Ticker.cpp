@@ -26,7 +26,44 @@
 #include <Arduino.h>
 #include "Ticker.h"
 
-// ETSTimer is part of the instance, and we don't have any state besides
+// Tickers wait in one timer wheel, in milliseconds, so that many of them
+// cost a single SDK timer: it is armed for the next tick of the wheel.
+// NONOS SDK timer object duration cannot be longer than 6870947 (0x68D7A3)
+static constexpr uint32_t WheelTimerMax = 6870947;
+
+static ETSTimer wheelTimer;
+static bool wheelRunning = false;
+
+static TimerWheel& wheel()
+{
+    static TimerWheel tickers;
+    return tickers;
+}
+
+static void wheelArm(ETSTimerFunc* callback)
+{
+    os_timer_disarm(&wheelTimer);
+    uint32_t tick;
+    if (!wheel().nextTick(tick)) {
+        return;
+    }
+    int32_t delay = tick - millis();
+    os_timer_setfn(&wheelTimer, callback, nullptr);
+    os_timer_arm(&wheelTimer, delay <= 0 ? 0 : std::min((uint32_t)delay, WheelTimerMax), false);
+}
+
+void Ticker::_wheel_callback(void*)
+{
+    wheelRunning = true;
+    const uint32_t now = millis();
+    while (auto timer = wheel().expire(now)) {
+        static_cast<wheel_timer_t*>(timer)->ticker->_static_callback();
+    }
+    wheelRunning = false;
+    wheelArm(_wheel_callback);
+}
+
+// The wheel timer is part of the instance, and we don't have any state besides
 // the things required for the callback. Allow copies and moves, but
 // disable any member copies and default-init + detach() instead.
 
@@ -59,17 +96,6 @@ Ticker& Ticker::operator=(Ticker&& other) noexcept
 
 void Ticker::_attach(Ticker::Milliseconds milliseconds, bool repeat)
 {
-    if (_timer) {
-        os_timer_disarm(_timer);
-    } else {
-        _timer = &_timer_internal;
-    }
-
-    os_timer_setfn(_timer,
-        [](void* ptr) {
-            reinterpret_cast<Ticker*>(ptr)->_static_callback();
-        }, this);
-
     _repeat = repeat;
 
     // whenever duration excedes this limit, make timer repeatable N times
@@ -86,16 +112,26 @@ void Ticker::_attach(Ticker::Milliseconds milliseconds, bool repeat)
             .count = 0,
         });
         repeat = true;
+    } else {
+        _tick.reset(nullptr);
     }
 
-    os_timer_arm(_timer, milliseconds.count(), repeat);
+    _timer.ticker = this;
+    _timer.resetStats();
+    wheel().add(_timer, millis(), milliseconds.count(), repeat ? milliseconds.count() : 0);
+    _attached = true;
+
+    // from a callback, the wheel is armed again once they all ran
+    if (!wheelRunning) {
+        wheelArm(_wheel_callback);
+    }
 }
 
 void Ticker::detach()
 {
-    if (_timer) {
-        os_timer_disarm(_timer);
-        _timer = nullptr;
+    if (_attached) {
+        wheel().cancel(_timer);
+        _attached = false;
         _tick.reset(nullptr);
         _callback = std::monostate{};
     }
@@ -103,7 +139,7 @@ void Ticker::detach()
 
 bool Ticker::active() const
 {
-    return _timer != nullptr;
+    return _attached;
 }
 
 void Ticker::_static_callback()
@@ -130,9 +166,9 @@ void Ticker::_static_callback()
     }, tmp);
 
     // ...and move ourselves back only when object is in a valid state
-    // * ticker was not detached, zeroing timer pointer
+    // * ticker was not detached
     // * nothing else replaced callback variant
-    if ((_timer == nullptr) || !std::holds_alternative<std::monostate>(_callback)) {
+    if (!_attached || !std::holds_alternative<std::monostate>(_callback)) {
         return;
     }
 
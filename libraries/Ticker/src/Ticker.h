@@ -28,6 +28,7 @@
 
 #include <Arduino.h>
 #include <Schedule.h>
+#include <TimerWheel.h>
 #include <ets_sys.h>
 
 class Ticker
@@ -172,6 +173,11 @@ public:
         return active();
     }
 
+    // calls and lateness (in ms) since the last attach or once
+    const TimerWheelStats& stats() const {
+        return _timer.stats();
+    }
+
 protected:
     // internals use this as duration
     using Milliseconds = std::chrono::duration<uint32_t, std::ratio<1, 1000>>;
@@ -180,9 +186,9 @@ protected:
     // float -> u32 has some precision issues, though
     using Seconds = std::chrono::duration<float, std::ratio<1>>;
 
-    // NONOS SDK timer object duration cannot be longer than 6870947 (0x68D7A3)
+    // all tickers share a timer wheel, delays cannot be longer than 2^31-1 ms
     // when that's the case, we split execution into multiple 'ticks'
-    static constexpr auto DurationMax = Milliseconds(6870947);
+    static constexpr auto DurationMax = Milliseconds(TimerWheel::maxDelay);
 
     struct callback_tick_t
     {
@@ -191,6 +197,7 @@ protected:
     };
 
     void _static_callback();
+    static void _wheel_callback(void*);
 
     void _attach(Milliseconds milliseconds, bool repeat);
     void _attach(Seconds seconds, bool repeat)
@@ -200,8 +207,13 @@ protected:
 
     std::unique_ptr<callback_tick_t> _tick;
     bool _repeat = false;
+    bool _attached = false;
 
-    ETSTimer* _timer = nullptr;
+    struct wheel_timer_t : TimerWheelTimer
+    {
+        Ticker* ticker = nullptr;
+    };
+    wheel_timer_t _timer;
 
 private:
     struct callback_ptr_t
@@ -231,5 +243,4 @@ private:
         callback_function_t>;
 
     callback_data_t _callback;
-    ETSTimer _timer_internal{};
 };
@@ -0,0 +1,63 @@
+/*
+   I2S output filled in place: a 440Hz tone computed straight into the DMA
+   blocks lent by i2s_tx_block_get(), handed back with i2s_tx_block_submit().
+
+   Every second, prints how many blocks were played before they were
+   submitted (i2s_tx_underruns()).  Send 'd' on the serial port to hold a
+   block longer than the DMA takes to play all the others: that one is
+   counted, and played once submitted.
+
+   Released to the Public Domain
+*/
+
+#include <core_esp8266_i2s.h>
+
+const uint32_t sampleRate = 22050;
+const float frequency = 440;
+
+float phase = 0;
+bool holdBlock = false;
+
+// one 32-bit sample is the right channel in the upper 16 bits, the left one
+// in the lower 16 bits
+void fillBlock(uint32_t *block, uint16_t samples) {
+  for (uint16_t i = 0; i < samples; i++) {
+    int16_t value = 8000 * sinf(phase);
+    block[i] = ((uint32_t)(uint16_t)value << 16) | (uint16_t)value;
+    phase += 2 * PI * frequency / sampleRate;
+    if (phase >= 2 * PI) { phase -= 2 * PI; }
+  }
+}
+
+void setup() {
+  Serial.begin(115200);
+  Serial.println("\nI2S zero-copy tone");
+
+  // 16 blocks of 256 samples: 186ms of sound queued at 22050Hz
+  i2s_set_dma_buffers(16, 256);
+  if (!i2s_rxtx_begin(false, true)) {
+    Serial.println("Failed to initialize I2S!");
+    while (1) { delay(1000); }
+  }
+  i2s_set_rate(sampleRate);
+}
+
+void loop() {
+  // fill all the free blocks, without waiting for more
+  while (uint32_t *block = i2s_tx_block_get(false)) {
+    fillBlock(block, i2s_block_samples());
+    if (holdBlock) {
+      holdBlock = false;
+      delay(250);
+    }
+    i2s_tx_block_submit(block);
+  }
+
+  if (Serial.read() == 'd') { holdBlock = true; }
+
+  static uint32_t last = 0;
+  if (millis() - last >= 1000) {
+    last = millis();
+    Serial.printf("underruns: %u\n", (unsigned)i2s_tx_underruns());
+  }
+}
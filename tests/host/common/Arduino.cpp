@@ -43,6 +43,7 @@ extern "C" unsigned long micros()
 
 extern "C" void yield()
 {
+    mock_uart_yield();
     run_scheduled_recurrent_functions();
 }
 
@@ -60,13 +61,17 @@ extern "C" bool can_yield()
 extern "C" void optimistic_yield(uint32_t interval_us)
 {
     (void)interval_us;
+    mock_uart_yield();
 }
 
 extern "C" void esp_suspend() { }
 
 extern "C" void esp_schedule() { }
 
-extern "C" void esp_yield() { }
+extern "C" void esp_yield()
+{
+    mock_uart_yield();
+}
 
 extern "C" void esp_delay(unsigned long ms)
 {
@@ -83,6 +83,11 @@ void pinMode(uint8_t pin, uint8_t mode)
     }
 }
 
+uint8_t mock_pin_mode(uint8_t pin)
+{
+    return pin < GPIONUM ? _mode[pin] : 0;
+}
+
 void digitalWrite(uint8_t pin, uint8_t val)
 {
     VERBOSE("digitalWrite(pin=%d val=%d)\n", pin, val);
@@ -92,22 +97,12 @@ void digitalWrite(uint8_t pin, uint8_t val)
     }
 }
 
-void analogWrite(uint8_t pin, int val)
-{
-    VERBOSE("analogWrite(pin=%d, val=%d\n", pin, val);
-}
-
 int analogRead(uint8_t pin)
 {
     (void)pin;
     return 512;
 }
 
-void analogWriteRange(uint32_t range)
-{
-    VERBOSE("analogWriteRange(range=%d)\n", range);
-}
-
 int digitalRead(uint8_t pin)
 {
     VERBOSE("digitalRead(%d)\n", pin);
@@ -36,6 +36,9 @@
 
 #include <stdlib.h>
 
+#include <map>
+#include <vector>
+
 #include <user_interface.h>
 struct rst_info resetInfo;
 
@@ -171,9 +174,19 @@ void EspClass::getHeapStats(uint32_t* hfree, uint32_t* hmax, uint8_t* hfrag)
         *hfrag = 100 - (sqrt(hm) * 100) / hf;
 }
 
+// Sparse flash for ESP.flash*(), sectors read erased until written
+static std::vector<uint8_t>& mockFlashSector(uint32_t offset)
+{
+    static std::map<uint32_t, std::vector<uint8_t>> sectors;
+    std::vector<uint8_t>& sector = sectors[offset / FLASH_SECTOR_SIZE];
+    if (sector.empty())
+        sector.assign(FLASH_SECTOR_SIZE, 0xff);
+    return sector;
+}
+
 bool EspClass::flashEraseSector(uint32_t sector)
 {
-    (void)sector;
+    mockFlashSector(sector * FLASH_SECTOR_SIZE).assign(FLASH_SECTOR_SIZE, 0xff);
     return true;
 }
 
@@ -190,33 +203,26 @@ FlashMode_t EspClass::magicFlashChipMode(uint8_t byte)
 
 bool EspClass::flashWrite(uint32_t offset, const uint32_t* data, size_t size)
 {
-    (void)offset;
-    (void)data;
-    (void)size;
-    return true;
+    return flashWrite(offset, (const uint8_t*)data, size);
 }
 
 bool EspClass::flashWrite(uint32_t offset, const uint8_t* data, size_t size)
 {
-    (void)offset;
-    (void)data;
-    (void)size;
+    // NOR flash, writing only clears bits
+    for (size_t i = 0; i < size; i++, offset++)
+        mockFlashSector(offset)[offset % FLASH_SECTOR_SIZE] &= data[i];
     return true;
 }
 
 bool EspClass::flashRead(uint32_t offset, uint32_t* data, size_t size)
 {
-    (void)offset;
-    (void)data;
-    (void)size;
-    return true;
+    return flashRead(offset, (uint8_t*)data, size);
 }
 
 bool EspClass::flashRead(uint32_t offset, uint8_t* data, size_t size)
 {
-    (void)offset;
-    (void)data;
-    (void)size;
+    for (size_t i = 0; i < size; i++, offset++)
+        data[i] = mockFlashSector(offset)[offset % FLASH_SECTOR_SIZE];
     return true;
 }
 
@@ -265,18 +271,6 @@ uint32_t EspClass::getFreeContStack()
 
 void EspClass::resetFreeContStack() { }
 
-uint32_t EspClass::getCycleCount()
-{
-    return esp_get_cycle_count();
-}
-
-uint32_t esp_get_cycle_count()
-{
-    timeval t;
-    gettimeofday(&t, NULL);
-    return (((uint64_t)t.tv_sec) * 1000000 + t.tv_usec) * (F_CPU / 1000000);
-}
-
 void EspClass::setDramHeap() { }
 
 void EspClass::setIramHeap() { }
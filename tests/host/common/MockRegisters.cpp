@@ -0,0 +1,551 @@
+/*
+ MockRegisters.cpp - esp8266 peripheral registers and interrupts emulation
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+/*
+ Registers (ESP8266_REG() and ESP8266_DREG(), see mock.h) are plain memory,
+ zero until written, in pages so that drivers can walk consecutive ones
+ (SPI1W0..SPI1W15) through a pointer.  Accessing some of them runs the
+ emulated hardware: the SPI1 controller, UART0 and UART1, and with the cycle
+ counter, timer 1 and the GPIO outputs.
+ */
+
+#include <Arduino.h>
+#include <ets_sys.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <deque>
+#include <map>
+
+// register memory, no hardware side effect
+static volatile uint32_t& mock_register_raw(uint32_t address)
+{
+    static std::map<uint32_t, std::vector<uint32_t>> pages;
+    std::vector<uint32_t>&                           page = pages[address >> 12];
+    if (page.empty())
+        page.resize(1024, 0);
+    return *(volatile uint32_t*)&page[(address & 0xfff) >> 2];
+}
+
+#define MOCK_REG(addr) mock_register_raw(0x60000000 + (addr))
+
+static void mock_spi1_cmd_access();
+static void mock_uart_access(int uart_nr, uint32_t reg);
+static void mock_gpio_access();
+
+extern "C" volatile uint32_t* mock_register(uint32_t address)
+{
+    if (address == 0x60000000 + 0x100)  // SPI1CMD
+        mock_spi1_cmd_access();
+    else if (address >= 0x60000000 && address < 0x60000000 + 0x80)  // UART0
+        mock_uart_access(UART0, address & 0x7f);
+    else if (address >= 0x60000000 + 0xF00 && address < 0x60000000 + 0xF80)  // UART1
+        mock_uart_access(UART1, address & 0x7f);
+    else if ((address >= 0x60000000 + 0x300 && address <= 0x60000000 + 0x308)
+             || address == 0x60000000 + 0x768)  // GPO, GPOS, GPOC, GP16O
+        mock_gpio_access();
+    return &mock_register_raw(address);
+}
+
+/**********************************************************/
+/************ interrupts **********************************/
+/**********************************************************/
+
+static int_handler_t isr_handler[32];
+static void*         isr_arg[32];
+static uint32_t      isr_masked  = 0xffffffff;
+static uint32_t      isr_pending = 0;
+static uint32_t      isr_running = 0;
+
+static void mock_isr_deliver()
+{
+    uint32_t run;
+    // like the level 1 interrupt, handlers are not reentered
+    while ((run = isr_pending & ~isr_masked & ~isr_running))
+    {
+        int inum = __builtin_ctz(run);
+        isr_pending &= ~(1 << inum);
+        if (isr_handler[inum])
+        {
+            isr_running |= 1 << inum;
+            isr_handler[inum](isr_arg[inum], nullptr);
+            isr_running &= ~(1 << inum);
+        }
+    }
+}
+
+extern "C"
+{
+    void ets_isr_attach(int intr, int_handler_t handler, void* arg)
+    {
+        isr_handler[intr] = handler;
+        isr_arg[intr]     = arg;
+    }
+
+    void ets_isr_mask(int intr)
+    {
+        isr_masked |= intr;
+    }
+
+    void ets_isr_unmask(int intr)
+    {
+        isr_masked &= ~intr;
+        mock_isr_deliver();
+    }
+};
+
+void mock_isr_raise(int inum)
+{
+    isr_pending |= 1 << inum;
+    mock_isr_deliver();
+}
+
+/**********************************************************/
+/************ SPI1 ****************************************/
+/**********************************************************/
+
+static std::function<void(const MockSPI1Transfer&, uint8_t* miso, size_t misoSize)> spi1_device;
+
+void mock_spi1_device(
+    std::function<void(const MockSPI1Transfer&, uint8_t* miso, size_t misoSize)> device)
+{
+    spi1_device = std::move(device);
+}
+
+// phases as set in SPI1U, SPI1U1 and SPI1U2, data in SPI1W0..SPI1W15
+static void mock_spi1_transfer()
+{
+    const uint32_t user  = MOCK_REG(0x11C);
+    const uint32_t user1 = MOCK_REG(0x120);
+    const uint32_t user2 = MOCK_REG(0x124);
+
+    MockSPI1Transfer transfer {};
+    if (user & SPIUCOMMAND)
+    {
+        // sent bits 7..0 then 15..8
+        transfer.commandBits = ((user2 >> SPILCOMMAND) & SPIMCOMMAND) + 1;
+        uint16_t value       = user2 & 0xffff;
+        uint16_t sequence    = (value << 8) | (value >> 8);
+        transfer.command     = sequence >> (16 - transfer.commandBits);
+    }
+    if (user & SPIUADDR)
+    {
+        // sent from bit 31
+        transfer.addressBits = ((user1 >> SPILADDR) & SPIMADDR) + 1;
+        uint32_t value       = MOCK_REG(0x104);
+        transfer.address = transfer.addressBits < 32 ? value >> (32 - transfer.addressBits) : value;
+    }
+
+    uint8_t data[64];
+    for (int i = 0; i < 16; i++)
+    {
+        uint32_t w = MOCK_REG(0x140 + i * 4);
+        memcpy(data + i * 4, &w, 4);
+    }
+    if (user & SPIUMOSI)
+    {
+        size_t bytes = (((user1 >> SPILMOSI) & SPIMMOSI) + 8) / 8;
+        transfer.mosi.assign(data, data + std::min(bytes, sizeof(data)));
+    }
+
+    size_t misoSize = 0;
+    if (user & (SPIUMISO | SPIUDUPLEX))
+        misoSize = std::min((size_t)(((user1 >> SPILMISO) & SPIMMISO) + 8) / 8, sizeof(data));
+    uint8_t miso[64];
+    memcpy(miso, data, sizeof(miso));
+    if (spi1_device)
+        spi1_device(transfer, miso, misoSize);
+    if (misoSize)
+    {
+        memcpy(data, miso, misoSize);
+        for (int i = 0; i < 16; i++)
+            memcpy((void*)&MOCK_REG(0x140 + i * 4), data + i * 4, 4);
+    }
+}
+
+bool mock_spi1_complete()
+{
+    static bool running = false;
+    if (running || !(MOCK_REG(0x100) & SPIBUSY))
+        return false;
+
+    running = true;
+    mock_spi1_transfer();
+    MOCK_REG(0x100) &= ~SPIBUSY;
+    MOCK_REG(0x130) |= SPISTRIS;
+    running = false;
+
+    if (MOCK_REG(0x130) & SPISTRIE)
+        mock_isr_raise(ETS_SPI_INUM);
+    return true;
+}
+
+// software polls SPI1CMD to wait for transfers, they take that long
+static void mock_spi1_cmd_access()
+{
+    mock_spi1_complete();
+}
+
+/**********************************************************/
+/************ UART0, UART1 ********************************/
+/**********************************************************/
+
+// USF holds 0x100 and the next RX byte when accessed: the access was a read
+// unless software wrote a byte there.  It is settled at the next access of
+// the UART registers, with the FIFO resets of USC0, the interrupt clears of
+// USIC, the FIFO counts of USS and the interrupt raised for USIS.
+//
+// Written bytes are sent right away.  A stalled UART sends them only when
+// software waits for it, at yields or polling a full TX FIFO, or when
+// mock_uart_tx() does.
+
+struct MockUART
+{
+    std::deque<uint8_t> tx;
+    std::deque<uint8_t> rx;
+    bool                stalled   = false;
+    bool                usf       = false;  // accessed, not settled
+    uint32_t            fullPolls = 0;
+};
+
+static MockUART                                  uart_emu[2];
+static std::function<void(int uart_nr, char c)> uart_output;
+static void (*uart_putc1)(char)                  = nullptr;
+
+#define MOCK_UART_REG(uart_nr, reg) MOCK_REG(0xF00 * (uart_nr) + (reg))
+
+static size_t mock_uart_send(int uart_nr, size_t count)
+{
+    MockUART& uart = uart_emu[uart_nr];
+    size_t    sent = 0;
+    for (; sent < count && !uart.tx.empty(); sent++)
+    {
+        char c = uart.tx.front();
+        uart.tx.pop_front();
+        if (uart_output)
+        {
+            uart_output(uart_nr, c);
+        }
+        else
+        {
+            // UART0 to stdout, UART1 to stderr
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-result"
+            write(uart_nr + 1, &c, 1);
+#pragma GCC diagnostic pop
+        }
+    }
+    return sent;
+}
+
+static void mock_uart_settle(int uart_nr)
+{
+    MockUART& uart = uart_emu[uart_nr];
+    if (uart.usf)
+    {
+        uint32_t usf = MOCK_UART_REG(uart_nr, 0x00);  // USF
+        if (usf < 0x100)
+        {
+            // lost when the FIFO is full
+            if (uart.tx.size() < UART_TX_FIFO_SIZE)
+                uart.tx.push_back(usf);
+        }
+        else if (!uart.rx.empty())
+        {
+            uart.rx.pop_front();
+        }
+        uart.usf = false;
+    }
+
+    uint32_t conf0 = MOCK_UART_REG(uart_nr, 0x20);  // USC0
+    if (conf0 & (1 << UCTXRST))
+        uart.tx.clear();
+    if (conf0 & (1 << UCRXRST))
+        uart.rx.clear();
+    if (!uart.stalled)
+        mock_uart_send(uart_nr, uart.tx.size());
+
+    // FIFO levels beyond the USC1 thresholds raise again what USIC cleared
+    uint32_t conf1 = MOCK_UART_REG(uart_nr, 0x24);
+    uint32_t raw   = MOCK_UART_REG(uart_nr, 0x04) & ~MOCK_UART_REG(uart_nr, 0x10);
+    MOCK_UART_REG(uart_nr, 0x10) = 0;
+    if (uart.tx.size() < ((conf1 >> UCFET) & 0x7f))
+        raw |= 1 << UIFE;
+    if (!uart.rx.empty() && uart.rx.size() >= ((conf1 >> UCFFT) & 0x7f))
+        raw |= 1 << UIFF;
+    MOCK_UART_REG(uart_nr, 0x04) = raw;
+    MOCK_UART_REG(uart_nr, 0x08) = raw & MOCK_UART_REG(uart_nr, 0x0C);
+    MOCK_UART_REG(uart_nr, 0x1C) = (std::min(uart.tx.size(), (size_t)0xff) << USTXC)
+                                   | (std::min(uart.rx.size(), (size_t)0xff) << USRXC);
+}
+
+static void mock_uart_settle()
+{
+    mock_uart_settle(UART0);
+    mock_uart_settle(UART1);
+    if (!MOCK_UART_REG(UART0, 0x08) && !MOCK_UART_REG(UART1, 0x08))
+        return;
+
+    // then the last access of the handler
+    mock_isr_raise(ETS_UART_INUM);
+    mock_uart_settle(UART0);
+    mock_uart_settle(UART1);
+}
+
+static void mock_uart_access(int uart_nr, uint32_t reg)
+{
+    mock_uart_settle();
+
+    MockUART& uart = uart_emu[uart_nr];
+    if (reg == 0x1C && uart.stalled && uart.tx.size() >= 0x7f)
+    {
+        // software spinning on a full FIFO waits for the UART
+        if (++uart.fullPolls >= 16)
+        {
+            uart.fullPolls = 0;
+            mock_uart_send(uart_nr, 1);
+            mock_uart_settle();
+        }
+    }
+    else
+    {
+        uart.fullPolls = 0;
+    }
+
+    if (reg == 0x00)
+    {
+        MOCK_UART_REG(uart_nr, 0x00) = 0x100 | (uart.rx.empty() ? 0 : uart.rx.front());
+        uart.usf                     = true;
+    }
+}
+
+void mock_uart_yield()
+{
+    mock_uart_settle();
+    for (int uart_nr = UART0; uart_nr <= UART1; uart_nr++)
+        mock_uart_send(uart_nr, uart_emu[uart_nr].tx.size());
+    mock_uart_settle();
+}
+
+void mock_uart_tx_output(std::function<void(int uart_nr, char c)> output)
+{
+    uart_output = std::move(output);
+}
+
+void mock_uart_tx_stall(int uart_nr, bool stall)
+{
+    mock_uart_settle();
+    uart_emu[uart_nr].stalled = stall;
+    mock_uart_settle();
+}
+
+size_t mock_uart_tx(int uart_nr, size_t count)
+{
+    mock_uart_settle();
+    size_t sent = mock_uart_send(uart_nr, count);
+    mock_uart_settle();
+    return sent;
+}
+
+size_t mock_uart_rx(int uart_nr, const char* data, size_t size)
+{
+    mock_uart_settle();
+    MockUART& uart     = uart_emu[uart_nr];
+    size_t    received = 0;
+    for (; received < size; received++)
+    {
+        if (uart.rx.size() == UART_TX_FIFO_SIZE)
+        {
+            MOCK_UART_REG(uart_nr, 0x04) |= 1 << UIOF;
+            break;
+        }
+        uart.rx.push_back(data[received]);
+    }
+    mock_uart_settle();
+    return received;
+}
+
+void mock_putc1(char c)
+{
+    if (uart_putc1)
+        uart_putc1(c);
+}
+
+// the ROM and SDK functions behind uart_set_debug() and uart_detect_baudrate()
+extern "C"
+{
+    void ets_install_putc1(void (*putc1)(char))
+    {
+        uart_putc1 = putc1;
+    }
+
+    void system_set_os_print(uint8_t onoff)
+    {
+        (void)onoff;
+    }
+
+    void uart_buff_switch(uint8_t uart_nr)
+    {
+        (void)uart_nr;
+    }
+
+    int uart_baudrate_detect(int uart_nr, int async)
+    {
+        (void)uart_nr;
+        (void)async;
+        return 0;
+    }
+};
+
+/**********************************************************/
+/************ cycle counter, timer 1, GPIO outputs ********/
+/**********************************************************/
+
+// Register writes are seen at the next access or cycle counter read, which is
+// when the timer (re)starts from a new T1L value and the GPIO outputs change.
+
+static bool     cycles_simulated = false;
+static uint32_t cycles_step      = 0;
+static uint32_t cycles_now       = 0;  // last value read
+
+static void (*timer1_nmi)(void)              = nullptr;
+static std::function<uint32_t()> timer1_latency;
+static bool                      timer1_armed   = false;
+static bool                      timer1_running = false;  // in the NMI
+static uint32_t                  timer1_load    = ~0U;
+static uint32_t                  timer1_due     = 0;
+
+static std::function<void(uint32_t cycle, uint32_t gpo)> gpio_trace;
+static uint32_t                                           gpio_out   = 0;
+static uint32_t                                           gpio_cycle = 0;  // of the last write
+
+static void mock_gpio_settle()
+{
+    // GPO holds the levels, GPOS and GPOC are write-only
+    uint32_t out = (MOCK_REG(0x300) | MOCK_REG(0x304)) & ~MOCK_REG(0x308) & 0xffff;
+    MOCK_REG(0x300) = out;
+    MOCK_REG(0x304) = 0;
+    MOCK_REG(0x308) = 0;
+    out |= (MOCK_REG(0x768) & 1) << 16;
+    if (out != gpio_out)
+    {
+        gpio_out = out;
+        if (gpio_trace)
+            gpio_trace(gpio_cycle, out);
+    }
+}
+
+static void mock_gpio_access()
+{
+    mock_gpio_settle();
+    gpio_cycle = cycles_now;
+}
+
+// timer 1 runs at 80MHz, divided by the prescaler
+static uint32_t mock_timer1_cycles(uint32_t ticks)
+{
+    static const uint32_t prescaler[] = { 1, 16, 256, 256 };
+    uint32_t              cpu2x       = mock_register_raw(0x3FF00000 + 0x14) & 1;
+    return (ticks * prescaler[(MOCK_REG(0x608) >> TCPD) & 3]) << cpu2x;
+}
+
+static void mock_timer1_check()
+{
+    mock_gpio_settle();
+
+    if (!(MOCK_REG(0x608) & (1 << TCTE)))  // T1C
+    {
+        timer1_armed = false;
+        timer1_load  = ~0U;
+        return;
+    }
+    uint32_t load = MOCK_REG(0x600) & 0x7fffff;  // T1L
+    if (load != timer1_load)
+    {
+        timer1_load  = load;
+        timer1_due   = cycles_now + mock_timer1_cycles(load);
+        timer1_armed = true;
+    }
+    if (!timer1_armed || timer1_running || (int32_t)(cycles_now - timer1_due) < 0)
+        return;
+
+    // one-shot, edge interrupt
+    timer1_armed = false;
+    if (!timer1_nmi)
+        return;
+    if (timer1_latency)
+        cycles_now += timer1_latency();
+    timer1_running = true;
+    timer1_nmi();
+    timer1_running = false;
+
+    // restarted from T1L even when the NMI wrote the same value
+    mock_gpio_settle();
+    timer1_load  = MOCK_REG(0x600) & 0x7fffff;
+    timer1_due   = cycles_now + mock_timer1_cycles(timer1_load);
+    timer1_armed = true;
+}
+
+uint32_t esp_get_cycle_count()
+{
+    if (cycles_simulated)
+    {
+        cycles_now += cycles_step;
+    }
+    else
+    {
+        timeval t;
+        gettimeofday(&t, NULL);
+        cycles_now = (((uint64_t)t.tv_sec) * 1000000 + t.tv_usec) * (F_CPU / 1000000);
+    }
+    mock_timer1_check();
+    return cycles_now;
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    return esp_get_cycle_count();
+}
+
+void mock_cycles_simulate(bool simulate, uint32_t step)
+{
+    cycles_simulated = simulate;
+    cycles_step      = step;
+}
+
+void mock_cycles_run(uint32_t cycles)
+{
+    uint32_t end = cycles_now + cycles;
+    while ((int32_t)(end - cycles_now) > 0)
+    {
+        // nothing happens until the timer is due
+        if (cycles_simulated && timer1_armed && !timer1_running)
+        {
+            int32_t idle = std::min((int32_t)(timer1_due - cycles_now), (int32_t)(end - cycles_now))
+                           - (int32_t)cycles_step;
+            if (idle > 0)
+                cycles_now += idle;
+        }
+        esp_get_cycle_count();
+    }
+}
+
+void mock_timer1_latency(std::function<uint32_t()> latency)
+{
+    timer1_latency = std::move(latency);
+}
+
+void mock_gpio_trace(std::function<void(uint32_t cycle, uint32_t gpo)> trace)
+{
+    gpio_trace = std::move(trace);
+}
+
+extern "C" void NmiTimSetFunc(void (*func)(void))
+{
+    timer1_nmi = func;
+}
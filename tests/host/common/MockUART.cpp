@@ -268,6 +268,26 @@ extern "C"
         return ret;
     }
 
+    // writes are not buffered, there is no TX ring buffer
+    size_t uart_resize_tx_buffer(uart_t* uart, size_t new_size)
+    {
+        (void)uart;
+        (void)new_size;
+        return 0;
+    }
+
+    size_t uart_get_tx_buffer_size(uart_t* uart)
+    {
+        (void)uart;
+        return 0;
+    }
+
+    void uart_set_tx_blocking(uart_t* uart, bool blocking)
+    {
+        (void)uart;
+        (void)blocking;
+    }
+
     size_t uart_tx_free(uart_t* uart)
     {
         if (uart == NULL || !uart->tx_enabled)
@@ -17,9 +17,25 @@ extern "C"
     extern uint32_t s_phys_block;
     extern uint8_t* s_phys_data;
 
+    // flash accesses (flash_hal_*_aligned and flash_hal_erase calls) and
+    // bytes since the last reset, for benchmarks
+    struct flash_hal_mock_stats_t
+    {
+        uint32_t reads;
+        uint32_t readBytes;
+        uint32_t writes;
+        uint32_t writeBytes;
+        uint32_t programs;  // flash pages programmed by the writes
+        uint32_t erases;
+        uint32_t eraseBytes;
+    };
+    extern flash_hal_mock_stats_t flash_hal_mock_stats;
+
     extern int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t* dst);
     extern int32_t flash_hal_write(uint32_t addr, uint32_t size, const uint8_t* src);
     extern int32_t flash_hal_erase(uint32_t addr, uint32_t size);
+    extern int32_t flash_hal_read_aligned(uint32_t addr, uint32_t size, uint32_t* dst);
+    extern int32_t flash_hal_write_aligned(uint32_t addr, uint32_t size, const uint32_t* src);
 }
 
 #endif
@@ -1,6 +1,7 @@
 /* Emulate the flash read/write HAL */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "flash_hal.h"
@@ -12,17 +13,43 @@ extern "C"
     uint32_t s_phys_page  = 0;
     uint32_t s_phys_block = 0;
     uint8_t* s_phys_data  = nullptr;
+
+    flash_hal_mock_stats_t flash_hal_mock_stats = {};
 }
 
-int32_t flash_hal_read(uint32_t addr, uint32_t size, uint8_t* dst)
+// flash_hal_read() and flash_hal_write() come from the core, on top of these
+
+int32_t flash_hal_read_aligned(uint32_t addr, uint32_t size, uint32_t* dst)
 {
+    if ((size & 3) != 0 || ((uintptr_t)dst & 3) != 0)
+    {
+        abort();
+    }
+    flash_hal_mock_stats.reads++;
+    flash_hal_mock_stats.readBytes += size;
     memcpy(dst, s_phys_data + addr, size);
     return 0;
 }
 
-int32_t flash_hal_write(uint32_t addr, uint32_t size, const uint8_t* src)
+int32_t flash_hal_write_aligned(uint32_t addr, uint32_t size, const uint32_t* src)
 {
-    memcpy(s_phys_data + addr, src, size);
+    if ((size & 3) != 0 || (addr & 3) != 0 || ((uintptr_t)src & 3) != 0)
+    {
+        abort();
+    }
+    flash_hal_mock_stats.writes++;
+    flash_hal_mock_stats.writeBytes += size;
+    if (size)
+    {
+        flash_hal_mock_stats.programs
+            += (addr + size - 1) / FLASH_PAGE_SIZE - addr / FLASH_PAGE_SIZE + 1;
+    }
+    // programming only clears bits
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(src);
+    for (uint32_t i = 0; i < size; ++i)
+    {
+        s_phys_data[addr + i] &= bytes[i];
+    }
     return 0;
 }
 
@@ -32,6 +59,8 @@ int32_t flash_hal_erase(uint32_t addr, uint32_t size)
     {
         abort();
     }
+    flash_hal_mock_stats.erases++;
+    flash_hal_mock_stats.eraseBytes += size;
     const uint32_t sector      = addr / FLASH_SECTOR_SIZE;
     const uint32_t sectorCount = size / FLASH_SECTOR_SIZE;
     for (uint32_t i = 0; i < sectorCount; ++i)
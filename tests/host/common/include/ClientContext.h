@@ -29,6 +29,7 @@ class WiFiClient;
 bool getDefaultPrivateGlobalSyncValue();
 
 typedef void (*discard_cb_t)(void*, ClientContext*);
+typedef void (*release_cb_t)(void*);
 
 class ClientContext
 {
@@ -232,6 +233,32 @@ public:
         return ret;
     }
 
+    size_t writev(const Print::Buffer* buffers, size_t count)
+    {
+        size_t written = 0;
+        for (size_t i = 0; i < count && _sock >= 0; i++)
+        {
+            size_t ret = buffers[i].size ? write((const char*)buffers[i].data, buffers[i].size) : 0;
+            written += ret;
+            if (ret != buffers[i].size)
+                break;
+        }
+        return written;
+    }
+
+    size_t write_nocopy(const char* data, size_t size, release_cb_t release, void* arg)
+    {
+        // the socket copies the data
+        size_t ret = write(data, size);
+        release(arg);
+        return ret;
+    }
+
+    size_t write_P(PGM_P data, size_t size)
+    {
+        return write(data, size);
+    }
+
     void keepAlive(uint16_t idle_sec = TCP_DEFAULT_KEEPALIVE_IDLE_SEC,
                    uint16_t intv_sec = TCP_DEFAULT_KEEPALIVE_INTERVAL_SEC,
                    uint8_t  count    = TCP_DEFAULT_KEEPALIVE_COUNT)
@@ -83,6 +83,15 @@ extern "C"
 typedef uint8_t  uint8;
 typedef uint32_t uint32;
 
+// peripheral registers, memory backed in common/MockRegisters.cpp
+
+#ifdef __cplusplus
+extern "C"
+#endif
+volatile uint32_t* mock_register(uint32_t address);
+#define ESP8266_REG(addr) (*mock_register(0x60000000 + (addr)))
+#define ESP8266_DREG(addr) (*mock_register(0x3FF00000 + (addr)))
+
 //
 
 #include <c_types.h>
@@ -183,9 +192,55 @@ void mock_start_littlefs(const String& fname, size_t size_kb, size_t block_kb =
                          size_t page_b = 512);
 void mock_stop_littlefs();
 
-//
+// peripherals
+
+#include <functional>
+#include <vector>
 
-#include <common/esp8266_peri.h>
+// interrupt, raised for the handler attached by ets_isr_attach(), now or
+// when unmasked
+void mock_isr_raise(int inum);
+
+// SPI1 (HSPI) controller: a transfer started with SPIBUSY in SPI1CMD
+// completes at the next SPI1CMD access or mock_spi1_complete() (false when
+// none was started), then raises the interrupt when SPISTRIE is set.  The
+// device gets each transfer and fills its MISO data, the MOSI data is
+// looped back without device.
+struct MockSPI1Transfer
+{
+    uint16_t             command;
+    uint8_t              commandBits;
+    uint32_t             address;
+    uint8_t              addressBits;
+    std::vector<uint8_t> mosi;
+};
+void mock_spi1_device(std::function<void(const MockSPI1Transfer&, uint8_t* miso, size_t misoSize)> device);
+bool mock_spi1_complete();
+
+// CPU cycle counter: from the host clock, or simulated, advancing by step
+// cycles at each read.  Reading it fires the timer 1 NMI when due.
+// mock_cycles_run() lets cycles pass, mock_timer1_latency() adds cycles
+// before each NMI, the GPIO outputs trace gets each change of GPO | GP16O << 16.
+void mock_cycles_simulate(bool simulate, uint32_t step = 8);
+void mock_cycles_run(uint32_t cycles);
+void mock_timer1_latency(std::function<uint32_t()> latency);
+void mock_gpio_trace(std::function<void(uint32_t cycle, uint32_t gpo)> trace);
+
+// last pinMode() of a pin (HostWiring.cpp)
+uint8_t mock_pin_mode(uint8_t pin);
+
+// UART0 and UART1 (cores/esp8266/uart.cpp, the host tests only): sent bytes
+// go to stdout and stderr, or to the output.  A stalled UART keeps them in
+// its TX FIFO until software waits for it (yields, or polls the full FIFO),
+// mock_uart_tx() sends up to count of them or unstalling sends them all.
+// mock_uart_rx() fills the RX FIFO, mock_putc1() is ets_putc(), through the
+// ets_install_putc1() routine.
+void   mock_uart_tx_output(std::function<void(int uart_nr, char c)> output);
+void   mock_uart_tx_stall(int uart_nr, bool stall);
+size_t mock_uart_tx(int uart_nr, size_t count);
+size_t mock_uart_rx(int uart_nr, const char* data, size_t size);
+void   mock_putc1(char c);
+void   mock_uart_yield();
 
 //
 
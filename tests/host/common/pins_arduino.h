@@ -15,4 +15,17 @@
 #ifndef pins_arduino_h
 #define pins_arduino_h
 
+// as the generic variant, for the SPI library
+#define PIN_SPI_SS (15)
+#define PIN_SPI_MOSI (13)
+#define PIN_SPI_MISO (12)
+#define PIN_SPI_SCK (14)
+
+static const uint8_t SS   = PIN_SPI_SS;
+static const uint8_t MOSI = PIN_SPI_MOSI;
+static const uint8_t MISO = PIN_SPI_MISO;
+static const uint8_t SCK  = PIN_SPI_SCK;
+
+#define isFlashInterfacePin(p) ((p) >= 6 && (p) <= 11)
+
 #endif /* pins_arduino_h */
@@ -411,16 +411,6 @@ extern "C"
     ///////////////////////////////////////
     // not user_interface
 
-    void ets_isr_mask(int intr)
-    {
-        (void)intr;
-    }
-
-    void ets_isr_unmask(int intr)
-    {
-        (void)intr;
-    }
-
 #include <smartconfig.h>
     bool smartconfig_start(sc_callback_t cb, ...)
     {
@@ -0,0 +1,129 @@
+/*
+ test_CertStore.cpp - sorted certificate index lookups, and their cost
+ against the linear scan of the index for growing store sizes.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <FS.h>
+#include <algorithm>
+#include <vector>
+#include "../common/spiffs_mock.h"
+#include <CertStoreBearSSL.h>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdeprecated-declarations"
+
+// exposes the index format and search without the BearSSL decoding side
+struct CertIndex: public BearSSL::CertStore
+{
+    using CertStore::_findIndex;
+    using CertStore::CertInfo;
+};
+
+static std::vector<CertIndex::CertInfo> makeInfos(size_t count, uint32_t seed)
+{
+    std::vector<CertIndex::CertInfo> infos(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (auto& b : infos[i].sha256)
+        {
+            seed = seed * 1103515245 + 12345;
+            b    = seed >> 16;
+        }
+        infos[i].offset = 8 + i * 1000;
+        infos[i].length = 900 + i;
+    }
+    return infos;
+}
+
+static void writeIndex(std::vector<CertIndex::CertInfo> infos)
+{
+    std::sort(infos.begin(), infos.end(),
+              [](const CertIndex::CertInfo& a, const CertIndex::CertInfo& b)
+              { return memcmp(a.sha256, b.sha256, sizeof(a.sha256)) < 0; });
+    File f = SPIFFS.open("/idx", "w");
+    REQUIRE(f);
+    REQUIRE(f.write((const uint8_t*)infos.data(), infos.size() * sizeof(infos[0]))
+            == infos.size() * sizeof(infos[0]));
+    f.close();
+}
+
+// what findHashedTA did before the index was sorted
+static bool linearIndex(File& index, const void* hashed_dn, CertIndex::CertInfo& ci)
+{
+    index.seek(0, fs::SeekSet);
+    while (index.read((uint8_t*)&ci, sizeof(ci)) == sizeof(ci))
+        if (!memcmp(ci.sha256, hashed_dn, sizeof(ci.sha256)))
+            return true;
+    return false;
+}
+
+TEST_CASE("CertStore index binary search finds every entry", "[certstore]")
+{
+    SPIFFS_MOCK_DECLARE(256, 8, 512, "");
+    REQUIRE(SPIFFS.begin());
+
+    for (size_t count : { 0, 1, 2, 3, 150 })
+    {
+        auto infos = makeInfos(count, count + 1);
+        writeIndex(infos);
+
+        File index = SPIFFS.open("/idx", "r");
+        REQUIRE(index);
+        CertIndex::CertInfo ci;
+        for (const auto& want : infos)
+        {
+            REQUIRE(CertIndex::_findIndex(index, want.sha256, ci));
+            CHECK(ci.offset == want.offset);
+            CHECK(ci.length == want.length);
+        }
+        for (const auto& absent : makeInfos(16, 1000 + count))
+            CHECK_FALSE(CertIndex::_findIndex(index, absent.sha256, ci));
+        index.close();
+    }
+    SPIFFS.end();
+}
+
+TEST_CASE("CertStore index lookup against store size", "[certstore]")
+{
+    SPIFFS_MOCK_DECLARE(256, 8, 512, "");
+    REQUIRE(SPIFFS.begin());
+
+    for (size_t count : { 16, 64, 150, 512 })
+    {
+        auto infos = makeInfos(count, count);
+        writeIndex(infos);
+        File index = SPIFFS.open("/idx", "r");
+        REQUIRE(index);
+
+        CertIndex::CertInfo ci;
+        double              reads[2], usecs[2];
+        for (int binary = 0; binary < 2; binary++)
+        {
+            flash_hal_mock_stats = {};
+            uint32_t start       = micros();
+            for (const auto& want : infos)
+            {
+                bool found = binary ? CertIndex::_findIndex(index, want.sha256, ci)
+                                    : linearIndex(index, want.sha256, ci);
+                REQUIRE(found);
+            }
+            usecs[binary] = double(micros() - start) / count;
+            reads[binary] = double(flash_hal_mock_stats.reads) / count;
+        }
+        index.close();
+
+        printf("CertStore %3zu certs: linear scan %5.1f flash reads %6.1f us, "
+               "binary search %4.1f flash reads %5.1f us per lookup\n",
+               count, reads[0], usecs[0], reads[1], usecs[1]);
+    }
+    SPIFFS.end();
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,283 @@
+/*
+ test_DeltaPatch.cpp - delta patches from tools/delta.py, applied alone and
+ through the Updater against the running sketch in the mocked flash.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <MD5Builder.h>
+#include <Inflate.h>
+#include <DeltaPatch.h>
+#include <Updater.h>
+#include <vector>
+
+// Source image of the size MockEsp gives for the running sketch, and a target
+// with code inserted, shifted addresses, code removed and code appended.
+// tools/delta.py was run on the same images generated in python.
+static void deltaImages(std::vector<uint8_t>& source, std::vector<uint8_t>& target)
+{
+    uint32_t x = 0x12345678;
+    source.resize(400000);
+    for (auto& c : source)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = x;
+    }
+    const uint8_t header[] = { 0xe9, 0x03, 0x02, 0x20 };
+    memcpy(source.data(), header, sizeof(header));
+    source[0x1000] = 0;
+
+    std::vector<uint8_t> moved(source.begin() + 50000, source.begin() + 120000);
+    for (size_t i = 0; i < moved.size(); i += 1000)
+    {
+        moved[i]++;
+    }
+    target.assign(source.begin(), source.begin() + 50000);
+    for (int i = 0; i < 300; i++)
+    {
+        target.push_back(i * 7);
+    }
+    target.insert(target.end(), moved.begin(), moved.end());
+    target.insert(target.end(), source.begin() + 130000, source.end());
+    for (int i = 0; i < 2000; i++)
+    {
+        target.push_back(i);
+    }
+    target[2] = 0;
+}
+
+// deltaImages() patch, from tools/delta.py -s old.bin -t new.bin
+static const uint8_t deltaPatchGz[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xed, 0xd3, 0x65, 0xb3, 0x16, 0x54,
+    0x18, 0x86, 0xd1, 0xf7, 0xc0, 0xa1, 0xbb, 0x53, 0xa4, 0x3b, 0xa5, 0x41, 0xba, 0x91, 0xee, 0x6e,
+    0x14, 0x90, 0x0e, 0x01, 0x69, 0xa4, 0xbb, 0x41, 0xba, 0xbb, 0xbb, 0xbb, 0x94, 0x90, 0x06, 0xe9,
+    0x2e, 0x45, 0x52, 0x3a, 0x74, 0x1c, 0xff, 0x80, 0x5f, 0x1c, 0x07, 0xd7, 0x9a, 0xd9, 0x3f, 0xe0,
+    0x7e, 0x66, 0x5f, 0xc5, 0x2a, 0x57, 0x28, 0xda, 0x3b, 0x7e, 0xe8, 0x40, 0xcb, 0xb7, 0xa1, 0x02,
+    0xf1, 0x52, 0x3f, 0x9d, 0x73, 0x3b, 0xf2, 0xdc, 0xf9, 0x7b, 0x63, 0xce, 0xba, 0x32, 0xf2, 0x6c,
+    0xef, 0xe7, 0x81, 0x3f, 0x05, 0xff, 0xfd, 0xee, 0x85, 0x0c, 0x24, 0x2e, 0xb3, 0x27, 0x10, 0xc8,
+    0x10, 0x14, 0x08, 0x04, 0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0xf8, 0xa8, 0x84, 0x89, 0x1c, 0x2b, 0x61, 0xb2, 0xb4, 0x59, 0x72,
+    0x15, 0x28, 0x5e, 0xb6, 0x4a, 0xed, 0x46, 0xcd, 0xdb, 0x76, 0xee, 0xd9, 0x7f, 0xd8, 0xd8, 0xc9,
+    0xb3, 0x16, 0xae, 0x58, 0xbf, 0x6d, 0xef, 0xa1, 0x13, 0x3f, 0x5f, 0xbd, 0xf3, 0xdb, 0xef, 0x6f,
+    0x43, 0x86, 0x8f, 0x16, 0xf7, 0xd3, 0x94, 0x19, 0xb2, 0xe5, 0x2d, 0x5c, 0xaa, 0x42, 0xf5, 0x7a,
+    0x4d, 0x5b, 0x76, 0xf8, 0xb6, 0xcf, 0xa0, 0x91, 0x13, 0xa6, 0xcd, 0x5d, 0xb2, 0x7a, 0xd3, 0xce,
+    0x03, 0x47, 0x4f, 0x5f, 0xbc, 0x71, 0xff, 0xf1, 0xcb, 0x0f, 0xa1, 0x23, 0xc5, 0x4c, 0x90, 0x34,
+    0x4d, 0xe6, 0x9c, 0xf9, 0x8b, 0x95, 0xa9, 0x5c, 0xab, 0x61, 0xb3, 0x36, 0xdf, 0xf4, 0xe8, 0x37,
+    0x74, 0xcc, 0xf7, 0x33, 0x17, 0x2c, 0x5f, 0xb7, 0x75, 0xcf, 0x8f, 0xc7, 0xcf, 0x5d, 0xb9, 0xfd,
+    0xe0, 0xd9, 0x9b, 0x10, 0xe1, 0xa2, 0xc6, 0x49, 0x94, 0x22, 0x7d, 0xd6, 0x3c, 0x85, 0x4a, 0x96,
+    0xaf, 0x56, 0xb7, 0xc9, 0xd7, 0xed, 0xbb, 0xf6, 0x1e, 0x38, 0x62, 0xfc, 0xd4, 0x39, 0x8b, 0x57,
+    0x6d, 0xdc, 0xb1, 0xff, 0xc8, 0xa9, 0x0b, 0xd7, 0xef, 0x3d, 0x7a, 0xf1, 0x3e, 0x54, 0xc4, 0x18,
+    0xf1, 0x93, 0xa4, 0xce, 0x94, 0x23, 0x5f, 0xd1, 0x2f, 0x2a, 0xd5, 0x6c, 0xf0, 0x55, 0xeb, 0x4e,
+    0xdd, 0xbf, 0x1b, 0x32, 0x7a, 0xd2, 0x8c, 0xf9, 0xcb, 0xd6, 0x6e, 0xd9, 0xfd, 0xc3, 0xb1, 0xb3,
+    0x97, 0x6f, 0xfd, 0xfa, 0xf4, 0x75, 0x50, 0xd8, 0x28, 0xb1, 0x3f, 0x49, 0x9e, 0xee, 0xb3, 0xdc,
+    0x05, 0x4b, 0x94, 0xab, 0x5a, 0xa7, 0x71, 0x8b, 0x76, 0x5d, 0x7a, 0x0d, 0x18, 0x3e, 0x6e, 0xca,
+    0xec, 0x45, 0x2b, 0x37, 0x6c, 0xdf, 0x77, 0xf8, 0xe4, 0xf9, 0x6b, 0x77, 0x1f, 0x3e, 0x7f, 0x17,
+    0x1c, 0x21, 0x7a, 0xbc, 0xc4, 0xa9, 0x32, 0x66, 0xff, 0xbc, 0x48, 0xe9, 0x8a, 0x35, 0xea, 0x7f,
+    0xd9, 0xaa, 0x63, 0xb7, 0xbe, 0x83, 0x47, 0x4d, 0x9c, 0x3e, 0x6f, 0xe9, 0x9a, 0xcd, 0xbb, 0x0e,
+    0xfe, 0x74, 0xe6, 0xd2, 0xcd, 0x5f, 0x9e, 0xbc, 0xfa, 0x27, 0xfb, 0xb3, 0xb4, 0x89, 0x16, 0xf4,
+    0xd7, 0xcd, 0xa2, 0xa6, 0xf2, 0x6f, 0xe0, 0x7f, 0x20, 0xc8, 0x09, 0x40, 0xe7, 0x80, 0xce, 0x01,
+    0x9d, 0x03, 0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c, 0xd0, 0x39, 0xa0, 0x73, 0xd0, 0x39, 0xa0, 0x73,
+    0x40, 0xe7, 0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c, 0x74, 0x0e, 0xe8,
+    0x1c, 0xd0, 0x39, 0xa0, 0x73, 0x40, 0xe7, 0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a, 0x07, 0x9d, 0x03,
+    0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c, 0xd0, 0x39, 0xa0, 0x73, 0x40, 0xe7, 0x80, 0xce, 0x41, 0xe7,
+    0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c, 0xd0, 0x39, 0xa0, 0x73, 0xd0,
+    0x39, 0xa0, 0x73, 0x40, 0xe7, 0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c,
+    0x74, 0x0e, 0xe8, 0x1c, 0xd0, 0x39, 0xa0, 0x73, 0x40, 0xe7, 0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a,
+    0x07, 0x9d, 0x03, 0x3a, 0x07, 0x74, 0x0e, 0xe8, 0x1c, 0xd0, 0x39, 0xa0, 0x73, 0x40, 0xe7, 0x80,
+    0xce, 0x41, 0xe7, 0x80, 0xce, 0x01, 0x9d, 0x03, 0x3a, 0x07, 0xfe, 0x75, 0x2b, 0x13, 0x05, 0x07,
+    0x8e, 0x85, 0x71, 0x07, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x43, 0x82, 0x42, 0x84, 0x0c, 0x0e,
+    0x15, 0x3a, 0x4c, 0xd8, 0x70, 0xe1, 0x23, 0x44, 0x8c, 0x14, 0x39, 0x4a, 0xd4, 0x68, 0xd1, 0x63,
+    0xc4, 0x8c, 0x15, 0x3b, 0x4e, 0xdc, 0x78, 0xf1, 0x13, 0x24, 0xfc, 0x24, 0xd1, 0xa7, 0x89, 0x93,
+    0x24, 0x4d, 0x96, 0x3c, 0x45, 0xca, 0x54, 0xa9, 0xd3, 0xa4, 0x4d, 0x97, 0x3e, 0x43, 0xc6, 0x4c,
+    0x99, 0xb3, 0x7c, 0x96, 0x35, 0x5b, 0xf6, 0x1c, 0x39, 0x73, 0xe5, 0xce, 0x93, 0xf7, 0xf3, 0x7c,
+    0xf9, 0x0b, 0x14, 0x2c, 0x54, 0xb8, 0x48, 0xd1, 0x62, 0xc5, 0x4b, 0x94, 0x2c, 0x55, 0xfa, 0x8b,
+    0x32, 0x65, 0xcb, 0x95, 0xaf, 0x50, 0xb1, 0x52, 0xe5, 0x2a, 0x55, 0xab, 0x55, 0xaf, 0x51, 0xb3,
+    0x56, 0xed, 0x3a, 0x75, 0xeb, 0xd5, 0x6f, 0xd0, 0xb0, 0x51, 0xe3, 0x26, 0x4d, 0xbf, 0xfc, 0xaa,
+    0x59, 0xf3, 0x16, 0x5f, 0xb7, 0x6c, 0xd5, 0xba, 0x4d, 0xdb, 0x76, 0xed, 0x3b, 0x74, 0xec, 0xf4,
+    0x4d, 0xe7, 0x2e, 0x5d, 0xbf, 0xed, 0xd6, 0xbd, 0x47, 0xcf, 0x5e, 0xbd, 0xfb, 0xf4, 0xfd, 0xae,
+    0x5f, 0xff, 0x01, 0x03, 0x07, 0x0d, 0x1e, 0x32, 0x74, 0xd8, 0xf0, 0x11, 0x23, 0x47, 0x8d, 0x1e,
+    0x33, 0x76, 0xdc, 0xf8, 0x09, 0x13, 0x27, 0x7d, 0x3f, 0x79, 0xca, 0xd4, 0x69, 0xd3, 0x67, 0xcc,
+    0x9c, 0x35, 0x7b, 0xce, 0xdc, 0x79, 0xf3, 0x17, 0x2c, 0x5c, 0xb4, 0x78, 0xc9, 0xd2, 0x65, 0xcb,
+    0x57, 0xac, 0x5c, 0xb5, 0x7a, 0xcd, 0xda, 0x75, 0xeb, 0x37, 0x6c, 0xdc, 0xb4, 0x79, 0xcb, 0xd6,
+    0x6d, 0xdb, 0x77, 0xec, 0xdc, 0xb5, 0x7b, 0xcf, 0xde, 0x7d, 0xfb, 0x0f, 0x1c, 0xfc, 0xe1, 0xc7,
+    0x43, 0x87, 0x8f, 0x1c, 0xfd, 0xe9, 0xd8, 0xf1, 0x13, 0x27, 0x4f, 0x9d, 0x3e, 0x73, 0xf6, 0xdc,
+    0xcf, 0xe7, 0x2f, 0x5c, 0xbc, 0x74, 0xf9, 0xca, 0xd5, 0x6b, 0xd7, 0x6f, 0xdc, 0xbc, 0x75, 0xfb,
+    0xce, 0xdd, 0x7b, 0xf7, 0x7f, 0xf9, 0xf5, 0xc1, 0x6f, 0x0f, 0x1f, 0x3d, 0x7e, 0xf2, 0xf4, 0xd9,
+    0xef, 0xcf, 0x5f, 0xbc, 0x7c, 0xf5, 0xfa, 0xcd, 0xdb, 0x77, 0xef, 0x3f, 0xd8, 0x6f, 0xbf, 0xfd,
+    0xf6, 0xdb, 0x6f, 0xff, 0xc7, 0xb0, 0xff, 0x0f, 0x92, 0x7e, 0xa3, 0x88, 0xb8, 0xfc, 0x05, 0x00,
+};
+
+static const char deltaTargetMd5[] = "a58c8a61da24063ad5236fc422969960";
+
+struct PatchedImage: public Print
+{
+    std::vector<uint8_t> data;
+    size_t               write(uint8_t c) override
+    {
+        data.push_back(c);
+        return 1;
+    }
+    size_t write(const uint8_t* buf, size_t len) override
+    {
+        data.insert(data.end(), buf, buf + len);
+        return len;
+    }
+};
+
+static DeltaPatch::Reader sourceReader(const std::vector<uint8_t>& source)
+{
+    return [&source](uint32_t offset, uint8_t* data, size_t size)
+    {
+        if (offset + size > source.size())
+            return false;
+        memcpy(data, source.data() + offset, size);
+        return true;
+    };
+}
+
+static DeltaPatchError applyPatch(const std::vector<uint8_t>& source, uint32_t sourceSize,
+                                  PatchedImage& out, size_t piece)
+{
+    DeltaPatch patch;
+    Inflate    inflate;
+    patch.begin(out, sourceReader(source), sourceSize);
+    REQUIRE(inflate.begin(patch, INFLATE_GZIP));
+    for (size_t pos = 0; pos < sizeof(deltaPatchGz); pos += piece)
+    {
+        size_t len = std::min(piece, sizeof(deltaPatchGz) - pos);
+        if (inflate.write(deltaPatchGz + pos, len) != len)
+            return patch.getError();
+    }
+    CHECK(inflate.finished());
+    CHECK(patch.finished());
+    return patch.getError();
+}
+
+TEST_CASE("DeltaPatch rebuilds the target from the source", "[core][DeltaPatch]")
+{
+    std::vector<uint8_t> source, target;
+    deltaImages(source, target);
+
+    for (size_t piece : { (size_t)1, (size_t)7, (size_t)100, sizeof(deltaPatchGz) })
+    {
+        PatchedImage out;
+        REQUIRE(applyPatch(source, source.size(), out, piece) == DELTA_OK);
+        REQUIRE(out.data == target);
+    }
+
+    // upload tools rewrite the flash mode, which is not part of the source check
+    source[2] = 0x03;
+    PatchedImage out;
+    REQUIRE(applyPatch(source, source.size(), out, 64) == DELTA_OK);
+    REQUIRE(out.data == target);
+}
+
+TEST_CASE("DeltaPatch refuses another source", "[core][DeltaPatch]")
+{
+    std::vector<uint8_t> source, target;
+    deltaImages(source, target);
+
+    PatchedImage out;
+    CHECK(applyPatch(source, source.size() - 16, out, 64) == DELTA_ERR_SOURCE);
+    source[200000] ^= 1;
+    CHECK(applyPatch(source, source.size(), out, 64) == DELTA_ERR_SOURCE);
+    CHECK(out.data.empty());
+}
+
+TEST_CASE("DeltaPatch checks records against the images", "[core][DeltaPatch]")
+{
+    std::vector<uint8_t> source(64, 0x55);
+    MD5Builder           md5;
+    md5.begin();
+    md5.add(source.data() + 4, source.size() - 4);
+    md5.calculate();
+
+    // 8 bytes target: 4 extra, then 4 diff from source offset 8
+    std::vector<uint8_t> patch = { 'E', 'S', 'P', 'D', 64, 0, 0, 0, 8, 0, 0, 0 };
+    patch.resize(28);
+    md5.getBytes(patch.data() + 12);
+    const uint8_t records[] = { 0, 0, 0, 0, 4, 0, 0, 0, 8, 0, 0, 0, 'a', 'b', 'c', 'd',
+                                4, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4 };
+    patch.insert(patch.end(), records, records + sizeof(records));
+
+    PatchedImage out;
+    DeltaPatch   delta;
+    delta.begin(out, sourceReader(source), source.size());
+    for (uint8_t c : patch)
+    {
+        REQUIRE(delta.write(&c, 1) == 1);
+    }
+    REQUIRE(delta.finished());
+    REQUIRE(delta.patched() == 8);
+    REQUIRE(out.data == std::vector<uint8_t>({ 'a', 'b', 'c', 'd', 0x56, 0x57, 0x58, 0x59 }));
+
+    // diffing past the end of the source
+    patch[28 + 8] = 62;
+    delta.begin(out, sourceReader(source), source.size());
+    REQUIRE(delta.write(patch.data(), patch.size()) == 0);
+    CHECK(delta.getError() == DELTA_ERR_DATA);
+
+    // not a patch
+    delta.begin(out, sourceReader(source), source.size());
+    REQUIRE(delta.write(records, sizeof(records)) == 0);
+    CHECK(delta.getError() == DELTA_ERR_HEADER);
+}
+
+TEST_CASE("Updater applies delta patches to the running sketch", "[core][DeltaPatch][Updater]")
+{
+    std::vector<uint8_t> source, target;
+    deltaImages(source, target);
+    // the running sketch, as flashed by an upload tool changing its flash mode
+    source[2] = 0x03;
+    for (uint32_t sector = 0; sector * FLASH_SECTOR_SIZE < source.size(); sector++)
+    {
+        REQUIRE(ESP.flashEraseSector(sector));
+    }
+    REQUIRE(ESP.flashWrite(0, source.data(), source.size()));
+
+    UpdaterClass u;
+    u.setInflate();
+    u.setDelta();
+    REQUIRE(u.begin(sizeof(deltaPatchGz)));
+    REQUIRE(u.setMD5(deltaTargetMd5));
+    for (size_t pos = 0; pos < sizeof(deltaPatchGz); pos += 100)
+    {
+        size_t len = std::min((size_t)100, sizeof(deltaPatchGz) - pos);
+        REQUIRE(u.write(const_cast<uint8_t*>(deltaPatchGz) + pos, len) == len);
+        REQUIRE(u.progress() == pos + len);
+    }
+    REQUIRE(u.isFinished());
+    REQUIRE(u.end());
+
+    // against another sketch
+    REQUIRE(ESP.flashWrite(0x10000, (const uint8_t*)"\0", 1));
+    REQUIRE(u.begin(sizeof(deltaPatchGz)));
+    REQUIRE(u.write(const_cast<uint8_t*>(deltaPatchGz), sizeof(deltaPatchGz)) == 0);
+    CHECK(u.getError() == UPDATE_ERROR_DELTA);
+    REQUIRE(!u.isRunning());
+}
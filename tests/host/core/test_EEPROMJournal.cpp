@@ -0,0 +1,179 @@
+/*
+ test_EEPROMJournal.cpp - EEPROM journal tests, and flash erases and
+ writes of frequent small commits compared to rewriting the sector.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <vector>
+#include "../common/flash_hal.h"
+#include <EEPROMJournal.h>
+
+static constexpr uint32_t sectors = 4;
+
+// owns the mocked flash
+struct Flash
+{
+    std::vector<uint8_t> data;
+
+    Flash() : data(sectors * FLASH_SECTOR_SIZE, 0xff)
+    {
+        s_phys_data = data.data();
+        s_phys_size = data.size();
+        reset();
+    }
+    ~Flash()
+    {
+        s_phys_data = nullptr;
+        s_phys_size = 0;
+    }
+    void reset()
+    {
+        flash_hal_mock_stats = {};
+    }
+};
+
+TEST_CASE("EEPROMJournal replays the changes", "[core][EEPROMJournal]")
+{
+    Flash         flash;
+    EEPROMJournal journal(0, sectors);
+    uint8_t       image[64];
+    memset(image, 0xff, sizeof(image));
+    CHECK_FALSE(journal.load(image, sizeof(image)));
+
+    for (size_t i = 0; i < sizeof(image); i++)
+        image[i] = i;
+    REQUIRE(journal.append(image, sizeof(image), 0, sizeof(image)));
+    image[10] = 100;
+    image[11] = 101;
+    REQUIRE(journal.append(image, sizeof(image), 10, 2));
+    image[63] = 0;
+    REQUIRE(journal.append(image, sizeof(image), 63, 1));
+
+    uint8_t loaded[64];
+    memset(loaded, 0xff, sizeof(loaded));
+    EEPROMJournal again(0, sectors);
+    REQUIRE(again.load(loaded, sizeof(loaded)));
+    CHECK(memcmp(image, loaded, sizeof(image)) == 0);
+
+    // a larger image keeps its new bytes, a smaller one ignores the rest
+    uint8_t larger[100];
+    memset(larger, 0xff, sizeof(larger));
+    REQUIRE(again.load(larger, sizeof(larger)));
+    CHECK(memcmp(image, larger, sizeof(image)) == 0);
+    CHECK(larger[99] == 0xff);
+    uint8_t smaller[8];
+    REQUIRE(again.load(smaller, sizeof(smaller)));
+    CHECK(memcmp(image, smaller, sizeof(smaller)) == 0);
+}
+
+TEST_CASE("EEPROMJournal moves around the ring", "[core][EEPROMJournal]")
+{
+    Flash         flash;
+    EEPROMJournal journal(0, sectors);
+    uint8_t       image[256] = {};
+    REQUIRE(journal.append(image, sizeof(image), 0, sizeof(image)));
+
+    uint32_t counter = 0;
+    for (int i = 0; i < 5000; i++)
+    {
+        counter++;
+        memcpy(&image[100], &counter, sizeof(counter));
+        REQUIRE(journal.append(image, sizeof(image), 100, sizeof(counter)));
+        if (i % 997 == 0)
+        {
+            uint8_t       loaded[256];
+            EEPROMJournal again(0, sectors);
+            REQUIRE(again.load(loaded, sizeof(loaded)));
+            REQUIRE(memcmp(image, loaded, sizeof(image)) == 0);
+        }
+    }
+    // every sector was used
+    CHECK(flash_hal_mock_stats.erases > sectors);
+    for (uint32_t s = 0; s < sectors; s++)
+        CHECK(flash.data[s * FLASH_SECTOR_SIZE] != 0xff);
+}
+
+TEST_CASE("EEPROMJournal survives interrupted commits", "[core][EEPROMJournal]")
+{
+    Flash         flash;
+    EEPROMJournal journal(0, sectors);
+    uint8_t       image[32] = {};
+    REQUIRE(journal.append(image, sizeof(image), 0, sizeof(image)));
+    image[5] = 5;
+    REQUIRE(journal.append(image, sizeof(image), 5, 1));
+
+    // second record torn: data programmed, header still erased
+    image[6] = 6;
+    const uint32_t torn = 8 + 8 + 32 + 8 + 4;
+    flash.data[torn + 8] = 6;
+
+    uint8_t       loaded[32];
+    EEPROMJournal again(0, sectors);
+    REQUIRE(again.load(loaded, sizeof(loaded)));
+    CHECK(loaded[5] == 5);
+    CHECK(loaded[6] == 0);
+    // not appended over the programmed bytes, but to a new sector
+    flash.reset();
+    REQUIRE(again.append(image, sizeof(image), 6, 1));
+    CHECK(flash_hal_mock_stats.erases == 1);
+    REQUIRE(again.load(loaded, sizeof(loaded)));
+    CHECK(memcmp(image, loaded, sizeof(image)) == 0);
+
+    // damaged snapshot in the newest sector: the previous one is used
+    flash.data[FLASH_SECTOR_SIZE + 8 + 8] ^= 0xff;
+    EEPROMJournal older(0, sectors);
+    REQUIRE(older.load(loaded, sizeof(loaded)));
+    CHECK(loaded[5] == 5);
+    CHECK(loaded[6] == 0);
+}
+
+TEST_CASE("EEPROMJournal flash erases and writes", "[core][EEPROMJournal]")
+{
+    // a 4 byte counter in a 512 byte image, committed 10000 times
+    constexpr int commits = 10000;
+    uint8_t       image[512] = {};
+
+    for (uint32_t ring : { 1, 2, 4 })
+    {
+        Flash         flash;
+        EEPROMJournal journal(0, ring);
+        for (uint32_t counter = 1; counter <= commits; counter++)
+        {
+            memcpy(&image[200], &counter, sizeof(counter));
+            REQUIRE(journal.append(image, sizeof(image), 200, sizeof(counter)));
+        }
+        uint32_t perSector = (flash_hal_mock_stats.erases + ring - 1) / ring;
+        printf("journal of %u sector(s): %5u erases (%4u per sector), %7u bytes written; "
+               "plain EEPROM: %u erases, %u bytes\n",
+               ring, flash_hal_mock_stats.erases, perSector, flash_hal_mock_stats.writeBytes,
+               commits, commits * (uint32_t)sizeof(image));
+        CHECK(flash_hal_mock_stats.erases < commits / 100);
+    }
+}
+
+TEST_CASE("EEPROMJournal refuses images larger than a snapshot", "[core][EEPROMJournal]")
+{
+    Flash                flash;
+    EEPROMJournal        journal(0, sectors);
+    std::vector<uint8_t> image(EEPROMJournal::maxSize() + 1, 0x5a);
+    CHECK(EEPROMJournal::maxSize() == 4080);
+    CHECK_FALSE(journal.append(image.data(), image.size(), 0, image.size()));
+    CHECK(flash_hal_mock_stats.erases == 0);
+
+    image.pop_back();
+    REQUIRE(journal.append(image.data(), image.size(), 0, image.size()));
+    image[4079] = 1;
+    REQUIRE(journal.append(image.data(), image.size(), 4079, 1));
+    CHECK(flash_hal_mock_stats.erases == 2);
+
+    std::vector<uint8_t> loaded(image.size());
+    EEPROMJournal        again(0, sectors);
+    REQUIRE(again.load(loaded.data(), loaded.size()));
+    CHECK(loaded == image);
+}
@@ -0,0 +1,548 @@
+/*
+ test_Inflate.cpp - streaming DEFLATE decoder, against data compressed by
+ zlib in its raw, zlib and gzip formats and fed in pieces of any size.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <StreamDev.h>
+#include <Inflate.h>
+#include <string>
+
+static std::string makeText(size_t size, uint32_t seed)
+{
+    static const char* words[]
+        = { "the",    "esp8266", "stream", "window", "inflate", "gzip",  "chunk",
+            "server", "client",  "header", "deflate", "buffer", "heap",  "flash",
+            "update", "sketch",  "core",   "data",    "length", "distance" };
+    std::string text;
+    while (text.size() < size)
+    {
+        seed = seed * 1103515245 + 12345;
+        text += words[(seed >> 16) % 20];
+        text += ((seed >> 8) & 7) ? ' ' : '\n';
+    }
+    text.resize(size);
+    return text;
+}
+
+// generated by zlib from makeText(6000, 1) and makeText(1000, 2)
+static const uint8_t gzipText[] = {
+    0x1f, 0x8b, 0x08, 0x1e, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x04, 0x00, 0x61, 0x62, 0x01, 0x00,
+    0x70, 0x61, 0x67, 0x65, 0x2e, 0x68, 0x74, 0x6d, 0x6c, 0x00, 0x63, 0x6f, 0x6d, 0x6d, 0x65, 0x6e,
+    0x74, 0x00, 0x07, 0x58, 0x75, 0x58, 0x41, 0x92, 0xdb, 0x30, 0x0c, 0xbb, 0xf3, 0x15, 0x7e, 0x43,
+    0x0f, 0x3b, 0xfd, 0x4e, 0xba, 0xf1, 0x36, 0x99, 0x6e, 0xd3, 0xcc, 0x26, 0xdb, 0xce, 0xf4, 0xf5,
+    0x8d, 0x49, 0x40, 0x02, 0x18, 0xf7, 0xd0, 0x66, 0x6d, 0xc9, 0x14, 0x49, 0x11, 0x20, 0xa4, 0xf7,
+    0xf5, 0xf2, 0xfd, 0x7e, 0x5a, 0x5e, 0x4f, 0x9f, 0x97, 0x1f, 0xf1, 0xf6, 0x7e, 0xb8, 0x9d, 0x96,
+    0x3f, 0xe7, 0xcb, 0xf1, 0xd7, 0x9f, 0xe5, 0x78, 0xbe, 0xdd, 0x0f, 0x97, 0xd7, 0x75, 0xb9, 0xfd,
+    0x58, 0xef, 0xaf, 0xa7, 0xe5, 0xbd, 0x66, 0xde, 0xd6, 0x8f, 0xdf, 0xeb, 0xc7, 0x72, 0x3f, 0xad,
+    0xf5, 0xd1, 0x72, 0x5a, 0x0f, 0xc7, 0xc7, 0x0b, 0xbc, 0x3f, 0x5f, 0x1e, 0x46, 0xee, 0x8f, 0xb1,
+    0xf7, 0xf3, 0x7a, 0xb9, 0xc7, 0xf7, 0xbf, 0xe7, 0xeb, 0xf2, 0xed, 0xf3, 0xed, 0xed, 0x31, 0x74,
+    0x3c, 0xdc, 0x0f, 0xfc, 0x3b, 0xdf, 0x7f, 0x5e, 0x8f, 0xdb, 0xd4, 0xfa, 0x89, 0xb2, 0x86, 0xc5,
+    0x30, 0x0d, 0x46, 0x31, 0x11, 0x2f, 0xcb, 0xcb, 0xdb, 0xfd, 0x63, 0x3d, 0xfc, 0x1c, 0xeb, 0x3d,
+    0xbc, 0xb8, 0xda, 0x48, 0x60, 0x42, 0x0f, 0x03, 0xb6, 0xd6, 0xdb, 0xf5, 0xeb, 0x97, 0x97, 0x97,
+    0x80, 0xf7, 0xaf, 0xbf, 0x3e, 0x56, 0xfc, 0x97, 0x8e, 0x97, 0x83, 0xc8, 0x04, 0xbc, 0xd0, 0x1c,
+    0x31, 0xa4, 0xb5, 0x56, 0x87, 0xd1, 0x1a, 0x83, 0x05, 0x78, 0x16, 0x35, 0x35, 0x38, 0x15, 0x69,
+    0xe4, 0x23, 0xbc, 0xca, 0xdc, 0xd4, 0xe7, 0xc3, 0x61, 0xac, 0xce, 0x54, 0x20, 0x1c, 0x7c, 0x37,
+    0x66, 0xa5, 0xd3, 0xf9, 0x39, 0x43, 0xc9, 0x3c, 0xc2, 0x23, 0x4e, 0xaf, 0x97, 0x39, 0x17, 0x23,
+    0x2d, 0x7f, 0x5b, 0xbc, 0x81, 0xa4, 0x70, 0xac, 0x1c, 0x18, 0x9e, 0x73, 0x54, 0xd3, 0x84, 0xd4,
+    0x0c, 0x6f, 0xe0, 0x03, 0xad, 0x32, 0xcb, 0x5b, 0xb5, 0x20, 0xba, 0x87, 0xa7, 0xc1, 0x61, 0x44,
+    0x98, 0x23, 0xdc, 0x2f, 0x26, 0xbb, 0xec, 0xb3, 0xb8, 0x6a, 0x0c, 0xa9, 0x44, 0x04, 0xb9, 0x45,
+    0x2d, 0x8f, 0x15, 0x27, 0x3d, 0xf5, 0x02, 0xf3, 0x94, 0xb5, 0x58, 0xe1, 0x5d, 0x59, 0x0b, 0xac,
+    0xde, 0x1f, 0xb7, 0x2c, 0xd3, 0x77, 0xcf, 0xac, 0xec, 0x1f, 0x37, 0x78, 0xd4, 0x9d, 0x54, 0x0f,
+    0x42, 0xb5, 0xc5, 0xc6, 0xef, 0x96, 0xa4, 0xed, 0x5f, 0xc6, 0x85, 0x25, 0xb7, 0x67, 0x4d, 0xee,
+    0x35, 0x11, 0x15, 0xd8, 0x99, 0xb2, 0x63, 0x78, 0xf0, 0x20, 0x9f, 0xe0, 0x57, 0xce, 0x04, 0xb2,
+    0x85, 0xfc, 0x23, 0xc9, 0x65, 0x87, 0x65, 0x5b, 0x4f, 0xcc, 0x12, 0x7f, 0xd3, 0x48, 0x87, 0x14,
+    0xca, 0x5e, 0xeb, 0x0e, 0x6b, 0x36, 0x84, 0x4b, 0xe1, 0x54, 0x96, 0xc2, 0x80, 0x03, 0xe7, 0x68,
+    0x3e, 0x58, 0xd5, 0x23, 0x1b, 0x1d, 0x1a, 0xad, 0x86, 0x67, 0xc8, 0x0e, 0x5c, 0x3a, 0xcf, 0x79,
+    0x4e, 0x68, 0x28, 0xaa, 0xfc, 0x2e, 0x17, 0x93, 0xbd, 0xc4, 0xd8, 0xa8, 0xfc, 0xb9, 0x87, 0x4b,
+    0xab, 0xe1, 0x06, 0x6b, 0x49, 0x36, 0xa9, 0x90, 0x15, 0xba, 0x39, 0x39, 0xb1, 0xd0, 0x29, 0xc4,
+    0xd1, 0x9e, 0xfe, 0x70, 0x47, 0x08, 0xdc, 0xb4, 0x03, 0x73, 0x03, 0x4a, 0x58, 0xbf, 0x0c, 0x63,
+    0x66, 0x2e, 0x95, 0x45, 0x03, 0xab, 0xf9, 0x02, 0x7f, 0xe3, 0x87, 0xa1, 0xe5, 0x4a, 0x24, 0x0d,
+    0xa6, 0x99, 0x76, 0x2a, 0x80, 0x51, 0xf9, 0x9b, 0xdb, 0x1d, 0x53, 0x04, 0xaa, 0x15, 0x16, 0xbf,
+    0x60, 0x65, 0xfb, 0xb6, 0xe4, 0x92, 0x2d, 0x6f, 0x98, 0xd1, 0xf7, 0x5b, 0xf9, 0xad, 0x11, 0x69,
+    0xed, 0x09, 0x03, 0x74, 0xd6, 0x28, 0x67, 0xda, 0x77, 0xde, 0x00, 0xf8, 0x09, 0x16, 0x96, 0x74,
+    0xcc, 0xa6, 0x16, 0x5e, 0xc6, 0x35, 0x16, 0x9d, 0x79, 0xb6, 0xdc, 0x0e, 0xf8, 0x32, 0xac, 0xcd,
+    0x6f, 0x47, 0xd9, 0x04, 0xa8, 0x71, 0xcc, 0x58, 0xd9, 0x73, 0x44, 0x52, 0x94, 0x72, 0x80, 0x1d,
+    0x43, 0xa4, 0xf1, 0x63, 0xeb, 0x74, 0xc9, 0xb8, 0x80, 0x9b, 0x27, 0x14, 0x5f, 0x6d, 0x4e, 0xa7,
+    0x65, 0xfc, 0xb1, 0x59, 0x87, 0x17, 0x83, 0xb7, 0x43, 0x4b, 0x87, 0x75, 0xbd, 0xbd, 0x62, 0xff,
+    0x32, 0xcc, 0xb2, 0x52, 0xa7, 0x54, 0x60, 0x94, 0xcc, 0x5d, 0x56, 0xfe, 0xe6, 0x18, 0xb8, 0x83,
+    0xc9, 0xc3, 0x27, 0xe0, 0xb7, 0xd6, 0x4d, 0xf2, 0x2b, 0xc6, 0x6d, 0x3b, 0x0e, 0x42, 0x6c, 0xa9,
+    0xd6, 0x56, 0xce, 0xd4, 0x0d, 0x6e, 0x30, 0xa4, 0x56, 0x11, 0x79, 0xea, 0x4d, 0x0c, 0xf9, 0x3e,
+    0x78, 0x7f, 0x64, 0xfe, 0x62, 0x17, 0x83, 0xe2, 0x03, 0x5a, 0x05, 0x16, 0x66, 0x54, 0x36, 0xdd,
+    0x59, 0x17, 0x31, 0xc2, 0xae, 0x57, 0xf5, 0xd8, 0x4a, 0xea, 0xb2, 0xf2, 0x09, 0xeb, 0x99, 0x12,
+    0x19, 0x3a, 0xed, 0x6a, 0x1d, 0xb7, 0x34, 0x5c, 0x43, 0x9a, 0x35, 0x13, 0xa3, 0x74, 0x47, 0x6a,
+    0xb4, 0x16, 0xaf, 0x42, 0xec, 0x58, 0xe0, 0x96, 0xc6, 0x6d, 0x9d, 0xd1, 0x10, 0x47, 0x5a, 0x7c,
+    0xf8, 0x12, 0xbe, 0x7b, 0xcc, 0x7c, 0x8d, 0x3f, 0xb3, 0xa7, 0xe2, 0xcc, 0x82, 0x0f, 0x93, 0x81,
+    0x58, 0xcd, 0xb4, 0xe3, 0x88, 0xd6, 0x49, 0x80, 0x12, 0x24, 0x2d, 0x0b, 0x45, 0xef, 0x55, 0xcc,
+    0xac, 0xe0, 0x2e, 0x81, 0x76, 0xda, 0xed, 0xc4, 0x7c, 0x26, 0x54, 0xec, 0xbb, 0x78, 0xc6, 0x93,
+    0xb6, 0xb0, 0xae, 0xa4, 0x4a, 0xee, 0xad, 0xd2, 0xf0, 0x5c, 0x97, 0x37, 0x56, 0x71, 0xc3, 0x20,
+    0x30, 0x7c, 0xd1, 0xb8, 0x8e, 0x05, 0x5b, 0x32, 0x1c, 0xf4, 0x53, 0xfe, 0xab, 0x0a, 0x09, 0x11,
+    0x91, 0x26, 0x86, 0xc3, 0x0b, 0xba, 0xd3, 0x9d, 0x36, 0x98, 0x0c, 0xd0, 0x94, 0xfb, 0x2c, 0xf1,
+    0xab, 0x31, 0xdb, 0x4c, 0x5d, 0xd7, 0xbf, 0x09, 0x5b, 0x4d, 0x86, 0xca, 0x28, 0xd5, 0x13, 0x39,
+    0x2b, 0x74, 0x95, 0x12, 0x8e, 0x8c, 0xe7, 0x79, 0x37, 0x06, 0xdf, 0x74, 0xaa, 0xe6, 0x27, 0x0a,
+    0x25, 0xed, 0x71, 0x5e, 0xfb, 0x23, 0x0e, 0x23, 0xdd, 0xd6, 0x86, 0x8c, 0x6c, 0x66, 0x50, 0xc9,
+    0x85, 0xd5, 0xe1, 0xbb, 0xe2, 0xf7, 0x6e, 0xe4, 0x2a, 0xd8, 0x30, 0x13, 0xd6, 0xd3, 0xbd, 0x20,
+    0xd4, 0xeb, 0xa6, 0x64, 0x14, 0xf4, 0x4e, 0xe7, 0x05, 0x28, 0xb5, 0x6a, 0xf0, 0x1e, 0x8e, 0x37,
+    0xbe, 0x02, 0x3e, 0xa4, 0xe3, 0xa4, 0x89, 0x74, 0x1c, 0xb0, 0xce, 0xbf, 0xe7, 0x91, 0x52, 0xa1,
+    0x3d, 0x74, 0x7a, 0x99, 0xc9, 0x21, 0x83, 0x3e, 0x2a, 0xb5, 0x0c, 0x99, 0x7a, 0x0d, 0x27, 0xf4,
+    0xf9, 0xe9, 0xce, 0x21, 0xd4, 0x7a, 0x8b, 0x2b, 0x86, 0xf0, 0xad, 0x2a, 0xbf, 0x0b, 0x18, 0xc6,
+    0xf8, 0x7a, 0x94, 0x34, 0x30, 0x0d, 0x55, 0xc0, 0x4c, 0x1b, 0xd9, 0xcf, 0xf6, 0xf4, 0xa4, 0x5f,
+    0x33, 0x23, 0xd2, 0x65, 0xa7, 0xa0, 0x61, 0xf8, 0x51, 0x14, 0x34, 0x1b, 0xb9, 0x11, 0xbf, 0x3e,
+    0x84, 0xe9, 0x25, 0xe9, 0xc7, 0x9e, 0x02, 0xc3, 0x46, 0x17, 0xa5, 0x3d, 0x8f, 0xae, 0xaf, 0xc3,
+    0xe5, 0x07, 0x5a, 0x3d, 0x5d, 0x37, 0x3d, 0x93, 0xcb, 0x2a, 0x51, 0x4a, 0x2a, 0xe4, 0x59, 0x33,
+    0x0a, 0x03, 0x88, 0xa2, 0x9f, 0xc2, 0x46, 0x79, 0x5b, 0x17, 0x2c, 0x27, 0xb5, 0x97, 0xfd, 0x07,
+    0x44, 0xfd, 0x60, 0x91, 0x3e, 0x78, 0xbb, 0x52, 0x27, 0x0c, 0x73, 0x0d, 0x7b, 0xfb, 0x42, 0xd2,
+    0xf2, 0xed, 0xb5, 0xda, 0x3c, 0x7b, 0x3e, 0xe1, 0x77, 0x26, 0x15, 0x9d, 0x94, 0x4e, 0xa9, 0xcf,
+    0xff, 0xd9, 0xb9, 0x71, 0x72, 0x5c, 0xf6, 0x4e, 0x7e, 0x93, 0x64, 0x77, 0x6e, 0x53, 0x76, 0x34,
+    0x3b, 0x1d, 0x92, 0xfb, 0x1c, 0x59, 0xa7, 0x03, 0xd7, 0x04, 0xba, 0x4e, 0x80, 0x65, 0x1e, 0x0e,
+    0xe7, 0x81, 0xd7, 0xd5, 0x6c, 0x3b, 0xb5, 0xa9, 0x57, 0xd1, 0xc5, 0x47, 0xdf, 0x4e, 0x97, 0x12,
+    0x72, 0x2c, 0x0a, 0x3d, 0x64, 0x77, 0x71, 0x6c, 0x34, 0x1e, 0x5a, 0x0b, 0xd4, 0x2c, 0xb3, 0x8a,
+    0x6b, 0x18, 0x10, 0x9b, 0x07, 0x84, 0x6b, 0xd7, 0x67, 0xe1, 0xbd, 0x01, 0x2b, 0xeb, 0xe9, 0xab,
+    0x1f, 0x28, 0xb4, 0xf8, 0x8b, 0x1e, 0xec, 0x6e, 0x43, 0x54, 0xc8, 0x4e, 0x61, 0x88, 0x57, 0x34,
+    0x84, 0x74, 0x7a, 0x8b, 0x00, 0x8f, 0x91, 0xfa, 0xa5, 0x9c, 0x26, 0x75, 0xc1, 0x1f, 0xbb, 0xfe,
+    0xd1, 0xfa, 0xeb, 0x98, 0x2a, 0xa6, 0xb7, 0xab, 0x01, 0xb9, 0xcc, 0x10, 0xbe, 0x52, 0x02, 0x50,
+    0xe9, 0x63, 0xf7, 0x2c, 0xfd, 0xb7, 0x03, 0x6b, 0xa4, 0x61, 0x0a, 0xc9, 0xa7, 0x1b, 0x4c, 0x95,
+    0x06, 0x9e, 0x06, 0x2b, 0x78, 0xf2, 0xd8, 0x90, 0x57, 0x26, 0x1d, 0x79, 0xe3, 0x55, 0xbe, 0x3f,
+    0xe3, 0xab, 0x17, 0xaa, 0x0b, 0xb2, 0xba, 0xfb, 0xb0, 0xab, 0xb9, 0x26, 0x18, 0x47, 0x0f, 0xe4,
+    0x16, 0xda, 0x91, 0x69, 0xe7, 0xd6, 0x2d, 0xa8, 0x5a, 0x8d, 0x19, 0x31, 0x45, 0xf7, 0x82, 0x96,
+    0x4c, 0x03, 0x8f, 0xe5, 0xdc, 0x6d, 0x13, 0xcf, 0x96, 0xe4, 0x79, 0x5a, 0x08, 0xbd, 0x07, 0xc1,
+    0x14, 0x91, 0x3f, 0x70, 0x44, 0x6d, 0x3f, 0x9d, 0xe7, 0x5d, 0x12, 0x69, 0xef, 0x65, 0x07, 0xcf,
+    0x7b, 0x2e, 0x60, 0x67, 0x28, 0x8b, 0x09, 0x86, 0x76, 0x07, 0x15, 0xc3, 0x19, 0xa2, 0xba, 0xa1,
+    0x70, 0x8a, 0x8b, 0x76, 0x63, 0x32, 0x2b, 0xae, 0x5f, 0x0c, 0xe4, 0x75, 0x6f, 0xbf, 0xc6, 0x93,
+    0x93, 0x93, 0xf6, 0x79, 0x3b, 0x85, 0xea, 0x6d, 0x4b, 0xa7, 0xcf, 0x7f, 0x1d, 0x99, 0x4f, 0x85,
+    0x70, 0x17, 0x00, 0x00,
+};
+
+static const uint8_t zlibText10[] = {
+    0x28, 0x91, 0x75, 0x92, 0x41, 0x72, 0x23, 0x57, 0x0c, 0x43, 0xf7, 0x3c, 0x85, 0xce, 0x90, 0xc5,
+    0x54, 0xae, 0xa3, 0x58, 0xed, 0x91, 0x6b, 0x1c, 0x8d, 0xca, 0x92, 0x33, 0x55, 0x39, 0x7d, 0x9a,
+    0xc4, 0xc3, 0x6f, 0xfe, 0x3f, 0xce, 0xc2, 0x6e, 0x75, 0x93, 0x04, 0x41, 0x00, 0xef, 0xdb, 0xed,
+    0xfb, 0xf3, 0x7a, 0x7a, 0xb9, 0x7e, 0xde, 0x7e, 0xc4, 0xeb, 0xfb, 0xf9, 0x71, 0x3d, 0xfd, 0x7a,
+    0xbb, 0x5d, 0x7e, 0xfe, 0x3a, 0x5d, 0xde, 0x1e, 0xcf, 0xf3, 0xed, 0x65, 0x3b, 0x3d, 0x7e, 0x6c,
+    0xcf, 0x97, 0xeb, 0xe9, 0x5d, 0x9d, 0x8f, 0xed, 0xe3, 0x9f, 0xed, 0xe3, 0xf4, 0xbc, 0x6e, 0x1a,
+    0x3a, 0x5d, 0xb7, 0xf3, 0x65, 0xff, 0xc0, 0xf7, 0xb7, 0xdb, 0x0e, 0xf2, 0xdc, 0x6b, 0xef, 0x6f,
+    0xdb, 0xed, 0x19, 0xdf, 0xff, 0x7d, 0xbb, 0x9f, 0xfe, 0xfa, 0x7c, 0x7d, 0xdd, 0x4b, 0x97, 0xf3,
+    0xf3, 0xec, 0xdf, 0xf5, 0xfd, 0xf3, 0x7e, 0xc9, 0x56, 0x3d, 0x42, 0x68, 0x2c, 0xa3, 0x0d, 0x50,
+    0x1a, 0xf9, 0x28, 0x96, 0x8f, 0xe7, 0xc7, 0x76, 0xfe, 0x7b, 0xec, 0xdb, 0x59, 0xdc, 0xa7, 0x4a,
+    0xd0, 0xb0, 0x9e, 0x01, 0xd6, 0xf6, 0xb8, 0xff, 0xf9, 0xc7, 0xb7, 0x6f, 0x01, 0xfb, 0x97, 0x9f,
+    0x1f, 0x1b, 0xff, 0x8a, 0xb8, 0x08, 0xa2, 0x04, 0x2c, 0xba, 0x46, 0x3e, 0x69, 0xd3, 0x76, 0x40,
+    0x55, 0x03, 0x01, 0x66, 0xa1, 0xd6, 0x70, 0x2b, 0x32, 0xfa, 0x15, 0x56, 0xa5, 0x8d, 0xc6, 0x07,
+    0x61, 0xb6, 0x5b, 0x0a, 0xce, 0x61, 0x6e, 0x74, 0x15, 0xe9, 0x1a, 0xf7, 0x29, 0xa5, 0x23, 0x8c,
+    0xdc, 0xae, 0x8f, 0xd5, 0x4b, 0x65, 0xd1, 0x2f, 0xef, 0x0d, 0x44, 0x71, 0x4d, 0x04, 0x06, 0x73,
+    0x57, 0xbb, 0x4c, 0x48, 0x33, 0xd8, 0xc0, 0xc1, 0xa8, 0x56, 0x39, 0xd3, 0xc2, 0x75, 0x3b, 0xd3,
+    0x70, 0x99, 0x0b, 0xab, 0x62, 0xbf, 0x2c, 0xb6, 0xf0, 0x1d, 0x2e, 0xd5, 0x90, 0x92, 0x0b, 0xca,
+    0xa2, 0x45, 0x47, 0xdd, 0x69, 0xa6, 0x73, 0xc0, 0x66, 0xc9, 0x96, 0x5b, 0x61, 0x27, 0xb4, 0x60,
+    0xfb, 0xfa, 0x9a, 0x2a, 0x9b, 0xfb, 0xac, 0x6c, 0xf3, 0xcf, 0x06, 0x8f, 0xdc, 0xb5, 0xf4, 0x70,
+    0xea, 0xb4, 0x6c, 0x3c, 0x53, 0xa4, 0xfc, 0xab, 0xbb, 0x58, 0x99, 0xef, 0x5d, 0xdc, 0x7b, 0x94,
+    0x51, 0x38, 0x23, 0x9c, 0x9e, 0xfa, 0x25, 0x17, 0x05, 0xe5, 0xac, 0x26, 0x45, 0x91, 0x09, 0xd4,
+    0x42, 0x7f, 0x44, 0x16, 0x8e, 0x63, 0xab, 0x37, 0xab, 0xe4, 0x67, 0x81, 0x1c, 0xa7, 0x09, 0x86,
+    0xd8, 0xf7, 0xdc, 0xb1, 0x73, 0x36, 0xa0, 0x07, 0x47, 0x2a, 0xd9, 0x4a, 0x4e, 0x10, 0x39, 0xc3,
+    0x87, 0x53, 0x3d, 0xd4, 0x18, 0x8b, 0x21, 0xbe, 0x64, 0xf8, 0x38, 0xd9, 0x75, 0x49, 0x6f, 0xf2,
+    0xee, 0x83, 0x36, 0x46, 0x11, 0xaa, 0x9a, 0xab, 0x65, 0xcd, 0x4b, 0x6a, 0x06, 0x68, 0x1e, 0x9e,
+    0x96, 0x0c, 0xdb, 0x75, 0x7b, 0x7a, 0x88, 0x0d, 0x79, 0x6b, 0x5e, 0x24, 0x09, 0x40, 0x89, 0xc9,
+    0xc4, 0x2c, 0x1c, 0x97, 0x15, 0x1f, 0x3b, 0x42, 0x87, 0x70, 0x80, 0x0b, 0xd3, 0x60, 0xbf, 0x80,
+    0xe9, 0xac, 0x55, 0x15, 0x1a, 0x50, 0xeb, 0x03, 0xbf, 0x79, 0xf8, 0xb4, 0xda, 0xc4, 0xdc, 0x90,
+    0xd9, 0x38, 0x3a, 0xc0, 0xab, 0x8a, 0x36, 0x96, 0xf6, 0x6c, 0x66, 0x86, 0xe6, 0x60, 0x79, 0xc2,
+    0xc9, 0x9e, 0x6d, 0xa9, 0x95, 0x8b, 0x6e, 0x74, 0xac, 0x7e, 0x3b, 0x09, 0xb9, 0xc2, 0xad, 0x4c,
+    0xca, 0x13, 0x1f, 0xa8, 0xb9, 0x99, 0xcc, 0x32, 0xc7, 0x51, 0xc3, 0x53, 0x8d, 0xb0, 0xb8, 0xc9,
+    0x51, 0x08, 0x4a, 0xe4, 0x1c, 0x63, 0xd5, 0xc2, 0x78, 0xdd, 0xd7, 0x3c, 0xb2, 0x82, 0xe4, 0xb3,
+    0x92, 0x37, 0xd0, 0xa6, 0xe1, 0x9b, 0x7c, 0x23, 0x30, 0xde, 0x3c, 0x6b, 0x44, 0x0e, 0x7a, 0x1c,
+    0xc0, 0x71, 0xbf, 0x92, 0xa6, 0xba, 0xc3, 0x23, 0x46, 0x76, 0x73, 0x6f, 0x08, 0xf1, 0x89, 0x59,
+    0x50, 0xa6, 0x92, 0x74, 0x21, 0xf3, 0x23, 0xd1, 0x61, 0x91, 0x5f, 0x2a, 0x52, 0xd1, 0xa3, 0xe3,
+    0x5c, 0xe7, 0x27, 0x76, 0x19, 0x38, 0x5a, 0x38, 0xdc, 0x97, 0x20, 0xbe, 0xd2, 0xda, 0x65, 0x57,
+    0x11, 0x53, 0x60, 0x87, 0x78, 0x8c, 0x68, 0x3d, 0x4a, 0x9f, 0xa6, 0xe0, 0xf9, 0xee, 0xc9, 0xf1,
+    0x80, 0xef, 0x2c, 0x35, 0x0a, 0x97, 0x21, 0x96, 0xee, 0xee, 0x1e, 0x33, 0x2a, 0x50, 0x85, 0x68,
+    0x96, 0x5e, 0xcc, 0xfc, 0x6d, 0xf2, 0x81, 0x07, 0x2c, 0xad, 0x1f, 0x22, 0x33, 0x88, 0x06, 0x9d,
+    0x83, 0xb6, 0x78, 0xb1, 0xaf, 0x9a, 0xda, 0xf5, 0xb2, 0xdc, 0x08, 0xee, 0x9c, 0xea, 0x61, 0x25,
+    0x55, 0x38, 0xb1, 0x0f, 0x59, 0xf5, 0xa2, 0xbd, 0xfd, 0x78, 0x95, 0x93, 0xb8, 0x53, 0x68, 0x34,
+    0x55, 0x0c, 0x56, 0x83, 0x50, 0x73, 0xa4, 0x45, 0x3f, 0x4c, 0xdf, 0x5c, 0xfd, 0x0e, 0x4b, 0x93,
+    0x15, 0x90, 0x50, 0x41, 0x60, 0x25, 0xea, 0x71, 0xce, 0xce, 0x25, 0x66, 0xf7, 0xac, 0xbc, 0xea,
+    0x3c, 0x2a, 0x28, 0x42, 0x2b, 0x49, 0xbf, 0x3a, 0x3e, 0xfa, 0x0d, 0xc1, 0x36, 0xa4, 0x54, 0x69,
+    0x5c, 0x6b, 0xf2, 0x0c, 0x02, 0x53, 0xc8, 0x74, 0x66, 0x3a, 0xbe, 0x4a, 0xcc, 0x91, 0x60, 0xe2,
+    0x32, 0x30, 0xd9, 0x54, 0x0d, 0xaa, 0xc5, 0xa8, 0x49, 0xd0, 0x86, 0x6f, 0x99, 0x84, 0xc1, 0x5b,
+    0xd5, 0x59, 0xba, 0xc8, 0x1c, 0x25, 0x80, 0x99, 0xd4, 0x8b, 0x25, 0x10, 0x84, 0xfd, 0xa4, 0x63,
+    0x06, 0x96, 0x93, 0xce, 0xa9, 0x8f, 0x9f, 0x8a, 0x50, 0x64, 0x0e, 0xfe, 0x19, 0x14, 0xdf, 0x20,
+    0x06, 0x20, 0xe9, 0x08, 0x5d, 0x1c, 0x73, 0xa0, 0x41, 0x1d, 0xa7, 0x57, 0xfc, 0xd8, 0x51, 0x07,
+    0xb6, 0xc0, 0xdc, 0x5b, 0xc4, 0xef, 0x83, 0x57, 0xa9, 0x3b, 0xe6, 0xf1, 0x66, 0x32, 0x61, 0x12,
+    0xc3, 0xcf, 0x24, 0x4b, 0x02, 0x90, 0x64, 0xef, 0x8a, 0xbe, 0xa5, 0xd6, 0x8f, 0x7b, 0x7e, 0x77,
+    0xc3, 0xcc, 0x0e, 0xdb, 0x10, 0xd5, 0x23, 0x05, 0xb6, 0x18, 0x94, 0x6b, 0x99, 0xe7, 0x31, 0xee,
+    0x30, 0x8c, 0x32, 0x03, 0x4d, 0xa4, 0x80, 0x63, 0x4b, 0x5b, 0x1d, 0x95, 0x68, 0x8a, 0x7c, 0x8c,
+    0xfb, 0xbc, 0x9d, 0xc9, 0xae, 0xa5, 0x7b, 0xe0, 0xc4, 0x64, 0x97, 0x7c, 0x09, 0x44, 0x67, 0xed,
+    0xdf, 0x0c, 0x2b, 0x00, 0x18, 0x5c, 0x8c, 0x4c, 0xb5, 0x1c, 0x98, 0x50, 0x31, 0x45, 0xec, 0x07,
+    0xf1, 0xc3, 0xcc, 0x96, 0xed, 0x42, 0xa2, 0xbf, 0x20, 0x8a, 0xb8, 0x98, 0xea, 0x77, 0x8e, 0x6a,
+    0x79, 0xbd, 0x2e, 0x29, 0x05, 0xa6, 0x4a, 0xbd, 0xee, 0xa4, 0x0a, 0x88, 0x5b, 0x14, 0xcc, 0xb0,
+    0x1c, 0xeb, 0xa8, 0x02, 0xab, 0xdf, 0xd6, 0x27, 0xe9, 0x79, 0x97, 0xb3, 0x2b, 0xcd, 0x62, 0xb6,
+    0x4a, 0xbc, 0xeb, 0x77, 0xc0, 0x61, 0x4a, 0x4f, 0xc9, 0xc0, 0x88, 0xce, 0xc9, 0xc3, 0xa6, 0xc8,
+    0x53, 0xd5, 0x58, 0x55, 0x4a, 0x91, 0x9a, 0xac, 0x57, 0x88, 0x97, 0x22, 0xf9, 0x91, 0xeb, 0x78,
+    0xb4, 0x2c, 0x97, 0x41, 0x81, 0xac, 0xd9, 0x8e, 0x15, 0x0a, 0x6c, 0x7f, 0x31, 0x57, 0x51, 0x72,
+    0x1c, 0xa6, 0x88, 0xa4, 0x04, 0x8a, 0x93, 0x13, 0x4b, 0x05, 0xbd, 0x7e, 0xd3, 0x91, 0x0f, 0xc8,
+    0x16, 0x6e, 0x1b, 0x2c, 0x77, 0x39, 0xc2, 0xd4, 0xb1, 0xa9, 0x05, 0x80, 0xf6, 0x5a, 0xdb, 0xa4,
+    0x68, 0xef, 0x5d, 0x51, 0x00, 0xb8, 0xc2, 0x4a, 0xfa, 0x8e, 0x11, 0x6f, 0xe1, 0x73, 0xbf, 0x48,
+    0xf2, 0x49, 0x77, 0x73, 0x99, 0x3d, 0xf5, 0xe9, 0x3e, 0x18, 0xe1, 0x8b, 0x83, 0x05, 0x13, 0x56,
+    0x27, 0x21, 0x9e, 0xcb, 0x6a, 0x46, 0x79, 0x7c, 0x1d, 0x25, 0x1d, 0x3e, 0x67, 0x75, 0x61, 0x76,
+    0xe0, 0xfa, 0x83, 0x21, 0xfc, 0x9e, 0x36, 0x43, 0xa4, 0x48, 0x75, 0xce, 0xff, 0xe3, 0x5c, 0xae,
+    0x0d, 0xa9, 0xa1, 0xdd, 0xcc, 0xe0, 0xd1, 0x98, 0x32, 0xa5, 0xa2, 0x29, 0x0f, 0xe8, 0x64, 0x61,
+    0x15, 0x4c, 0x28, 0x17, 0xb2, 0xa0, 0xed, 0xb1, 0x6e, 0x56, 0x40, 0xe7, 0x7d, 0xd1, 0x00, 0xb2,
+    0x98, 0x06, 0x32, 0xd7, 0x71, 0x72, 0x8c, 0x11, 0x73, 0x82, 0x79, 0x67, 0x15, 0xde, 0xe1, 0x9e,
+    0xd5, 0x4e, 0x98, 0x4e, 0x9b, 0x4a, 0x34, 0x89, 0xc1, 0x4e, 0xf1, 0x89, 0x75, 0xca, 0xe2, 0xb4,
+    0x2c, 0xb0, 0xb6, 0xa5, 0x58, 0x65, 0x01, 0x11, 0xaa, 0xa8, 0x23, 0x07, 0x1a, 0xe8, 0x13, 0xa8,
+    0x37, 0xb7, 0x94, 0xec, 0x48, 0xdb, 0x74, 0xa8, 0x3b, 0xd3, 0xe2, 0x42, 0x94, 0x90, 0x1e, 0x91,
+    0xdd, 0x93, 0xe7, 0x2d, 0x18, 0x8d, 0x95, 0x81, 0x90, 0xd3, 0x7e, 0xd6, 0x92, 0x50, 0x7b, 0xf0,
+    0xb1, 0xc7, 0x49, 0xdb, 0x0a, 0x52, 0x7c, 0x86, 0x9f, 0xd9, 0xd4, 0xf3, 0xe7, 0xfd, 0x61, 0xf5,
+    0x73, 0xf7, 0xe4, 0x56, 0xf3, 0x36, 0x8b, 0x31, 0x1b, 0x5c, 0xfd, 0x90, 0x2c, 0x5b, 0xea, 0x83,
+    0x2d, 0x5d, 0x9f, 0x4d, 0xb2, 0x11, 0xc2, 0xbe, 0x31, 0x97, 0x70, 0xc2, 0x10, 0xc6, 0xca, 0x66,
+    0x6d, 0x96, 0x61, 0x0a, 0x3c, 0xd0, 0xc3, 0x08, 0x68, 0x33, 0xc1, 0x1b, 0xdc, 0xb9, 0xb5, 0xc7,
+    0x7a, 0x09, 0xaa, 0x25, 0xd2, 0x58, 0x29, 0x25, 0x4d, 0xd7, 0x90, 0x82, 0x51, 0xa7, 0x77, 0x0b,
+    0xb7, 0x41, 0x6d, 0xe4, 0xc0, 0x1c, 0xe4, 0x1a, 0xa9, 0xa3, 0x9f, 0x88, 0xd2, 0xd2, 0xbd, 0x30,
+    0x12, 0x8b, 0xe4, 0xc9, 0x58, 0x37, 0xd3, 0x0e, 0x55, 0x8f, 0x84, 0x0f, 0x91, 0xb3, 0x97, 0x8d,
+    0xba, 0x43, 0x9d, 0xb4, 0x64, 0x95, 0x9f, 0x10, 0xe9, 0xd8, 0x90, 0x3a, 0x0c, 0x19, 0x3f, 0x86,
+    0x7d, 0xf6, 0x95, 0x91, 0x48, 0x7e, 0x21, 0xa8, 0xa8, 0xdb, 0x6b, 0x7f, 0xfe, 0x28, 0xb1, 0x07,
+    0xc2, 0x44, 0xbb, 0x4a, 0x90, 0x9c, 0xdb, 0x6a, 0xba, 0x68, 0x9b, 0x13, 0x34, 0x8f, 0xc4, 0x21,
+    0xd9, 0xc8, 0x79, 0x76, 0xc7, 0xb1, 0x47, 0x2a, 0x6b, 0xcf, 0xe0, 0xc2, 0x0c, 0x2b, 0x09, 0x95,
+    0x03, 0x93, 0x0d, 0x7c, 0x62, 0xfa, 0xba, 0xfd, 0x07, 0x3b, 0xdf, 0x90, 0x52,
+};
+
+static const uint8_t fixedText[] = {
+    0xcb, 0x49, 0xcd, 0x4b, 0x2f, 0xc9, 0x50, 0x48, 0xce, 0x28, 0xcd, 0xcb, 0xe6, 0x4a, 0xcb, 0x49,
+    0x2c, 0xce, 0x50, 0x28, 0xcf, 0xcc, 0x4b, 0xc9, 0x2f, 0x57, 0x48, 0xc9, 0x2c, 0x2e, 0x49, 0xcc,
+    0x4b, 0x4e, 0x55, 0x28, 0xce, 0x4e, 0x2d, 0x49, 0xce, 0x50, 0xc8, 0x81, 0xa8, 0x2c, 0x4e, 0x2d,
+    0x2a, 0x4b, 0x2d, 0x52, 0x28, 0xc9, 0x48, 0x85, 0x68, 0x52, 0xc8, 0x48, 0x4d, 0x4c, 0x01, 0x0a,
+    0x40, 0xc5, 0x33, 0xf3, 0x80, 0x86, 0x94, 0x00, 0xe5, 0x72, 0x32, 0x53, 0xf3, 0x4a, 0xb8, 0xd2,
+    0xab, 0x32, 0x0b, 0x14, 0x92, 0x4a, 0xd3, 0xd2, 0x80, 0x52, 0x29, 0x89, 0x25, 0x89, 0x30, 0x36,
+    0x58, 0xbc, 0xb4, 0x20, 0x05, 0xa4, 0x14, 0x42, 0x71, 0x41, 0x4c, 0x83, 0x5a, 0x06, 0x55, 0x06,
+    0x35, 0x14, 0xaa, 0x10, 0x2a, 0x08, 0x71, 0x65, 0x71, 0x49, 0x51, 0x6a, 0x62, 0x2e, 0xdc, 0x3e,
+    0xa0, 0x2b, 0x0a, 0x50, 0x64, 0xb8, 0xa0, 0x0a, 0xd0, 0xbd, 0x01, 0x35, 0x2b, 0xb5, 0xb8, 0xc0,
+    0xc2, 0xc8, 0xcc, 0x8c, 0x0b, 0xea, 0xfa, 0xe4, 0xfc, 0xa2, 0x54, 0x28, 0x01, 0x76, 0x38, 0xc4,
+    0x81, 0xd0, 0x90, 0x80, 0xba, 0x02, 0x39, 0x8c, 0x60, 0x5e, 0x4a, 0x85, 0xd8, 0x0e, 0x35, 0x14,
+    0x22, 0x07, 0x35, 0x01, 0xea, 0x32, 0x2e, 0x88, 0x52, 0x2e, 0x98, 0x52, 0x68, 0x30, 0xc2, 0xb8,
+    0x50, 0x57, 0x81, 0xc3, 0x06, 0xa2, 0x1d, 0xee, 0x60, 0xa8, 0xed, 0xb0, 0xa0, 0x80, 0x7a, 0x07,
+    0xaa, 0x0f, 0xae, 0x0a, 0xec, 0x68, 0xb0, 0x76, 0x98, 0x57, 0xc0, 0xe1, 0x08, 0x75, 0x11, 0x4c,
+    0x39, 0x44, 0x10, 0xac, 0x16, 0x2a, 0x83, 0x16, 0x7e, 0x20, 0xff, 0x72, 0x41, 0x03, 0x05, 0x26,
+    0x07, 0x71, 0x00, 0xdc, 0xe5, 0x30, 0x59, 0xe4, 0x60, 0x82, 0x06, 0x0d, 0xdc, 0x35, 0x50, 0x37,
+    0xc0, 0x4c, 0x85, 0x85, 0x32, 0x28, 0xb5, 0x40, 0x7d, 0x07, 0x74, 0x29, 0x17, 0x4c, 0x1a, 0xea,
+    0x43, 0xb0, 0x0c, 0x2c, 0xbe, 0x60, 0x81, 0x0d, 0x31, 0x1f, 0x96, 0xb8, 0x20, 0x72, 0xd0, 0xa0,
+    0x84, 0xfa, 0x00, 0x1c, 0x45, 0x68, 0xe1, 0x08, 0xf1, 0x27, 0xcc, 0xa5, 0xa8, 0x09, 0x0c, 0x35,
+    0xc8, 0xd0, 0xfc, 0x0a, 0x75, 0x1d, 0xc4, 0x34, 0x2e, 0xa8, 0xed, 0xe8, 0x5c, 0x50, 0x28, 0xc3,
+    0xdc, 0x8e, 0x1a, 0xb2, 0x48, 0xf1, 0x07, 0x8b, 0x60, 0x78, 0xba, 0x43, 0x4a, 0x3d, 0x50, 0xaf,
+    0xa2, 0x58, 0x06, 0xa7, 0x41, 0x81, 0x04, 0xc2, 0x60, 0x7f, 0x41, 0xad, 0x04, 0xf1, 0x91, 0x03,
+    0xb7, 0x00, 0x9c, 0xa3, 0xb8, 0xa0, 0x31, 0x03, 0x31, 0x07, 0x25, 0x3f, 0xa0, 0x7a, 0x12, 0x23,
+    0xfb, 0x41, 0x1c, 0xc3, 0x05, 0x0d, 0x2d, 0x68, 0xf8, 0x43, 0x03, 0x19, 0x62, 0x0e, 0x2c, 0xd9,
+    0x42, 0x78, 0xb0, 0x50, 0x82, 0xd1, 0x60, 0x43, 0xd0, 0xb3, 0x14, 0x34, 0xd9, 0x23, 0xa7, 0x3b,
+    0xa8, 0x9d, 0x68, 0x39, 0x1c, 0x29, 0xe1, 0x40, 0x42, 0x89, 0x0b, 0x25, 0xe3, 0x40, 0x1d, 0x07,
+    0x33, 0x9e, 0x0b, 0x96, 0xaa, 0xe1, 0xa1, 0x81, 0x9e, 0x35, 0xd0, 0xd2, 0x30, 0xc2, 0xcb, 0xa8,
+    0x19, 0x17, 0xe6, 0x78, 0x98, 0x3a, 0xd4, 0x02, 0x0d, 0x9a, 0xa8, 0xc0, 0xfa, 0xc0, 0x96, 0x21,
+    0xc5, 0x25, 0x54, 0x0e, 0x9e, 0xf2, 0x11, 0x71, 0xa8, 0x80, 0x96, 0x86, 0xd1, 0xb2, 0x35, 0x52,
+    0x60, 0xc3, 0x8a, 0x42, 0x58, 0x0a, 0x05, 0x39, 0x12, 0x91, 0x17, 0xd0, 0x8b, 0x10, 0xd4, 0xdc,
+    0x0e, 0x76, 0x0f, 0x2c, 0x46, 0x60, 0x19, 0x17, 0x6c, 0x0e, 0xd4, 0x38, 0x78, 0x56, 0x82, 0xda,
+    0x0f, 0x31, 0x18, 0xaa, 0x12, 0x6c, 0x15, 0x38, 0xd1, 0x40, 0x4d, 0x05, 0x0b, 0x40, 0xd9, 0x50,
+    0x0a, 0xe6, 0x35, 0xb0, 0x4d, 0xb0, 0x42, 0x03, 0x16, 0xcc, 0x30, 0x73, 0x20, 0x1e, 0x80, 0xa7,
+    0x7c, 0x90, 0xb3, 0xd1, 0xf3, 0x14, 0x2c, 0xa3, 0xa2, 0x24, 0x2c, 0x98, 0x0e, 0x58, 0xca, 0x46,
+    0x8d, 0x16, 0xb0, 0x95, 0x68, 0xe1, 0x06, 0x55, 0x81, 0x1e, 0xdf, 0xc8, 0xe5, 0x1b, 0x5a, 0x41,
+    0x0a, 0x89, 0x13, 0x98, 0x07, 0x51, 0x4b, 0x0d, 0x88, 0x63, 0xd0, 0xf4, 0xa1, 0x56, 0x00, 0x30,
+    0x2d, 0x50, 0x8b, 0x91, 0x82, 0x03, 0x51, 0xa9, 0x71, 0xa1, 0x26, 0x63, 0x88, 0x1c, 0x17, 0x7a,
+    0xc9, 0x03, 0x0a, 0x5b, 0x78, 0xf6, 0x85, 0x79, 0x0b, 0xe4, 0x6e, 0xd4, 0x5c, 0x86, 0xc8, 0xa0,
+    0x28, 0x65, 0x0c, 0xdc, 0x66, 0xd4, 0x30, 0x82, 0x15, 0x8a, 0x48, 0xc9, 0x01, 0x6a, 0x0e, 0x4a,
+    0x8e, 0x44, 0x29, 0x1f, 0xd1, 0x6a, 0x3a, 0x70, 0x89, 0x0b, 0xcd, 0x6e, 0xa8, 0x01, 0x0a, 0xd5,
+    0x05, 0x72, 0x34, 0xd8, 0x64, 0x28, 0x03, 0x64, 0x3a, 0xd4, 0x15, 0xf0, 0x72, 0x9b, 0x0b, 0x39,
+    0xe9, 0xc0, 0xd2, 0x35, 0x48, 0x08, 0x56, 0x7f, 0xa1, 0xe4, 0x59, 0x58, 0x4a, 0x45, 0x34, 0x15,
+    0x60, 0xbe, 0x84, 0x85, 0x1d, 0x38, 0xe5, 0x83, 0x1c, 0x06, 0x2d, 0x3b, 0x60, 0x81, 0x07, 0xd5,
+    0x02, 0x2d, 0xdf, 0xd0, 0x6a, 0x13, 0xb0, 0x2e, 0x98, 0xbf, 0x51, 0x62, 0x1c, 0x5a, 0x20, 0xa2,
+    0x05, 0x35, 0x72, 0x55, 0x0e, 0x0b, 0x3a, 0x78, 0xd9, 0x80, 0x92, 0x53, 0x21, 0x89, 0x08, 0x35,
+    0xe8, 0x51, 0x1a, 0x43, 0xa8, 0xf1, 0x80, 0x5a, 0x3f, 0xc2, 0xc2, 0x8f, 0x0b, 0x6b, 0x1e, 0x44,
+    0x72, 0x03, 0xb4, 0xaa, 0x80, 0x5a, 0x0c, 0xf3, 0x15, 0x8a, 0x72, 0xd4, 0x52, 0x17, 0xea, 0x47,
+    0xa8, 0xb9, 0xa8, 0xa9, 0x1a, 0x1e, 0x95, 0xb0, 0x76, 0x19, 0xc4, 0x4d, 0x50, 0xfb, 0x50, 0x5a,
+    0x22, 0xf0, 0x76, 0x5a, 0x01, 0x4a, 0x8d, 0x0b, 0x69, 0xc3, 0xa1, 0xe5, 0x34, 0x94, 0xca, 0x04,
+    0xa5, 0x48, 0x47, 0xcd, 0xa9, 0x5c, 0x68, 0x55, 0x3c, 0x72, 0x43, 0x2c, 0x05, 0x92, 0xb9, 0x91,
+    0x2a, 0x6e, 0x94, 0x9a, 0x11, 0x25, 0xc7, 0xc1, 0x8a, 0x45, 0xa0, 0x5b, 0xb8, 0x50, 0x63, 0x0f,
+    0x16, 0xf2, 0x10, 0x79, 0xcc, 0xd2, 0x13, 0x39, 0x9f, 0xa1, 0x78, 0x9e, 0x0b, 0xa5, 0x19, 0x08,
+    0xb5, 0x0d, 0xa5, 0xed, 0x08, 0xf7, 0x2d, 0x6a, 0x21, 0x00, 0x6b, 0x82, 0x80, 0x4d, 0x46, 0x2a,
+    0xa2, 0xb1, 0xa5, 0x18, 0x44, 0x0a, 0x46, 0x6f, 0x02, 0x61, 0xa9, 0x6e, 0x11, 0x79, 0x1e, 0x1c,
+    0xa0, 0x48, 0xe6, 0xa3, 0x36, 0x9e, 0xa1, 0x3c, 0xe4, 0x2a, 0x0c, 0xbd, 0x25, 0x05, 0x69, 0xee,
+    0xa5, 0x22, 0x55, 0x78, 0xa8, 0xed, 0x72, 0xb4, 0x52, 0x05, 0xd5, 0x60, 0x68, 0x01, 0x06, 0xd5,
+    0x81, 0x56, 0xd6, 0xc1, 0x12, 0x2c, 0xa4, 0x19, 0x0e, 0x2d, 0x7e, 0x20, 0xee, 0x47, 0x6e, 0x85,
+    0x70, 0x21, 0x35, 0x22, 0x51, 0x1a, 0xc3, 0x5c, 0xa8, 0x09, 0x1a, 0xbd, 0xb8, 0x43, 0xae, 0x60,
+    0xc0, 0x1e, 0x44, 0x69, 0xb9, 0x23, 0x92, 0x78, 0x01, 0x4a, 0xc9, 0x86, 0x08, 0x3a, 0xf4, 0xf6,
+    0x2f, 0x38, 0xdb, 0x22, 0x07, 0x06, 0x72, 0x33, 0x0a, 0xb9, 0x3d, 0x01, 0x56, 0xc5, 0x85, 0x6c,
+    0x0b, 0xa4, 0xe1, 0x08, 0xf3, 0x0f, 0x66, 0x6c, 0xc0, 0xcb, 0x1b, 0xf4, 0xa2, 0x1a, 0xa6, 0x05,
+    0x39, 0x2b, 0x21, 0xd7, 0x71, 0xa8, 0x69, 0x1f, 0xee, 0x0f, 0x94, 0x42, 0x17, 0xad, 0x1a, 0x42,
+    0x29, 0x6c, 0x10, 0x9e, 0x02, 0x97, 0x85, 0x90, 0x1a, 0x1e, 0xbd, 0xc5, 0x8f, 0x5a, 0x1b, 0xa1,
+    0xb6, 0x82, 0x51, 0xf2, 0x0c, 0x17, 0x4a, 0x9d, 0x8e, 0x9a, 0x20, 0x90, 0x5d, 0x8d, 0xd6, 0x92,
+    0x41, 0xce, 0xf4, 0xa8, 0xc5, 0x39, 0x24, 0x43, 0x21, 0x9b, 0x8a, 0x92, 0xbd, 0xe1, 0x0e, 0x47,
+    0x2b, 0xaf, 0xa0, 0xf9, 0x03, 0xa9, 0xc6, 0x01, 0x1b, 0x01, 0x76, 0x38, 0x34, 0x5b, 0x83, 0xd9,
+    0x88, 0x2e, 0x25, 0x72, 0xd6, 0x86, 0xb7, 0xd3, 0x21, 0xc6, 0x80, 0xa5, 0x50, 0xb2, 0x3e, 0x34,
+    0xa5, 0x42, 0x0c, 0x42, 0x69, 0xbd, 0x72, 0xa1, 0x16, 0xe8, 0x08, 0xad, 0x58, 0x3a, 0xa1, 0x28,
+    0x75, 0x0b, 0x6a, 0x8b, 0x81, 0x0b, 0x35, 0xaa, 0x20, 0xee, 0x86, 0x64, 0x0c, 0x94, 0x12, 0x1f,
+    0xb9, 0x2b, 0x89, 0x92, 0x99, 0xe0, 0xad, 0x02, 0x58, 0x48, 0xa3, 0x14, 0xf6, 0x88, 0xea, 0x09,
+    0xa3, 0xfd, 0x0a, 0x0e, 0x11, 0xa4, 0x5a, 0x16, 0xd1, 0xa0, 0x81, 0x79, 0x9f, 0x0b, 0x52, 0x04,
+    0x21, 0x2a, 0x72, 0x94, 0x82, 0x1f, 0x99, 0xc3, 0x85, 0xd2, 0x5e, 0x42, 0xaa, 0x8f, 0x51, 0x83,
+    0x00, 0x25, 0x6f, 0xa0, 0x37, 0x4a, 0xd1, 0xc3, 0x11, 0xb5, 0x7d, 0xcd, 0x85, 0xda, 0xfc, 0x80,
+    0x56, 0xf5, 0x30, 0xa7, 0xa3, 0xb4, 0x67, 0xc0, 0xd6, 0x22, 0x17, 0x94, 0x48, 0x41, 0x81, 0xc4,
+    0x47, 0x0e, 0x51, 0xa8, 0x01, 0x50, 0x5f, 0xa0, 0xf7, 0xc2, 0xe0, 0xc9, 0x1b, 0xa5, 0x16, 0x84,
+    0x38, 0x12, 0xb9, 0x2e, 0xc3, 0x91, 0x89, 0xd0, 0x3b, 0x16, 0x60, 0x37, 0xa0, 0x56, 0x57, 0xc8,
+    0x8e, 0x40, 0xc9, 0x73, 0x68, 0x79, 0x0f, 0x7b, 0x43, 0x12, 0x25, 0xbc, 0x51, 0xd3, 0x2a, 0x9a,
+    0xcb, 0x30, 0x7b, 0xf8, 0xe8, 0x25, 0x29, 0x52, 0x3b, 0x09, 0xec, 0x28, 0x64, 0x37, 0xe3, 0x88,
+    0x39, 0x78, 0xcf, 0x51, 0x01, 0x5b, 0xcf, 0x0f, 0x51, 0xc8, 0x62, 0x19, 0x4d, 0xc1, 0xd2, 0x66,
+    0x87, 0x39, 0x08, 0x69, 0x3c, 0x07, 0xc9, 0x1e, 0xf4, 0x8c, 0x8b, 0xd2, 0x40, 0x47, 0x56, 0x00,
+    0x35, 0x19, 0xd6, 0x39, 0x44, 0x74, 0x78, 0x51, 0x5b, 0xb3, 0x68, 0xbd, 0x36, 0x64, 0x57, 0x71,
+    0xa1, 0x37, 0x3e, 0xd0, 0xa3, 0x13, 0xb5, 0x29, 0x81, 0xd4, 0x2d, 0xe2, 0x42, 0xee, 0x64, 0xa3,
+    0x37, 0x8e, 0x51, 0x8a, 0x71, 0x2e, 0xe4, 0xb4, 0x00, 0x6b, 0xb3, 0x20, 0x52, 0x31, 0x44, 0x1a,
+    0x9a, 0xc5, 0x10, 0x1d, 0x84, 0x02, 0xf4, 0xf6, 0x19, 0x17, 0x6a, 0xdd, 0x00, 0xb5, 0x19, 0xb9,
+    0xf7, 0x85, 0xde, 0xa1, 0x40, 0x4e, 0xfc, 0x90, 0xe2, 0x01, 0x65, 0x6c, 0x03, 0xa9, 0x15, 0x82,
+    0x25, 0x61, 0x20, 0xb9, 0x0a, 0x66, 0x10, 0x34, 0x38, 0x51, 0xab, 0x08, 0x68, 0x39, 0x06, 0x2b,
+    0xfa, 0x91, 0x92, 0x13, 0xa2, 0xe8, 0x82, 0xba, 0x07, 0x65, 0xf8, 0x07, 0x39, 0xfd, 0xa1, 0xe7,
+    0x29, 0x48, 0x49, 0x8f, 0x32, 0x34, 0x80, 0x34, 0x98, 0x81, 0x54, 0x5e, 0x21, 0x17, 0x00, 0xc8,
+    0x4d, 0x1f, 0x94, 0x71, 0x16, 0x74, 0x1a, 0x3d, 0x63, 0xc1, 0x83, 0x01, 0xd1, 0x90, 0xc4, 0x18,
+    0xc1, 0x44, 0x6e, 0x1a, 0xa0, 0x06, 0x03, 0x4a, 0x82, 0x87, 0x95, 0x63, 0xf0, 0xe6, 0x15, 0x4a,
+    0xd3, 0x11, 0x36, 0xe2, 0x05, 0x71, 0x3b, 0x66, 0xfe, 0x42, 0x4f, 0xa8, 0xa8, 0x0d, 0x32, 0xc8,
+    0xd8, 0x07, 0xca, 0xd0, 0x1c, 0x5a, 0x83, 0x11, 0x5e, 0x07, 0xc2, 0xa2, 0x10, 0xa5, 0xcb, 0x84,
+    0x65, 0xd4, 0x8d, 0x0b, 0xd6, 0x6a, 0x45, 0x29, 0x19, 0xa1, 0x4a, 0x90, 0xe3, 0x02, 0x66, 0x12,
+    0x4a, 0x1b, 0x18, 0x6e, 0x1d, 0xaa, 0xb3, 0x51, 0x1a, 0xcf, 0x28, 0x81, 0x8c, 0xe8, 0x2d, 0x70,
+    0x21, 0x8f, 0x83, 0x40, 0x95, 0x20, 0x35, 0x7f, 0xa0, 0x0e, 0x41, 0x36, 0x1b, 0xa3, 0x3f, 0x8f,
+    0xda, 0x24, 0x42, 0xae, 0x7b, 0x61, 0x35, 0x38, 0x78, 0x9c, 0x0b, 0x9a, 0x77, 0xe0, 0x2d, 0x0b,
+    0x44, 0x66, 0x40, 0x1b, 0x83, 0xe2, 0x82, 0x3b, 0x06, 0x96, 0xab, 0xd1, 0x72, 0x21, 0xa2, 0x71,
+    0x81, 0x36, 0x62, 0x82, 0x48, 0x71, 0xe8, 0x03, 0x03, 0xe0, 0xe1, 0x5e, 0xf4, 0x61, 0x3c, 0xa4,
+    0x9e, 0x13, 0x72, 0x3d, 0x8f, 0xd2, 0x0b, 0x45, 0x1e, 0x6d, 0x41, 0x2f, 0x3e, 0x01,
+};
+
+static const uint8_t storedText[] = {
+    0x78, 0x01, 0x01, 0xe8, 0x03, 0x17, 0xfc, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x64, 0x61, 0x74, 0x61,
+    0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x20, 0x67,
+    0x7a, 0x69, 0x70, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x63, 0x6f, 0x72, 0x65, 0x20,
+    0x67, 0x7a, 0x69, 0x70, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x64, 0x69, 0x73,
+    0x74, 0x61, 0x6e, 0x63, 0x65, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x0a, 0x64, 0x69, 0x73, 0x74, 0x61,
+    0x6e, 0x63, 0x65, 0x20, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x68, 0x65, 0x61, 0x70, 0x20, 0x62, 0x75, 0x66, 0x66,
+    0x65, 0x72, 0x20, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x0a, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65,
+    0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74, 0x20, 0x66,
+    0x6c, 0x61, 0x73, 0x68, 0x20, 0x63, 0x68, 0x75, 0x6e, 0x6b, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e,
+    0x74, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x75, 0x70, 0x64, 0x61,
+    0x74, 0x65, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x20, 0x64, 0x69, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65,
+    0x20, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x73, 0x65,
+    0x72, 0x76, 0x65, 0x72, 0x20, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x0a, 0x63, 0x6f, 0x72, 0x65,
+    0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x0a, 0x74, 0x68, 0x65, 0x20, 0x73, 0x6b, 0x65, 0x74,
+    0x63, 0x68, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x0a, 0x63, 0x68, 0x75, 0x6e, 0x6b, 0x20,
+    0x63, 0x68, 0x75, 0x6e, 0x6b, 0x0a, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x20,
+    0x67, 0x7a, 0x69, 0x70, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20,
+    0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x74, 0x68,
+    0x65, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x67,
+    0x7a, 0x69, 0x70, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x0a, 0x64, 0x65, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x63,
+    0x6f, 0x72, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63,
+    0x68, 0x20, 0x68, 0x65, 0x61, 0x70, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x62, 0x75,
+    0x66, 0x66, 0x65, 0x72, 0x20, 0x65, 0x73, 0x70, 0x38, 0x32, 0x36, 0x36, 0x20, 0x67, 0x7a, 0x69,
+    0x70, 0x20, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20,
+    0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x0a, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x66, 0x6c, 0x61, 0x73,
+    0x68, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x69, 0x6e,
+    0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x20, 0x63, 0x6f, 0x72, 0x65, 0x20,
+    0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x65, 0x73,
+    0x70, 0x38, 0x32, 0x36, 0x36, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x74, 0x68, 0x65, 0x20,
+    0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74, 0x20, 0x77, 0x69, 0x6e,
+    0x64, 0x6f, 0x77, 0x0a, 0x74, 0x68, 0x65, 0x20, 0x64, 0x61, 0x74, 0x61, 0x20, 0x73, 0x6b, 0x65,
+    0x74, 0x63, 0x68, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x20,
+    0x68, 0x65, 0x61, 0x70, 0x20, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x20, 0x75, 0x70, 0x64, 0x61,
+    0x74, 0x65, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20,
+    0x64, 0x61, 0x74, 0x61, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x64, 0x61, 0x74, 0x61,
+    0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20,
+    0x64, 0x69, 0x73, 0x74, 0x61, 0x6e, 0x63, 0x65, 0x0a, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20,
+    0x65, 0x73, 0x70, 0x38, 0x32, 0x36, 0x36, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20,
+    0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x73, 0x65,
+    0x72, 0x76, 0x65, 0x72, 0x20, 0x68, 0x65, 0x61, 0x70, 0x20, 0x64, 0x61, 0x74, 0x61, 0x20, 0x73,
+    0x74, 0x72, 0x65, 0x61, 0x6d, 0x20, 0x67, 0x7a, 0x69, 0x70, 0x20, 0x75, 0x70, 0x64, 0x61, 0x74,
+    0x65, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74,
+    0x65, 0x0a, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x75, 0x70, 0x64, 0x61, 0x74, 0x65, 0x20,
+    0x63, 0x6f, 0x72, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x73, 0x6b, 0x65, 0x74,
+    0x63, 0x68, 0x20, 0x69, 0x6e, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x67, 0x74,
+    0x68, 0x20, 0x74, 0x68, 0x65, 0x20, 0x6c, 0x65, 0x6e, 0x67, 0x74, 0x68, 0x20, 0x67, 0x7a, 0x69,
+    0x70, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x68, 0x65, 0x61, 0x70, 0x20, 0x66, 0x6c,
+    0x61, 0x73, 0x68, 0x20, 0x63, 0x6f, 0x72, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20,
+    0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x0a, 0x66, 0x6c,
+    0x61, 0x73, 0x68, 0x20, 0x73, 0x65, 0x72, 0x76, 0x65, 0x72, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63,
+    0x68, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74, 0x20, 0x73, 0x74, 0x72, 0x65, 0x61, 0x6d, 0x20,
+    0x77, 0x69, 0x6e, 0x64, 0x6f, 0x77, 0x20, 0x73, 0x6b, 0x65, 0x74, 0x63, 0x68, 0x20, 0x68, 0x65,
+    0x61, 0x64, 0x65, 0x72, 0x20, 0x65, 0x73, 0x70, 0x38, 0x32, 0x36, 0x36, 0x20, 0x73, 0x6b, 0x65,
+    0x74, 0x63, 0x68, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x63, 0x68, 0x75, 0x6e,
+    0x6b, 0x20, 0x63, 0x6c, 0x69, 0x65, 0x6e, 0x74, 0x20, 0x74, 0x68, 0x65, 0x20, 0x73, 0x65, 0x72,
+    0x76, 0x65, 0x72, 0x0a, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x68, 0x65, 0x61, 0x70, 0x20,
+    0x68, 0x65, 0x61, 0x70, 0x0a, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x64, 0x61, 0x74, 0x61,
+    0x20, 0x74, 0x68, 0x65, 0x0a, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x20, 0x69, 0x6e, 0x66, 0x6c,
+    0x61, 0x74, 0x65, 0x20, 0x62, 0x75, 0x66, 0x66, 0x65, 0x72, 0x0a, 0x75, 0x70, 0x64, 0x61, 0x74,
+    0x65, 0x20, 0x66, 0x6c, 0x61, 0x73, 0x68, 0x20, 0x68, 0x65, 0x61, 0x64, 0x65, 0x72, 0x20, 0x64,
+    0x61, 0x74, 0x61, 0x20, 0x64, 0x65, 0x66, 0x6c, 0x61, 0x74, 0x65, 0x20, 0x74, 0x68, 0x65, 0xff,
+    0xa9, 0x6f, 0x24,
+};
+
+struct StringPrint: public Print
+{
+    std::string data;
+    size_t      limit = SIZE_MAX;
+
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t* buf, size_t len) override
+    {
+        len = std::min(len, limit - data.size());
+        data.append((const char*)buf, len);
+        return len;
+    }
+    int availableForWrite() override
+    {
+        return 1024;
+    }
+};
+
+// feeds the data in pieces of pseudo random sizes up to maxChunk
+static InflateError inflateChunks(Inflate& inflate, const uint8_t* data, size_t len,
+                                  size_t maxChunk, uint32_t seed = 1)
+{
+    while (len)
+    {
+        seed      = seed * 1103515245 + 12345;
+        size_t n  = std::min(len, 1 + (seed >> 16) % maxChunk);
+        if (inflate.write(data, n) != n)
+            break;
+        data += n;
+        len -= n;
+    }
+    return inflate.getError();
+}
+
+TEST_CASE("Inflate decodes every format in pieces of any size", "[inflate]")
+{
+    const std::string text   = makeText(6000, 1);
+    const std::string stored = makeText(1000, 2);
+    struct
+    {
+        const uint8_t* data;
+        size_t         len;
+        InflateFormat  format;
+        uint8_t        windowBits;
+        const std::string& expected;
+    } vectors[] = {
+        { gzipText, sizeof(gzipText), INFLATE_GZIP, 15, text },
+        { zlibText10, sizeof(zlibText10), INFLATE_ZLIB, 10, text },
+        { fixedText, sizeof(fixedText), INFLATE_RAW, 13, text },
+        { storedText, sizeof(storedText), INFLATE_ZLIB, 8, stored },
+    };
+
+    for (const auto& v : vectors)
+    {
+        for (bool autodetect : { false, true })
+        {
+            if (autodetect && v.format == INFLATE_RAW)
+                continue;
+            for (size_t maxChunk : { (size_t)1, (size_t)7, (size_t)100, (size_t)4096 })
+            {
+                StringPrint out;
+                Inflate     inflate;
+                REQUIRE(inflate.begin(out, autodetect ? INFLATE_AUTO : v.format, v.windowBits));
+                CHECK(inflateChunks(inflate, v.data, v.len, maxChunk) == INFLATE_OK);
+                CHECK(inflate.finished());
+                CHECK(inflate.inflated() == v.expected.size());
+                CHECK(out.data == v.expected);
+            }
+        }
+    }
+}
+
+TEST_CASE("Inflate is fed by Stream::send", "[inflate]")
+{
+    const std::string text = makeText(6000, 1);
+    StringPrint       out;
+    Inflate           inflate;
+    REQUIRE(inflate.begin(out));
+    StreamConstPtr in(gzipText, sizeof(gzipText));
+    CHECK(in.sendAll(inflate) == sizeof(gzipText));
+    CHECK(inflate.finished());
+    CHECK(out.data == text);
+}
+
+TEST_CASE("Inflate stops at the end of the stream", "[inflate]")
+{
+    const std::string text = makeText(6000, 1);
+    std::string       data((const char*)zlibText10, sizeof(zlibText10));
+    data += "trailing garbage";
+    StringPrint out;
+    Inflate     inflate;
+    REQUIRE(inflate.begin(out, INFLATE_ZLIB, 10));
+    CHECK(inflate.write((const uint8_t*)data.data(), data.size()) == data.size());
+    CHECK(inflate.finished());
+    CHECK(inflate.write((const uint8_t*)"more", 4) == 4);
+    CHECK(out.data == text);
+}
+
+TEST_CASE("Inflate reports errors", "[inflate]")
+{
+    StringPrint out;
+    Inflate     inflate;
+
+    SECTION("window smaller than the compressor's")
+    {
+        REQUIRE(inflate.begin(out, INFLATE_GZIP, 8));
+        CHECK(inflateChunks(inflate, gzipText, sizeof(gzipText), 50) == INFLATE_ERR_DISTANCE);
+        CHECK_FALSE(inflate.finished());
+    }
+    SECTION("invalid window size")
+    {
+        CHECK_FALSE(inflate.begin(out, INFLATE_AUTO, 16));
+        CHECK_FALSE(inflate.begin(out, INFLATE_AUTO, 7));
+        CHECK(inflate.write((const uint8_t*)"x", 1) == 0);
+    }
+    SECTION("bad header")
+    {
+        REQUIRE(inflate.begin(out, INFLATE_GZIP));
+        CHECK(inflate.write(zlibText10, sizeof(zlibText10)) == 0);
+        CHECK(inflate.getError() == INFLATE_ERR_HEADER);
+    }
+    SECTION("corrupted checksums")
+    {
+        for (size_t pos : { sizeof(gzipText) - 8, sizeof(gzipText) - 1 })
+        {
+            std::string data((const char*)gzipText, sizeof(gzipText));
+            data[pos] ^= 1;
+            REQUIRE(inflate.begin(out));
+            CHECK(inflateChunks(inflate, (const uint8_t*)data.data(), data.size(), 300)
+                  == INFLATE_ERR_CHECKSUM);
+        }
+        std::string data((const char*)zlibText10, sizeof(zlibText10));
+        data.back() ^= 1;
+        REQUIRE(inflate.begin(out, INFLATE_ZLIB, 10));
+        CHECK(inflateChunks(inflate, (const uint8_t*)data.data(), data.size(), 300)
+              == INFLATE_ERR_CHECKSUM);
+    }
+    SECTION("corrupted data")
+    {
+        // every single byte corruption of the compressed data must be caught
+        // by the decoder or by the checksum, and never crash
+        std::string data((const char*)fixedText, sizeof(fixedText));
+        for (size_t pos = 0; pos < data.size(); pos += 13)
+        {
+            std::string bad = data;
+            bad[pos] ^= 0x5a;
+            REQUIRE(inflate.begin(out, INFLATE_RAW));
+            inflate.write((const uint8_t*)bad.data(), bad.size());
+        }
+        for (size_t pos = 0; pos < sizeof(zlibText10); pos += 11)
+        {
+            std::string bad((const char*)zlibText10, sizeof(zlibText10));
+            bad[pos] ^= 0x21;
+            REQUIRE(inflate.begin(out, INFLATE_ZLIB, 10));
+            inflate.write((const uint8_t*)bad.data(), bad.size());
+            CHECK((inflate.getError() != INFLATE_OK || !inflate.finished()));
+        }
+    }
+    SECTION("output refusing data")
+    {
+        out.limit = 100;
+        REQUIRE(inflate.begin(out));
+        CHECK(inflate.write(gzipText, sizeof(gzipText)) == 0);
+        CHECK(inflate.getError() == INFLATE_ERR_OUTPUT);
+    }
+}
@@ -79,3 +79,26 @@ TEST_CASE("Print::write overrides all compile properly", "[core][Print]")
     REQUIRE(buff[13] == 0);
     REQUIRE(buff[14] == 1);
 }
+
+TEST_CASE("Print::writev writes all buffers in order", "[core][Print]")
+{
+    LITTLEFS_MOCK_DECLARE(64, 8, 512, "");
+    REQUIRE(LittleFS.begin());
+    auto p = LittleFS.open("test.txt", "w");
+    REQUIRE(p);
+    const char   head[] = "HTTP/1.1 200 OK\r\n";
+    const char   body[] = "hello";
+    Print::Buffer bufs[] = {
+        { (const uint8_t*)head, strlen(head) },
+        { nullptr, 0 },
+        { (const uint8_t*)"\r\n", 2 },
+        { (const uint8_t*)body, strlen(body) },
+    };
+    REQUIRE(p.writev(bufs, 4) == strlen(head) + 2 + strlen(body));
+    p.close();
+
+    p = LittleFS.open("test.txt", "r");
+    REQUIRE(p);
+    REQUIRE(p.readString() == "HTTP/1.1 200 OK\r\n\r\nhello");
+    p.close();
+}
@@ -0,0 +1,148 @@
+/*
+ test_Schedule.cpp - scheduled functions tests
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <string>
+#include <Schedule.h>
+
+static std::string trace;
+
+static void mark(char c)
+{
+    trace += c;
+}
+
+static void markX()
+{
+    mark('x');
+}
+
+TEST_CASE("inline scheduled functions run by priority", "[schedule]")
+{
+    run_scheduled_functions();
+    trace.clear();
+
+    const char* n = "n";
+    const char* h = "h";
+    CHECK(schedule_inline_function([n]() { mark(n[0]); }));
+    CHECK(schedule_function([]() { mark('f'); }));
+    CHECK(schedule_inline_function([h]() { mark(h[0]); }, SCHEDULE_PRIORITY_HIGH));
+    CHECK(schedule_inline_function(markX));
+    run_scheduled_functions();
+    CHECK(trace == "hnxf");
+
+    // functions scheduled while running wait for the next run
+    trace.clear();
+    CHECK(schedule_inline_function([]() {
+        mark('a');
+        schedule_inline_function([]() { mark('h'); }, SCHEDULE_PRIORITY_HIGH);
+        schedule_inline_function([]() { mark('b'); });
+    }));
+    run_scheduled_functions();
+    CHECK(trace == "ah");
+    run_scheduled_functions();
+    CHECK(trace == "ahb");
+}
+
+TEST_CASE("inline scheduled functions count drops", "[schedule]")
+{
+    run_scheduled_functions();
+    schedule_inline_reset_stats();
+    trace.clear();
+
+    for (int i = 0; i < SCHEDULED_INLINE_FN_COUNT + 3; i++)
+        schedule_inline_function(markX);
+    CHECK(schedule_inline_function(markX, SCHEDULE_PRIORITY_HIGH));
+
+    schedule_inline_stats_t stats;
+    schedule_inline_get_stats(&stats);
+    CHECK(stats.scheduled[SCHEDULE_PRIORITY_NORMAL] == SCHEDULED_INLINE_FN_COUNT);
+    CHECK(stats.dropped[SCHEDULE_PRIORITY_NORMAL] == 3);
+    CHECK(stats.maxPending[SCHEDULE_PRIORITY_NORMAL] == SCHEDULED_INLINE_FN_COUNT);
+    CHECK(stats.scheduled[SCHEDULE_PRIORITY_HIGH] == 1);
+    CHECK(stats.dropped[SCHEDULE_PRIORITY_HIGH] == 0);
+
+    run_scheduled_functions();
+    CHECK(trace == std::string(SCHEDULED_INLINE_FN_COUNT + 1, 'x'));
+
+    // the ring wraps around
+    for (int round = 0; round < 3; round++)
+    {
+        for (int i = 0; i < SCHEDULED_INLINE_FN_COUNT - 1; i++)
+            CHECK(schedule_inline_function(markX));
+        run_scheduled_functions();
+    }
+    schedule_inline_get_stats(&stats);
+    CHECK(stats.dropped[SCHEDULE_PRIORITY_NORMAL] == 3);
+    CHECK(trace.size() == SCHEDULED_INLINE_FN_COUNT + 1 + 3 * (SCHEDULED_INLINE_FN_COUNT - 1));
+}
+
+static int  recurrentEvery = 0, recurrentPeriodic = 0, recurrentAlarmed = 0;
+static bool recurrentKeep = true, recurrentRing = false;
+
+TEST_CASE("recurrent scheduled functions run when due", "[schedule]")
+{
+    run_scheduled_recurrent_functions();
+    size_t before = schedule_recurrent_get_stats(nullptr, 0);
+
+    CHECK(schedule_recurrent_function_us([]() { recurrentEvery++; return recurrentKeep; }, 0));
+    CHECK(schedule_recurrent_function_us([]() { return ++recurrentPeriodic < 3; }, 2000));
+    CHECK(schedule_recurrent_function_us([]() { recurrentAlarmed++; return recurrentKeep; },
+        10000000, []() { bool ring = recurrentRing; recurrentRing = false; return ring; }));
+
+    uint32_t start = micros();
+    while (micros() - start < 20000)
+    {
+        if (!recurrentAlarmed && micros() - start > 10000)
+            recurrentRing = true;
+        run_scheduled_recurrent_functions();
+    }
+    CHECK(recurrentEvery > 10);
+    CHECK(recurrentPeriodic == 3);
+    CHECK(recurrentAlarmed == 1);
+
+    // the periodic one is gone, alarms are not counted
+    schedule_recurrent_stats_t stats[8];
+    size_t count = schedule_recurrent_get_stats(stats, 8);
+    REQUIRE(count == before + 2);
+    REQUIRE(count <= 8);
+    CHECK(stats[count - 2].repeat_us == 0);
+    CHECK(stats[count - 2].timer.runs == (uint32_t)recurrentEvery);
+    CHECK(stats[count - 1].repeat_us == 10000000);
+    CHECK(stats[count - 1].timer.runs == 0);
+
+    recurrentKeep = false;
+    recurrentRing = true;
+    run_scheduled_recurrent_functions();
+    CHECK(recurrentAlarmed == 2);
+    CHECK(schedule_recurrent_get_stats(nullptr, 0) == before);
+}
+
+TEST_CASE("recurrent grain counts the functions not run yet", "[schedule]")
+{
+    run_scheduled_recurrent_functions();
+    REQUIRE(schedule_recurrent_get_stats(nullptr, 0) == 0);
+
+    // delay() right after scheduling, before any run
+    static bool keep = true;
+    CHECK(schedule_recurrent_function_us([]() { return keep; }, 100000));
+    CHECK(compute_scheduled_recurrent_grain() == 100);
+    run_scheduled_recurrent_functions();
+    CHECK(schedule_recurrent_function_us([]() { return keep; }, 30000));
+    CHECK(compute_scheduled_recurrent_grain() == 10);
+    run_scheduled_recurrent_functions();
+    CHECK(compute_scheduled_recurrent_grain() == 10);
+
+    keep           = false;
+    uint32_t start = millis();
+    while (schedule_recurrent_get_stats(nullptr, 0) && millis() - start < 1000)
+        run_scheduled_recurrent_functions();
+    CHECK(schedule_recurrent_get_stats(nullptr, 0) == 0);
+    CHECK(compute_scheduled_recurrent_grain() == 0);
+}
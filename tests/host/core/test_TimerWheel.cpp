@@ -0,0 +1,262 @@
+/*
+ test_TimerWheel.cpp - hierarchical timing wheel tests and benchmark
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <TimerWheel.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct WheelTestTimer: TimerWheelTimer
+{
+    uint32_t id;
+    uint32_t fired = 0;
+    bool     cancelled = false;
+};
+
+TEST_CASE("TimerWheel expires each timer at its tick", "[timerwheel]")
+{
+    std::mt19937 rng(25);
+    for (uint32_t start : { 0u, 0xfff00000u, 12345u })
+    {
+        TimerWheel                  wheel;
+        std::vector<WheelTestTimer> timers(3000);
+        uint32_t                    now = start;
+
+        for (size_t i = 0; i < timers.size(); i++)
+        {
+            // log-uniform delays up to beyond the last level
+            uint32_t delay = (rng() >> (rng() % 28 + 4)) + 1;
+            timers[i].id   = i;
+            wheel.add(timers[i], now, delay);
+        }
+        CHECK(wheel.count() == timers.size());
+        for (size_t i = 0; i < timers.size(); i += 5)
+        {
+            wheel.cancel(timers[i]);
+            timers[i].cancelled = true;
+        }
+
+        // stepping from one next tick to the other, nothing is ever late
+        uint32_t tick;
+        size_t   steps = 0;
+        while (wheel.nextTick(tick))
+        {
+            REQUIRE((int32_t)(tick - now) > 0);
+            now = tick;
+            steps++;
+            while (auto timer = wheel.expire(now))
+            {
+                auto t = static_cast<WheelTestTimer*>(timer);
+                REQUIRE(t->expiry() == now);
+                REQUIRE_FALSE(t->cancelled);
+                REQUIRE_FALSE(t->armed());
+                t->fired++;
+                // sometimes rearmed
+                if (t->id % 7 == 0 && t->fired < 3)
+                    wheel.add(*t, now, (rng() >> (rng() % 28 + 4)) + 1);
+            }
+        }
+        CHECK(wheel.count() == 0);
+        for (auto& t : timers)
+        {
+            if (t.cancelled)
+                CHECK(t.fired == 0);
+            else if (t.id % 7 == 0)
+                CHECK(t.fired == 3);
+            else
+                CHECK(t.fired == 1);
+            CHECK(t.stats().runs == t.fired);
+            CHECK(t.stats().lateMax == 0);
+        }
+        // far less visits than timers, moving down levels included
+        CHECK(steps < 3 * timers.size());
+    }
+}
+
+TEST_CASE("TimerWheel with random time steps", "[timerwheel]")
+{
+    std::mt19937                rng(2);
+    TimerWheel                  wheel;
+    std::vector<WheelTestTimer> timers(1000);
+    uint32_t                    now = 0xffffff00;
+
+    for (size_t i = 0; i < timers.size(); i++)
+    {
+        timers[i].id = i;
+        wheel.add(timers[i], now, rng() % 100000);
+    }
+    uint32_t previous = now;
+    while (wheel.count())
+    {
+        now += rng() % 2000;
+        while (auto timer = wheel.expire(now))
+        {
+            auto t = static_cast<WheelTestTimer*>(timer);
+            // at the first call after its expiry
+            REQUIRE((int32_t)(now - t->expiry()) >= 0);
+            REQUIRE((int32_t)(t->expiry() - previous) > 0);
+            CHECK(t->stats().lateMax == now - t->expiry());
+            t->fired++;
+        }
+        previous = now;
+    }
+    for (auto& t : timers)
+        CHECK(t.fired == 1);
+}
+
+TEST_CASE("TimerWheel periodic timers skip and count overruns", "[timerwheel]")
+{
+    TimerWheel     wheel;
+    WheelTestTimer timer;
+    wheel.add(timer, 1000, 10, 10);
+    CHECK(wheel.expire(1009) == nullptr);
+    CHECK(wheel.expire(1010) == &timer);
+    CHECK(wheel.expire(1010) == nullptr);
+    CHECK(timer.armed());
+    CHECK(timer.expiry() == 1020);
+
+    // 25 late: runs once, 2 periods skipped, stays in phase
+    CHECK(wheel.expire(1045) == &timer);
+    CHECK(wheel.expire(1045) == nullptr);
+    CHECK(timer.expiry() == 1050);
+    CHECK(timer.stats().runs == 2);
+    CHECK(timer.stats().overruns == 2);
+    CHECK(timer.stats().lateMax == 25);
+    CHECK(timer.stats().lateTotal == 25);
+
+    timer.resetStats();
+    CHECK(wheel.expire(1053) == &timer);
+    CHECK(timer.stats().runs == 1);
+    CHECK(timer.stats().lateMax == 3);
+    wheel.cancel(timer);
+    CHECK_FALSE(timer.armed());
+    CHECK(wheel.count() == 0);
+    CHECK(wheel.expire(2000) == nullptr);
+}
+
+TEST_CASE("TimerWheel changes from the expired timers", "[timerwheel]")
+{
+    TimerWheel     wheel;
+    WheelTestTimer a, b, c;
+    wheel.add(a, 0, 100);
+    wheel.add(b, 0, 100);
+    wheel.add(c, 0, 100, 50);
+
+    // one due timer cancels the others, which were due too
+    auto first = static_cast<WheelTestTimer*>(wheel.expire(100));
+    REQUIRE(first);
+    for (auto t : { &a, &b, &c })
+        if (t != first)
+            wheel.cancel(*t);
+    CHECK(wheel.expire(100) == nullptr);
+    CHECK(wheel.count() == (first == &c ? 1 : 0));
+    wheel.cancel(c);
+
+    // added with no delay while expiring: at the next call
+    wheel.add(a, 100, 0);
+    CHECK(wheel.expire(100) == nullptr);
+    CHECK(wheel.expire(101) == &a);
+
+    // copies are not armed
+    wheel.add(b, 200, 5);
+    WheelTestTimer copy = b;
+    CHECK_FALSE(copy.armed());
+    CHECK(wheel.count() == 1);
+    wheel.add(b, 200, TimerWheel::maxDelay + 10);
+    CHECK(b.expiry() == 200 + TimerWheel::maxDelay);
+}
+
+// The benchmark: periodic tasks run from loop(), each one checked at every
+// turn as run_scheduled_recurrent_functions() did through its list, or
+// waiting in a wheel.
+struct PolledTask
+{
+    PolledTask*           next;
+    std::function<bool()> alarm;
+    uint32_t              period;
+    uint32_t              last;
+    uint32_t              runs;
+};
+
+struct WheelTask: TimerWheelTimer
+{
+    uint32_t runs = 0;
+};
+
+static void wheelBenchmark(size_t count)
+{
+    using clock = std::chrono::steady_clock;
+    using ns    = std::chrono::nanoseconds;
+
+    const uint32_t turns = 200000, turnUs = 50;  // 10s of loop()
+    std::mt19937   rng(count);
+
+    std::vector<std::unique_ptr<PolledTask>> polled;
+    PolledTask*                              first = nullptr;
+    std::vector<WheelTask>                   tasks(count);
+    TimerWheel                               wheel;
+    for (size_t i = 0; i < count; i++)
+    {
+        // 1ms to 1s
+        uint32_t period = 1000 << (rng() % 10);
+        polled.emplace_back(new PolledTask { first, nullptr, period, 0, 0 });
+        first = polled.back().get();
+        wheel.add(tasks[i], 0, period, period);
+    }
+
+    auto     start = clock::now();
+    uint32_t now   = 0;
+    for (uint32_t turn = 0; turn < turns; turn++)
+    {
+        now += turnUs;
+        for (auto task = first; task; task = task->next)
+        {
+            bool wakeup = task->alarm && task->alarm();
+            if (wakeup || now - task->last >= task->period)
+            {
+                task->last += (now - task->last) / task->period * task->period;
+                task->runs++;
+            }
+        }
+    }
+    auto polledTime = clock::now() - start;
+
+    start = clock::now();
+    now   = 0;
+    for (uint32_t turn = 0; turn < turns; turn++)
+    {
+        now += turnUs;
+        while (auto timer = wheel.expire(now))
+            static_cast<WheelTask*>(timer)->runs++;
+    }
+    auto wheelTime = clock::now() - start;
+
+    uint32_t runs = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        CHECK(tasks[i].runs == polled[i]->runs);
+        CHECK(tasks[i].stats().overruns == 0);
+        CHECK(tasks[i].stats().lateMax < turnUs);
+        runs += tasks[i].runs;
+    }
+
+    printf("%zu periodic tasks, %u runs in %u loop turns: list walk %lld ns, timer wheel %lld ns "
+           "per turn\n",
+           count, runs, turns, (long long)std::chrono::duration_cast<ns>(polledTime).count() / turns,
+           (long long)std::chrono::duration_cast<ns>(wheelTime).count() / turns);
+}
+
+TEST_CASE("TimerWheel against a list walk of periodic tasks", "[timerwheel]")
+{
+    wheelBenchmark(50);
+    wheelBenchmark(500);
+}
@@ -15,6 +15,7 @@
 
 #include <catch.hpp>
 #include <Updater.h>
+#include <StreamDev.h>
 
 // Use a SPIFFS file because we can't instantiate a virtual class like Print
 TEST_CASE("Updater fails when writes overflow requested size", "[core][Updater]")
@@ -53,3 +54,134 @@ TEST_CASE("Updater fails when writes overflow requested size", "[core][Updater]"
     REQUIRE(!u->write(buff, 2048));
     delete u;
 }
+
+static const uint8_t gzipImage[] = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7b, 0xc9, 0xcc, 0xa4, 0xc0, 0xc2,
+    0xca, 0xc6, 0xce, 0xc1, 0xc9, 0xc5, 0xcd, 0xc3, 0xcb, 0xc7, 0x2f, 0x20, 0x28, 0x24, 0x2c, 0x22,
+    0x2a, 0x26, 0x2e, 0x21, 0x29, 0x25, 0x2d, 0x23, 0x2b, 0x27, 0xaf, 0xa0, 0xa8, 0xa4, 0xac, 0xa2,
+    0xaa, 0xa6, 0xae, 0xa1, 0xa9, 0xa5, 0xad, 0xa3, 0xab, 0xa7, 0x6f, 0x60, 0x68, 0x64, 0x6c, 0x62,
+    0x6a, 0x66, 0x6e, 0x61, 0x69, 0x65, 0x6d, 0x63, 0x6b, 0x67, 0xef, 0xe0, 0xe8, 0xe4, 0xec, 0xe2,
+    0xea, 0xe6, 0xee, 0xe1, 0xe9, 0xe5, 0xed, 0xe3, 0xeb, 0xe7, 0x1f, 0x10, 0x18, 0x14, 0x1c, 0x12,
+    0x1a, 0x16, 0x1e, 0x11, 0x19, 0x15, 0x1d, 0x13, 0x1b, 0x17, 0x9f, 0x90, 0x98, 0x94, 0x9c, 0x92,
+    0x9a, 0x96, 0x9e, 0x91, 0x99, 0x95, 0x9d, 0x93, 0x9b, 0x97, 0x5f, 0x50, 0x58, 0x54, 0x5c, 0x52,
+    0x5a, 0x56, 0x5e, 0x51, 0x59, 0x55, 0x5d, 0x53, 0x5b, 0x57, 0xdf, 0xd0, 0xd8, 0xd4, 0xdc, 0xd2,
+    0xda, 0xd6, 0xde, 0xd1, 0xd9, 0xd5, 0xdd, 0xd3, 0xdb, 0xd7, 0x3f, 0x61, 0xe2, 0xa4, 0xc9, 0x53,
+    0xa6, 0x4e, 0x9b, 0x3e, 0x63, 0xe6, 0xac, 0xd9, 0x73, 0xe6, 0xce, 0x9b, 0xbf, 0x60, 0xe1, 0xa2,
+    0xc5, 0x4b, 0x96, 0x2e, 0x5b, 0xbe, 0x62, 0xe5, 0xaa, 0xd5, 0x6b, 0xd6, 0xae, 0x5b, 0xbf, 0x61,
+    0xe3, 0xa6, 0xcd, 0x5b, 0xb6, 0x6e, 0xdb, 0xbe, 0x63, 0xe7, 0xae, 0xdd, 0x7b, 0xf6, 0xee, 0xdb,
+    0x7f, 0xe0, 0xe0, 0xa1, 0xc3, 0x47, 0x8e, 0x1e, 0x3b, 0x7e, 0xe2, 0xe4, 0xa9, 0xd3, 0x67, 0xce,
+    0x9e, 0x3b, 0x7f, 0xe1, 0xe2, 0xa5, 0xcb, 0x57, 0xae, 0x5e, 0xbb, 0x7e, 0xe3, 0xe6, 0xad, 0xdb,
+    0x77, 0xee, 0xde, 0xbb, 0xff, 0xe0, 0xe1, 0xa3, 0xc7, 0x4f, 0x9e, 0x3e, 0x7b, 0xfe, 0xe2, 0xe5,
+    0xab, 0xd7, 0x6f, 0xde, 0xbe, 0x7b, 0xff, 0xe1, 0xe3, 0xa7, 0xcf, 0x5f, 0xbe, 0x7e, 0xfb, 0xfe,
+    0xe3, 0xe7, 0x2f, 0x06, 0x46, 0x26, 0xe6, 0x51, 0xaf, 0x8f, 0x7a, 0x7d, 0xd4, 0xeb, 0xa3, 0x5e,
+    0x1f, 0xf5, 0xfa, 0xa8, 0xd7, 0x47, 0xbd, 0x3e, 0xea, 0xf5, 0x51, 0xaf, 0x8f, 0x7a, 0x7d, 0xd4,
+    0xeb, 0xa3, 0x5e, 0x1f, 0xf5, 0xfa, 0xa8, 0xd7, 0x47, 0xbd, 0x3e, 0xea, 0xf5, 0x51, 0xaf, 0x8f,
+    0x7a, 0x7d, 0xd4, 0xeb, 0xa3, 0x5e, 0x1f, 0xf5, 0xfa, 0xa8, 0xd7, 0x47, 0xbd, 0x3e, 0xea, 0xf5,
+    0x51, 0xaf, 0x8f, 0x7a, 0x7d, 0xd4, 0xeb, 0xa3, 0x5e, 0x1f, 0xf5, 0xfa, 0xa8, 0xd7, 0x47, 0xbd,
+    0x3e, 0xea, 0xf5, 0x51, 0xaf, 0x8f, 0x7a, 0x7d, 0xd4, 0xeb, 0xa3, 0x5e, 0x1f, 0xf5, 0xfa, 0x30,
+    0xf1, 0x3a, 0x00, 0x5a, 0xee, 0x85, 0x98, 0x10, 0x27, 0x00, 0x00,
+};
+
+// A fake 10000 bytes sketch: image header, then i % 251
+static void inflateImage(uint8_t* image)
+{
+    for (size_t i = 0; i < 10000; i++)
+    {
+        image[i] = i % 251;
+    }
+    image[0] = 0xe9;
+    image[1] = 0x03;
+    image[2] = 0x02;
+    image[3] = 0x20;
+}
+
+TEST_CASE("Updater inflates gzip compressed images", "[core][Updater]")
+{
+    UpdaterClass u;
+    u.setInflate(10);
+    REQUIRE(u.begin(sizeof(gzipImage)));
+    REQUIRE(u.size() == sizeof(gzipImage));
+    REQUIRE(u.remaining() == sizeof(gzipImage));
+
+    // in uneven pieces, the last one crossing the gzip trailer
+    size_t pos = 0;
+    for (size_t len = 1; pos < sizeof(gzipImage); len += 7)
+    {
+        len = std::min(len, sizeof(gzipImage) - pos);
+        REQUIRE(!u.isFinished());
+        REQUIRE(u.write(const_cast<uint8_t*>(gzipImage) + pos, len) == len);
+        pos += len;
+        REQUIRE(u.progress() == pos);
+    }
+    REQUIRE(!u.hasError());
+    REQUIRE(u.isFinished());
+    REQUIRE(u.remaining() == 0);
+
+    REQUIRE(u.setMD5("ef0003429efbdc64378382d44a875930"));
+    REQUIRE(u.end());
+    CHECK(u.getError() == UPDATE_ERROR_OK);
+
+    // the inflated image, at the start of the update space after the sketch
+    uint8_t  image[10000], flashed[10000];
+    uint32_t start = (ESP.getSketchSize() + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+    inflateImage(image);
+    REQUIRE(ESP.flashRead(start, flashed, sizeof(flashed)));
+    CHECK(memcmp(image, flashed, sizeof(image)) == 0);
+}
+
+TEST_CASE("Updater checks the MD5 of compressed images", "[core][Updater]")
+{
+    UpdaterClass u;
+    u.setInflate(10);
+    REQUIRE(u.begin(sizeof(gzipImage)));
+    REQUIRE(u.setMD5("9a22ae008d8876fcdaec7f7ffe346dfb"));
+    StreamConstPtr in(gzipImage, sizeof(gzipImage));
+    REQUIRE(u.writeStream(in) == sizeof(gzipImage));
+    REQUIRE(u.isFinished());
+    REQUIRE(u.end());
+
+    REQUIRE(u.begin(sizeof(gzipImage)));
+    REQUIRE(u.setMD5("00000000000000000000000000000000"));
+    REQUIRE(u.write(const_cast<uint8_t*>(gzipImage), sizeof(gzipImage)) == sizeof(gzipImage));
+    REQUIRE(!u.end());
+    CHECK(u.getError() == UPDATE_ERROR_MD5);
+}
+
+TEST_CASE("Updater fails on truncated or corrupt compressed images", "[core][Updater]")
+{
+    uint8_t      corrupt[sizeof(gzipImage)];
+    UpdaterClass u;
+    u.setInflate(10);
+
+    REQUIRE(u.begin(sizeof(gzipImage)));
+    REQUIRE(u.write(const_cast<uint8_t*>(gzipImage), 200) == 200);
+    REQUIRE(!u.end(true));
+    REQUIRE(!u.isRunning());
+
+    // CRC32 of the gzip trailer
+    memcpy(corrupt, gzipImage, sizeof(corrupt));
+    corrupt[sizeof(corrupt) - 8] ^= 0x55;
+    REQUIRE(u.begin(sizeof(corrupt)));
+    REQUIRE(u.write(corrupt, sizeof(corrupt)) == 0);
+    CHECK(u.getError() == UPDATE_ERROR_INFLATE);
+    REQUIRE(!u.isRunning());
+
+    // compressed data larger than announced
+    REQUIRE(u.begin(100));
+    REQUIRE(!u.write(const_cast<uint8_t*>(gzipImage), sizeof(gzipImage)));
+    CHECK(u.getError() == UPDATE_ERROR_SPACE);
+}
+
+TEST_CASE("Updater writes uncompressed images as they are with setInflate()", "[core][Updater]")
+{
+    uint8_t      image[10000];
+    UpdaterClass u;
+    inflateImage(image);
+    u.setInflate(10);
+    REQUIRE(u.begin(sizeof(image)));
+    REQUIRE(u.write(image, 4096) == 4096);
+    REQUIRE(u.size() == sizeof(image));
+    REQUIRE(u.write(image + 4096, 10000 - 4096) == 10000 - 4096);
+    REQUIRE(u.isFinished());
+    REQUIRE(!u.write(image, 1));
+}
@@ -0,0 +1,147 @@
+/*
+ test_flash_hal.cpp - flash_hal_read() and flash_hal_write() of any
+ alignment, and count of the flash accesses they issue.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <vector>
+#include "../common/flash_hal.h"
+
+static constexpr uint32_t flashSize = 16 * 1024;
+
+// owns the mocked flash
+struct Flash
+{
+    std::vector<uint8_t> data;
+
+    Flash() : data(flashSize, 0xff)
+    {
+        s_phys_data = data.data();
+        s_phys_size = flashSize;
+        reset();
+    }
+    ~Flash()
+    {
+        s_phys_data = nullptr;
+        s_phys_size = 0;
+    }
+    void reset()
+    {
+        flash_hal_mock_stats = {};
+    }
+};
+
+static void fill(uint8_t* buf, size_t size, uint32_t seed)
+{
+    while (size--)
+    {
+        seed   = seed * 1103515245 + 12345;
+        *buf++ = seed >> 16;
+    }
+}
+
+TEST_CASE("flash_hal_read of any alignment", "[core][flash_hal]")
+{
+    Flash flash;
+    fill(flash.data.data(), flashSize, 1);
+
+    alignas(4) uint8_t buf[600];
+    for (uint32_t addr = 100; addr < 104; addr++)
+        for (uint32_t offset = 0; offset < 4; offset++)
+            for (uint32_t size : { 1, 2, 3, 4, 5, 6, 7, 8, 9, 63, 64, 65, 511, 512, 513 })
+            {
+                memset(buf, 0, sizeof(buf));
+                flash.reset();
+                REQUIRE(flash_hal_read(addr, size, buf + offset) == FLASH_HAL_OK);
+                INFO("addr " << addr << " offset " << offset << " size " << size);
+                REQUIRE(memcmp(buf + offset, &flash.data[addr], size) == 0);
+                // nothing around it touched
+                REQUIRE(buf[offset + size] == 0);
+                if (offset)
+                    REQUIRE(buf[offset - 1] == 0);
+                // bulk and remaining bytes at most
+                REQUIRE(flash_hal_mock_stats.reads <= 2);
+                if (offset == 0 && (size & 3) == 0)
+                    REQUIRE(flash_hal_mock_stats.reads == 1);
+            }
+}
+
+TEST_CASE("flash_hal_write of any alignment", "[core][flash_hal]")
+{
+    alignas(4) uint8_t src[1100];
+    fill(src, sizeof(src), 2);
+
+    for (uint32_t addr = 1000; addr < 1004; addr++)
+        for (uint32_t offset = 0; offset < 4; offset++)
+            for (uint32_t size : { 1, 2, 3, 4, 5, 7, 8, 255, 256, 257, 1024, 1025 })
+            {
+                Flash flash;
+                // bytes next to the written ones keep their programmed value
+                flash.data[addr - 1]    = 0x5a;
+                flash.data[addr + size] = 0xa5;
+                REQUIRE(flash_hal_write(addr, size, src + offset) == FLASH_HAL_OK);
+                INFO("addr " << addr << " offset " << offset << " size " << size);
+                REQUIRE(memcmp(&flash.data[addr], src + offset, size) == 0);
+                REQUIRE(flash.data[addr - 1] == 0x5a);
+                REQUIRE(flash.data[addr + size] == 0xa5);
+                // one program operation per flash page touched
+                uint32_t pages
+                    = (addr + size - 1) / FLASH_PAGE_SIZE - addr / FLASH_PAGE_SIZE + 1;
+                REQUIRE(flash_hal_mock_stats.programs == pages);
+                REQUIRE(flash_hal_mock_stats.reads == 0);
+            }
+}
+
+TEST_CASE("flash_hal flash accesses", "[core][flash_hal]")
+{
+    // SDK calls of the former ESP.flashRead()/flashWrite() based version:
+    // unaligned buffers went through the stack in 64 byte (reads) and
+    // 256 byte (writes) chunks, each written chunk split again at flash
+    // pages, and unaligned write heads and tails were read back first
+    struct Case
+    {
+        const char* what;
+        uint32_t    addr, offset, size;
+        uint32_t    before;
+    };
+    const Case reads[] = {
+        { "aligned 4KB", 0, 0, 4096, 1 },
+        { "4KB into an unaligned buffer", 0, 1, 4096, 64 },
+        { "4093 bytes into an unaligned buffer", 1, 3, 4093, 65 },
+        { "61 bytes into an unaligned buffer", 3, 1, 61, 2 },
+    };
+    const Case writes[] = {
+        { "aligned 4KB", 0, 0, 4096, 17 },
+        { "4KB from an unaligned buffer", 0, 1, 4096, 32 },
+        { "4KB at an unaligned address", 2, 0, 4096, 35 },
+        { "1000 bytes at an unaligned address", 130, 2, 1000, 11 },
+        { "10 bytes at an unaligned address", 3, 0, 10, 4 },
+    };
+
+    alignas(4) uint8_t buf[4100];
+    Flash              flash;
+    fill(buf, sizeof(buf), 3);
+    for (const Case& c : reads)
+    {
+        flash.reset();
+        REQUIRE(flash_hal_read(c.addr, c.size, buf + c.offset) == FLASH_HAL_OK);
+        printf("flash_hal_read  %-36s %2u flash reads, formerly %2u\n", c.what,
+               flash_hal_mock_stats.reads, c.before);
+        CHECK(flash_hal_mock_stats.reads <= c.before);
+    }
+    for (const Case& c : writes)
+    {
+        flash.reset();
+        REQUIRE(flash_hal_write(c.addr, c.size, buf + c.offset) == FLASH_HAL_OK);
+        uint32_t accesses = flash_hal_mock_stats.programs + flash_hal_mock_stats.reads;
+        printf("flash_hal_write %-36s %2u flash accesses, formerly %2u\n", c.what, accesses,
+               c.before);
+        CHECK(accesses < c.before);
+    }
+}
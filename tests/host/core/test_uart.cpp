@@ -0,0 +1,187 @@
+/*
+ test_uart.cpp - HardwareSerial and the uart.cpp driver, on the UART
+ registers of MockRegisters.cpp
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <string>
+
+static std::string uartSent;
+
+static void uartCapture(int uart_nr, char c)
+{
+    if (uart_nr == UART1)
+        uartSent += c;
+}
+
+// UART1 with a stalled TX FIFO, sending to uartSent
+struct UartTxFixture
+{
+    HardwareSerial serial { UART1 };
+
+    UartTxFixture(size_t txSize)
+    {
+        uartSent.clear();
+        mock_uart_tx_output(uartCapture);
+        serial.setTxBufferSize(txSize);
+        serial.begin(115200);
+        mock_uart_tx_stall(UART1, true);
+    }
+    ~UartTxFixture()
+    {
+        mock_uart_tx_stall(UART1, false);
+        serial.end();
+        mock_uart_tx_output(nullptr);
+    }
+};
+
+static std::string uartPattern(size_t size, size_t start = 0)
+{
+    std::string data;
+    for (size_t i = 0; i < size; i++)
+        data += (char)('a' + (start + i) % 26);
+    return data;
+}
+
+TEST_CASE("Serial TX without ring buffer is the FIFO", "[core][uart]")
+{
+    UartTxFixture fixture(0);
+    HardwareSerial& serial = fixture.serial;
+
+    CHECK(serial.getTxBufferSize() == 0);
+    CHECK(serial.availableForWrite() == UART_TX_FIFO_SIZE);
+    // one by one, longer writes yield between bytes
+    for (char c : std::string("abc"))
+        CHECK(serial.write(c) == 1);
+    CHECK(serial.availableForWrite() == UART_TX_FIFO_SIZE - 3);
+    CHECK(uartSent.empty());
+    CHECK(mock_uart_tx(UART1, 10) == 3);
+    CHECK(uartSent == "abc");
+}
+
+TEST_CASE("Serial TX ring buffer keeps order across wrap-around", "[core][uart]")
+{
+    UartTxFixture fixture(64);
+    HardwareSerial& serial = fixture.serial;
+
+    REQUIRE(serial.getTxBufferSize() == 64);
+    serial.setTxBlocking(false);
+    // FIFO (0x7f bytes) and ring buffer (63 bytes) empty
+    CHECK(serial.availableForWrite() == 127 + 63);
+
+    std::string expected;
+    size_t      pos = 0;
+    for (size_t round = 0; round < 200; round++)
+    {
+        // sizes across the ring buffer end, up to more than fits
+        size_t      size  = (round * 37) % 211;
+        size_t      room  = serial.availableForWrite();
+        std::string chunk = uartPattern(size, pos);
+        size_t      wrote = serial.write(chunk.c_str(), chunk.size());
+        REQUIRE(wrote == std::min(size, room));
+        CHECK((size_t)serial.availableForWrite() == room - wrote);
+        expected += chunk.substr(0, wrote);
+        pos += wrote;
+
+        // the interrupt refills the FIFO from the ring buffer as it empties
+        mock_uart_tx(UART1, (round * 53) % 140);
+        REQUIRE(uartSent == expected.substr(0, uartSent.size()));
+    }
+
+    serial.flush();
+    CHECK(uartSent == expected);
+    CHECK(serial.availableForWrite() == 127 + 63);
+}
+
+TEST_CASE("Serial TX ring buffer overflow policy", "[core][uart]")
+{
+    std::string data = uartPattern(1000);
+
+    SECTION("blocking waits for room")
+    {
+        UartTxFixture fixture(64);
+        // the UART sends while the write waits
+        CHECK(fixture.serial.write(data.c_str(), data.size()) == data.size());
+        CHECK(uartSent.size() >= data.size() - 127 - 63);
+        CHECK(uartSent == data.substr(0, uartSent.size()));
+        mock_uart_tx_stall(UART1, false);
+        CHECK(uartSent == data);
+    }
+
+    SECTION("non-blocking queues what fits")
+    {
+        UartTxFixture fixture(64);
+        fixture.serial.setTxBlocking(false);
+        CHECK(fixture.serial.write(data.c_str(), data.size()) == 127 + 63);
+        CHECK(fixture.serial.availableForWrite() == 0);
+        CHECK(fixture.serial.write('x') == 0);
+        CHECK(uartSent.empty());
+        mock_uart_tx_stall(UART1, false);
+        CHECK(uartSent == data.substr(0, 127 + 63));
+    }
+}
+
+TEST_CASE("Serial TX ring buffer resize sends queued data first", "[core][uart]")
+{
+    UartTxFixture   fixture(32);
+    HardwareSerial& serial = fixture.serial;
+
+    std::string data = uartPattern(150);
+    CHECK(serial.write(data.c_str(), data.size()) == data.size());
+    CHECK(serial.setTxBufferSize(256) == 256);
+    CHECK(serial.getTxBufferSize() == 256);
+    CHECK(uartSent.size() >= data.size() - 127);
+    CHECK(serial.setTxBufferSize(0) == 0);
+    CHECK(serial.getTxBufferSize() == 0);
+    mock_uart_tx_stall(UART1, false);
+    CHECK(uartSent == data);
+}
+
+TEST_CASE("Serial TX ring buffer goes out before debug output", "[core][uart]")
+{
+    UartTxFixture   fixture(64);
+    HardwareSerial& serial = fixture.serial;
+    serial.setDebugOutput(true);
+    serial.setTxBlocking(false);
+
+    // the FIFO has room again, the ring buffer still holds data
+    std::string data = uartPattern(127 + 63);
+    CHECK(serial.write(data.c_str(), data.size()) == data.size());
+    CHECK(mock_uart_tx(UART1, 100) == 100);
+    for (char c : std::string("os_printf"))
+        mock_putc1(c);
+
+    mock_uart_tx_stall(UART1, false);
+    CHECK(uartSent == data + "os_printf");
+    serial.setDebugOutput(false);
+}
+
+TEST_CASE("Serial RX from the FIFO and its interrupt", "[core][uart]")
+{
+    HardwareSerial serial(UART0);
+    serial.begin(115200);
+
+    // below the FIFO full threshold, read from the FIFO
+    CHECK(mock_uart_rx(UART0, "hello", 5) == 5);
+    CHECK(serial.available() == 5);
+    char buf[256];
+    CHECK(serial.readBytes(buf, 5) == 5);
+    CHECK(std::string(buf, 5) == "hello");
+
+    // the interrupt moves the FIFO to the RX buffer as it fills
+    std::string data = uartPattern(200);
+    CHECK(mock_uart_rx(UART0, data.c_str(), 100) == 100);
+    CHECK(mock_uart_rx(UART0, data.c_str() + 100, 100) == 100);
+    CHECK(serial.available() == 200);
+    CHECK(serial.readBytes(buf, 200) == 200);
+    CHECK(std::string(buf, 200) == data);
+    CHECK_FALSE(serial.hasOverrun());
+
+    serial.end();
+}
@@ -0,0 +1,229 @@
+/*
+ test_umm_slab.cpp - umm_malloc fixed size slot pools (UMM_SLAB), on a heap
+ of a local buffer
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+// what umm_local.h maps memcpy & co and its printf to
+static void* ets_memcpy(void* d, const void* s, size_t n)
+{
+    return memcpy(d, s, n);
+}
+static void* ets_memmove(void* d, const void* s, size_t n)
+{
+    return memmove(d, s, n);
+}
+static void* ets_memset(void* d, int c, size_t n)
+{
+    return memset(d, c, n);
+}
+static void ets_uart_putc1(char c)
+{
+    putchar(c);
+}
+static int ets_vprintf(void (*)(char), const char* fmt, va_list ap)
+{
+    return vprintf(fmt, ap);
+}
+
+// the allocator under test does not replace the host one
+#define malloc      umm_host_malloc
+#define calloc      umm_host_calloc
+#define realloc     umm_host_realloc
+#define free        umm_host_free
+#define umm_info    umm_host_info
+#define _heap_start umm_host_heap_start
+char umm_host_heap_start[1];
+
+#define UMM_SLAB
+#define UMM_SLAB_SIZES       16, 32, 64
+#define UMM_SLAB_DRAM_COUNTS 4, 4, 2
+#include <umm_malloc/umm_malloc.cpp>
+
+#undef memcpy
+#undef memmove
+#undef memset
+#undef malloc
+#undef calloc
+#undef realloc
+#undef free
+
+static const size_t slabCount[] = { 4, 4, 2 };
+
+struct SlabHeapFixture
+{
+    alignas(8) uint8_t heap[8192];
+
+    SlabHeapFixture()
+    {
+        memset(&heap_context[0], 0, sizeof(heap_context));
+        umm_init_heap(UMM_HEAP_DRAM, heap, sizeof(heap), true);
+    }
+
+    umm_heap_context_t& context()
+    {
+        return heap_context[0];
+    }
+    bool inSlab(void* ptr)
+    {
+        return (char*)ptr >= context().slab_start && (char*)ptr < context().slab_end;
+    }
+    // the class serving ptr, -1 for the umm heap
+    int slabClass(void* ptr)
+    {
+        for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++)
+            if (inSlab(ptr) && (char*)ptr < context().slab[i].end)
+                return i;
+        return -1;
+    }
+    UMM_SLAB_STATS stats(size_t which)
+    {
+        UMM_SLAB_STATS s;
+        REQUIRE(umm_slab_get_stats(which, &s));
+        return s;
+    }
+};
+
+TEST_CASE("umm slab serves small requests from the smallest class", "[umm][slab]")
+{
+    SlabHeapFixture f;
+    REQUIRE(f.context().slab_start);
+    size_t pools = f.context().slab_end - f.context().slab_start;
+    CHECK(pools == 4 * 16 + 4 * 32 + 2 * 64);
+    CHECK(umm_slab_classes() == 3);
+
+    void* a = umm_host_malloc(1);
+    void* b = umm_host_malloc(16);
+    void* c = umm_host_malloc(17);
+    void* d = umm_host_malloc(64);
+    void* e = umm_host_malloc(65);
+    CHECK(f.slabClass(a) == 0);
+    CHECK(f.slabClass(b) == 0);
+    CHECK(f.slabClass(c) == 1);
+    CHECK(f.slabClass(d) == 2);
+    CHECK(f.slabClass(e) == -1);
+    CHECK(umm_slab_usable_size(c) == 32);
+    CHECK(umm_slab_usable_size(e) == 0);
+    CHECK(f.stats(0).used == 2);
+    CHECK(f.stats(0).allocs == 2);
+
+    // slots are reused last freed first
+    memset(b, 0x5a, 16);
+    umm_host_free(b);
+    CHECK(f.stats(0).used == 1);
+    CHECK(umm_host_malloc(8) == b);
+    CHECK(f.stats(0).used_max == 2);
+
+    for (void* p : { a, b, c, d, e })
+        umm_host_free(p);
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++)
+        CHECK(f.stats(i).used == 0);
+}
+
+TEST_CASE("umm slab falls back to the heap when a class is exhausted", "[umm][slab]")
+{
+    SlabHeapFixture f;
+    size_t          heapFree = umm_free_heap_size_core_lw(&f.context());
+
+    std::vector<void*> slots;
+    for (size_t i = 0; i < slabCount[0]; i++)
+    {
+        slots.push_back(umm_host_malloc(12));
+        CHECK(f.slabClass(slots.back()) == 0);
+    }
+    CHECK(umm_free_heap_size_core_lw(&f.context()) == heapFree);
+
+    // not taken from the next class
+    void* more = umm_host_malloc(12);
+    REQUIRE(more);
+    CHECK(f.slabClass(more) == -1);
+    CHECK(f.stats(0).fallbacks == 1);
+    CHECK(f.stats(1).used == 0);
+    CHECK(umm_free_heap_size_core_lw(&f.context()) < heapFree);
+
+    // a freed slot is available again, the heap block goes back to the heap
+    umm_host_free(slots.back());
+    slots.pop_back();
+    umm_host_free(more);
+    CHECK(umm_free_heap_size_core_lw(&f.context()) == heapFree);
+    void* again = umm_host_malloc(12);
+    CHECK(f.slabClass(again) == 0);
+    CHECK(f.stats(0).fallbacks == 1);
+
+    umm_slab_reset_stats();
+    CHECK(f.stats(0).allocs == 0);
+    CHECK(f.stats(0).fallbacks == 0);
+    CHECK(f.stats(0).used_max == slabCount[0]);
+}
+
+TEST_CASE("umm slab frees at the class and pool boundaries", "[umm][slab]")
+{
+    SlabHeapFixture f;
+
+    // take every slot, in address order
+    std::vector<void*> slots[UMM_SLAB_NUM_CLASSES];
+    for (size_t i = 0; i < UMM_SLAB_NUM_CLASSES; i++)
+        for (size_t n = 0; n < slabCount[i]; n++)
+            slots[i].push_back(umm_host_malloc(umm_slab_size[i]));
+    CHECK(slots[0].front() == f.context().slab_start);
+    char* end = (char*)slots[0].back() + 16;
+    CHECK(end == f.context().slab[0].end);
+    CHECK(slots[1].front() == f.context().slab[0].end);
+    end = (char*)slots[2].back() + 64;
+    CHECK(end == f.context().slab_end);
+
+    // the last slot of a class and the first of the next one go back to
+    // their own class
+    umm_host_free(slots[0].back());
+    umm_host_free(slots[1].front());
+    CHECK(f.stats(0).used == slabCount[0] - 1);
+    CHECK(f.stats(1).used == slabCount[1] - 1);
+    CHECK(umm_host_malloc(16) == slots[0].back());
+    CHECK(umm_host_malloc(32) == slots[1].front());
+
+    // the block right after the pools is a heap block
+    void* heap = umm_host_malloc(64);
+    CHECK(f.slabClass(heap) == -1);
+    CHECK((char*)heap >= f.context().slab_end);
+    umm_host_free(heap);
+    CHECK(f.stats(2).used == slabCount[2]);
+    umm_host_free(slots[2].back());
+    CHECK(f.stats(2).used == slabCount[2] - 1);
+}
+
+TEST_CASE("umm slab realloc keeps or moves the slot", "[umm][slab]")
+{
+    SlabHeapFixture f;
+
+    char* p = (char*)umm_host_malloc(10);
+    REQUIRE(f.slabClass(p) == 0);
+    strcpy(p, "slab slot");
+    CHECK(umm_host_realloc(p, 16) == p);
+
+    // grown out of its slot: content moves to the next class
+    char* q = (char*)umm_host_realloc(p, 20);
+    CHECK(f.slabClass(q) == 1);
+    CHECK(strcmp(q, "slab slot") == 0);
+    CHECK(f.stats(0).used == 0);
+
+    // and to the heap
+    char* r = (char*)umm_host_realloc(q, 200);
+    CHECK(f.slabClass(r) == -1);
+    CHECK(strcmp(r, "slab slot") == 0);
+    CHECK(f.stats(1).used == 0);
+
+    CHECK(umm_host_realloc(umm_host_malloc(8), 0) == nullptr);
+    CHECK(f.stats(0).used == 0);
+    umm_host_free(r);
+}
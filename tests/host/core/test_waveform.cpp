@@ -0,0 +1,296 @@
+/*
+ test_waveform.cpp - PWM waveform generator, its timer 1 NMI run on the
+ simulated cycle counter of MockRegisters.cpp.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <core_esp8266_waveform.h>
+#include <vector>
+
+struct PwmEdge
+{
+    uint32_t cycle;
+    uint32_t gpo;
+};
+
+static std::vector<PwmEdge> pwmEdges;
+
+static const uint8_t  pwmPins[]   = { 0, 1, 2, 3, 4, 5, 12, 13 };
+static const size_t   pwmPinCount = sizeof(pwmPins);
+static const uint32_t pwmMask     = 0x303f;
+static const uint32_t pwmMs       = microsecondsToClockCycles(1000);
+
+struct WaveformSimFixture
+{
+    WaveformSimFixture()
+    {
+        pwmEdges.clear();
+        mock_cycles_simulate(true);
+        mock_gpio_trace([](uint32_t cycle, uint32_t gpo) { pwmEdges.push_back({ cycle, gpo }); });
+        _setPWMFreq(1000);
+        getWaveformStats(nullptr, true);
+    }
+    ~WaveformSimFixture()
+    {
+        for (int pin = 0; pin <= 16; pin++)
+            _stopPWM(pin);
+        mock_cycles_run(2 * pwmMs);
+        mock_gpio_trace(nullptr);
+        mock_timer1_latency(nullptr);
+        mock_cycles_simulate(false);
+    }
+};
+
+// high time of each pin in each PWM period, from the edges after a cycle
+struct PwmPeriod
+{
+    uint32_t start;
+    uint32_t length;
+    uint32_t high[17];
+};
+
+static std::vector<PwmPeriod> pwmPeriods(uint32_t after)
+{
+    std::vector<PwmPeriod> periods;
+    uint32_t               prev = ~0U;
+    for (auto& edge : pwmEdges)
+    {
+        if ((int32_t)(edge.cycle - after) >= 0)
+        {
+            uint32_t rising = edge.gpo & ~prev;
+            if ((rising & pwmMask) == pwmMask)
+            {
+                if (!periods.empty())
+                    periods.back().length = edge.cycle - periods.back().start;
+                periods.push_back({ edge.cycle, 0, {} });
+            }
+            else if (!periods.empty())
+            {
+                uint32_t falling = prev & ~edge.gpo;
+                for (int pin = 0; pin <= 16; pin++)
+                    if (falling & (1 << pin))
+                        periods.back().high[pin] = edge.cycle - periods.back().start;
+            }
+        }
+        prev = edge.gpo;
+    }
+    if (!periods.empty())
+        periods.pop_back();  // incomplete
+    return periods;
+}
+
+// the pins changing level from a cycle on
+static uint32_t pwmToggled(uint32_t from)
+{
+    uint32_t toggled = 0, prev = pwmEdges.front().gpo;
+    for (auto& edge : pwmEdges)
+    {
+        if ((int32_t)(edge.cycle - from) >= 0)
+            toggled |= edge.gpo ^ prev;
+        prev = edge.gpo;
+    }
+    return toggled;
+}
+
+static double pwmDuty(const PwmPeriod& period, int pin)
+{
+    return (double)period.high[pin] / period.length;
+}
+
+TEST_CASE("PWM batch update starts all duties in the same period", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    uint32_t before[pwmPinCount], after[pwmPinCount];
+    for (size_t i = 0; i < pwmPinCount; i++)
+    {
+        before[i] = 20 + i * 25;
+        after[i]  = 230 - i * 25;
+    }
+    uint32_t start = esp_get_cycle_count();
+    REQUIRE(_setPWMBatch(pwmPins, before, pwmPinCount, 255));
+    mock_cycles_run(5 * pwmMs);
+
+    auto periods = pwmPeriods(start);
+    REQUIRE(periods.size() >= 3);
+    for (auto& period : periods)
+    {
+        CHECK(period.length > pwmMs * 95 / 100);
+        CHECK(period.length < pwmMs * 105 / 100);
+        for (size_t i = 0; i < pwmPinCount; i++)
+            CHECK(std::abs(pwmDuty(period, pwmPins[i]) - before[i] / 255.) < 0.02);
+    }
+
+    uint32_t update = esp_get_cycle_count();
+    REQUIRE(_setPWMBatch(pwmPins, after, pwmPinCount, 255));
+    // a single handoff, taken at the next period start
+    uint32_t handoff = esp_get_cycle_count() - update;
+    CHECK(handoff < pwmMs * 11 / 10);
+    mock_cycles_run(5 * pwmMs);
+
+    size_t changed = 0;
+    for (auto& period : pwmPeriods(update))
+    {
+        size_t updated = 0;
+        for (size_t i = 0; i < pwmPinCount; i++)
+        {
+            double duty = pwmDuty(period, pwmPins[i]);
+            if (std::abs(duty - after[i] / 255.) < std::abs(duty - before[i] / 255.))
+                updated++;
+        }
+        // never some pins old and some new
+        CHECK((updated == 0 || updated == pwmPinCount));
+        changed += (updated == pwmPinCount);
+    }
+    CHECK(changed >= 3);
+}
+
+TEST_CASE("PWM batch update of full on and off pins", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    uint32_t duty[pwmPinCount] = { 100, 100, 100, 100, 100, 100, 100, 100 };
+    REQUIRE(_setPWMBatch(pwmPins, duty, pwmPinCount, 255));
+    mock_cycles_run(2 * pwmMs);
+
+    const uint8_t  pins[] = { 0, 1, 9 };
+    const uint32_t vals[] = { 0, 255, 255 };
+    REQUIRE(_setPWMBatch(pins, vals, 3, 255));
+    CHECK(digitalRead(0) == LOW);
+    CHECK(digitalRead(1) == HIGH);
+
+    uint32_t from = esp_get_cycle_count() + pwmMs;
+    mock_cycles_run(3 * pwmMs);
+    CHECK(pwmToggled(from) == (pwmMask & ~3));
+
+    // more than the generator can take leaves everything as it was
+    const uint8_t  more[] = { 0, 1, 9, 14, 15 };
+    const uint32_t half[] = { 128, 128, 128, 128, 128 };
+    CHECK_FALSE(_setPWMBatch(more, half, 5, 255));
+    CHECK(digitalRead(1) == HIGH);
+}
+
+TEST_CASE("PWM one pin at a time waits for a period each", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    uint32_t duty[pwmPinCount] = { 50, 60, 70, 80, 90, 100, 110, 120 };
+    REQUIRE(_setPWMBatch(pwmPins, duty, pwmPinCount, 255));
+    mock_cycles_run(2 * pwmMs);
+
+    uint32_t start = esp_get_cycle_count();
+    for (size_t i = 0; i < pwmPinCount; i++)
+        REQUIRE(_setPWM(pwmPins[i], 200 - duty[i], 255));
+    uint32_t single = esp_get_cycle_count() - start;
+
+    start = esp_get_cycle_count();
+    REQUIRE(_setPWMBatch(pwmPins, duty, pwmPinCount, 255));
+    uint32_t batch = esp_get_cycle_count() - start;
+
+    CHECK(single > 4 * pwmMs);
+    CHECK(batch < pwmMs * 11 / 10);
+}
+
+TEST_CASE("analogWriteBatch clamps the values to the range", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    int values[pwmPinCount] = { -20, 300, 100, 100, 100, 100, 100, 100 };
+    analogWriteBatch(pwmPins, values, pwmPinCount);
+    CHECK(digitalRead(0) == LOW);
+    CHECK(digitalRead(1) == HIGH);
+    uint32_t from = esp_get_cycle_count() + pwmMs;
+    mock_cycles_run(3 * pwmMs);
+    CHECK(pwmToggled(from) == (pwmMask & ~3));
+
+    // to the range set with analogWriteRange()
+    analogWriteRange(1023);
+    values[0] = 2000;
+    values[1] = 512;
+    values[2] = -1;
+    analogWriteBatch(pwmPins, values, pwmPinCount);
+    analogWriteRange(255);
+    CHECK(digitalRead(0) == HIGH);
+    CHECK(digitalRead(2) == LOW);
+    from = esp_get_cycle_count() + pwmMs;
+    mock_cycles_run(3 * pwmMs);
+    CHECK(pwmToggled(from) == (pwmMask & ~5));
+}
+
+TEST_CASE("analogWriteBatch leaves the mode of running pins alone", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    analogWriteMode(14, 100, true);
+    CHECK(mock_pin_mode(14) == OUTPUT_OPEN_DRAIN);
+    pinMode(15, INPUT);
+
+    const uint8_t pins[]   = { 14, 15 };
+    const int     values[] = { 50, 150 };
+    analogWriteBatch(pins, values, 2);
+    CHECK(mock_pin_mode(14) == OUTPUT_OPEN_DRAIN);
+    CHECK(mock_pin_mode(15) == OUTPUT);
+    uint32_t from = esp_get_cycle_count() + pwmMs;
+    mock_cycles_run(3 * pwmMs);
+    CHECK(pwmToggled(from) == ((1 << 14) | (1 << 15)));
+
+    // the batch pins are known running, analogWrite() keeps their mode too
+    pinMode(15, OUTPUT_OPEN_DRAIN);
+    analogWrite(15, 200);
+    CHECK(mock_pin_mode(15) == OUTPUT_OPEN_DRAIN);
+}
+
+static uint32_t statsSum(const uint32_t* histogram)
+{
+    uint32_t sum = 0;
+    for (int i = 0; i < WAVEFORM_STATS_BUCKETS; i++)
+        sum += histogram[i];
+    return sum;
+}
+
+TEST_CASE("PWM timing histograms measure the interrupt latency", "[core][waveform]")
+{
+    WaveformSimFixture fixture;
+
+    uint32_t duty[pwmPinCount] = { 30, 60, 90, 120, 150, 180, 210, 240 };
+    REQUIRE(_setPWMBatch(pwmPins, duty, pwmPinCount, 255));
+    mock_cycles_run(2 * pwmMs);
+
+    WaveformStats quiet;
+    getWaveformStats(nullptr, true);
+    mock_cycles_run(20 * pwmMs);
+    getWaveformStats(&quiet, true);
+
+    // something else delaying the NMI by up to 10us
+    uint32_t seed = 1;
+    mock_timer1_latency(
+        [&seed]()
+        {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) % microsecondsToClockCycles(10);
+        });
+    WaveformStats busy;
+    mock_cycles_run(20 * pwmMs);
+    getWaveformStats(&busy, false);
+
+    CHECK(quiet.irqCount > 20 * 9);
+    CHECK(statsSum(quiet.irqLatency) > 0);
+    CHECK(statsSum(quiet.edgeError) >= 20 * 8);
+    CHECK(statsSum(busy.irqLatency) > 0);
+
+    // the latency shows in the histograms and in the edges timing
+    CHECK(quiet.irqLatencyMax < 100);
+    CHECK(busy.irqLatencyMax > microsecondsToClockCycles(5));
+    CHECK(busy.irqLatencyMax < microsecondsToClockCycles(10) + 100);
+    CHECK(busy.edgeErrorMax > quiet.edgeErrorMax);
+    uint32_t late = 0;
+    for (int i = 10; i < WAVEFORM_STATS_BUCKETS; i++)  // 512 cycles or more
+        late += busy.irqLatency[i];
+    CHECK(late > 0);
+}
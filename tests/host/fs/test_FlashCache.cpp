@@ -0,0 +1,235 @@
+/*
+ test_FlashCache.cpp - LittleFS block device read-ahead and write-back
+ tests, and count of flash HAL calls with and without them.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <vector>
+#include "../common/flash_hal.h"
+#include <FlashCache.h>
+
+using littlefs_impl::FlashCache;
+
+static constexpr uint32_t flashSize = 64 * 1024;
+
+// owns the mocked flash
+struct Flash
+{
+    std::vector<uint8_t> data;
+
+    Flash() : data(flashSize, 0xff)
+    {
+        s_phys_data = data.data();
+        s_phys_size = flashSize;
+        reset();
+    }
+    ~Flash()
+    {
+        s_phys_data = nullptr;
+        s_phys_size = 0;
+    }
+    void reset()
+    {
+        flash_hal_mock_stats = {};
+    }
+};
+
+static void fill(std::vector<uint8_t>& buf, uint32_t seed)
+{
+    for (auto& b : buf)
+    {
+        seed = seed * 1103515245 + 12345;
+        b    = seed >> 16;
+    }
+}
+
+TEST_CASE("FlashCache without buffers calls the HAL directly", "[fs][FlashCache]")
+{
+    Flash      flash;
+    FlashCache cache;
+    REQUIRE(cache.begin(0, flashSize, 0, 0));
+
+    std::vector<uint8_t> buf(64);
+    fill(buf, 1);
+    CHECK(cache.prog(128, buf.size(), buf.data()) == 0);
+    CHECK(flash_hal_mock_stats.writes == 1);
+    std::vector<uint8_t> back(64);
+    CHECK(cache.read(128, back.size(), back.data()) == 0);
+    CHECK(cache.read(192, back.size(), back.data()) == 0);
+    CHECK(flash_hal_mock_stats.reads == 2);
+    CHECK(cache.sync() == 0);
+    CHECK(flash_hal_mock_stats.writes == 1);
+}
+
+TEST_CASE("FlashCache read-ahead grows on sequential reads only", "[fs][FlashCache]")
+{
+    Flash flash;
+    fill(flash.data, 2);
+    FlashCache cache;
+    REQUIRE(cache.begin(0, flashSize, 4096, 0));
+
+    std::vector<uint8_t> buf(64);
+    uint32_t             addr = 0;
+    // first read is random, the window opens on the second one
+    CHECK(cache.read(addr, 64, buf.data()) == 0);
+    CHECK(flash_hal_mock_stats.readBytes == 64);
+    addr += 64;
+    CHECK(cache.read(addr, 64, buf.data()) == 0);
+    CHECK(flash_hal_mock_stats.readBytes == 64 + 1024);
+    for (addr += 64; addr < 64 + 1024 + 2048 + 4096 + 4096; addr += 64)
+    {
+        REQUIRE(cache.read(addr, 64, buf.data()) == 0);
+        REQUIRE(memcmp(buf.data(), &flash.data[addr], 64) == 0);
+    }
+    // 1KB, 2KB, then capped at 4KB
+    CHECK(flash_hal_mock_stats.reads == 5);
+
+    // a jump resets the window
+    flash.reset();
+    CHECK(cache.read(32768, 64, buf.data()) == 0);
+    CHECK(cache.read(0, 64, buf.data()) == 0);
+    CHECK(flash_hal_mock_stats.reads == 2);
+    CHECK(flash_hal_mock_stats.readBytes == 128);
+
+    // never reads past the end
+    flash.reset();
+    CHECK(cache.read(flashSize - 256, 64, buf.data()) == 0);
+    CHECK(cache.read(flashSize - 192, 64, buf.data()) == 0);
+    CHECK(flash_hal_mock_stats.readBytes == 64 + 192);
+}
+
+TEST_CASE("FlashCache write-back gathers progs into aligned writes", "[fs][FlashCache]")
+{
+    Flash      flash;
+    FlashCache cache;
+    REQUIRE(cache.begin(0, flashSize, 0, 256));
+
+    std::vector<uint8_t> data(1024);
+    fill(data, 3);
+    for (uint32_t off = 0; off < 512; off += 64)
+        REQUIRE(cache.prog(4096 + off, 64, &data[off]) == 0);
+    CHECK(flash_hal_mock_stats.writes == 2);
+    CHECK(flash_hal_mock_stats.writeBytes == 512);
+
+    // pending until synced
+    CHECK(cache.prog(4096 + 512, 64, &data[512]) == 0);
+    CHECK(flash_hal_mock_stats.writes == 2);
+    CHECK(flash.data[4096 + 512] == 0xff);
+    CHECK(cache.sync() == 0);
+    CHECK(flash_hal_mock_stats.writes == 3);
+    CHECK(memcmp(&flash.data[4096], data.data(), 576) == 0);
+
+    // a read of pending data writes it back first
+    CHECK(cache.prog(4096 + 576, 64, &data[576]) == 0);
+    std::vector<uint8_t> back(64);
+    CHECK(cache.read(4096 + 576, 64, back.data()) == 0);
+    CHECK(memcmp(back.data(), &data[576], 64) == 0);
+    CHECK(flash_hal_mock_stats.writes == 4);
+
+    // unaligned start fills up to the next boundary, large aligned runs go through
+    flash.reset();
+    CHECK(cache.prog(8192 + 192, 64 + 512, data.data()) == 0);
+    CHECK(flash_hal_mock_stats.writes == 2);
+    CHECK(flash_hal_mock_stats.writeBytes == 64 + 512);
+    CHECK(memcmp(&flash.data[8192 + 192], data.data(), 576) == 0);
+
+    // end() writes back
+    CHECK(cache.prog(12288, 64, data.data()) == 0);
+    CHECK(cache.end() == 0);
+    CHECK(memcmp(&flash.data[12288], data.data(), 64) == 0);
+}
+
+TEST_CASE("FlashCache keeps reads coherent with progs and erases", "[fs][FlashCache]")
+{
+    Flash      flash;
+    FlashCache cache;
+    REQUIRE(cache.begin(0, flashSize, 4096, 256));
+
+    std::vector<uint8_t> ref(flashSize, 0xff);
+    std::vector<uint8_t> buf(512);
+    uint32_t             seed = 4;
+    auto                 next = [&seed](uint32_t mod)
+    {
+        seed = seed * 1103515245 + 12345;
+        return (seed >> 8) % mod;
+    };
+    uint32_t addr = 0;
+    for (int i = 0; i < 20000; i++)
+    {
+        // mostly sequential, like littlefs
+        if (next(8) == 0)
+            addr = next(flashSize / 64) * 64;
+        uint32_t size = std::min<uint32_t>(64 * (1 + next(4)), flashSize - addr);
+        switch (next(10))
+        {
+        case 0:
+        {
+            uint32_t sector = addr & ~(FLASH_SECTOR_SIZE - 1);
+            REQUIRE(cache.erase(sector, FLASH_SECTOR_SIZE) == 0);
+            memset(&ref[sector], 0xff, FLASH_SECTOR_SIZE);
+            break;
+        }
+        case 1:
+        case 2:
+        case 3:
+            fill(buf, seed);
+            REQUIRE(cache.prog(addr, size, buf.data()) == 0);
+            // programming only clears bits
+            for (uint32_t n = 0; n < size; n++)
+                ref[addr + n] &= buf[n];
+            break;
+        case 4:
+            REQUIRE(cache.sync() == 0);
+            break;
+        default:
+            REQUIRE(cache.read(addr, size, buf.data()) == 0);
+            INFO("read " << size << " at " << addr);
+            REQUIRE(memcmp(buf.data(), &ref[addr], size) == 0);
+            break;
+        }
+        addr = (addr + size) % flashSize;
+    }
+    REQUIRE(cache.sync() == 0);
+    CHECK(flash.data == ref);
+}
+
+TEST_CASE("FlashCache flash HAL calls", "[fs][FlashCache]")
+{
+    // littlefs with its 64 byte cache: a 32KB file written, synced every
+    // 4KB, then read back
+    struct Run
+    {
+        uint32_t readAhead, writeBack;
+    };
+    for (Run run : { Run { 0, 0 }, Run { 2048, 256 }, Run { 4096, 4096 } })
+    {
+        Flash      flash;
+        FlashCache cache;
+        REQUIRE(cache.begin(0, flashSize, run.readAhead, run.writeBack));
+
+        std::vector<uint8_t> data(32768), back(32768);
+        fill(data, 5);
+        for (uint32_t addr = 0; addr < data.size(); addr += 64)
+        {
+            REQUIRE(cache.prog(addr, 64, &data[addr]) == 0);
+            if ((addr + 64) % 4096 == 0)
+                REQUIRE(cache.sync() == 0);
+        }
+        flash_hal_mock_stats_t written = flash_hal_mock_stats;
+        flash.reset();
+        for (uint32_t addr = 0; addr < back.size(); addr += 64)
+            REQUIRE(cache.read(addr, 64, &back[addr]) == 0);
+        CHECK(back == data);
+
+        printf("read-ahead %4u, write-back %4u: 32KB written in %4u HAL calls, read in %4u "
+               "HAL calls (%u bytes)\n",
+               run.readAhead, run.writeBack, written.writes, flash_hal_mock_stats.reads,
+               flash_hal_mock_stats.readBytes);
+    }
+}
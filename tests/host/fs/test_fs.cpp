@@ -15,6 +15,7 @@
 
 #include <catch.hpp>
 #include <map>
+#include <vector>
 #include <FS.h>
 #include "../common/spiffs_mock.h"
 #include "../common/littlefs_mock.h"
@@ -92,6 +93,68 @@ TEST_CASE("LittleFS checks the config object passed in", "[fs]")
     REQUIRE_FALSE(LittleFS.setConfig(s));
     REQUIRE_FALSE(LittleFS.setConfig(d));
     REQUIRE(LittleFS.setConfig(l));
+
+    REQUIRE_FALSE(LittleFS.setConfig(LittleFSConfig().setCacheSize(96)));
+    REQUIRE_FALSE(LittleFS.setConfig(LittleFSConfig().setCacheSize(16384)));
+    REQUIRE_FALSE(LittleFS.setConfig(LittleFSConfig().setLookaheadSize(12)));
+    REQUIRE_FALSE(LittleFS.setConfig(LittleFSConfig().setWriteBack(100)));
+    REQUIRE(LittleFS.setConfig(LittleFSConfig().setCacheSize(256).setLookaheadSize(32)));
+    REQUIRE(LittleFS.setConfig(LittleFSConfig().setReadAhead(4096).setWriteBack(1024)));
+}
+
+TEST_CASE("LittleFS caches, read-ahead and write-back", "[lfs]")
+{
+    struct Run
+    {
+        const char*    name;
+        LittleFSConfig cfg;
+    };
+    const Run runs[] = {
+        { "defaults", LittleFSConfig() },
+        { "cache 256", LittleFSConfig().setCacheSize(256) },
+        { "read-ahead 4K, write-back 512",
+          LittleFSConfig().setReadAhead(4096).setWriteBack(512) },
+        { "cache 256, read-ahead 4K, write-back 4K",
+          LittleFSConfig().setCacheSize(256).setReadAhead(4096).setWriteBack(4096) },
+    };
+
+    std::vector<uint8_t> data(200 * 1024);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = (uint8_t)(i * 7 + (i >> 9));
+
+    for (const Run& run : runs)
+    {
+        LITTLEFS_MOCK_DECLARE(512, 8, 256, "");
+        REQUIRE(LittleFS.setConfig(run.cfg));
+        REQUIRE(LittleFS.format());
+        REQUIRE(LittleFS.begin());
+
+        flash_hal_mock_stats = {};
+        File f               = LittleFS.open("/big", "w");
+        REQUIRE(f);
+        for (size_t off = 0; off < data.size(); off += 100)
+            REQUIRE(f.write(&data[off], std::min<size_t>(100, data.size() - off)) > 0);
+        f.close();
+        flash_hal_mock_stats_t written = flash_hal_mock_stats;
+
+        // remount, read back in stream sized chunks
+        LittleFS.end();
+        REQUIRE(LittleFS.begin());
+        flash_hal_mock_stats = {};
+        f                    = LittleFS.open("/big", "r");
+        REQUIRE(f.size() == data.size());
+        std::vector<uint8_t> back(data.size());
+        for (size_t off = 0; off < back.size(); off += 128)
+            REQUIRE(f.read(&back[off], std::min<size_t>(128, back.size() - off)) > 0);
+        f.close();
+        CHECK(back == data);
+
+        printf("LittleFS %s: 200KB written with %u flash writes (%u bytes), %u erases, "
+               "read with %u flash reads (%u bytes)\n",
+               run.name, written.writes, written.writeBytes, written.erases,
+               flash_hal_mock_stats.reads, flash_hal_mock_stats.readBytes);
+        LittleFS.end();
+    }
 }
 
 };  // namespace littlefs_test
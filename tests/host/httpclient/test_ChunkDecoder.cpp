@@ -0,0 +1,114 @@
+/*
+ test_ChunkDecoder.cpp - ESP8266HTTPClient chunked transfer coding decoder
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <string>
+#include <HTTPChunkDecoder.h>
+
+// takes up to room bytes until room is raised again
+struct ChunkOutput: public Print
+{
+    std::string data;
+    int         room = 1024;
+
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t* buf, size_t len) override
+    {
+        len = std::min(len, (size_t)room);
+        data.append((const char*)buf, len);
+        room -= len;
+        return len;
+    }
+    int availableForWrite() override
+    {
+        return room;
+    }
+};
+
+// feeds the body in pieces of size step, returns the bytes consumed
+static size_t decodeSteps(HTTPChunkDecoder& chunks, const std::string& body, size_t step,
+                          Print& out)
+{
+    size_t pos = 0;
+    while (pos < body.size() && !chunks.finished() && !chunks.failed())
+    {
+        size_t n = std::min(step, body.size() - pos);
+        size_t c = chunks.decode((const uint8_t*)body.data() + pos, n, out);
+        if (!c)
+            break;
+        pos += c;
+    }
+    return pos;
+}
+
+TEST_CASE("Chunk decoder strips the framing in pieces of any size", "[httpclient]")
+{
+    const std::string body = "4\r\nWiki\r\n"
+                             "6;name=value\r\npedia \r\n"
+                             "E\r\nin \r\n\r\nchunks.\r\n"
+                             "0\r\n"
+                             "Expires: never\r\n"
+                             "\r\n";
+    const std::string next = "HTTP/1.1 200 OK\r\n";
+
+    for (size_t step : { 1, 2, 3, 7, 100 })
+    {
+        HTTPChunkDecoder chunks;
+        ChunkOutput      out;
+        CHECK(decodeSteps(chunks, body + next, step, out) == body.size());
+        CHECK(chunks.finished());
+        CHECK(chunks.decoded() == 24);
+        CHECK(out.data == "Wikipedia in \r\n\r\nchunks.");
+        CHECK(chunks.want() == 0);
+    }
+}
+
+TEST_CASE("Chunk decoder asks for no more than the body", "[httpclient]")
+{
+    HTTPChunkDecoder chunks;
+    ChunkOutput      out;
+    CHECK(chunks.want() == 1);
+    CHECK(chunks.decode((const uint8_t*)"1a\r\n", 4, out) == 4);
+    CHECK(chunks.want() == 26);
+    CHECK(chunks.decode((const uint8_t*)"abcdefghij", 10, out) == 10);
+    CHECK(chunks.want() == 16);
+}
+
+TEST_CASE("Chunk decoder waits for room in the output", "[httpclient]")
+{
+    const std::string body = "a\r\n0123456789\r\n0\r\n\r\n";
+    HTTPChunkDecoder  chunks;
+    ChunkOutput       out;
+    out.room = 0;
+    CHECK(chunks.decode((const uint8_t*)body.data(), body.size(), out) == 3);
+    out.room = 4;
+    CHECK(chunks.decode((const uint8_t*)body.data() + 3, body.size() - 3, out) == 4);
+    CHECK(out.data == "0123");
+    out.room = 1024;
+    CHECK(decodeSteps(chunks, body.substr(7), 100, out) == body.size() - 7);
+    CHECK(chunks.finished());
+    CHECK(out.data == "0123456789");
+}
+
+TEST_CASE("Chunk decoder rejects bad framing", "[httpclient]")
+{
+    for (const char* body : { "\r\n", "x\r\n", "3\r\nabcX", "3\rabc", "fffffffff\r\n",
+                              "0\r\n\rX" })
+    {
+        HTTPChunkDecoder chunks;
+        ChunkOutput      out;
+        decodeSteps(chunks, body, 100, out);
+        CHECK(chunks.failed());
+        CHECK_FALSE(chunks.writeFailed());
+    }
+}
@@ -0,0 +1,213 @@
+/*
+ test_ConnectionPool.cpp - ESP8266HTTPClient pool of idle keep-alive
+ connections
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <ESP8266WiFi.h>
+#include <memory>
+#include <HTTPConnectionPool.h>
+
+// WiFiClient::connect(host) resolves through WiFi, not used here
+ESP8266WiFiGenericClass::ESP8266WiFiGenericClass() { }
+int ESP8266WiFiGenericClass::hostByName(const char*, IPAddress&, uint32_t)
+{
+    return 0;
+}
+ESP8266WiFiClass WiFi;
+extern "C" const ip_addr_t ip_addr_any = IPADDR4_INIT(IPADDR_ANY);
+
+// the connection, shared by clones as a WiFiClientSecure context is
+struct FakeConnection
+{
+    bool      connected = true;
+    int       available = 0;
+    IPAddress remoteIP { 10, 0, 0, 1 };
+    uint16_t  remotePort = 443;
+    uint16_t  localPort  = 50000;
+    int       stops      = 0;
+};
+
+struct FakeClient: public WiFiClient
+{
+    std::shared_ptr<FakeConnection> conn;
+
+    FakeClient(std::shared_ptr<FakeConnection> conn) : conn(conn) { }
+
+    std::unique_ptr<WiFiClient> clone() const override
+    {
+        return std::unique_ptr<WiFiClient>(new FakeClient(conn));
+    }
+    uint8_t connected() override
+    {
+        return conn->connected;
+    }
+    int available() override
+    {
+        return conn->available;
+    }
+    using WiFiClient::stop;
+    void stop() override
+    {
+        conn->stops++;
+        conn->connected = false;
+    }
+    IPAddress remoteIP() override
+    {
+        return conn->connected ? conn->remoteIP : IPAddress();
+    }
+    uint16_t remotePort() override
+    {
+        return conn->connected ? conn->remotePort : 0;
+    }
+    uint16_t localPort() override
+    {
+        return conn->connected ? conn->localPort : 0;
+    }
+};
+
+static std::shared_ptr<FakeConnection> connection(uint16_t localPort)
+{
+    auto conn       = std::make_shared<FakeConnection>();
+    conn->localPort = localPort;
+    return conn;
+}
+
+static std::unique_ptr<WiFiClient> client(std::shared_ptr<FakeConnection> conn)
+{
+    return std::unique_ptr<WiFiClient>(new FakeClient(conn));
+}
+
+TEST_CASE("HTTPConnectionPool hands connections back per server", "[httpclient][pool]")
+{
+    HTTPConnectionPool pool;
+    auto               a = connection(50001);
+    auto               b = connection(50002);
+    pool.checkin("a.example", 443, true, client(a));
+    pool.checkin("b.example", 80, false, client(b));
+    CHECK(pool.idle() == 2);
+
+    CHECK_FALSE(pool.checkout("a.example", 80, true));
+    CHECK_FALSE(pool.checkout("a.example", 443, false));
+    CHECK_FALSE(pool.checkout("c.example", 443, true));
+    auto reused = pool.checkout("A.example", 443, true);
+    REQUIRE(reused);
+    CHECK(static_cast<FakeClient*>(reused.get())->conn == a);
+    CHECK(pool.idle() == 1);
+    CHECK(a->stops == 0);
+
+    // one idle connection per server, the older one is closed
+    auto b2 = connection(50003);
+    pool.checkin("b.example", 80, false, client(b2));
+    CHECK(pool.idle() == 1);
+    CHECK(b->stops == 1);
+    pool.clear();
+    CHECK(b2->stops == 1);
+}
+
+TEST_CASE("HTTPConnectionPool drops unusable connections", "[httpclient][pool]")
+{
+    HTTPConnectionPool pool;
+
+    // closed by the server
+    auto closed = connection(50001);
+    pool.checkin("a.example", 80, false, client(closed));
+    closed->connected = false;
+    CHECK_FALSE(pool.checkout("a.example", 80, false));
+    CHECK(pool.idle() == 0);
+
+    // sent data nobody asked for
+    auto chatty = connection(50002);
+    pool.checkin("a.example", 80, false, client(chatty));
+    chatty->available = 10;
+    CHECK_FALSE(pool.checkout("a.example", 80, false));
+    CHECK(chatty->stops == 1);
+
+    // not even kept
+    auto gone       = connection(50003);
+    gone->connected = false;
+    pool.checkin("a.example", 80, false, client(gone));
+    CHECK(pool.idle() == 0);
+}
+
+TEST_CASE("HTTPConnectionPool leaves a context connected elsewhere alone", "[httpclient][pool]")
+{
+    HTTPConnectionPool pool;
+
+    // the pooled clone shares its context with the client object, which
+    // then connects to another server sitting at the same address
+    auto       shared = connection(50001);
+    FakeClient secure(shared);
+    pool.checkin("a.example", 443, true, secure.clone());
+    shared->localPort = 50002;
+    CHECK_FALSE(pool.checkout("a.example", 443, true));
+    CHECK(pool.idle() == 0);
+    CHECK(shared->stops == 0);
+    CHECK(shared->connected);
+
+    // nor when the entry is evicted
+    shared->localPort = 50003;
+    pool.checkin("b.example", 443, true, secure.clone());
+    shared->remoteIP = IPAddress(10, 0, 0, 2);
+    pool.clear();
+    CHECK(shared->stops == 0);
+
+    // same connection: stopped
+    pool.checkin("c.example", 443, true, secure.clone());
+    pool.clear();
+    CHECK(shared->stops == 1);
+}
+
+TEST_CASE("HTTPConnectionPool caps and timeouts", "[httpclient][pool]")
+{
+    HTTPConnectionPool pool(3, 1, 1000);
+    auto               plain1 = connection(50001);
+    auto               plain2 = connection(50002);
+    auto               tls1   = connection(50003);
+    auto               tls2   = connection(50004);
+    auto               plain3 = connection(50005);
+    pool.checkin("p1", 80, false, client(plain1));
+    pool.checkin("t1", 443, true, client(tls1));
+    pool.checkin("p2", 80, false, client(plain2));
+
+    // one TLS connection at most: the older one is closed
+    pool.checkin("t2", 443, true, client(tls2));
+    CHECK(pool.idle() == 3);
+    CHECK(tls1->stops == 1);
+    // three at most: the least recently used one is closed
+    pool.checkin("p3", 80, false, client(plain3));
+    CHECK(pool.idle() == 3);
+    CHECK(plain1->stops == 1);
+    CHECK(plain2->stops == 0);
+
+    pool.setMaxIdle(1);
+    CHECK(pool.idle() == 1);
+    CHECK(pool.checkout("p3", 80, false));
+
+    // a shorter server timeout
+    auto brief = connection(50006);
+    auto kept  = connection(50007);
+    pool.setMaxIdle(3);
+    pool.checkin("brief", 80, false, client(brief), 20);
+    pool.checkin("kept", 80, false, client(kept));
+    delay(40);
+    pool.expire();
+    CHECK(pool.idle() == 1);
+    CHECK(brief->stops == 1);
+    pool.setIdleTimeout(0);
+    CHECK(pool.idle() == 0);
+    CHECK(kept->stops == 1);
+
+    // nothing kept
+    HTTPConnectionPool none(0);
+    auto               refused = connection(50008);
+    none.checkin("a", 80, false, client(refused));
+    CHECK(none.idle() == 0);
+    CHECK(refused->stops == 1);
+}
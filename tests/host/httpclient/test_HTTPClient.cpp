@@ -0,0 +1,187 @@
+/*
+ test_HTTPClient.cpp - ESP8266HTTPClient connection reuse, against a
+ scripted server
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <ESP8266HTTPClient.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// one TCP connection: the server answers each request head with a
+// keep-alive response
+struct FakeConnection
+{
+    std::string in;
+    size_t      inPos = 0;
+    std::string request;
+    bool        connected = true;
+    int         requests  = 0;
+
+    size_t pending() const
+    {
+        return in.size() - inPos;
+    }
+    void received(const uint8_t* buf, size_t size)
+    {
+        request.append((const char*)buf, size);
+        size_t end;
+        while ((end = request.find("\r\n\r\n")) != std::string::npos)
+        {
+            request.erase(0, end + 4);
+            requests++;
+            in += "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nConnection: keep-alive\r\n\r\nok";
+        }
+    }
+};
+
+// the connections made by a client and its clones
+struct FakeServer
+{
+    std::vector<std::shared_ptr<FakeConnection>> connections;
+};
+
+struct FakeClient: public WiFiClient
+{
+    std::shared_ptr<FakeServer>     server;
+    std::shared_ptr<FakeConnection> conn;
+
+    FakeClient(std::shared_ptr<FakeServer> server) : server(server) { }
+
+    std::unique_ptr<WiFiClient> clone() const override
+    {
+        return std::unique_ptr<WiFiClient>(new FakeClient(*this));
+    }
+    int connect(const char*, uint16_t) override
+    {
+        conn = std::make_shared<FakeConnection>();
+        server->connections.push_back(conn);
+        return 1;
+    }
+    uint8_t connected() override
+    {
+        return conn && conn->connected;
+    }
+    int available() override
+    {
+        return conn ? conn->pending() : 0;
+    }
+    int read() override
+    {
+        return available() ? (uint8_t)conn->in[conn->inPos++] : -1;
+    }
+    int read(uint8_t* buf, size_t size) override
+    {
+        size = std::min(size, (size_t)available());
+        memcpy(buf, peekBuffer(), size);
+        peekConsume(size);
+        return size;
+    }
+    int peek() override
+    {
+        return available() ? (uint8_t)conn->in[conn->inPos] : -1;
+    }
+    bool hasPeekBufferAPI() const override
+    {
+        return true;
+    }
+    size_t peekAvailable() override
+    {
+        return available();
+    }
+    const char* peekBuffer() override
+    {
+        return conn ? conn->in.data() + conn->inPos : nullptr;
+    }
+    void peekConsume(size_t consume) override
+    {
+        conn->inPos += std::min(consume, conn->pending());
+    }
+    using WiFiClient::write;
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t* buf, size_t size) override
+    {
+        if (!connected())
+            return 0;
+        conn->received(buf, size);
+        return size;
+    }
+    int availableForWrite() override
+    {
+        return connected() ? 4096 : 0;
+    }
+    using WiFiClient::stop;
+    void stop() override
+    {
+        if (conn)
+            conn->connected = false;
+    }
+    IPAddress remoteIP() override
+    {
+        return connected() ? IPAddress(10, 0, 0, 1) : IPAddress();
+    }
+    uint16_t remotePort() override
+    {
+        return connected() ? 80 : 0;
+    }
+    uint16_t localPort() override
+    {
+        return connected() ? 50000 + server->connections.size() : 0;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("HTTPClient with a pool keeps its connection between requests", "[httpclient][pool]")
+{
+    HTTPConnectionPool pool;
+    auto               server = std::make_shared<FakeServer>();
+    FakeClient         client(server);
+    HTTPClient         http;
+    http.setConnectionPool(&pool);
+    REQUIRE(http.begin(client, "http://a.example/"));
+
+    REQUIRE(http.GET() == 200);
+    CHECK(http.getString() == "ok");
+    REQUIRE(server->connections.size() == 1);
+    CHECK(pool.idle() == 0);
+
+    // not pooled by getString(): whatever the pool does, the connection
+    // is still there for the next request
+    pool.clear();
+    REQUIRE(http.GET() == 200);
+    CHECK(http.getString() == "ok");
+    CHECK(server->connections.size() == 1);
+    CHECK(server->connections[0]->requests == 2);
+
+    // closed by the server: reconnected with the client given to begin()
+    server->connections[0]->connected = false;
+    REQUIRE(http.GET() == 200);
+    CHECK(http.getString() == "ok");
+    CHECK(server->connections.size() == 2);
+
+    // pooled by end(), and taken back by the next begin()
+    http.end();
+    CHECK(pool.idle() == 1);
+    REQUIRE(http.begin(client, "http://a.example/other"));
+    REQUIRE(http.GET() == 200);
+    CHECK(http.getString() == "ok");
+    CHECK(server->connections.size() == 2);
+    CHECK(server->connections[1]->requests == 2);
+    CHECK(pool.idle() == 0);
+    http.end();
+    pool.clear();
+}
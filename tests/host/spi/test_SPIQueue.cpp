@@ -0,0 +1,252 @@
+/*
+ test_SPIQueue.cpp - SPIClass transaction queue, against the SPI1 controller
+ emulated in MockRegisters.cpp.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <SPI.h>
+#include <ets_sys.h>
+#include <string>
+#include <vector>
+
+static std::vector<MockSPI1Transfer> spiTransfers;
+static std::vector<int>              spiCsDuringTransfer;
+static int                           spiCsPin = -1;
+
+// records the transfers, answers the MOSI bytes + 1
+static void spiDevice(const MockSPI1Transfer& transfer, uint8_t* miso, size_t misoSize)
+{
+    spiTransfers.push_back(transfer);
+    if (spiCsPin >= 0)
+        spiCsDuringTransfer.push_back(digitalRead(spiCsPin));
+    for (size_t i = 0; i < misoSize; i++)
+        miso[i] = i < transfer.mosi.size() ? transfer.mosi[i] + 1 : 0;
+}
+
+struct SPIQueueFixture
+{
+    SPIClass spi;
+
+    SPIQueueFixture()
+    {
+        spiTransfers.clear();
+        spiCsDuringTransfer.clear();
+        spiCsPin = -1;
+        mock_spi1_device(spiDevice);
+        spi.begin();
+    }
+    ~SPIQueueFixture()
+    {
+        spi.end();
+        mock_spi1_device(nullptr);
+    }
+};
+
+static std::vector<uint8_t> spiPattern(size_t size)
+{
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; i++)
+        data[i] = (uint8_t)(i * 7 + 3);
+    return data;
+}
+
+static void spiCountDone(SPITransaction* transaction)
+{
+    ++*(int*)transaction->arg;
+}
+
+TEST_CASE("SPI queue overlaps transfers with the caller", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+
+    std::vector<uint8_t> data = spiPattern(10);
+    int                  done = 0;
+    SPITransaction       a, b;
+    a.out = b.out = data.data();
+    a.length      = 10;
+    b.length      = 4;
+    a.callback = b.callback = spiCountDone;
+    a.arg = b.arg = &done;
+
+    REQUIRE(spi.queue(a));
+    REQUIRE(spi.queue(b));
+    CHECK_FALSE(spi.queue(a));
+    CHECK(a.pending());
+    CHECK(b.pending());
+    CHECK_FALSE(spi.queueIdle());
+
+    // one transfer per emulated bus completion
+    CHECK(mock_spi1_complete());
+    CHECK_FALSE(a.pending());
+    CHECK(b.pending());
+    CHECK(done == 1);
+    CHECK(mock_spi1_complete());
+    CHECK_FALSE(b.pending());
+    CHECK(done == 2);
+    CHECK(spi.queueIdle());
+    CHECK_FALSE(mock_spi1_complete());
+
+    REQUIRE(spiTransfers.size() == 2);
+    CHECK(spiTransfers[0].mosi == data);
+    CHECK(spiTransfers[1].mosi == std::vector<uint8_t>(data.begin(), data.begin() + 4));
+    CHECK(spiTransfers[0].commandBits == 0);
+    CHECK(spiTransfers[0].addressBits == 0);
+}
+
+TEST_CASE("SPI queue phases, chunks and received data", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+
+    // unaligned buffers, over two 64-byte FIFO loads
+    std::vector<uint8_t> out = spiPattern(151);
+    std::vector<uint8_t> in(152, 0);
+    SPITransaction       t;
+    t.command     = 0x2a5;
+    t.commandBits = 10;
+    t.address     = 0x123456;
+    t.addressBits = 24;
+    t.out         = out.data() + 1;
+    t.in          = in.data() + 1;
+    t.length      = 150;
+
+    REQUIRE(spi.queue(t));
+    spi.waitQueue();
+    CHECK_FALSE(t.pending());
+
+    REQUIRE(spiTransfers.size() == 3);
+    CHECK(spiTransfers[0].commandBits == 10);
+    CHECK(spiTransfers[0].command == 0x2a5);
+    CHECK(spiTransfers[0].addressBits == 24);
+    CHECK(spiTransfers[0].address == 0x123456);
+    CHECK(spiTransfers[1].commandBits == 0);
+    CHECK(spiTransfers[1].addressBits == 0);
+    CHECK(spiTransfers[0].mosi.size() == 64);
+    CHECK(spiTransfers[1].mosi.size() == 64);
+    CHECK(spiTransfers[2].mosi.size() == 22);
+
+    std::vector<uint8_t> sent;
+    for (auto& transfer : spiTransfers)
+        sent.insert(sent.end(), transfer.mosi.begin(), transfer.mosi.end());
+    CHECK(sent == std::vector<uint8_t>(out.begin() + 1, out.end()));
+    CHECK(in[0] == 0);
+    for (size_t i = 0; i < 150; i++)
+        REQUIRE(in[i + 1] == (uint8_t)(out[i + 1] + 1));
+    CHECK(in[151] == 0);
+}
+
+TEST_CASE("SPI queue command only, and without out data", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+
+    SPITransaction command;
+    command.command     = 0x06;
+    command.commandBits = 8;
+    uint8_t        in[3] = { 0 };
+    SPITransaction read;
+    read.in     = in;
+    read.length = sizeof(in);
+
+    SPITransaction empty;
+    CHECK_FALSE(spi.queue(empty));
+    empty.addressBits = 33;
+    empty.length      = 1;
+    CHECK_FALSE(spi.queue(empty));
+
+    REQUIRE(spi.queue(command));
+    REQUIRE(spi.queue(read));
+    spi.waitQueue();
+    REQUIRE(spiTransfers.size() == 2);
+    CHECK(spiTransfers[0].command == 0x06);
+    CHECK(spiTransfers[0].mosi.empty());
+    CHECK(spiTransfers[1].mosi == std::vector<uint8_t>(3, 0xff));
+    CHECK(in[0] == 0);  // 0xff + 1
+}
+
+TEST_CASE("SPI queue holds csPin low for the transaction", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+
+    spiCsPin = 5;
+    digitalWrite(5, HIGH);
+    std::vector<uint8_t> data = spiPattern(100);
+    SPITransaction       t;
+    t.out    = data.data();
+    t.length = data.size();
+    t.csPin  = 5;
+
+    REQUIRE(spi.queue(t));
+    CHECK(digitalRead(5) == LOW);
+    spi.waitQueue();
+    CHECK(digitalRead(5) == HIGH);
+    CHECK(spiCsDuringTransfer == std::vector<int>({ LOW, LOW }));
+}
+
+static SPIClass*      spiChained;
+static SPITransaction spiChainedNext;
+
+static void spiQueueNext(SPITransaction* transaction)
+{
+    ++*(int*)transaction->arg;
+    if (transaction != &spiChainedNext)
+        spiChained->queue(spiChainedNext);
+}
+
+TEST_CASE("SPI queue from the callback and blocking calls", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+    spiChained          = &spi;
+
+    std::vector<uint8_t> data = spiPattern(8);
+    int                  done = 0;
+    SPITransaction       t;
+    t.out                   = data.data();
+    t.length                = 8;
+    t.callback              = spiQueueNext;
+    t.arg                   = &done;
+    spiChainedNext.out      = data.data();
+    spiChainedNext.length   = 2;
+    spiChainedNext.callback = spiQueueNext;
+    spiChainedNext.arg      = &done;
+
+    REQUIRE(spi.queue(t));
+    // waits for both transactions first
+    CHECK(spi.transfer(0x41) == 0x42);
+    CHECK(done == 2);
+    REQUIRE(spiTransfers.size() == 3);
+    CHECK(spiTransfers[1].mosi.size() == 2);
+    CHECK(spiTransfers[2].mosi == std::vector<uint8_t>({ 0x41 }));
+}
+
+TEST_CASE("SPI queue completion waits for the interrupt unmask", "[spi]")
+{
+    SPIQueueFixture fixture;
+    SPIClass&       spi = fixture.spi;
+
+    uint8_t        data[4] = { 1, 2, 3, 4 };
+    int            done    = 0;
+    SPITransaction t;
+    t.out      = data;
+    t.length   = sizeof(data);
+    t.callback = spiCountDone;
+    t.arg      = &done;
+
+    REQUIRE(spi.queue(t));
+    ETS_SPI_INTR_DISABLE();
+    CHECK(mock_spi1_complete());
+    CHECK(done == 0);
+    CHECK(t.pending());
+    ETS_SPI_INTR_ENABLE();
+    CHECK(done == 1);
+    CHECK_FALSE(t.pending());
+}
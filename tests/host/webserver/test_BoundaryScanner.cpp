@@ -0,0 +1,75 @@
+/*
+ test_BoundaryScanner.cpp - ESP8266WebServer multipart delimiter search tests
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <detail/BoundaryScanner.h>
+
+using esp8266webserver::BoundaryScanner;
+
+static const uint8_t* bytes(const String& s)
+{
+    return (const uint8_t*)s.c_str();
+}
+
+TEST_CASE("BoundaryScanner finds the delimiter", "[webserver][BoundaryScanner]")
+{
+    BoundaryScanner scanner;
+    REQUIRE(scanner.begin("----WebKitFormBoundary7MA4YWxkTrZu0gW"));
+    CHECK(scanner.length() == 4 + 37);
+
+    String data("file content\r\n--not the boundary\r\n------WebKitFormBoundary7MA4YWxkTrZu0gW--\r\n");
+    int    pos = data.indexOf("\r\n------WebKit");
+    CHECK(scanner.find(bytes(data), data.length()) == pos);
+    CHECK(scanner.find(bytes(data), data.length(), pos) == pos);
+    CHECK(scanner.find(bytes(data), data.length(), pos + 1) == -1);
+    // delimiter cut by the end of the data
+    CHECK(scanner.find(bytes(data), pos + scanner.length() - 1) == -1);
+
+    // every position, with data around
+    for (int i = 0; i < 100; i++)
+    {
+        String s;
+        for (int j = 0; j < i; j++)
+            s += (char)('a' + j % 26);
+        s += "\r\n------WebKitFormBoundary7MA4YWxkTrZu0gW";
+        s += "xyz";
+        REQUIRE(scanner.find(bytes(s), s.length()) == i);
+    }
+}
+
+TEST_CASE("BoundaryScanner keeps a possible delimiter start", "[webserver][BoundaryScanner]")
+{
+    BoundaryScanner scanner;
+    REQUIRE(scanner.begin("xyz"));
+
+    String data("abc\r\n--x");
+    CHECK(scanner.partial(bytes(data), data.length()) == 5);
+    data = "abc\r\n--";
+    CHECK(scanner.partial(bytes(data), data.length()) == 4);
+    data = "abc\r";
+    CHECK(scanner.partial(bytes(data), data.length()) == 1);
+    data = "abc\r\n-x";
+    CHECK(scanner.partial(bytes(data), data.length()) == 0);
+    data = "\r\n--xy";
+    CHECK(scanner.partial(bytes(data), data.length()) == 6);
+    data = "";
+    CHECK(scanner.partial(bytes(data), data.length()) == 0);
+}
+
+TEST_CASE("BoundaryScanner rejects invalid boundaries", "[webserver][BoundaryScanner]")
+{
+    BoundaryScanner scanner;
+    CHECK(!scanner.begin(""));
+    String tooLong;
+    for (size_t i = 0; i <= BoundaryScanner::maxBoundaryLength; i++)
+        tooLong += 'b';
+    CHECK(!scanner.begin(tooLong));
+    CHECK(scanner.find((const uint8_t*)"abc", 3) == -1);
+}
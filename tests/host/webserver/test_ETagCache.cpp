@@ -0,0 +1,292 @@
+/*
+ test_ETagCache.cpp - ESP8266WebServer ETag cache tests
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <FS.h>
+#include <FSImpl.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <detail/ETagCache.h>
+
+using esp8266webserver::ETagCache;
+
+// flat in-memory filesystem with modification times and a read counter
+struct MemFile
+{
+    std::string data;
+    time_t      mtime = 0;
+};
+
+struct MemStorage
+{
+    std::map<std::string, MemFile> files;
+    time_t                         now    = 0;
+    size_t                         reads  = 0;
+    size_t                         opens  = 0;
+    size_t                         writes = 0;
+};
+
+class MemFileImpl: public fs::FileImpl
+{
+public:
+    MemFileImpl(MemStorage& storage, const std::string& path, bool write) :
+        _storage(storage), _path(path), _write(write)
+    {
+    }
+
+    size_t write(const uint8_t* buf, size_t size) override
+    {
+        if (!_write)
+            return 0;
+        _storage.writes++;
+        file().data.append((const char*)buf, size);
+        file().mtime = _storage.now;
+        _pos         = file().data.size();
+        return size;
+    }
+    int read(uint8_t* buf, size_t size) override
+    {
+        _storage.reads++;
+        size_t len = std::min(size, file().data.size() - _pos);
+        memcpy(buf, file().data.data() + _pos, len);
+        _pos += len;
+        return len;
+    }
+    void flush() override { }
+    bool seek(uint32_t pos, fs::SeekMode) override
+    {
+        _pos = pos;
+        return true;
+    }
+    size_t      position() const override { return _pos; }
+    size_t      size() const override { return _storage.files[_path].data.size(); }
+    bool        truncate(uint32_t) override { return false; }
+    void        close() override { }
+    const char* name() const override { return _path.c_str(); }
+    const char* fullName() const override { return _path.c_str(); }
+    bool        isFile() const override { return true; }
+    bool        isDirectory() const override { return false; }
+    time_t      getLastWrite() override { return file().mtime; }
+
+private:
+    MemFile& file() { return _storage.files[_path]; }
+
+    MemStorage& _storage;
+    std::string _path;
+    bool        _write;
+    size_t      _pos = 0;
+};
+
+class MemFSImpl: public fs::FSImpl
+{
+public:
+    explicit MemFSImpl(MemStorage& storage) : _storage(storage) { }
+
+    bool            setConfig(const fs::FSConfig&) override { return true; }
+    bool            begin() override { return true; }
+    void            end() override { }
+    bool            format() override { return false; }
+    bool            info(fs::FSInfo&) override { return false; }
+    bool            info64(fs::FSInfo64&) override { return false; }
+    fs::FileImplPtr open(const char* path, fs::OpenMode openMode, fs::AccessMode accessMode) override
+    {
+        _storage.opens++;
+        auto it = _storage.files.find(path);
+        if (it == _storage.files.end())
+        {
+            if (!(openMode & fs::OM_CREATE))
+                return nullptr;
+            _storage.files[path].mtime = _storage.now;
+        }
+        else if (openMode & fs::OM_TRUNCATE)
+        {
+            it->second.data.clear();
+            it->second.mtime = _storage.now;
+        }
+        return std::make_shared<MemFileImpl>(_storage, path, accessMode & fs::AM_WRITE);
+    }
+    bool exists(const char* path) override { return _storage.files.count(path); }
+    bool stat(const char* path, fs::FSStat& st) override
+    {
+        auto it = _storage.files.find(path);
+        if (it == _storage.files.end())
+            return false;
+        st = { it->second.data.size(), it->second.mtime, false };
+        return true;
+    }
+    fs::DirImplPtr openDir(const char*) override { return nullptr; }
+    bool           rename(const char*, const char*) override { return false; }
+    bool           remove(const char* path) override { return _storage.files.erase(path); }
+    bool           mkdir(const char*) override { return true; }
+    bool           rmdir(const char*) override { return true; }
+
+private:
+    MemStorage& _storage;
+};
+
+static void put(MemStorage& storage, const char* path, const std::string& data, time_t mtime)
+{
+    storage.files[path] = { data, mtime };
+}
+
+static String eTagOf(ETagCache& cache, fs::FS& fs, const char* path)
+{
+    File f = fs.open(path, "r");
+    return cache.get(fs, path, f);
+}
+
+TEST_CASE("ETagCache only reads unchanged files once", "[webserver][ETagCache]")
+{
+    MemStorage storage;
+    storage.now = 1000;
+    fs::FS fs(std::make_shared<MemFSImpl>(storage));
+    put(storage, "/www/index.html", "<html>hello</html>", 100);
+    put(storage, "/www/app.js", "console.log(1)", 200);
+
+    ETagCache cache("/www/.etags");
+    String    index = eTagOf(cache, fs, "/www/index.html");
+    String    app   = eTagOf(cache, fs, "/www/app.js");
+    CHECK(index == esp8266webserver::calcETag(fs, "/www/index.html"));
+    CHECK(app != index);
+    // serving never writes
+    CHECK(!storage.files.count("/www/.etags"));
+
+    storage.reads = 0;
+    CHECK(eTagOf(cache, fs, "/www/index.html") == index);
+    CHECK(eTagOf(cache, fs, "/www/app.js") == app);
+    CHECK(storage.reads == 0);
+
+    // known without opening the file
+    storage.opens = 0;
+    String eTag;
+    CHECK(cache.lookup(fs, "/www/app.js", eTag));
+    CHECK(eTag == app);
+    CHECK_FALSE(cache.lookup(fs, "/www/missing.js", eTag));
+    CHECK(storage.opens == 0);
+
+    SECTION("a changed modification time invalidates the entry")
+    {
+        put(storage, "/www/index.html", "<html>HELLO</html>", 101);
+        CHECK_FALSE(cache.lookup(fs, "/www/index.html", eTag));
+        String changed = eTagOf(cache, fs, "/www/index.html");
+        CHECK(changed != index);
+        CHECK(changed == esp8266webserver::calcETag(fs, "/www/index.html"));
+    }
+
+    SECTION("a changed size invalidates the entry")
+    {
+        put(storage, "/www/app.js", "console.log(12)", 200);
+        CHECK_FALSE(cache.lookup(fs, "/www/app.js", eTag));
+        CHECK(eTagOf(cache, fs, "/www/app.js") != app);
+    }
+
+    SECTION("the index is written by saveIdle() once no new ETag came")
+    {
+        CHECK(cache.dirty());
+        CHECK_FALSE(cache.saveIdle(fs));
+        CHECK(!storage.files.count("/www/.etags"));
+        delay(WEBSERVER_ETAG_SAVE_DELAY + 10);
+        CHECK(cache.saveIdle(fs));
+        CHECK(storage.files.count("/www/.etags"));
+        CHECK_FALSE(cache.dirty());
+        storage.writes = 0;
+        CHECK(cache.saveIdle(fs));
+        CHECK(storage.writes == 0);
+    }
+
+    SECTION("the index is written by save() and loaded after a restart")
+    {
+        put(storage, "/www/app.js", "console.log(2)", 201);
+        app = eTagOf(cache, fs, "/www/app.js");
+        CHECK(cache.save(fs));
+        storage.writes = 0;
+        CHECK(cache.save(fs));
+        CHECK(storage.writes == 0);
+
+        ETagCache reloaded("/www/.etags");
+        storage.reads = 0;
+        storage.opens = 0;
+        CHECK(reloaded.lookup(fs, "/www/index.html", eTag));
+        CHECK(eTag == index);
+        CHECK(reloaded.lookup(fs, "/www/app.js", eTag));
+        CHECK(eTag == app);
+        size_t indexBytes = storage.files["/www/.etags"].data.size();
+        // only the index file was read
+        CHECK(storage.opens == 1);
+        CHECK(storage.reads <= 1 + indexBytes);
+        CHECK(storage.files["/www/index.html"].mtime == 100);
+    }
+}
+
+TEST_CASE("ETagCache keeps the most recently used entries", "[webserver][ETagCache]")
+{
+    MemStorage storage;
+    fs::FS     fs(std::make_shared<MemFSImpl>(storage));
+    ETagCache  cache("/.etags");
+
+    char path[16];
+    for (int i = 0; i <= WEBSERVER_ETAG_CACHE_SIZE; i++)
+    {
+        snprintf(path, sizeof(path), "/f%d", i);
+        put(storage, path, std::string(i + 1, 'x'), 10);
+    }
+    for (int i = 0; i < WEBSERVER_ETAG_CACHE_SIZE; i++)
+    {
+        snprintf(path, sizeof(path), "/f%d", i);
+        eTagOf(cache, fs, path);
+    }
+    // /f0 used again, then one more file evicts /f1
+    String eTag;
+    CHECK(cache.lookup(fs, "/f0", eTag));
+    eTagOf(cache, fs, "/f0");
+    snprintf(path, sizeof(path), "/f%d", WEBSERVER_ETAG_CACHE_SIZE);
+    eTagOf(cache, fs, path);
+    CHECK(cache.lookup(fs, "/f0", eTag));
+    CHECK_FALSE(cache.lookup(fs, "/f1", eTag));
+    CHECK(cache.lookup(fs, "/f2", eTag));
+    CHECK(cache.lookup(fs, path, eTag));
+
+    // many GET of changing files never write the index
+    for (int i = 1; i <= 4 * WEBSERVER_ETAG_CACHE_SIZE; i++)
+    {
+        put(storage, "/data.bin", std::string(i, 'x'), i);
+        CHECK(eTagOf(cache, fs, "/data.bin") == esp8266webserver::calcETag(fs, "/data.bin"));
+    }
+    CHECK(storage.writes == 0);
+    CHECK(!storage.files.count("/.etags"));
+
+    // the index holds the entries in RAM: /data.bin evicted /f3, the least
+    // recently used
+    CHECK(cache.save(fs));
+    const std::string& index = storage.files["/.etags"].data;
+    CHECK(std::count(index.begin(), index.end(), '\n') == WEBSERVER_ETAG_CACHE_SIZE);
+    ETagCache reloaded("/.etags");
+    CHECK(reloaded.lookup(fs, "/data.bin", eTag));
+    CHECK(reloaded.lookup(fs, "/f0", eTag));
+    CHECK(reloaded.lookup(fs, "/f2", eTag));
+    CHECK_FALSE(reloaded.lookup(fs, "/f3", eTag));
+}
+
+TEST_CASE("ETagCache does not cache files without modification time", "[webserver][ETagCache]")
+{
+    MemStorage storage;
+    fs::FS     fs(std::make_shared<MemFSImpl>(storage));
+    put(storage, "/a.txt", "aaaa", 0);
+
+    ETagCache cache("/.etags");
+    String    a = eTagOf(cache, fs, "/a.txt");
+    String    eTag;
+    CHECK_FALSE(cache.lookup(fs, "/a.txt", eTag));
+    put(storage, "/a.txt", "bbbb", 0);
+    CHECK(eTagOf(cache, fs, "/a.txt") != a);
+    CHECK(cache.save(fs));
+    CHECK(!storage.files.count("/.etags"));
+}
@@ -0,0 +1,297 @@
+/*
+ test_RequestParser.cpp - ESP8266WebServer request head parser tests
+ and allocation count comparison against the former String based parsing.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <StreamString.h>
+#include <detail/RequestParser.h>
+
+using esp8266webserver::RequestParser;
+
+#ifdef __GLIBC__
+// count heap allocations (String uses malloc/realloc) while enabled
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+static bool   countAllocs = false;
+static size_t allocs      = 0;
+extern "C" void* malloc(size_t size)
+{
+    allocs += countAllocs;
+    return __libc_malloc(size);
+}
+extern "C" void* realloc(void* ptr, size_t size)
+{
+    allocs += countAllocs;
+    return __libc_realloc(ptr, size);
+}
+#define HAVE_ALLOC_COUNT 1
+#endif
+
+static const char browserRequest[]
+    = "GET /api/sensors/temperature?unit=celsius&precision=2 HTTP/1.1\r\n"
+      "Host: 192.168.4.1\r\n"
+      "Connection: keep-alive\r\n"
+      "Cache-Control: max-age=0\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+      "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+      "Accept-Encoding: gzip, deflate\r\n"
+      "Accept-Language: en-US,en;q=0.9\r\n"
+      "If-None-Match: \"abcdef\"\r\n"
+      "\r\n";
+
+static bool keepSome(void* context, const char* name)
+{
+    (void)context;
+    return strcasecmp(name, "Host") == 0 || strcasecmp(name, "Connection") == 0
+           || strcasecmp(name, "If-None-Match") == 0;
+}
+
+static void checkBrowserRequest(const RequestParser& p)
+{
+    CHECK(p.done());
+    CHECK(strcmp(p.method(), "GET") == 0);
+    CHECK(strcmp(p.uri(), "/api/sensors/temperature") == 0);
+    CHECK(strcmp(p.query(), "unit=celsius&precision=2") == 0);
+    CHECK(strcmp(p.version(), "HTTP/1.1") == 0);
+    CHECK(p.versionMinor() == 1);
+    REQUIRE(p.headerCount() == 3);
+    CHECK(strcmp(p.header(F("host")), "192.168.4.1") == 0);
+    CHECK(strcmp(p.header(F("CONNECTION")), "keep-alive") == 0);
+    CHECK(strcmp(p.header(F("If-None-Match")), "\"abcdef\"") == 0);
+    CHECK(p.header(F("User-Agent")) == nullptr);
+}
+
+TEST_CASE("RequestParser parses a request head", "[webserver][RequestParser]")
+{
+    RequestParser p;
+    p.setHeaderFilter(keepSome, nullptr);
+
+    String request(browserRequest);
+    request += "body";
+    size_t used = p.feed(request.c_str(), request.length());
+    // the body is left untouched
+    CHECK(used == request.length() - 4);
+    checkBrowserRequest(p);
+}
+
+TEST_CASE("RequestParser accepts input in pieces", "[webserver][RequestParser]")
+{
+    RequestParser p;
+    p.setHeaderFilter(keepSome, nullptr);
+    for (size_t i = 0; i < sizeof(browserRequest) - 1; i++)
+    {
+        REQUIRE(!p.done());
+        CHECK(p.feed(&browserRequest[i], 1) == 1);
+    }
+    checkBrowserRequest(p);
+
+    // parser is reusable, bare LF line endings are accepted
+    p.reset();
+    const char* req = "POST /upload HTTP/1.0\nContent-Length:  42  \nX-Other: 1\n\n";
+    p.setHeaderFilter(nullptr, nullptr);
+    p.feed(req, strlen(req));
+    CHECK(p.done());
+    CHECK(strcmp(p.method(), "POST") == 0);
+    CHECK(strcmp(p.uri(), "/upload") == 0);
+    CHECK(!p.hasQuery());
+    CHECK(strcmp(p.query(), "") == 0);
+    CHECK(p.versionMinor() == 0);
+    CHECK(p.headerCount() == 2);
+    CHECK(strcmp(p.header(F("Content-Length")), "42") == 0);
+}
+
+TEST_CASE("RequestParser rejects malformed requests", "[webserver][RequestParser]")
+{
+    RequestParser p;
+    const char*   noUri = "GET\r\n\r\n";
+    p.feed(noUri, strlen(noUri));
+    CHECK(p.failed());
+
+    p.reset();
+    const char* badEnd = "GET / HTTP/1.1\r\n\rX";
+    p.feed(badEnd, strlen(badEnd));
+    CHECK(p.failed());
+
+    CHECK(p.error() == 400);
+    // unwanted headers do not use the arena, headers without ':' are ignored
+    p.reset();
+    p.setHeaderFilter(keepSome, nullptr);
+    String bigHeaders("GET / HTTP/1.1\r\nbroken line\r\n");
+    for (int i = 0; i < WEBSERVER_REQUEST_ARENA / 16; i++)
+        bigHeaders += "Cookie: 0123456789abcdef\r\n";
+    bigHeaders += "Host: esp\r\n\r\n";
+    p.feed(bigHeaders.c_str(), bigHeaders.length());
+    CHECK(p.done());
+    CHECK(p.headerCount() == 1);
+    CHECK(strcmp(p.header(F("Host")), "esp") == 0);
+}
+
+TEST_CASE("RequestParser moves large request heads to the heap", "[webserver][RequestParser]")
+{
+    RequestParser p;
+    p.setHeaderFilter(keepSome, nullptr);
+
+    // larger than the embedded arena, but under the limit
+    String longUri("/");
+    for (int i = 0; i < 3 * WEBSERVER_REQUEST_ARENA; i++)
+        longUri += (char)('a' + i % 26);
+    String cookie;
+    for (int i = 0; i < WEBSERVER_REQUEST_ARENA; i++)
+        cookie += 'c';
+    String request = "GET " + longUri + " HTTP/1.1\r\nCookie: " + cookie + "\r\n";
+    for (int i = 0; i < WEBSERVER_REQUEST_MAX_HEADERS; i++)
+        request += "X-Unwanted: 1\r\n";
+    request += "Host: esp\r\nIf-None-Match: \"" + cookie + "\"\r\n\r\n";
+    for (size_t i = 0; i < request.length(); i += 100)
+        p.feed(request.c_str() + i, std::min<size_t>(100, request.length() - i));
+    REQUIRE(p.done());
+    CHECK(p.capacity() > WEBSERVER_REQUEST_ARENA);
+    CHECK(longUri == p.uri());
+    CHECK(strcmp(p.header(F("Host")), "esp") == 0);
+    CHECK(strlen(p.header(F("If-None-Match"))) == cookie.length() + 2);
+
+    // back to the embedded arena
+    p.reset();
+    CHECK(p.capacity() == WEBSERVER_REQUEST_ARENA);
+    p.feed(browserRequest, sizeof(browserRequest) - 1);
+    checkBrowserRequest(p);
+}
+
+TEST_CASE("RequestParser answers too large request heads", "[webserver][RequestParser]")
+{
+    RequestParser p;
+    p.setHeaderFilter(keepSome, nullptr);
+
+    String longUri("GET /");
+    for (int i = 0; i < WEBSERVER_REQUEST_MAX_HEAD; i++)
+        longUri += 'a';
+    longUri += " HTTP/1.1\r\n\r\n";
+    p.feed(longUri.c_str(), longUri.length());
+    CHECK(p.failed());
+    CHECK(p.error() == 414);
+
+    p.reset();
+    String longHeader("GET / HTTP/1.1\r\nHost: ");
+    for (int i = 0; i < WEBSERVER_REQUEST_MAX_HEAD; i++)
+        longHeader += 'h';
+    longHeader += "\r\n\r\n";
+    p.feed(longHeader.c_str(), longHeader.length());
+    CHECK(p.failed());
+    CHECK(p.error() == 431);
+
+    // a wanted header is never dropped, even after too many others
+    p.reset();
+    p.setHeaderFilter(nullptr, nullptr);
+    String manyHeaders("POST / HTTP/1.1\r\n");
+    for (int i = 0; i < WEBSERVER_REQUEST_MAX_HEADERS; i++)
+        manyHeaders += "X-Header: 1\r\n";
+    manyHeaders += "Content-Length: 10\r\n\r\n";
+    p.feed(manyHeaders.c_str(), manyHeaders.length());
+    CHECK(p.failed());
+    CHECK(p.error() == 431);
+}
+
+#ifdef HAVE_ALLOC_COUNT
+
+// former ESP8266WebServer::_parseRequest() request line and header handling
+static void legacyParse(Stream& client, String& uri, String& host, String& connection)
+{
+    String req = client.readStringUntil('\r');
+    client.readStringUntil('\n');
+    int    addr_start = req.indexOf(' ');
+    int    addr_end   = req.indexOf(' ', addr_start + 1);
+    String methodStr  = req.substring(0, addr_start);
+    String url        = req.substring(addr_start + 1, addr_end);
+    String versionEnd = req.substring(addr_end + 8);
+    String searchStr;
+    int    hasSearch = url.indexOf('?');
+    if (hasSearch != -1)
+    {
+        searchStr = url.substring(hasSearch + 1);
+        url       = url.substring(0, hasSearch);
+    }
+    uri = url;
+    String headerName;
+    String headerValue;
+    while (1)
+    {
+        req = client.readStringUntil('\r');
+        client.readStringUntil('\n');
+        if (req.isEmpty())
+            break;
+        int headerDiv = req.indexOf(':');
+        if (headerDiv == -1)
+            break;
+        headerName  = req.substring(0, headerDiv);
+        headerValue = req.substring(headerDiv + 2);
+        if (headerName.equalsIgnoreCase(F("Host")))
+            host = headerValue;
+        else if (headerName.equalsIgnoreCase(F("Connection")))
+            connection = headerValue;
+    }
+}
+
+static void parserParse(Stream& client, RequestParser& p, String& uri, String& host,
+                        String& connection)
+{
+    p.reset();
+    p.setHeaderFilter(keepSome, nullptr);
+    while (!p.done() && !p.failed() && client.peekAvailable())
+        client.peekConsume(p.feed(client.peekBuffer(), client.peekAvailable()));
+    uri        = p.uri();
+    host       = p.header(F("Host"));
+    connection = p.header(F("Connection"));
+}
+
+TEST_CASE("RequestParser allocations per request", "[webserver][RequestParser]")
+{
+    constexpr int requests = 100;
+    // persistent server-side Strings
+    String uri, host, connection;
+    // request source, allocated before counting
+    StreamString client;
+    client.reserve(sizeof(browserRequest));
+    RequestParser* parser = new RequestParser;
+
+    size_t before = 0;
+    for (int i = 0; i < requests; i++)
+    {
+        client = browserRequest;
+        allocs = 0;
+        countAllocs = true;
+        legacyParse(client, uri, host, connection);
+        countAllocs = false;
+        before += allocs;
+        REQUIRE(uri == "/api/sensors/temperature");
+    }
+
+    size_t after = 0;
+    for (int i = 0; i < requests; i++)
+    {
+        client = browserRequest;
+        allocs = 0;
+        countAllocs = true;
+        parserParse(client, *parser, uri, host, connection);
+        countAllocs = false;
+        after += allocs;
+        REQUIRE(uri == "/api/sensors/temperature");
+        REQUIRE(host == "192.168.4.1");
+        REQUIRE(connection == "keep-alive");
+    }
+    delete parser;
+
+    printf("request head allocations per request: String parsing %g, RequestParser %g\n",
+           (double)before / requests, (double)after / requests);
+    CHECK(after < before);
+    // once the server-side Strings have grown, the parser does not allocate
+    CHECK(after == 0);
+}
+
+#endif  // HAVE_ALLOC_COUNT
@@ -0,0 +1,205 @@
+/*
+ test_RouteIndex.cpp - ESP8266WebServer route index tests, and dispatch
+ time comparison against walking the list of handlers.
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <chrono>
+#include <memory>
+#include <detail/RouteIndex.h>
+#include <Uri.h>
+#include <uri/UriBraces.h>
+#include <uri/UriGlob.h>
+
+using esp8266webserver::RouteIndex;
+
+// stands for the server's handler list: uris in registration order
+struct Routes
+{
+    std::vector<std::unique_ptr<Uri>> uris;
+    RouteIndex                        index;
+    std::vector<RouteIndex::Id>       candidates;
+    std::vector<String>               pathArgs;
+
+    void add(const Uri& uri)
+    {
+        // the server keeps clones, which carry the route kind
+        uris.emplace_back(uri.clone());
+    }
+
+    // same as ESP8266WebServerTemplate::_buildRoutes()
+    void build()
+    {
+        index.clear();
+        for (size_t id = 0; id < uris.size(); id++)
+        {
+            const Uri* uri = uris[id].get();
+            switch (uri->routeKind())
+            {
+            case Uri::ROUTE_EXACT:
+                index.addExact(uri->str(), id);
+                break;
+            case Uri::ROUTE_PREFIX:
+            {
+                int brace = uri->str().indexOf('{');
+                index.addPrefix(brace < 0 ? uri->str() : uri->str().substring(0, brace), id);
+                break;
+            }
+            default:
+                index.addAlways(id);
+                break;
+            }
+        }
+        index.build();
+    }
+
+    // former dispatch
+    int walk(const String& uri)
+    {
+        for (size_t id = 0; id < uris.size(); id++)
+            if (uris[id]->canHandle(uri, pathArgs))
+                return id;
+        return -1;
+    }
+
+    int lookup(const String& uri)
+    {
+        index.candidates(uri, candidates);
+        for (RouteIndex::Id id : candidates)
+            if (uris[id]->canHandle(uri, pathArgs))
+                return id;
+        return -1;
+    }
+};
+
+static void restApi(Routes& routes)
+{
+    static const char* const resources[]
+        = { "sensors", "relays", "leds", "buttons", "config", "wifi", "time", "logs" };
+    for (const char* r : resources)
+    {
+        String base = String("/api/") + r;
+        routes.add(Uri(base));
+        routes.add(Uri(base + "/count"));
+        routes.add(UriBraces(base + "/{}"));
+        routes.add(UriBraces(base + "/{}/history/{}"));
+    }
+    routes.add(Uri("/"));
+    routes.add(Uri("/index.html"));
+    routes.add(Uri("/status"));
+    routes.add(UriBraces("/files/{}"));
+    routes.add(UriGlob("/static/*"));
+    routes.add(UriGlob("/assets/*.js"));
+    routes.add(UriBraces("/{}.json"));
+    routes.add(Uri("/update"));
+}
+
+static const char* const requests[] = {
+    "/",
+    "/status",
+    "/update",
+    "/api/sensors",
+    "/api/logs/count",
+    "/api/relays/3",
+    "/api/leds/2/history/10",
+    "/api/time/x/y",
+    "/files/readme.txt",
+    "/static/style.css",
+    "/assets/app.js",
+    "/config.json",
+    "/nothing/here",
+    "/api/unknown",
+};
+
+TEST_CASE("RouteIndex finds the same handler as the list walk", "[webserver][RouteIndex]")
+{
+    Routes routes;
+    restApi(routes);
+    REQUIRE(routes.uris.size() == 40);
+    routes.build();
+
+    for (const char* req : requests)
+    {
+        String uri(req);
+        INFO(req);
+        CHECK(routes.lookup(uri) == routes.walk(uri));
+    }
+    CHECK(routes.lookup("/api/relays/3") == 6);
+    CHECK(routes.lookup("/nothing/here") == -1);
+}
+
+TEST_CASE("RouteIndex keeps registration order", "[webserver][RouteIndex]")
+{
+    Routes routes;
+    routes.add(UriBraces("/a/{}"));
+    routes.add(Uri("/a/b"));
+    routes.add(UriGlob("/a/*"));
+    routes.add(UriBraces("/a/b{}"));
+    routes.add(Uri("/a/b"));
+    routes.add(UriBraces("/{}"));
+    routes.build();
+
+    using Ids = std::vector<RouteIndex::Id>;
+    Ids ids;
+    routes.index.candidates("/a/b", ids);
+    CHECK((ids == Ids { 0, 1, 2, 3, 4, 5 }));
+    routes.index.candidates("/a/c", ids);
+    CHECK((ids == Ids { 0, 2, 5 }));
+    routes.index.candidates("/b", ids);
+    CHECK((ids == Ids { 2, 5 }));
+
+    CHECK(routes.lookup("/a/b") == 0);
+    CHECK(routes.lookup("/a/b/c") == 2);
+
+    // prefixes sharing a beginning split the trie
+    Routes split;
+    split.add(UriBraces("/users/{}"));
+    split.add(UriBraces("/user{}"));
+    split.add(UriBraces("/use/{}"));
+    split.build();
+    split.index.candidates("/users/1", ids);
+    CHECK((ids == Ids { 0, 1 }));
+    split.index.candidates("/use/1", ids);
+    CHECK((ids == Ids { 2 }));
+    split.index.candidates("/us", ids);
+    CHECK(ids.empty());
+}
+
+TEST_CASE("RouteIndex dispatch time", "[webserver][RouteIndex]")
+{
+    Routes routes;
+    restApi(routes);
+    routes.build();
+
+    std::vector<String> uris;
+    for (const char* req : requests)
+        uris.emplace_back(req);
+
+    constexpr int rounds = 2000;
+    using clock         = std::chrono::steady_clock;
+    int  found          = 0;
+    auto start          = clock::now();
+    for (int i = 0; i < rounds; i++)
+        for (const String& uri : uris)
+            found += routes.walk(uri) >= 0;
+    auto walk = clock::now() - start;
+
+    start = clock::now();
+    for (int i = 0; i < rounds; i++)
+        for (const String& uri : uris)
+            found -= routes.lookup(uri) >= 0;
+    auto lookup = clock::now() - start;
+
+    auto ns = [](clock::duration d)
+    { return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(); };
+    printf("dispatch among %zu routes: list walk %.0f ns, route index %.0f ns per request\n",
+           routes.uris.size(), ns(walk) / (rounds * uris.size()),
+           ns(lookup) / (rounds * uris.size()));
+    CHECK(found == 0);
+}
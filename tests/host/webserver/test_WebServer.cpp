@@ -0,0 +1,230 @@
+/*
+ test_WebServer.cpp - ESP8266WebServer connection handling, on scripted
+ clients
+
+ This library is free software; you can redistribute it and/or
+ modify it under the terms of the GNU Lesser General Public
+ License as published by the Free Software Foundation; either
+ version 2.1 of the License, or (at your option) any later version.
+ */
+
+#include <catch.hpp>
+#include <Arduino.h>
+#include <ESP8266WebServer.h>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace
+{
+
+// both ends of a connection: what the peer sent and what it received
+struct FakeConnection
+{
+    std::string in;
+    size_t      inPos = 0;
+    std::string out;
+    bool        connected = true;
+    int         stops     = 0;
+
+    size_t pending() const
+    {
+        return in.size() - inPos;
+    }
+};
+
+struct FakeClient: public WiFiClient
+{
+    std::shared_ptr<FakeConnection> conn;
+
+    FakeClient() { }
+    FakeClient(std::shared_ptr<FakeConnection> conn) : conn(conn) { }
+
+    uint8_t connected() override
+    {
+        return conn && conn->connected;
+    }
+    operator bool() override
+    {
+        return (bool)conn;
+    }
+    int available() override
+    {
+        return conn ? conn->pending() : 0;
+    }
+    int read() override
+    {
+        return available() ? (uint8_t)conn->in[conn->inPos++] : -1;
+    }
+    int read(uint8_t* buf, size_t size) override
+    {
+        size = std::min(size, (size_t)available());
+        memcpy(buf, peekBuffer(), size);
+        peekConsume(size);
+        return size;
+    }
+    int peek() override
+    {
+        return available() ? (uint8_t)conn->in[conn->inPos] : -1;
+    }
+    bool hasPeekBufferAPI() const override
+    {
+        return true;
+    }
+    size_t peekAvailable() override
+    {
+        return available();
+    }
+    const char* peekBuffer() override
+    {
+        return conn ? conn->in.data() + conn->inPos : nullptr;
+    }
+    void peekConsume(size_t consume) override
+    {
+        conn->inPos += std::min(consume, conn->pending());
+    }
+    using WiFiClient::write;
+    size_t write(uint8_t c) override
+    {
+        return write(&c, 1);
+    }
+    size_t write(const uint8_t* buf, size_t size) override
+    {
+        if (!connected())
+            return 0;
+        conn->out.append((const char*)buf, size);
+        return size;
+    }
+    size_t write_P(PGM_P buf, size_t size) override
+    {
+        return write((const uint8_t*)buf, size);
+    }
+    size_t writev(const Buffer* buffers, size_t count) override
+    {
+        return Print::writev(buffers, count);
+    }
+    int availableForWrite() override
+    {
+        return connected() ? 4096 : 0;
+    }
+    using WiFiClient::flush;
+    void flush() override { }
+    using WiFiClient::stop;
+    void stop() override
+    {
+        if (conn)
+        {
+            conn->stops++;
+            conn->connected = false;
+        }
+    }
+};
+
+// connections waiting to be accepted, and whether another one has data
+struct FakeServer
+{
+    using ClientType = FakeClient;
+
+    std::deque<std::shared_ptr<FakeConnection>> incoming;
+    bool                                        clientData = false;
+
+    FakeServer(IPAddress, int) { }
+    FakeServer(int) { }
+    void begin() { }
+    void begin(uint16_t) { }
+    void close() { }
+
+    FakeClient accept()
+    {
+        if (incoming.empty())
+            return FakeClient();
+        auto conn = incoming.front();
+        incoming.pop_front();
+        return FakeClient(conn);
+    }
+    bool hasClient()
+    {
+        return !incoming.empty();
+    }
+    size_t hasClientData()
+    {
+        return clientData;
+    }
+    bool hasMaxPendingClients()
+    {
+        return false;
+    }
+};
+
+}  // namespace
+
+using FakeWebServer = esp8266webserver::ESP8266WebServerTemplate<FakeServer>;
+
+static std::shared_ptr<FakeConnection> connect(FakeWebServer& server)
+{
+    auto conn = std::make_shared<FakeConnection>();
+    server.getServer().incoming.push_back(conn);
+    return conn;
+}
+
+static size_t responses(const FakeConnection& conn)
+{
+    size_t count = 0;
+    for (size_t pos = 0; (pos = conn.out.find("HTTP/1.1 200", pos)) != std::string::npos; pos++)
+        count++;
+    return count;
+}
+
+TEST_CASE("WebServer times a kept-alive request from its first bytes", "[webserver][server]")
+{
+    FakeWebServer server;
+    server.on("/", [&server]() { server.send(200, "text/plain", "ok"); });
+    server.setKeepAliveTimeout(2000);
+    server.begin();
+
+    auto conn = connect(server);
+    conn->in += "GET / HTTP/1.1\r\nHost: esp\r\n\r\n";
+    server.handleClient();
+    REQUIRE(responses(*conn) == 1);
+    CHECK(conn->out.find("Connection: keep-alive") != std::string::npos);
+
+    // idle for longer than a request may take to arrive when another
+    // client is waiting, then a request in two segments
+    delay(HTTP_MAX_DATA_AVAILABLE_WAIT + 20);
+    server.handleClient();
+    server.getServer().clientData = true;
+    conn->in += "GET / HTTP/1.1\r\nHo";
+    server.handleClient();
+    conn->in += "st: esp\r\n\r\n";
+    server.handleClient();
+    CHECK(responses(*conn) == 2);
+    CHECK(conn->stops == 0);
+
+    server.close();
+}
+
+TEST_CASE("WebServer gathers a request body without holding other clients", "[webserver][server]")
+{
+    FakeWebServer server;
+    server.setMaxClients(2);
+    server.on("/", [&server]() { server.send(200, "text/plain", "ok"); });
+    server.on("/echo", HTTP_POST, [&server]() { server.send(200, "text/plain", server.arg("plain")); });
+    server.begin();
+
+    auto slow = connect(server);
+    auto fast = connect(server);
+    slow->in += "POST /echo HTTP/1.1\r\nHost: esp\r\nContent-Length: 10\r\n\r\nhello";
+    fast->in += "GET / HTTP/1.1\r\nHost: esp\r\n\r\n";
+    uint32_t start = millis();
+    server.handleClient();
+    CHECK((millis() - start) < 100);
+    CHECK(responses(*fast) == 1);
+    CHECK(responses(*slow) == 0);
+
+    slow->in += "world";
+    server.handleClient();
+    REQUIRE(responses(*slow) == 1);
+    CHECK(slow->out.substr(slow->out.size() - 10) == "helloworld");
+    CHECK(slow->pending() == 0);
+    server.close();
+}
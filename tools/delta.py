@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+#
+# Delta OTA patch generator, for Update.setDelta()
+#
+# Makes a patch that rebuilds the new sketch .bin from the one the device
+# runs, in the format cores/esp8266/DeltaPatch.h reads.  Patches are gzip
+# compressed by default and then need Update.setInflate() too.
+#
+import argparse
+import hashlib
+import struct
+import sys
+import zlib
+
+MAGIC = b'ESPD'
+# header bytes of the source rewritten by upload tools, never diffed against
+SOURCE_SKIP = 4
+# bytes that must match exactly to find a copy in the source
+BLOCK = 16
+# approximate matches end after this many bytes with no gain
+LOOKAHEAD = 64
+
+def parse_args():
+    parser = argparse.ArgumentParser(description='Delta OTA patch generator')
+    parser.add_argument('-s', '--source', required=True, help='Sketch binary running on the device')
+    parser.add_argument('-t', '--target', required=True, help='New sketch binary (signed, if signing is used)')
+    parser.add_argument('-o', '--out', required=True, help='Output patch file')
+    parser.add_argument('-w', '--window-bits', type=int, default=15,
+                        help='gzip window, 8..15, as given to Update.setInflate() (default 15)')
+    parser.add_argument('-r', '--raw', action='store_true', help='Do not compress the patch')
+    return parser.parse_args()
+
+def sketch_size(image):
+    """Size ESP.getSketchSize() gives for this image once flashed."""
+    pos = 0x1000
+    if len(image) < pos + 8 or image[pos] != 0xe9:
+        return len(image)
+    segments = image[pos + 1]
+    pos += 8
+    for _ in range(segments):
+        size, = struct.unpack('<I', image[pos + 4:pos + 8])
+        pos += 8 + size
+    return min((pos + 16) & ~15, len(image))
+
+def extend(source, target, s, t):
+    """Length of the approximate match from source[s] and target[t], the one
+    with the most matching bytes over mismatching ones (as bsdiff does)."""
+    score = best = length = 0
+    i = 0
+    end = min(len(source) - s, len(target) - t)
+    while i < end:
+        if source[s + i] == target[t + i]:
+            score += 1
+        i += 1
+        if 2 * score - i > 2 * best - length:
+            best, length = score, i
+        elif i - length > LOOKAHEAD:
+            break
+    return length
+
+def diff(source, target):
+    """Records (diff start in target, source offset, diff length, extra length)."""
+    index = {}
+    # every 4th position is enough, a match of BLOCK + 3 bytes holds one
+    for i in range(len(source) - BLOCK, SOURCE_SKIP - 1, -1):
+        if i % 4 == 0:
+            index[source[i:i + BLOCK]] = i
+
+    records = []
+    last_t, last_s, last_len = 0, 0, 0
+    t = 0
+    while t + BLOCK <= len(target):
+        s = index.get(target[t:t + BLOCK])
+        if s is None:
+            t += 1
+            continue
+        gap = last_t + last_len
+        while t > gap and s > SOURCE_SKIP and source[s - 1] == target[t - 1]:
+            s -= 1
+            t -= 1
+        length = extend(source, target, s, t)
+        records.append((last_t, last_s, last_len, t - gap))
+        last_t, last_s, last_len = t, s, length
+        t += length
+    records.append((last_t, last_s, last_len, len(target) - last_t - last_len))
+    return records
+
+def make_patch(source, target):
+    source = source[:sketch_size(source)]
+    patch = bytearray(MAGIC)
+    patch += struct.pack('<II', len(source), len(target))
+    patch += hashlib.md5(source[SOURCE_SKIP:]).digest()
+
+    records = diff(source, target)
+    for n, (t, s, length, extra) in enumerate(records):
+        # the next record reads the source from its own offset
+        following = records[n + 1][1] if n + 1 < len(records) else s + length
+        patch += struct.pack('<IIi', length, extra, following - (s + length))
+        patch += bytes((target[t + i] - source[s + i]) & 0xff for i in range(length))
+        patch += target[t + length:t + length + extra]
+    return bytes(patch)
+
+def main():
+    args = parse_args()
+    if not 8 <= args.window_bits <= 15:
+        sys.stderr.write("Window bits must be 8..15\n")
+        return 1
+    with open(args.source, "rb") as f:
+        source = f.read()
+    with open(args.target, "rb") as f:
+        target = f.read()
+
+    patch = make_patch(source, target)
+    size = len(patch)
+    if not args.raw:
+        gz = zlib.compressobj(9, zlib.DEFLATED, 16 + args.window_bits)
+        patch = gz.compress(patch) + gz.flush()
+    with open(args.out, "wb") as out:
+        out.write(patch)
+    sys.stderr.write("Patch: " + args.out + ", " + str(len(patch)) + " bytes (" + str(size) +
+                     " uncompressed) for a " + str(len(target)) + " bytes image\n")
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())